@@ -2382,6 +2382,8 @@ main(int argc, char **argv, char **envp) /* qstat */
 	enum { JOBS, QUEUES, SERVERS } mode;
 	struct batch_status *p_status;
 	struct batch_status *p_server = NULL;
+	struct batch_status *p_hdr;
+	struct pbs_statjob_iter *p_iter = NULL;
 	struct attropl *p_atropl = 0;
 	struct attropl *new_atropl;
 #ifdef NAS /* localmod 071 */
@@ -2962,10 +2964,15 @@ job_no_args:
 				}
 
 				if ((stat_single_job == 1) || (new_atropl == 0)) {
-					if (E_opt == 1)
-						p_status = pbs_statjob(conn, query_job_list, display_attribs, extend);
+					char *stat_id = (E_opt == 1) ? query_job_list : job_id_out;
+
+					/* -T sorts all of the jobs, others are shown a page at a time */
+					if (alt_opt & ALT_DISPLAY_T)
+						p_status = pbs_statjob(conn, stat_id, display_attribs, extend);
+					else if ((p_iter = pbs_statjob_open(conn, stat_id, display_attribs, extend)) != NULL)
+						p_status = pbs_statjob_next(p_iter);
 					else
-						p_status = pbs_statjob(conn, job_id_out, display_attribs, extend);
+						p_status = NULL;
 				} else {
 					p_status = pbs_selstat(conn, new_atropl, NULL, extend);
 				}
@@ -2981,6 +2988,8 @@ job_no_args:
 					if ((pbs_errno == PBSE_UNKJOBID) && !located) {
 						located = TRUE;
 						if (locate_job(job_id_out, server_out, rmt_server)) {
+							pbs_statjob_close(p_iter);
+							p_iter = NULL;
 							pbs_disconnect(conn);
 							strcpy(server_out, rmt_server);
 							goto job_no_args;
@@ -3028,30 +3037,42 @@ job_no_args:
 						any_failed = pbs_errno;
 					}
 				} else {
-
+					/* the header goes out with the first page only */
+					p_hdr = p_server;
+					do {
 #ifdef NAS /* localmod 071 */
-					if (p_server) {
-						tcl_stat("serverhdr", p_server, tcl_opt);
-						tcl_stat("resv", p_rsvstat, tcl_opt);
-					}
-					if (tcl_stat("job", p_status, tcl_opt)) {
-						if (alt_opt != 0) {
-							altdsp_statjob(p_status, p_server, alt_opt, wide, how_opt);
-						} else
-							if (display_statjob(p_status, p_server, f_opt, how_opt))
-								exit_qstat("out of memory");
-					}
+						if (p_hdr) {
+							tcl_stat("serverhdr", p_hdr, tcl_opt);
+							tcl_stat("resv", p_rsvstat, tcl_opt);
+						}
+						if (tcl_stat("job", p_status, tcl_opt)) {
+							if (alt_opt != 0) {
+								altdsp_statjob(p_status, p_hdr, alt_opt, wide, how_opt);
+							} else
+								if (display_statjob(p_status, p_hdr, f_opt, how_opt))
+									exit_qstat("out of memory");
+						}
 #else
 
-					if ((alt_opt & ~ALT_DISPLAY_w) != 0 && !(wide && f_opt)) {
-						altdsp_statjob(p_status, p_server, alt_opt, wide, how_opt);
-					} else if (f_opt == 0 || tcl_stat("job", p_status, f_opt))
-						if (display_statjob(p_status, p_server, f_opt, how_opt, alt_opt, wide))
-							exit_qstat("out of memory");
+						if ((alt_opt & ~ALT_DISPLAY_w) != 0 && !(wide && f_opt)) {
+							altdsp_statjob(p_status, p_hdr, alt_opt, wide, how_opt);
+						} else if (f_opt == 0 || tcl_stat("job", p_status, f_opt))
+							if (display_statjob(p_status, p_hdr, f_opt, how_opt, alt_opt, wide))
+								exit_qstat("out of memory");
 #endif /* localmod 071 */
-					p_header = FALSE;
-					pbs_statfree(p_status);
+						p_header = FALSE;
+						p_hdr = NULL;
+						pbs_statfree(p_status);
+					} while (p_iter != NULL && (p_status = pbs_statjob_next(p_iter)) != NULL);
+
+					/* lost the server part way through the listing */
+					if (p_iter != NULL && pbs_errno == PBSE_PROTOCOL) {
+						prt_job_err("qstat", conn, job_id_out);
+						any_failed = pbs_errno;
+					}
 				}
+				pbs_statjob_close(p_iter);
+				p_iter = NULL;
 				pbs_statfree(p_server);
 				p_server = NULL;
 				pbs_disconnect(conn);
@@ -109,6 +109,17 @@ struct rq_deletejoblist {
 	char **rq_jobslist;
 };
 
+/* ModifyJobs_Async - attribute updates for a list of jobs */
+struct rq_modifyjobs_ent {
+	char rq_objname[PBS_MAXSVRJOBID + 1];
+	pbs_list_head rq_attr; /* svrattrlist */
+};
+
+struct rq_modifyjobs {
+	int rq_count;
+	struct rq_modifyjobs_ent *rq_jobs;
+};
+
 /* Management - used by PBS_BATCH_Manager requests */
 struct rq_management {
 	struct rq_manage rq_manager;
@@ -286,6 +297,7 @@ struct batch_request {
 	int rq_orgconn;				/* original socket if relayed to MOM */
 	int rq_extsz;				/* size of "extension" data */
 	long rq_time;				/* time batch request created */
+	long rq_jobsaveseq;			/* deferred job saves when request created */
 	char rq_user[PBS_MAXUSER + 1];		/* user name request is from */
 	char rq_host[PBS_MAXHOSTNAME + 1];	/* name of host sending request */
 	void *rq_extra;				/* optional ptr to extra info */
@@ -314,6 +326,7 @@ struct batch_request {
 		struct rq_relnodes rq_relnodes;
 		struct rq_py_spawn rq_py_spawn;
 		struct rq_manage rq_modify;
+		struct rq_modifyjobs rq_modifyjobs;
 		struct rq_move rq_move;
 		struct rq_register rq_register;
 		struct rq_manage rq_release;
@@ -405,6 +418,7 @@ extern int decode_DIS_DelJobList(int, struct batch_request *);
 extern int decode_DIS_MoveJob(int, struct batch_request *);
 extern int decode_DIS_MessageJob(int, struct batch_request *);
 extern int decode_DIS_ModifyResv(int, struct batch_request *);
+extern int decode_DIS_ModifyJobs(int, struct batch_request *);
 extern int decode_DIS_PySpawn(int, struct batch_request *);
 extern int decode_DIS_QueueJob(int, struct batch_request *);
 extern int decode_DIS_Register(int, struct batch_request *);
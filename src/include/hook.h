@@ -302,6 +302,22 @@ typedef struct hook hook;
 #define	FMT_HOOK_RESCDEF_COPY "%s" FMT_HOOK_PREFIX "resourcedef.%s"
 #define	FMT_HOOK_LOG "%s" FMT_HOOK_PREFIX "log%d"
 
+/*
+ * Persistent pbs_python hook worker used by MoM.  The worker is started
+ * as "pbs_python --hook-worker <listen_fd> <path_log> <log_event_mask>
+ * [<resourcedef>]" and accepts requests on the unix socket
+ * HOOK_WORKER_SOCK in the hooks work directory.  A request is a 32-bit
+ * string count followed by that many length-prefixed strings: the working
+ * directory, the hook config file (or empty), then the "--hook" argument
+ * vector.  The reply is the wait status of the hook process, or
+ * HOOK_WORKER_DECLINED if the caller should run pbs_python itself.
+ */
+#define	HOOK_WORKER_MODE	"--hook-worker"
+#define	HOOK_WORKER_SOCK	FMT_HOOK_PREFIX "worker.sock"
+#define	HOOK_WORKER_DECLINED	(-1)
+#define	HOOK_WORKER_MAXSTRS	32
+#define	HOOK_WORKER_MAXREQ	65536
+
 /* Special log levels  - values must not intersect PBS_EVENT* values in log.h */
 
 #define SEVERITY_LOG_DEBUG		0x0005		/* syslog DEBUG */
@@ -57,6 +57,8 @@ int __pbs_alterjob(int, char *, struct attrl *, char *);
 
 int __pbs_asyalterjob(int, char *, struct attrl *, char *);
 
+int __pbs_asyalterjobs(int, struct alterjob_info *, int, char *);
+
 int __pbs_confirmresv(int, char *, char *, unsigned long, char *);
 
 int __pbs_connect(char *);
@@ -105,6 +107,12 @@ struct batch_status *__pbs_statrsc(int, char *, struct attrl *, char *);
 
 struct batch_status *__pbs_statjob(int, char *, struct attrl *, char *);
 
+struct pbs_statjob_iter *__pbs_statjob_open(int, char *, struct attrl *, char *);
+
+struct batch_status *__pbs_statjob_next(struct pbs_statjob_iter *);
+
+void __pbs_statjob_close(struct pbs_statjob_iter *);
+
 struct batch_status *__pbs_selstat(int, struct attropl *, struct attrl *, char *);
 
 struct batch_status *__pbs_statque(int, char *, struct attrl *, char *);
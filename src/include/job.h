@@ -495,6 +495,9 @@ struct job {
 	int ji_discarding;		   /* discarding job */
 	struct batch_request *ji_prunreq;  /* outstanding runjob request */
 	pbs_list_head ji_svrtask;	   /* links to svr work_task list */
+	pbs_list_link ji_dirtyjobs;	   /* links to jobs with a deferred save pending */
+	struct qrank_node *ji_svr_rank;	   /* node in svr_alljobs qrank index */
+	struct qrank_node *ji_que_rank;	   /* node in queue's qrank index */
 	struct pbs_queue *ji_qhdr;	   /* current queue header */
 	struct resc_resv *ji_myResv;	   /* !=0 job belongs to a reservation, see also, attribute JOB_ATR_myResv */
 
@@ -1012,6 +1015,11 @@ extern int   site_check_user_map(void *, int, char *);
 extern int   site_allow_u(char *user, char *host);
 extern void  svr_dequejob(job *);
 extern int   svr_enquejob(job *, char *);
+struct qrank_node;
+extern void  job_qrank_unindex(job *);
+extern void  job_qrank_swap(job *, job *);
+extern void  qrank_idx_remove(struct qrank_node *);
+extern void  qrank_idx_free(struct qrank_node *);
 extern void  svr_evaljobstate(job *, char *, int *, int);
 extern int   svr_setjobstate(job *, char, int);
 extern int   state_char2int(char);
@@ -1068,6 +1076,10 @@ extern int job_save_fs(job *);
 
 extern job *job_recov_db(char *, job *pjob);
 extern int job_save_db(job *);
+extern void job_save_db_flush(int);
+extern void job_save_db_cancel(job *);
+extern time_t job_save_db_waittime(time_t);
+extern long job_save_db_seq(void);
 
 #define job_save  job_save_db
 #define job_recov job_recov_db
@@ -1088,6 +1100,7 @@ extern int   svr_chk_ownerResv(struct batch_request *, resc_resv *);
 #endif	/* _BATCH_REQUEST_H */
 
 #ifdef	_QUEUE_H
+extern job  *find_job_by_qrank(pbs_queue *, long);
 extern int   svr_chkque(job *, pbs_queue *, char *, int mtype);
 extern int   default_router(job *, pbs_queue *, long);
 extern int   site_alt_router(job *, pbs_queue *, long);
@@ -311,6 +311,7 @@ struct batch_reply
 #define PBS_BATCH_ModifyVnode    	99
 #define PBS_BATCH_DeleteJobList  	100
 #define PBS_BATCH_ServerReady    	101
+#define PBS_BATCH_ModifyJobs_Async	102
 
 #define PBS_BATCH_FileOpt_Default	0
 #define PBS_BATCH_FileOpt_OFlg		1
@@ -337,6 +338,20 @@ struct batch_reply
 #define EXTEND_OPT_NEXT_MSG_TYPE "next_msg_type"
 #define EXTEND_OPT_NEXT_MSG_PARAM "next_msg_param"
 
+/*
+ * Paging options of a PBS_BATCH_StatusJob request for the jobs of a queue
+ * or of the server.  They follow the flag characters of the extend string,
+ * each preceded by a comma: "xt,page=1000,after=123.svr,rank=1700000000000".
+ * A page which stops short of the end of the list carries the cursor to
+ * pass back as "rank=" in a STAT_PAGE_CURSOR attribute of its last status.
+ */
+#define EXTEND_OPT_STAT_PAGE "page="	/* max jobs in the reply */
+#define EXTEND_OPT_STAT_AFTER "after="	/* resume after this job */
+#define EXTEND_OPT_STAT_RANK "rank="	/* qrank 'after' had in the previous page */
+#define STAT_PAGE_CURSOR "page_cursor"	/* attribute holding the cursor */
+#define STAT_PAGE_MORE 1		/* reply auxcode: more jobs follow */
+#define STAT_PAGE_DFLT 1000		/* page size used by pbs_statjob_next() */
+
 int is_compose(int, int);
 int is_compose_cmd(int, int, char **);
 void PBS_free_aopl(struct attropl *);
@@ -377,6 +392,7 @@ int encode_DIS_Manage(int, int, int, char *, struct attropl *);
 int encode_DIS_MessageJob(int, char *, int, char *);
 int encode_DIS_MoveJob(int, char *, char *);
 int encode_DIS_ModifyResv(int, char *, struct attropl *);
+int encode_DIS_ModifyJobs(int, struct alterjob_info *, int);
 int encode_DIS_RelnodesJob(int, char *, char *);
 int encode_DIS_PySpawn(int, char *, char **, char **);
 int encode_DIS_QueueJob(int, char *, char *, struct attropl *);
@@ -341,6 +341,13 @@ char *perf_stat_stop(char *instance);
 extern char *netaddr(struct sockaddr_in *);
 extern unsigned long crc_file(char *fname);
 extern int get_fullhostname(char *, char *, int);
+
+/* host name resolution cache */
+#define PBS_RESOLVE_MAXADDRS	16	/* IPv4 addresses kept per host name */
+extern int pbs_resolve_addrs(char *, unsigned long *, int, int *);
+extern int pbs_resolve_name(unsigned long, char *, size_t);
+extern void pbs_resolve_cache_invalidate(char *);
+extern void pbs_resolve_cache_stats(unsigned long *, unsigned long *);
 extern char *parse_servername(char *, unsigned int *);
 extern int rand_num(void);
 extern int msvr_mode(void);
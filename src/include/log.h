@@ -107,6 +107,7 @@ extern int set_msgdaemonname(const char *ch);
 void set_log_conf(char *leafname, char *nodename,
 		  unsigned int islocallog, unsigned int sl_fac, unsigned int sl_svr,
 		  unsigned int log_highres);
+void set_log_async(unsigned int async, unsigned int overflow_drop, unsigned int shutdown_flush);
 
 extern struct log_net_info *get_if_info(char *msg);
 extern void free_if_info(struct log_net_info *ni);
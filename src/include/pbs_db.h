@@ -331,6 +331,34 @@ int pbs_db_connect(void **conn, char *host, int port, int timeout);
  */
 int pbs_db_disconnect(void *conn);
 
+/**
+ * @brief
+ *	Start a transaction, so that the following statements are
+ *	committed (or rolled back) together by pbs_db_end_trx
+ *
+ * @param[in]   conn - Connected database handle
+ *
+ * @return      int
+ * @retval      -1  - Failure
+ * @retval       0  - success
+ *
+ */
+int pbs_db_begin_trx(void *conn);
+
+/**
+ * @brief
+ *	End a transaction started by pbs_db_begin_trx
+ *
+ * @param[in]   conn - Connected database handle
+ * @param[in]   commit - 1 to commit, 0 to roll back
+ *
+ * @return      int
+ * @retval      -1  - Failure
+ * @retval       0  - success
+ *
+ */
+int pbs_db_end_trx(void *conn, int commit);
+
 /**
  * @brief
  *	Insert a new object into the database
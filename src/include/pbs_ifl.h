@@ -320,6 +320,7 @@ extern "C" {
 #define ATTR_python_restart_max_hooks "python_restart_max_hooks"
 #define ATTR_python_restart_max_objects "python_restart_max_objects"
 #define ATTR_python_restart_min_interval "python_restart_min_interval"
+#define ATTR_job_save_window "job_save_window"
 #define ATTR_power_provisioning "power_provisioning"
 #define ATTR_sync_mom_hookfiles_timeout "sync_mom_hookfiles_timeout"
 #define ATTR_max_job_sequence_id "max_job_sequence_id"
@@ -571,6 +572,15 @@ typedef struct preempt_job_info {
         char	order[PREEMPT_METHOD_HIGH + 1];
 } preempt_job_info;
 
+/* one job's worth of attribute updates for pbs_asyalterjobs() */
+typedef struct alterjob_info {
+	char *job_id;
+	struct attrl *attrib;
+} alterjob_info;
+
+/* job status returned a page at a time, see pbs_statjob_open() */
+struct pbs_statjob_iter;
+
 /* Resource Reservation Information */
 typedef int	pbs_resource_t;	/* resource reservation handle */
 
@@ -708,6 +718,8 @@ extern int pbs_alterjob(int, char *, struct attrl *, char *);
 
 extern int pbs_asyalterjob(int c, char *jobid, struct attrl *attrib, char *extend);
 
+extern int pbs_asyalterjobs(int c, struct alterjob_info *jobs, int njobs, char *extend);
+
 extern int pbs_confirmresv(int, char *, char *, unsigned long, char *);
 
 extern int pbs_connect(char *);
@@ -758,6 +770,12 @@ extern struct batch_status *pbs_statrsc(int, char *, struct attrl *, char *);
 
 extern struct batch_status *pbs_statjob(int, char *, struct attrl *, char *);
 
+extern struct pbs_statjob_iter *pbs_statjob_open(int, char *, struct attrl *, char *);
+
+extern struct batch_status *pbs_statjob_next(struct pbs_statjob_iter *);
+
+extern void pbs_statjob_close(struct pbs_statjob_iter *);
+
 extern struct batch_status *pbs_selstat(int, struct attropl *, struct attrl *, char *);
 
 extern struct batch_status *pbs_statque(int, char *, struct attrl *, char *);
@@ -796,6 +814,7 @@ extern int (*pfn_pbs_asyrunjob)(int, char *, char *, char *);
 extern int (*pfn_pbs_asyrunjob_ack)(int, char *, char *, char *);
 extern int (*pfn_pbs_alterjob)(int, char *, struct attrl *, char *);
 extern int (*pfn_pbs_asyalterjob)(int, char *, struct attrl *, char *);
+extern int (*pfn_pbs_asyalterjobs)(int, struct alterjob_info *, int, char *);
 extern int (*pfn_pbs_confirmresv)(int, char *, char *, unsigned long, char *);
 extern int (*pfn_pbs_connect)(char *);
 extern int (*pfn_pbs_connect_extend)(char *, char *);
@@ -820,6 +839,9 @@ extern void (*pfn_pbs_statfree)(struct batch_status *);
 extern void (*pfn_pbs_delstatfree)(struct batch_deljob_status *);
 extern struct batch_status *(*pfn_pbs_statrsc)(int, char *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_statjob)(int, char *, struct attrl *, char *);
+extern struct pbs_statjob_iter *(*pfn_pbs_statjob_open)(int, char *, struct attrl *, char *);
+extern struct batch_status *(*pfn_pbs_statjob_next)(struct pbs_statjob_iter *);
+extern void (*pfn_pbs_statjob_close)(struct pbs_statjob_iter *);
 extern struct batch_status *(*pfn_pbs_selstat)(int, struct attropl *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_statque)(int, char *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_statserver)(int, struct attrl *, char *);
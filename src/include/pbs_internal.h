@@ -254,6 +254,11 @@ struct pbs_config
 	char *pbs_mom_node_name;	/* mom short name used for natural node, default NULL */
 	char *pbs_lr_save_path;		/* path to store undo live recordings */
 	unsigned int pbs_log_highres_timestamp; /* high resolution logging */
+	unsigned int pbs_log_async;		/* write daemon logs from a background thread */
+	unsigned int pbs_log_async_drop;	/* drop async log records when the queue is full */
+	unsigned int pbs_log_async_flush;	/* write queued async log records at shutdown */
+	unsigned int pbs_dns_cache_ttl;		/* seconds to cache a host name resolution */
+	unsigned int pbs_dns_cache_neg_ttl;	/* seconds to cache a failed resolution */
 	unsigned int pbs_sched_threads;	/* number of threads for scheduler */
 	char *pbs_daemon_service_user; /* user the scheduler runs as */
 	char current_user[PBS_MAXUSER+1]; /* current running user */
@@ -320,6 +325,11 @@ extern struct pbs_config pbs_conf;
 #define PBS_CONF_MOM_NODE_NAME	"PBS_MOM_NODE_NAME"
 #define PBS_CONF_LR_SAVE_PATH	"PBS_LR_SAVE_PATH"
 #define PBS_CONF_LOG_HIGHRES_TIMESTAMP	"PBS_LOG_HIGHRES_TIMESTAMP"
+#define PBS_CONF_LOG_ASYNC	"PBS_LOG_ASYNC"
+#define PBS_CONF_LOG_ASYNC_DROP	"PBS_LOG_ASYNC_DROP"
+#define PBS_CONF_LOG_ASYNC_FLUSH	"PBS_LOG_ASYNC_FLUSH"
+#define PBS_CONF_DNS_CACHE_TTL	"PBS_DNS_CACHE_TTL"
+#define PBS_CONF_DNS_CACHE_NEG_TTL	"PBS_DNS_CACHE_NEG_TTL"
 #define PBS_CONF_SCHED_THREADS	"PBS_SCHED_THREADS"
 #define PBS_CONF_DAEMON_SERVICE_USER "PBS_DAEMON_SERVICE_USER"
 #ifdef WIN32
@@ -82,10 +82,47 @@ struct JsonNode {
 	} value;
 };
 
+/*
+ * A parsed JSON text.  Its nodes are laid out in document order the way
+ * add_json_node() builds them: an object or array is a JSON_OBJECT or
+ * JSON_ARRAY node, its members, then the matching _END node.  Strings
+ * and keys are decoded into 'buf'.  Integers, true, false and null are
+ * kept as JSON_NUMERIC literals.
+ */
+typedef struct JsonDoc {
+	JsonNode *nodes;
+	int count;
+	int size;
+	char *buf;
+	int refs;	/* JsonObjects holding members of the document */
+} JsonDoc;
+
+/* member of a JsonObject: the node holding its key and value */
+typedef struct JsonMember {
+	JsonDoc *doc;
+	int idx;
+} JsonMember;
+
+/*
+ * Top level members of one or more JSON objects merged with
+ * merge_json_object().  A key seen again replaces the earlier value but
+ * keeps its place, as a Python dict update does.
+ */
+typedef struct JsonObject {
+	JsonMember *members;
+	int count;
+	int size;
+} JsonObject;
+
 JsonNode *add_json_node(JsonNodeType ntype, JsonValueType vtype, JsonEscapeType esc_type, char *key, void *value);
 char *strdup_escape(JsonEscapeType esc_type, const char *str);
 int generate_json(FILE *stream);
 void free_json_node_list();
+JsonDoc *parse_json(const char *str, char *msg, size_t msg_len);
+void free_json_doc(JsonDoc *doc);
+int merge_json_object(JsonObject *obj, JsonDoc *doc);
+char *dump_json_object(JsonObject *obj);
+void free_json_object(JsonObject *obj);
 
 #ifdef	__cplusplus
 }
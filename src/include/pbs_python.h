@@ -128,7 +128,10 @@ struct python_script {
  * @param[in]	jobs_list - list of jobs and their attributes/resources
  * 				passed to an exechost_periodic hook.
  * @param[in]	vns_list - list of vnodes and their attributes/resources
- * 				passed to various hooks.
+ * 				passed to various hooks. For a server periodic
+ *				hook a NULL list means the vnodes are taken
+ *				from the server on first access from the hook.
+ * @param[in]	resv_list - same as vns_list, but for reservations.
  * @param[in]	vns_list_fail - list of failed vnodes and their
  *				attributes/resources passed to various hooks.
  * @param[in]	failed_mom_list - list of parent moms that have been
@@ -350,6 +353,7 @@ extern int get_py_progname(char **);
 #define PY_TYPE_ENV			"pbs_env"
 #define PY_TYPE_MANAGEMENT	"management"
 #define PY_TYPE_SERVER_ATTRIBUTE	"server_attribute"
+#define PY_TYPE_LAZY_DICT		"lazy_dict"
 
 /* PBS Python Exception errors - in modules/pbs/v1.1 files */
 #define	PY_ERROR_EVENT_INCOMPATIBLE 	"EventIncompatibleError"
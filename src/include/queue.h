@@ -69,6 +69,7 @@ extern attribute_def que_attr_def[];
 struct pbs_queue {
 	pbs_list_link qu_link; /* forward/backward links */
 	pbs_list_head qu_jobs; /* jobs in this queue */
+	struct qrank_node *qu_jobs_rank; /* qrank index of qu_jobs */
 	resc_resv *qu_resvp;   /* != NULL if que established */
 	/* to support a reservation */
 	int qu_nseldft;		   /* number of elm in qu_seldft */
@@ -39,6 +39,7 @@
 
 #include <stdlib.h>
 #include <ctype.h>
+#include <math.h>
 #include "pbs_json.h"
 #include "libutil.h"
 #define ARRAY_NESTING_LEVEL 500 /* describes the nesting level of a JSON array*/
@@ -529,3 +530,962 @@ generate_json(FILE * stream) {
 	fprintf(stream, "\n}\n");
 	return 0;
 }
+
+/* parser state for parse_json() */
+typedef struct JsonParser {
+	const char *start;	/* text being parsed */
+	const char *p;		/* next character to read */
+	char *out;		/* next free byte of doc->buf */
+	JsonDoc *doc;
+	char *msg;
+	size_t msg_len;
+} JsonParser;
+
+/* output buffer for dump_json_object() */
+typedef struct JsonBuf {
+	char *s;
+	size_t len;
+	size_t size;
+} JsonBuf;
+
+/* key of a member and its place in the object, for dump_json_members() */
+typedef struct JsonKeyPos {
+	const char *key;
+	int pos;
+} JsonKeyPos;
+
+static int parse_json_value(JsonParser *ps, char *key, int depth);
+static int dump_json_value(JsonBuf *jb, JsonDoc *doc, int idx);
+
+/**
+ * @brief
+ *	Record a parse error and where it was found.
+ *
+ * @param[in] ps - parser state
+ * @param[in] what - description of the error
+ *
+ * @return	int
+ * @retval	1	always, for the caller to return
+ */
+static int
+json_parse_error(JsonParser *ps, const char *what)
+{
+	if (ps->msg != NULL && ps->msg_len > 0)
+		snprintf(ps->msg, ps->msg_len, "%s: char %ld", what, (long) (ps->p - ps->start));
+	return 1;
+}
+
+/**
+ * @brief
+ *	Append a node to a document, growing its node array as needed.
+ *
+ * @param[in] ps - parser state
+ * @param[in] ntype - node type
+ * @param[in] vtype - value type
+ * @param[in] key - member key, NULL if none
+ *
+ * @return	int
+ * @retval	index of the new node	success
+ * @retval	-1			out of memory
+ */
+static int
+new_json_doc_node(JsonParser *ps, JsonNodeType ntype, JsonValueType vtype, char *key)
+{
+	JsonDoc *doc = ps->doc;
+	JsonNode *node;
+
+	if (doc->count == doc->size) {
+		int size = doc->size ? doc->size * 2 : 16;
+		JsonNode *nodes = realloc(doc->nodes, size * sizeof(JsonNode));
+
+		if (nodes == NULL) {
+			json_parse_error(ps, "out of memory");
+			return -1;
+		}
+		doc->nodes = nodes;
+		doc->size = size;
+	}
+	node = &doc->nodes[doc->count];
+	node->node_type = ntype;
+	node->value_type = vtype;
+	node->key = key;
+	node->value.string = NULL;
+	return doc->count++;
+}
+
+/**
+ * @brief
+ *	Write the UTF-8 encoding of a code point.
+ *
+ * @param[out] out - where to write, at least 4 bytes
+ * @param[in] cp - code point
+ *
+ * @return	int
+ * @retval	number of bytes written
+ */
+static int
+put_utf8(char *out, unsigned long cp)
+{
+	if (cp == 0) {
+		/* two byte form, so the string is not cut short */
+		out[0] = (char) 0xC0;
+		out[1] = (char) 0x80;
+		return 2;
+	} else if (cp < 0x80) {
+		out[0] = (char) cp;
+		return 1;
+	} else if (cp < 0x800) {
+		out[0] = (char) (0xC0 | (cp >> 6));
+		out[1] = (char) (0x80 | (cp & 0x3F));
+		return 2;
+	} else if (cp < 0x10000) {
+		out[0] = (char) (0xE0 | (cp >> 12));
+		out[1] = (char) (0x80 | ((cp >> 6) & 0x3F));
+		out[2] = (char) (0x80 | (cp & 0x3F));
+		return 3;
+	}
+	out[0] = (char) (0xF0 | (cp >> 18));
+	out[1] = (char) (0x80 | ((cp >> 12) & 0x3F));
+	out[2] = (char) (0x80 | ((cp >> 6) & 0x3F));
+	out[3] = (char) (0x80 | (cp & 0x3F));
+	return 4;
+}
+
+/**
+ * @brief
+ *	Read the code point of a UTF-8 sequence.
+ *
+ * @param[in] s - start of the sequence
+ * @param[out] cp - code point read
+ *
+ * @return	int
+ * @retval	length of the sequence	success
+ * @retval	0			not a valid sequence
+ */
+static int
+get_utf8(const unsigned char *s, unsigned long *cp)
+{
+	int len;
+	int i;
+
+	if (*s < 0x80) {
+		*cp = *s;
+		return 1;
+	} else if (*s == 0xC0 && s[1] == 0x80) {
+		*cp = 0;
+		return 2;
+	} else if (*s >= 0xC2 && *s <= 0xDF) {
+		*cp = *s & 0x1F;
+		len = 2;
+	} else if (*s >= 0xE0 && *s <= 0xEF) {
+		*cp = *s & 0x0F;
+		len = 3;
+	} else if (*s >= 0xF0 && *s <= 0xF4) {
+		*cp = *s & 0x07;
+		len = 4;
+	} else
+		return 0;
+	for (i = 1; i < len; i++) {
+		if ((s[i] & 0xC0) != 0x80)
+			return 0;
+		*cp = (*cp << 6) | (s[i] & 0x3F);
+	}
+	return len;
+}
+
+/**
+ * @brief
+ *	Read the four hex digits of a \\u escape.
+ *
+ * @param[in] s - first digit
+ *
+ * @return	long
+ * @retval	value of the digits	success
+ * @retval	-1			not four hex digits
+ */
+static long
+get_hex4(const char *s)
+{
+	long val = 0;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		if (!isxdigit((unsigned char) s[i]))
+			return -1;
+		val = val * 16 + (isdigit((unsigned char) s[i]) ? s[i] - '0' : (tolower((unsigned char) s[i]) - 'a' + 10));
+	}
+	return val;
+}
+
+/**
+ * @brief
+ *	Decode a JSON string into the document buffer.
+ *
+ * @param[in] ps - parser state, positioned on the opening quote
+ * @param[out] res - decoded string
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	error
+ */
+static int
+parse_json_string(JsonParser *ps, char **res)
+{
+	unsigned long cp;
+	long cp2;
+	int len;
+
+	*res = ps->out;
+	ps->p++;
+	while (*ps->p != '"') {
+		if (*ps->p == '\0')
+			return json_parse_error(ps, "Unterminated string");
+		if ((unsigned char) *ps->p < 0x20)
+			return json_parse_error(ps, "Invalid control character");
+		if (*ps->p != '\\') {
+			if ((len = get_utf8((const unsigned char *) ps->p, &cp)) == 0)
+				return json_parse_error(ps, "Invalid UTF-8");
+			memcpy(ps->out, ps->p, len);
+			ps->out += len;
+			ps->p += len;
+			continue;
+		}
+		ps->p++;
+		switch (*ps->p) {
+			case '"':
+			case '\\':
+			case '/':
+				*ps->out++ = *ps->p;
+				break;
+			case 'b':
+				*ps->out++ = '\b';
+				break;
+			case 'f':
+				*ps->out++ = '\f';
+				break;
+			case 'n':
+				*ps->out++ = '\n';
+				break;
+			case 'r':
+				*ps->out++ = '\r';
+				break;
+			case 't':
+				*ps->out++ = '\t';
+				break;
+			case 'u':
+				if ((cp = get_hex4(ps->p + 1)) == (unsigned long) -1)
+					return json_parse_error(ps, "Invalid \\uXXXX escape");
+				ps->p += 4;
+				/* join a surrogate pair, a lone surrogate is kept as is */
+				if (cp >= 0xD800 && cp <= 0xDBFF && ps->p[1] == '\\' && ps->p[2] == 'u' &&
+				    (cp2 = get_hex4(ps->p + 3)) >= 0xDC00 && cp2 <= 0xDFFF) {
+					cp = 0x10000 + ((cp - 0xD800) << 10) + (cp2 - 0xDC00);
+					ps->p += 6;
+				}
+				ps->out += put_utf8(ps->out, cp);
+				break;
+			default:
+				return json_parse_error(ps, "Invalid \\escape");
+		}
+		ps->p++;
+	}
+	ps->p++;
+	*ps->out++ = '\0';
+	return 0;
+}
+
+/**
+ * @brief
+ *	Parse a number or one of the literals true, false, null, NaN and
+ *	Infinity into a value node.
+ *
+ * @param[in] ps - parser state
+ * @param[in] key - member key, NULL if none
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	error
+ */
+static int
+parse_json_scalar(JsonParser *ps, char *key)
+{
+	static char *literals[] = {"true", "false", "null"};
+	const char *start = ps->p;
+	int isfloat = 0;
+	int idx;
+	int i;
+
+	for (i = 0; i < (int) (sizeof(literals) / sizeof(literals[0])); i++) {
+		if (strncmp(ps->p, literals[i], strlen(literals[i])) == 0) {
+			if ((idx = new_json_doc_node(ps, JSON_VALUE, JSON_NUMERIC, key)) == -1)
+				return 1;
+			ps->doc->nodes[idx].value.string = literals[i];
+			ps->p += strlen(literals[i]);
+			return 0;
+		}
+	}
+	if (strncmp(ps->p, "NaN", 3) == 0 || strncmp(ps->p, "Infinity", 8) == 0 || strncmp(ps->p, "-Infinity", 9) == 0) {
+		if ((idx = new_json_doc_node(ps, JSON_VALUE, JSON_FLOAT, key)) == -1)
+			return 1;
+		if (*ps->p == 'N') {
+			ps->doc->nodes[idx].value.fnumber = NAN;
+			ps->p += 3;
+		} else {
+			ps->doc->nodes[idx].value.fnumber = (*ps->p == '-') ? -INFINITY : INFINITY;
+			ps->p += (*ps->p == '-') ? 9 : 8;
+		}
+		return 0;
+	}
+
+	if (*ps->p == '-')
+		ps->p++;
+	if (*ps->p == '0')
+		ps->p++;
+	else if (isdigit((unsigned char) *ps->p)) {
+		while (isdigit((unsigned char) *ps->p))
+			ps->p++;
+	} else {
+		ps->p = start;
+		return json_parse_error(ps, "Expecting value");
+	}
+	if (*ps->p == '.' && isdigit((unsigned char) ps->p[1])) {
+		ps->p++;
+		while (isdigit((unsigned char) *ps->p))
+			ps->p++;
+		isfloat = 1;
+	}
+	if ((*ps->p == 'e' || *ps->p == 'E') &&
+	    (isdigit((unsigned char) ps->p[1]) || ((ps->p[1] == '+' || ps->p[1] == '-') && isdigit((unsigned char) ps->p[2])))) {
+		ps->p += 2;
+		while (isdigit((unsigned char) *ps->p))
+			ps->p++;
+		isfloat = 1;
+	}
+
+	if (isfloat) {
+		if ((idx = new_json_doc_node(ps, JSON_VALUE, JSON_FLOAT, key)) == -1)
+			return 1;
+		ps->doc->nodes[idx].value.fnumber = strtod(start, NULL);
+	} else {
+		if ((idx = new_json_doc_node(ps, JSON_VALUE, JSON_NUMERIC, key)) == -1)
+			return 1;
+		/* keep the digits as they are, integers have no size limit */
+		if (strncmp(start, "-0", ps->p - start) == 0)
+			start++;
+		ps->doc->nodes[idx].value.string = ps->out;
+		memcpy(ps->out, start, ps->p - start);
+		ps->out += ps->p - start;
+		*ps->out++ = '\0';
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Skip JSON white space.
+ *
+ * @param[in] ps - parser state
+ *
+ * @return	void
+ */
+static void
+skip_json_space(JsonParser *ps)
+{
+	while (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\n' || *ps->p == '\r')
+		ps->p++;
+}
+
+/**
+ * @brief
+ *	Parse an object or array into its start node, members and end node.
+ *
+ * @param[in] ps - parser state, positioned on the opening bracket
+ * @param[in] key - member key, NULL if none
+ * @param[in] depth - nesting level
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	error
+ */
+static int
+parse_json_container(JsonParser *ps, char *key, int depth)
+{
+	int isobj = (*ps->p == '{');
+	char close = isobj ? '}' : ']';
+	char *mkey = NULL;
+
+	if (depth >= ARRAY_NESTING_LEVEL)
+		return json_parse_error(ps, "Nesting too deep");
+	if (new_json_doc_node(ps, isobj ? JSON_OBJECT : JSON_ARRAY, JSON_NULL, key) == -1)
+		return 1;
+	ps->p++;
+	skip_json_space(ps);
+	if (*ps->p != close) {
+		while (1) {
+			skip_json_space(ps);
+			if (isobj) {
+				if (*ps->p != '"')
+					return json_parse_error(ps, "Expecting property name enclosed in double quotes");
+				if (parse_json_string(ps, &mkey))
+					return 1;
+				skip_json_space(ps);
+				if (*ps->p != ':')
+					return json_parse_error(ps, "Expecting ':' delimiter");
+				ps->p++;
+			}
+			if (parse_json_value(ps, mkey, depth + 1))
+				return 1;
+			skip_json_space(ps);
+			if (*ps->p == close)
+				break;
+			if (*ps->p != ',')
+				return json_parse_error(ps, "Expecting ',' delimiter");
+			ps->p++;
+		}
+	}
+	ps->p++;
+	if (new_json_doc_node(ps, isobj ? JSON_OBJECT_END : JSON_ARRAY_END, JSON_NULL, NULL) == -1)
+		return 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Parse any JSON value.
+ *
+ * @param[in] ps - parser state
+ * @param[in] key - member key, NULL if none
+ * @param[in] depth - nesting level
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	error
+ */
+static int
+parse_json_value(JsonParser *ps, char *key, int depth)
+{
+	char *str;
+	int idx;
+
+	skip_json_space(ps);
+	if (*ps->p == '{' || *ps->p == '[')
+		return parse_json_container(ps, key, depth);
+	if (*ps->p == '"') {
+		if (parse_json_string(ps, &str))
+			return 1;
+		if ((idx = new_json_doc_node(ps, JSON_VALUE, JSON_STRING, key)) == -1)
+			return 1;
+		ps->doc->nodes[idx].value.string = str;
+		return 0;
+	}
+	return parse_json_scalar(ps, key);
+}
+
+/**
+ * @brief
+ *	Parse a JSON object.  The whole document takes three allocations: the
+ *	JsonDoc, its node array and one buffer for all of its strings.
+ *
+ * @param[in] str - JSON text
+ * @param[out] msg - error message buffer, may be NULL
+ * @param[in] msg_len - size of 'msg' buffer
+ *
+ * @return	JsonDoc *
+ * @retval	parsed document, to free with free_json_doc()	success
+ * @retval	NULL	'str' is not a JSON object, 'msg' tells why
+ */
+JsonDoc *
+parse_json(const char *str, char *msg, size_t msg_len)
+{
+	JsonParser ps;
+	JsonDoc *doc;
+
+	if (str == NULL)
+		return NULL;
+	if (msg != NULL && msg_len > 0)
+		msg[0] = '\0';
+
+	if ((doc = calloc(1, sizeof(JsonDoc))) == NULL)
+		return NULL;
+	doc->refs = 1;
+	/* decoded strings, integers and their terminators never outgrow the text */
+	if ((doc->buf = malloc(strlen(str) + 1)) == NULL) {
+		free(doc);
+		return NULL;
+	}
+	ps.start = ps.p = str;
+	ps.out = doc->buf;
+	ps.doc = doc;
+	ps.msg = msg;
+	ps.msg_len = msg_len;
+
+	if (parse_json_value(&ps, NULL, 0) == 0) {
+		skip_json_space(&ps);
+		if (*ps.p != '\0')
+			json_parse_error(&ps, "Extra data");
+		else if (doc->nodes[0].node_type != JSON_OBJECT)
+			json_parse_error(&ps, "value is not a dictionary");
+		else
+			return doc;
+	}
+	free_json_doc(doc);
+	return NULL;
+}
+
+/**
+ * @brief
+ *	Drop a reference to a document, freeing it with the last one.
+ *
+ * @param[in] doc - document from parse_json()
+ *
+ * @return	void
+ */
+void
+free_json_doc(JsonDoc *doc)
+{
+	if (doc == NULL || --doc->refs > 0)
+		return;
+	free(doc->nodes);
+	free(doc->buf);
+	free(doc);
+}
+
+/**
+ * @brief
+ *	Index of the node following the value that starts at 'idx'.
+ *
+ * @param[in] doc - document
+ * @param[in] idx - first node of a value
+ *
+ * @return	int
+ */
+static int
+next_json_doc_node(JsonDoc *doc, int idx)
+{
+	int depth = 0;
+
+	do {
+		switch (doc->nodes[idx].node_type) {
+			case JSON_OBJECT:
+			case JSON_ARRAY:
+				depth++;
+				break;
+			case JSON_OBJECT_END:
+			case JSON_ARRAY_END:
+				depth--;
+				break;
+			default:
+				break;
+		}
+		idx++;
+	} while (depth > 0);
+	return idx;
+}
+
+/**
+ * @brief
+ *	Add the top level members of a document to an object.  The object
+ *	keeps a reference to the document until free_json_object().
+ *
+ * @param[in,out] obj - object to merge into, zeroed before first use
+ * @param[in] doc - document from parse_json()
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	out of memory
+ */
+int
+merge_json_object(JsonObject *obj, JsonDoc *doc)
+{
+	int i;
+
+	for (i = 1; doc->nodes[i].node_type != JSON_OBJECT_END; i = next_json_doc_node(doc, i)) {
+		if (obj->count == obj->size) {
+			int size = obj->size ? obj->size * 2 : 16;
+			JsonMember *members = realloc(obj->members, size * sizeof(JsonMember));
+
+			if (members == NULL)
+				return 1;
+			obj->members = members;
+			obj->size = size;
+		}
+		obj->members[obj->count].doc = doc;
+		obj->members[obj->count].idx = i;
+		obj->count++;
+		doc->refs++;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Release the members of an object and the documents they came from.
+ *	The object is left empty and may be reused.
+ *
+ * @param[in,out] obj - object
+ *
+ * @return	void
+ */
+void
+free_json_object(JsonObject *obj)
+{
+	int i;
+
+	for (i = 0; i < obj->count; i++)
+		free_json_doc(obj->members[i].doc);
+	free(obj->members);
+	obj->members = NULL;
+	obj->count = 0;
+	obj->size = 0;
+}
+
+/**
+ * @brief
+ *	Append bytes to an output buffer.
+ *
+ * @param[in,out] jb - output buffer
+ * @param[in] str - bytes to add
+ * @param[in] len - number of bytes
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	out of memory
+ */
+static int
+add_json_buf(JsonBuf *jb, const char *str, size_t len)
+{
+	if (jb->len + len + 1 > jb->size) {
+		size_t size = jb->size ? jb->size : 256;
+		char *s;
+
+		while (jb->len + len + 1 > size)
+			size *= 2;
+		if ((s = realloc(jb->s, size)) == NULL)
+			return 1;
+		jb->s = s;
+		jb->size = size;
+	}
+	memcpy(jb->s + jb->len, str, len);
+	jb->len += len;
+	jb->s[jb->len] = '\0';
+	return 0;
+}
+
+/**
+ * @brief
+ *	Write a string as json.dumps() does: quoted, with every character
+ *	outside printable ASCII escaped.
+ *
+ * @param[in,out] jb - output buffer
+ * @param[in] str - UTF-8 string
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	out of memory
+ */
+static int
+dump_json_string(JsonBuf *jb, const char *str)
+{
+	const unsigned char *s = (const unsigned char *) str;
+	const unsigned char *run;
+	unsigned long cp;
+	char esc[32];
+	int len;
+
+	if (add_json_buf(jb, "\"", 1))
+		return 1;
+	while (*s) {
+		for (run = s; *s >= 0x20 && *s < 0x7F && *s != '"' && *s != '\\'; s++)
+			;
+		if (s > run && add_json_buf(jb, (const char *) run, s - run))
+			return 1;
+		if (*s == '\0')
+			break;
+		switch (*s) {
+			case '"':
+				strcpy(esc, "\\\"");
+				break;
+			case '\\':
+				strcpy(esc, "\\\\");
+				break;
+			case '\n':
+				strcpy(esc, "\\n");
+				break;
+			case '\r':
+				strcpy(esc, "\\r");
+				break;
+			case '\t':
+				strcpy(esc, "\\t");
+				break;
+			case '\b':
+				strcpy(esc, "\\b");
+				break;
+			case '\f':
+				strcpy(esc, "\\f");
+				break;
+			default:
+				if ((len = get_utf8(s, &cp)) == 0) {
+					cp = *s;
+					len = 1;
+				}
+				if (cp >= 0x10000) {
+					cp -= 0x10000;
+					sprintf(esc, "\\u%04lx\\u%04lx", 0xD800 + (cp >> 10), 0xDC00 + (cp & 0x3FF));
+				} else
+					sprintf(esc, "\\u%04lx", cp);
+				s += len - 1;
+				break;
+		}
+		s++;
+		if (add_json_buf(jb, esc, strlen(esc)))
+			return 1;
+	}
+	return add_json_buf(jb, "\"", 1);
+}
+
+/**
+ * @brief
+ *	Write a float as Python's repr() does: the shortest digits that read
+ *	back to the same value, in exponent form below 1e-4 or from 1e16.
+ *
+ * @param[in,out] jb - output buffer
+ * @param[in] d - value
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	out of memory
+ */
+static int
+dump_json_float(JsonBuf *jb, double d)
+{
+	char tmp[40];
+	char digits[20];
+	char out[64];
+	char *p;
+	char *o = out;
+	int ndigits = 0;
+	int decpt;
+	int prec;
+	int i;
+
+	if (isnan(d))
+		return add_json_buf(jb, "NaN", 3);
+	if (isinf(d))
+		return d < 0 ? add_json_buf(jb, "-Infinity", 9) : add_json_buf(jb, "Infinity", 8);
+
+	for (prec = 1; prec <= 17; prec++) {
+		snprintf(tmp, sizeof(tmp), "%.*e", prec - 1, d);
+		if (strtod(tmp, NULL) == d)
+			break;
+	}
+
+	/* split "-d.ddde+XX" into its digits and decimal point position */
+	p = tmp;
+	if (*p == '-')
+		*o++ = *p++;
+	for (; *p != 'e'; p++) {
+		if (isdigit((unsigned char) *p))
+			digits[ndigits++] = *p;
+	}
+	decpt = atoi(p + 1) + 1;
+	while (ndigits > 1 && digits[ndigits - 1] == '0')
+		ndigits--;
+	digits[ndigits] = '\0';
+
+	if (decpt > -4 && decpt <= 16) {
+		if (decpt <= 0) {
+			*o++ = '0';
+			*o++ = '.';
+			for (i = decpt; i < 0; i++)
+				*o++ = '0';
+			memcpy(o, digits, ndigits);
+			o += ndigits;
+		} else if (decpt >= ndigits) {
+			memcpy(o, digits, ndigits);
+			o += ndigits;
+			for (i = ndigits; i < decpt; i++)
+				*o++ = '0';
+			*o++ = '.';
+			*o++ = '0';
+		} else {
+			memcpy(o, digits, decpt);
+			o += decpt;
+			*o++ = '.';
+			memcpy(o, digits + decpt, ndigits - decpt);
+			o += ndigits - decpt;
+		}
+	} else {
+		if (ndigits > 1)
+			o += sprintf(o, "%c.%se%c%02d", digits[0], digits + 1, decpt - 1 < 0 ? '-' : '+', abs(decpt - 1));
+		else
+			o += sprintf(o, "%ce%c%02d", digits[0], decpt - 1 < 0 ? '-' : '+', abs(decpt - 1));
+	}
+	return add_json_buf(jb, out, o - out);
+}
+
+/**
+ * @brief
+ *	qsort comparison of object members by key, then by place.
+ */
+static int
+cmp_json_keypos(const void *a, const void *b)
+{
+	const JsonKeyPos *ka = a;
+	const JsonKeyPos *kb = b;
+	int rc;
+
+	if ((rc = strcmp(ka->key, kb->key)) != 0)
+		return rc;
+	return ka->pos - kb->pos;
+}
+
+/**
+ * @brief
+ *	Write the members of an object.  A key that appears more than once is
+ *	written once, at its first place, with its last value.
+ *
+ * @param[in,out] jb - output buffer
+ * @param[in] members - members in order
+ * @param[in] count - number of members
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	out of memory
+ */
+static int
+dump_json_members(JsonBuf *jb, JsonMember *members, int count)
+{
+	JsonKeyPos *keys = NULL;
+	int *winner = NULL;
+	int first = 1;
+	int i;
+	int j;
+	int rc = 1;
+
+	if (count > 1) {
+		/* one allocation for the sorted keys and the value each place gets */
+		if ((keys = malloc(count * (sizeof(JsonKeyPos) + sizeof(int)))) == NULL)
+			return 1;
+		winner = (int *) (keys + count);
+		for (i = 0; i < count; i++) {
+			keys[i].key = members[i].doc->nodes[members[i].idx].key;
+			keys[i].pos = i;
+		}
+		qsort(keys, count, sizeof(JsonKeyPos), cmp_json_keypos);
+		for (i = 0; i < count; i = j) {
+			for (j = i + 1; j < count && strcmp(keys[i].key, keys[j].key) == 0; j++)
+				winner[keys[j].pos] = -1;
+			winner[keys[i].pos] = keys[j - 1].pos;
+		}
+	}
+
+	if (add_json_buf(jb, "{", 1))
+		goto dump_members_exit;
+	for (i = 0; i < count; i++) {
+		JsonMember *m = &members[i];
+
+		if (winner != NULL) {
+			if (winner[i] == -1)
+				continue;
+			m = &members[winner[i]];
+		}
+		if (!first && add_json_buf(jb, ", ", 2))
+			goto dump_members_exit;
+		first = 0;
+		if (dump_json_string(jb, m->doc->nodes[m->idx].key) ||
+		    add_json_buf(jb, ": ", 2) ||
+		    dump_json_value(jb, m->doc, m->idx))
+			goto dump_members_exit;
+	}
+	rc = add_json_buf(jb, "}", 1);
+
+dump_members_exit:
+	free(keys);
+	return rc;
+}
+
+/**
+ * @brief
+ *	Write the value that starts at node 'idx' of a document.
+ *
+ * @param[in,out] jb - output buffer
+ * @param[in] doc - document
+ * @param[in] idx - first node of the value
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	out of memory
+ */
+static int
+dump_json_value(JsonBuf *jb, JsonDoc *doc, int idx)
+{
+	JsonNode *node = &doc->nodes[idx];
+	JsonMember *members;
+	int count = 0;
+	int rc;
+	int i;
+
+	switch (node->node_type) {
+		case JSON_OBJECT:
+			for (i = idx + 1; doc->nodes[i].node_type != JSON_OBJECT_END; i = next_json_doc_node(doc, i))
+				count++;
+			if (count == 0)
+				return add_json_buf(jb, "{}", 2);
+			if ((members = malloc(count * sizeof(JsonMember))) == NULL)
+				return 1;
+			count = 0;
+			for (i = idx + 1; doc->nodes[i].node_type != JSON_OBJECT_END; i = next_json_doc_node(doc, i)) {
+				members[count].doc = doc;
+				members[count++].idx = i;
+			}
+			rc = dump_json_members(jb, members, count);
+			free(members);
+			return rc;
+
+		case JSON_ARRAY:
+			if (add_json_buf(jb, "[", 1))
+				return 1;
+			for (i = idx + 1; doc->nodes[i].node_type != JSON_ARRAY_END; i = next_json_doc_node(doc, i)) {
+				if (i > idx + 1 && add_json_buf(jb, ", ", 2))
+					return 1;
+				if (dump_json_value(jb, doc, i))
+					return 1;
+			}
+			return add_json_buf(jb, "]", 1);
+
+		default:
+			break;
+	}
+
+	switch (node->value_type) {
+		case JSON_STRING:
+			return dump_json_string(jb, node->value.string);
+		case JSON_FLOAT:
+			return dump_json_float(jb, node->value.fnumber);
+		default:
+			return add_json_buf(jb, node->value.string, strlen(node->value.string));
+	}
+}
+
+/**
+ * @brief
+ *	Return the JSON text of an object in the format of Python's
+ *	json.dumps(): ", " and ": " separators, non-ASCII characters escaped.
+ *
+ * @param[in] obj - object
+ *
+ * @return	char *
+ * @retval	JSON text, to be freed by the caller	success
+ * @retval	NULL					out of memory
+ */
+char *
+dump_json_object(JsonObject *obj)
+{
+	JsonBuf jb = {NULL, 0, 0};
+
+	if (dump_json_members(&jb, obj->members, obj->count)) {
+		free(jb.s);
+		return NULL;
+	}
+	return jb.s;
+}
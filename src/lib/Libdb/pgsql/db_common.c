@@ -871,6 +871,53 @@ pbs_db_disconnect(void *conn)
 	return 0;
 }
 
+/**
+ * @brief
+ *	Start a transaction on the connection
+ *
+ * @param[in]   conn - Connected database handle
+ *
+ * @return      Error code
+ * @retval       0  - success
+ * @retval      -1  - Failure
+ *
+ */
+int
+pbs_db_begin_trx(void *conn)
+{
+	if (!conn)
+		return -1;
+
+	if (db_execute_str(conn, "BEGIN") == -1)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	Commit or roll back the transaction started by pbs_db_begin_trx
+ *
+ * @param[in]   conn - Connected database handle
+ * @param[in]   commit - 1 to commit, 0 to roll back
+ *
+ * @return      Error code
+ * @retval       0  - success
+ * @retval      -1  - Failure
+ *
+ */
+int
+pbs_db_end_trx(void *conn, int commit)
+{
+	if (!conn)
+		return -1;
+
+	if (db_execute_str(conn, commit ? "COMMIT" : "ROLLBACK") == -1)
+		return -1;
+
+	return 0;
+}
+
 /**
  * @brief
  *	Saves a new object into the database
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+/**
+ * @file	dec_ModifyJobs.c
+ * @brief
+ * decode_DIS_ModifyJobs() - decode a Modify Jobs Batch Request
+ *
+ *	The batch_request structure must already exist (be allocated by the
+ *	caller.   It is assumed that the header fields (protocol type,
+ *	protocol version, request type, and user name) have already be decoded.
+ *
+ * @par	Data items are:
+ * 			unsigned int	count
+ *			followed by count entries of:
+ *			string		job id
+ *			svrattrl	attributes
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include "libpbs.h"
+#include "list_link.h"
+#include "server_limits.h"
+#include "attribute.h"
+#include "credential.h"
+#include "batch_request.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-decode a Modify Jobs Batch Request
+ *
+ * @par	Functionality:
+ *	All entries are allocated (with empty attribute lists) before any
+ *	of them is read, so free_br() can release a partially decoded
+ *	request.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+int
+decode_DIS_ModifyJobs(int sock, struct batch_request *preq)
+{
+	int rc;
+	int count;
+	int i;
+	struct rq_modifyjobs_ent *jobs;
+
+	preq->rq_ind.rq_modifyjobs.rq_count = 0;
+	preq->rq_ind.rq_modifyjobs.rq_jobs = NULL;
+
+	count = disrui(sock, &rc);
+	if (rc)
+		return rc;
+	if (count <= 0)
+		return DIS_PROTO;
+
+	jobs = malloc(count * sizeof(struct rq_modifyjobs_ent));
+	if (jobs == NULL)
+		return DIS_NOMALLOC;
+	for (i = 0; i < count; i++)
+		CLEAR_HEAD(jobs[i].rq_attr);
+	preq->rq_ind.rq_modifyjobs.rq_jobs = jobs;
+	preq->rq_ind.rq_modifyjobs.rq_count = count;
+
+	for (i = 0; i < count; i++) {
+		if ((rc = disrfst(sock, PBS_MAXSVRJOBID + 1, jobs[i].rq_objname)) != 0)
+			return rc;
+		if ((rc = decode_DIS_svrattrl(sock, &jobs[i].rq_attr)) != 0)
+			return rc;
+	}
+
+	return rc;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+/**
+ * @file	enc_ModifyJobs.c
+ * @brief
+ * encode_DIS_ModifyJobs() - encode a Modify Jobs Batch Request
+ *
+ *	This request carries attribute updates for a list of jobs in a
+ *	single message.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include "libpbs.h"
+#include "pbs_error.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-encode a Modify Jobs Batch Request
+ *
+ * @par	Data items are:\n
+ *		unsigned int	count\n
+ *		followed by count entries of:\n
+ *		string		job id\n
+ *		attrl		attributes
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] jobs - array of job ids and their attribute lists
+ * @param[in] njobs - number of entries in jobs
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+int
+encode_DIS_ModifyJobs(int sock, struct alterjob_info *jobs, int njobs)
+{
+	int rc;
+	int i;
+
+	if ((rc = diswui(sock, njobs)) != 0)
+		return rc;
+
+	for (i = 0; i < njobs; i++) {
+		if ((rc = diswst(sock, jobs[i].job_id)) != 0)
+			return rc;
+		if ((rc = encode_DIS_attrl(sock, jobs[i].attrib)) != 0)
+			return rc;
+	}
+
+	return rc;
+}
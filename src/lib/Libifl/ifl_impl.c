@@ -131,6 +131,26 @@ pbs_asyalterjob(int c, char *jobid, struct attrl *attrib, char *extend) {
 	return (*pfn_pbs_asyalterjob)(c, jobid, attrib, extend);
 }
 
+/**
+ * @brief
+ *	-Pass-through call to send alter Job requests for a list of jobs
+ *	in a single message.
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobs - array of job ids and their attribute lists
+ * @param[in] njobs - number of entries in jobs
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	!0	error
+ *
+ */
+int
+pbs_asyalterjobs(int c, struct alterjob_info *jobs, int njobs, char *extend) {
+	return (*pfn_pbs_asyalterjobs)(c, jobs, njobs, extend);
+}
+
 /**
  * @brief
  * 	-pbs_confirmresv - this function is for exclusive use by the Scheduler
@@ -604,6 +624,55 @@ pbs_statjob(int c, char *id, struct attrl *attrib, char *extend) {
 	return (*pfn_pbs_statjob)(c, id, attrib, extend);
 }
 
+/**
+ * @brief
+ *	-Pass-through call to start a job status returned a page at a time.
+ *
+ * @param[in] c - communication handle
+ * @param[in] id - job id(s), queue or server
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for req
+ *
+ * @return	struct pbs_statjob_iter *
+ * @retval	handle for pbs_statjob_next()		success
+ * @retval	NULL					error
+ *
+ */
+struct pbs_statjob_iter *
+pbs_statjob_open(int c, char *id, struct attrl *attrib, char *extend) {
+	return (*pfn_pbs_statjob_open)(c, id, attrib, extend);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to get the next page of a job status.
+ *
+ * @param[in] it - handle returned by pbs_statjob_open()
+ *
+ * @return	structure handle
+ * @retval	pointer to batch_status struct		next page
+ * @retval	NULL					end or error
+ *
+ */
+struct batch_status *
+pbs_statjob_next(struct pbs_statjob_iter *it) {
+	return (*pfn_pbs_statjob_next)(it);
+}
+
+/**
+ * @brief
+ *	-Pass-through call to release a job status handle.
+ *
+ * @param[in] it - handle returned by pbs_statjob_open()
+ *
+ * @return	Void
+ *
+ */
+void
+pbs_statjob_close(struct pbs_statjob_iter *it) {
+	(*pfn_pbs_statjob_close)(it);
+}
+
 /**
  * @brief
  *	-Pass-through call to SelectJob request
@@ -47,6 +47,7 @@ int (*pfn_pbs_asyrunjob)(int, char *, char *, char *) = __pbs_asyrunjob;
 int (*pfn_pbs_asyrunjob_ack)(int, char *, char *, char *) = __pbs_asyrunjob_ack;
 int (*pfn_pbs_alterjob)(int, char *, struct attrl *, char *) = __pbs_alterjob;
 int (*pfn_pbs_asyalterjob)(int, char *, struct attrl *, char *) = __pbs_asyalterjob;
+int (*pfn_pbs_asyalterjobs)(int, struct alterjob_info *, int, char *) = __pbs_asyalterjobs;
 int (*pfn_pbs_confirmresv)(int, char *, char *, unsigned long, char *) = __pbs_confirmresv;
 int (*pfn_pbs_connect)(char *) = __pbs_connect;
 int (*pfn_pbs_connect_extend)(char *, char *) = __pbs_connect_extend;
@@ -71,6 +72,9 @@ void (*pfn_pbs_statfree)(struct batch_status *) = __pbs_statfree;
 void (*pfn_pbs_delstatfree)(struct batch_deljob_status *) = __pbs_delstatfree;
 struct batch_status *(*pfn_pbs_statrsc)(int, char *, struct attrl *, char *) = __pbs_statrsc;
 struct batch_status *(*pfn_pbs_statjob)(int, char *, struct attrl *, char *) = __pbs_statjob;
+struct pbs_statjob_iter *(*pfn_pbs_statjob_open)(int, char *, struct attrl *, char *) = __pbs_statjob_open;
+struct batch_status *(*pfn_pbs_statjob_next)(struct pbs_statjob_iter *) = __pbs_statjob_next;
+void (*pfn_pbs_statjob_close)(struct pbs_statjob_iter *) = __pbs_statjob_close;
 struct batch_status *(*pfn_pbs_selstat)(int, struct attropl *, struct attrl *, char *) = __pbs_selstat;
 struct batch_status *(*pfn_pbs_statque)(int, char *, struct attrl *, char *) = __pbs_statque;
 struct batch_status *(*pfn_pbs_statserver)(int, struct attrl *, char *) = __pbs_statserver;
@@ -49,6 +49,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "libpbs.h"
+#include "dis.h"
+
+/* jobs carried by a single ModifyJobs_Async message */
+#define ALTERJOBS_BATCH_SIZE 1000
 
 /**
  * @brief	Convenience function to create attropl list from attrl (shallow copy)
@@ -203,3 +207,80 @@ __pbs_asyalterjob(int c, char *jobid, struct attrl *attrib, char *extend)
 	return i;
 
 }
+
+
+/**
+ * @brief	Send Alter Job requests for a list of jobs to the server,
+ *		Asynchronously.
+ *
+ * @par	Functionality:
+ *		The updates are carried by PBS_BATCH_ModifyJobs_Async messages of
+ *		up to ALTERJOBS_BATCH_SIZE jobs each instead of one message per job.
+ *		As with pbs_asyalterjob(), no reply is sent back; the server logs
+ *		any per-job failure.
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobs - array of job ids and their attribute lists
+ * @param[in] njobs - number of entries in jobs
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	!0	error
+ *
+ */
+int
+__pbs_asyalterjobs(int c, struct alterjob_info *jobs, int njobs, char *extend)
+{
+	int i;
+	int n;
+	int rc;
+
+	if ((jobs == NULL) || (njobs <= 0))
+		return (pbs_errno = PBSE_IVALREQ);
+
+	for (i = 0; i < njobs; i++) {
+		if ((jobs[i].job_id == NULL) || (*jobs[i].job_id == '\0'))
+			return (pbs_errno = PBSE_IVALREQ);
+	}
+
+	/* initialize the thread context data, if not initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return pbs_errno;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return pbs_errno;
+
+	DIS_tcp_funcs();
+
+	for (i = 0; i < njobs; i += n) {
+		n = njobs - i;
+		if (n > ALTERJOBS_BATCH_SIZE)
+			n = ALTERJOBS_BATCH_SIZE;
+
+		if ((rc = encode_DIS_ReqHdr(c, PBS_BATCH_ModifyJobs_Async, pbs_current_user)) ||
+			(rc = encode_DIS_ModifyJobs(c, &jobs[i], n)) ||
+			(rc = encode_DIS_ReqExtend(c, extend))) {
+			if (set_conn_errtxt(c, dis_emsg[rc]) != 0)
+				pbs_errno = PBSE_SYSTEM;
+			else
+				pbs_errno = PBSE_PROTOCOL;
+			(void)pbs_client_thread_unlock_connection(c);
+			return pbs_errno;
+		}
+
+		if (dis_flush(c)) {
+			pbs_errno = PBSE_PROTOCOL;
+			(void)pbs_client_thread_unlock_connection(c);
+			return pbs_errno;
+		}
+	}
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return pbs_errno;
+
+	return 0;
+}
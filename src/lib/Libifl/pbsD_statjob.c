@@ -45,8 +45,58 @@
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include "libpbs.h"
 #include "pbs_ecl.h"
+#include "attribute.h"
+#include "ifl_internal.h"
+
+/* state of a job status walked a page at a time, see pbs_statjob_open() */
+struct pbs_statjob_iter {
+	int c;			/* communication handle */
+	char *id;		/* job id(s), queue or server */
+	struct attrl *attrib;	/* attributes to return */
+	char *extend;		/* caller's extend flags */
+	int paged;		/* id names a queue or the server */
+	int start;		/* first server instance to ask */
+	int nsvrs;		/* number of server instances to ask */
+	int cur;		/* server instances already exhausted */
+	char after[PBS_MAXSVRJOBID + 1];	/* last job of the previous page */
+	char rank[32];		/* cursor of the previous page, see STAT_PAGE_CURSOR */
+};
+
+/**
+ * @brief
+ *	-Take the paging cursor off the last status of a page.
+ *
+ * @param[in] last - last status of the page
+ * @param[out] rank - the cursor, empty if the page has none
+ * @param[in] len - size of rank
+ *
+ * @return	void
+ *
+ */
+static void
+take_stat_page_cursor(struct batch_status *last, char *rank, size_t len)
+{
+	struct attrl **pp;
+	struct attrl *pal;
+
+	*rank = '\0';
+	for (pp = &last->attribs; (pal = *pp) != NULL; pp = &pal->next) {
+		if (strcmp(pal->name, STAT_PAGE_CURSOR) == 0) {
+			if (pal->value != NULL)
+				pbs_strncpy(rank, pal->value, len);
+			*pp = pal->next;
+			pal->next = NULL;
+			free_attrl(pal);
+			return;
+		}
+	}
+}
 
 
 /**
@@ -68,3 +118,194 @@ __pbs_statjob(int c, char *id, struct attrl *attrib, char *extend)
 {
 	return PBSD_status_aggregate(c, PBS_BATCH_StatusJob, id, attrib, extend, MGR_OBJ_JOB, NULL);
 }
+
+/**
+ * @brief
+ *	-Start a job status which is returned a page at a time by
+ *	pbs_statjob_next().  The jobs of a queue or of the server are requested
+ *	STAT_PAGE_DFLT at a time, so neither the server nor the caller holds
+ *	the status of every job at once.  Other ids are statused in one page.
+ *
+ * @note
+ *	The connection must not be used for other requests until the status
+ *	is closed with pbs_statjob_close().
+ *
+ * @param[in] c - communication handle
+ * @param[in] id - job id(s), queue name or NULL/"@server" for all jobs
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for req
+ *
+ * @return	struct pbs_statjob_iter *
+ * @retval	handle to pass to pbs_statjob_next()	success
+ * @retval	NULL					error, pbs_errno is set
+ *
+ */
+struct pbs_statjob_iter *
+__pbs_statjob_open(int c, char *id, struct attrl *attrib, char *extend)
+{
+	struct pbs_statjob_iter *it;
+	svr_conn_t **svr_conns = get_conn_svr_instances(c);
+
+	if (!svr_conns)
+		return NULL;
+
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	if (pbs_verify_attributes(random_srv_conn(svr_conns), PBS_BATCH_StatusJob, MGR_OBJ_JOB, MGR_CMD_NONE, (struct attropl *) attrib) != 0)
+		return NULL;
+
+	if (id == NULL)
+		id = "";
+	if ((it = calloc(1, sizeof(struct pbs_statjob_iter))) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	it->c = c;
+	it->id = strdup(id);
+	it->extend = strdup(extend ? extend : "");
+	if (attrib != NULL)
+		it->attrib = dup_attrl_list(attrib);
+	if (it->id == NULL || it->extend == NULL || (attrib != NULL && it->attrib == NULL)) {
+		__pbs_statjob_close(it);
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	it->paged = !isdigit((int) *id);
+	it->nsvrs = get_num_servers();
+	if ((it->start = starting_index(id)) == -1)
+		it->start = 0;
+	else
+		it->nsvrs = 1;
+
+	return it;
+}
+
+/**
+ * @brief
+ *	-Return the next page of a job status started by pbs_statjob_open().
+ *	The caller frees each page with pbs_statfree().
+ *
+ * @param[in] it - handle returned by pbs_statjob_open()
+ *
+ * @return	structure handle
+ * @retval	pointer to batch_status struct		next page
+ * @retval	NULL					no more jobs, or error if
+ *							pbs_errno is not PBSE_NONE
+ *
+ */
+struct batch_status *
+__pbs_statjob_next(struct pbs_statjob_iter *it)
+{
+	svr_conn_t **svr_conns;
+	struct batch_reply *reply;
+	struct batch_status *ret = NULL;
+	char *extend = NULL;
+	char *p;
+	int more;
+	int rc = 0;
+	int i;
+
+	if (it == NULL || (svr_conns = get_conn_svr_instances(it->c)) == NULL)
+		return NULL;
+
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	if (pbs_client_thread_lock_connection(it->c) != 0)
+		return NULL;
+
+	pbs_errno = PBSE_NONE;
+	while (ret == NULL && it->cur < it->nsvrs) {
+		i = (it->start + it->cur) % get_num_servers();
+		more = 0;
+
+		if (!svr_conns[i] || svr_conns[i]->state != SVR_CONN_STATE_UP) {
+			rc = PBSE_NOSERVER;
+			it->cur++;
+			continue;
+		}
+
+		free(extend);
+		extend = NULL;
+		if (it->paged) {
+			if (*it->after == '\0')
+				rc = pbs_asprintf(&extend, "%s,%s%d", it->extend, EXTEND_OPT_STAT_PAGE, STAT_PAGE_DFLT);
+			else
+				rc = pbs_asprintf(&extend, "%s,%s%d,%s%s,%s%s", it->extend, EXTEND_OPT_STAT_PAGE, STAT_PAGE_DFLT,
+						  EXTEND_OPT_STAT_AFTER, it->after, EXTEND_OPT_STAT_RANK, it->rank);
+			if (rc == -1) {
+				rc = PBSE_SYSTEM;
+				break;
+			}
+		}
+
+		if ((rc = PBSD_status_put(svr_conns[i]->sd, PBS_BATCH_StatusJob, it->id, it->attrib,
+					  extend ? extend : it->extend, PROT_TCP, NULL)) != 0) {
+			it->cur++;
+			continue;
+		}
+
+		reply = PBSD_rdrpy(svr_conns[i]->sd);
+		if (reply == NULL) {
+			pbs_errno = PBSE_PROTOCOL;
+		} else if (reply->brp_choice != BATCH_REPLY_CHOICE_NULL &&
+			   reply->brp_choice != BATCH_REPLY_CHOICE_Text &&
+			   reply->brp_choice != BATCH_REPLY_CHOICE_Status) {
+			pbs_errno = PBSE_PROTOCOL;
+		} else if (get_conn_errno(svr_conns[i]->sd) == 0) {
+			ret = reply->brp_un.brp_statc;
+			reply->brp_un.brp_statc = NULL;
+			if (it->paged && reply->last != NULL)
+				take_stat_page_cursor(reply->last, it->rank, sizeof(it->rank));
+			/* resume after the last job, or its parent if it is a subjob */
+			if (it->paged && reply->brp_auxcode == STAT_PAGE_MORE && reply->last != NULL &&
+			    *it->rank != '\0' && strlen(reply->last->name) <= PBS_MAXSVRJOBID) {
+				pbs_strncpy(it->after, reply->last->name, sizeof(it->after));
+				if ((p = strchr(it->after, '[')) != NULL && p[1] != ']') {
+					char *q = strchr(reply->last->name, ']');
+
+					if (q != NULL)
+						sprintf(p + 1, "%s", q);
+				}
+				more = 1;
+			}
+		}
+		PBSD_FreeReply(reply);
+
+		if (!more) {
+			it->after[0] = '\0';
+			it->cur++;
+		}
+	}
+	free(extend);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(it->c) != 0)
+		return NULL;
+
+	if (ret == NULL && rc)
+		pbs_errno = rc;
+
+	return ret;
+}
+
+/**
+ * @brief
+ *	-Release a job status started by pbs_statjob_open().
+ *
+ * @param[in] it - handle returned by pbs_statjob_open()
+ *
+ * @return	void
+ *
+ */
+void
+__pbs_statjob_close(struct pbs_statjob_iter *it)
+{
+	if (it == NULL)
+		return;
+	free(it->id);
+	free(it->extend);
+	free_attrl_list(it->attrib);
+	free(it);
+}
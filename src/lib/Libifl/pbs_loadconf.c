@@ -130,6 +130,11 @@ struct pbs_config pbs_conf = {
 	NULL,					/* mom short name override */
 	NULL,					/* pbs_lr_save_path */
 	0,					/* high resolution timestamp logging */
+	0,					/* asynchronous logging */
+	0,					/* wait for room in the async log queue */
+	1,					/* write queued async log records at shutdown */
+	60,					/* host name resolution cache ttl */
+	10,					/* failed host name resolution cache ttl */
 	0,					/* number of scheduler threads */
 	NULL,					/* default scheduler user */
 	{'\0'}					/* current running user */
@@ -636,6 +641,26 @@ __pbs_loadconf(int reload)
 				if (sscanf(conf_value, "%u", &uvalue) == 1)
 					pbs_conf.pbs_log_highres_timestamp = ((uvalue > 0) ? 1 : 0);
 			}
+			else if (!strcmp(conf_name, PBS_CONF_LOG_ASYNC)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_log_async = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_LOG_ASYNC_DROP)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_log_async_drop = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_LOG_ASYNC_FLUSH)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_log_async_flush = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_DNS_CACHE_TTL)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_dns_cache_ttl = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_DNS_CACHE_NEG_TTL)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_dns_cache_neg_ttl = uvalue;
+			}
 			else if (!strcmp(conf_name, PBS_CONF_SCHED_THREADS)) {
 				if (sscanf(conf_value, "%u", &uvalue) == 1)
 					pbs_conf.pbs_sched_threads = uvalue;
@@ -884,6 +909,26 @@ __pbs_loadconf(int reload)
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
 			pbs_conf.pbs_log_highres_timestamp = ((uvalue > 0) ? 1 : 0);
 	}
+	if ((gvalue = getenv(PBS_CONF_LOG_ASYNC)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_log_async = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_LOG_ASYNC_DROP)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_log_async_drop = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_LOG_ASYNC_FLUSH)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_log_async_flush = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_DNS_CACHE_TTL)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_dns_cache_ttl = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_DNS_CACHE_NEG_TTL)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_dns_cache_neg_ttl = uvalue;
+	}
 	if ((gvalue = getenv(PBS_CONF_SCHED_THREADS)) != NULL) {
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
 			pbs_conf.pbs_sched_threads = uvalue;
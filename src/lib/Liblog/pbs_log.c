@@ -67,6 +67,7 @@
 #include <signal.h>
 #include <stddef.h>
 #include <stdarg.h>
+#include <sched.h>
 
 #include "log.h"
 #include "pbs_ifl.h"
@@ -134,10 +135,68 @@ static unsigned int syslogfac = 0;
 static unsigned int syslogsvr = 3;
 static unsigned int pbs_log_highres_timestamp = 0;
 
+/* format of a record in the log file */
+#define LOG_RECORD_FMT "%02d/%02d/%04d %02d:%02d:%02d%s;%04x;%s;%s;%s;%s\n"
+
+#ifndef WIN32
+/*
+ * Asynchronous logging, enabled by set_log_async().  log_record() copies
+ * the record into a ring and returns; a writer thread formats the records
+ * and writes them to the log file in batches.
+ *
+ * The ring is a bounded multi-producer, single-consumer queue.  Each slot
+ * carries a sequence number which says whose turn it is: a producer may
+ * fill slot i when its sequence is the producer's position, the writer may
+ * empty it once the producer has bumped the sequence to position + 1.
+ */
+#define LOG_ASYNC_RING_SIZE 8192	/* must be a power of 2 */
+#define LOG_ASYNC_BATCH 256		/* records written per lock of the log */
+#define LOG_ASYNC_BUF_SIZE (64 * 1024)	/* writer's formatting buffer */
+#define LOG_ASYNC_IDLE_MS 100		/* writer's sleep when the ring is empty */
+#define LOG_ASYNC_EXIT_WAIT 5		/* seconds to wait for the writer at exit */
+
+struct log_async_rec {
+	struct timeval tv;
+	int eventtype;
+	int objclass;
+	char *text;		/* points into objname's buffer */
+	char objname[1];	/* objname and text, both null terminated */
+};
+
+struct log_async_slot {
+	unsigned long seq;
+	struct log_async_rec *rec;
+};
+
+static struct log_async_slot *log_async_ring = NULL;
+static unsigned long log_async_enq = 0;		/* next position producers claim */
+static unsigned long log_async_deq = 0;		/* next position the writer empties */
+static int log_async_enabled = 0;		/* asynchronous logging configured */
+static int log_async_drop = 0;			/* drop records when the ring is full */
+static int log_async_flush = 1;			/* write queued records at shutdown */
+static int log_async_running = 0;		/* writer thread accepts records */
+static int log_async_stop = 0;			/* writer thread should exit */
+static int log_async_idle = 0;			/* writer thread is sleeping */
+static int log_async_done = 0;			/* writer thread has finished */
+static int log_async_users = 0;			/* producers inside log_async_put() */
+static unsigned long log_async_dropped = 0;	/* records dropped since last report */
+static pthread_t log_async_tid;
+static pthread_mutex_t log_async_wait_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_async_wait_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t log_async_done_cond = PTHREAD_COND_INITIALIZER;
+static char log_async_buf[LOG_ASYNC_BUF_SIZE];
+
+static int log_async_put(int eventtype, int objclass, const char *objname, const char *text);
+static void log_async_start(void);
+static int log_async_stop_writer(int timeout);
+static void log_async_atexit(void);
+#endif
+
 static void log_init(void);
 static int log_mutex_lock();
 static int log_mutex_unlock();
 static void get_timestamp(ms_time *mst);
+static void tv_to_timestamp(struct timeval *tp, ms_time *mst);
 static void log_record_inner(int eventtype, int objclass, int sev, const char *objname, const char *text, ms_time *mst);
 static void log_console_error(char *);
 
@@ -168,6 +227,47 @@ set_log_conf(char *leafname, char *nodename,
 	log_mutex_unlock();
 }
 
+/**
+ * @brief
+ *	Turn asynchronous logging on or off.  When on, log_record() queues
+ *	records for a writer thread instead of writing them itself.
+ *
+ *	Call this once the daemon is running in the background: a forked
+ *	child goes back to synchronous logging.
+ *
+ * @param[in] async - 1 to log asynchronously, 0 to log synchronously
+ * @param[in] overflow_drop - when the queue is full, 1 drops records (the
+ *			      number dropped is logged later), 0 waits for room
+ * @param[in] shutdown_flush - 1 writes queued records when the log is
+ *			       closed or the daemon exits, 0 discards them
+ *
+ */
+void
+set_log_async(unsigned int async, unsigned int overflow_drop, unsigned int shutdown_flush)
+{
+#ifndef WIN32
+	static int atexit_set = 0;
+
+	pthread_once(&log_once_ctl, log_init); /* initialize mutex once */
+
+	log_async_drop = overflow_drop ? 1 : 0;
+	log_async_flush = shutdown_flush ? 1 : 0;
+
+	if (!async) {
+		log_async_stop_writer(0);
+		log_async_enabled = 0;
+		return;
+	}
+
+	if (!atexit_set) {
+		atexit(log_async_atexit);
+		atexit_set = 1;
+	}
+	log_async_enabled = 1;
+	log_async_start();
+#endif
+}
+
 #ifdef WIN32
 /**
  * @brief
@@ -357,6 +457,29 @@ log_parent_post_fork_handler()
 static void
 log_child_post_fork_handler()
 {
+	unsigned long pos;
+	struct log_async_slot *slot;
+
+	/*
+	 * The writer thread does not exist in the child, so the child logs
+	 * synchronously: it may well exec before a new writer would get to its
+	 * records.  The parent's writer owns the records still in the ring.
+	 */
+	if (log_async_ring != NULL) {
+		for (pos = log_async_deq;; pos++) {
+			slot = &log_async_ring[pos & (LOG_ASYNC_RING_SIZE - 1)];
+			if (slot->seq != pos + 1)
+				break;
+			free(slot->rec);
+		}
+		free(log_async_ring);
+		log_async_ring = NULL;
+	}
+	log_async_enabled = 0;
+	log_async_running = 0;
+	log_async_users = 0;
+	log_async_enq = 0;
+	log_async_deq = 0;
 	log_mutex_unlock();
 }
 #endif
@@ -689,6 +812,11 @@ log_open_main(char *filename, char *directory, int silent)
 	}
 #endif
 
+#ifndef WIN32
+	/* restart the writer thread stopped by log_close() */
+	log_async_start();
+#endif
+
 
 	return (0);
 }
@@ -924,20 +1052,38 @@ log_suspect_file(const char *func, const char *text, const char *file, struct st
 void
 get_timestamp(ms_time *mst)
 {
-	time_t now = 0;
-	struct tm *ptm;
 	struct timeval tp;
+
+	/* if gettimeofday() fails, log messages will be printed at the epoch */
+	if (gettimeofday(&tp, NULL) == -1) {
+		tp.tv_sec = 0;
+		tp.tv_usec = 0;
+	}
+	tv_to_timestamp(&tp, mst);
+}
+
+/**
+ * @brief
+ *	Convert a time of day to the ms_time format used in log records
+ *
+ * @param[in] tp - the time of day
+ * @param[out] mst - the ms_time structure is populated and returned
+ *
+ */
+static void
+tv_to_timestamp(struct timeval *tp, ms_time *mst)
+{
+	time_t now;
+	struct tm *ptm;
 #ifndef WIN32
 	struct tm ltm;
 #endif
-	/* if gettimeofday() fails, log messages will be printed at the epoch */
-	if (gettimeofday(&tp, NULL) != -1) {
-		now = tp.tv_sec;
-		if (pbs_log_highres_timestamp)
-			snprintf(mst->microsec_buf, sizeof(mst->microsec_buf), ".%06ld", (long)tp.tv_usec);
-		else
-			mst->microsec_buf[0] = '\0';
-	}
+
+	now = tp->tv_sec;
+	if (pbs_log_highres_timestamp)
+		snprintf(mst->microsec_buf, sizeof(mst->microsec_buf), ".%06ld", (long)tp->tv_usec);
+	else
+		mst->microsec_buf[0] = '\0';
 
 #ifdef WIN32
 	ptm = localtime(&now);
@@ -1016,12 +1162,31 @@ log_record(int eventtype, int objclass, int sev, const char *objname, const char
 	if ((text == NULL) || (objname == NULL))
 		goto sigunblock;
 
+#ifndef WIN32
+	/* hand the record to the writer thread, if there is one */
+	if (__atomic_load_n(&log_async_running, __ATOMIC_ACQUIRE) &&
+	    log_async_put(eventtype, objclass, objname, text) == 0)
+		goto sigunblock;
+#endif
+
 	/* lock the file mutex */
 	if (log_mutex_lock() == 0) {
 		get_timestamp(&mst);
 		
 		/* Do we need to switch the log? */
 		if (log_auto_switch && (mst.ptm.tm_yday != log_open_day)) {
+#ifndef WIN32
+			/*
+			 * log_close() stops the writer thread, which needs the log
+			 * mutex to finish its batch: do not hold it while waiting.
+			 */
+			if (__atomic_load_n(&log_async_running, __ATOMIC_SEQ_CST)) {
+				log_mutex_unlock();
+				log_async_stop_writer(0);
+				if (log_mutex_lock() != 0)
+					goto sigunblock;
+			}
+#endif
 			log_close(1);
 			log_open(NULL, log_directory);
 			if (log_opened < 1) {
@@ -1067,8 +1232,7 @@ log_record_inner(int eventtype, int objclass, int sev, const char *objname, cons
 {
 	int rc = 0;
 	if (locallog != 0 || syslogfac == 0) {
-		rc = fprintf(logfile,
-				"%02d/%02d/%04d %02d:%02d:%02d%s;%04x;%s;%s;%s;%s\n",
+		rc = fprintf(logfile, LOG_RECORD_FMT,
 				mst->ptm.tm_mon + 1, mst->ptm.tm_mday, mst->ptm.tm_year + 1900,
 				mst->ptm.tm_hour, mst->ptm.tm_min, mst->ptm.tm_sec, mst->microsec_buf,
 				eventtype & ~PBSEVENT_FORCE, msg_daemonname,
@@ -1080,6 +1244,425 @@ log_record_inner(int eventtype, int objclass, int sev, const char *objname, cons
 	}
 }
 
+#ifndef WIN32
+/**
+ * @brief
+ *	Wake the writer thread if it is waiting for records
+ *
+ */
+static void
+log_async_wake(void)
+{
+	if (__atomic_load_n(&log_async_idle, __ATOMIC_ACQUIRE)) {
+		pthread_mutex_lock(&log_async_wait_mutex);
+		pthread_cond_signal(&log_async_wait_cond);
+		pthread_mutex_unlock(&log_async_wait_mutex);
+	}
+}
+
+/**
+ * @brief
+ *	Add a record to the ring
+ *
+ * @param[in] rec - the record
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - the ring is full
+ *
+ * @par MT-safe: Yes
+ */
+static int
+log_async_push(struct log_async_rec *rec)
+{
+	unsigned long pos;
+	unsigned long seq;
+	long diff;
+	struct log_async_slot *slot;
+
+	pos = __atomic_load_n(&log_async_enq, __ATOMIC_RELAXED);
+	for (;;) {
+		slot = &log_async_ring[pos & (LOG_ASYNC_RING_SIZE - 1)];
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		diff = (long) seq - (long) pos;
+		if (diff == 0) {
+			/* the slot is free, claim it */
+			if (__atomic_compare_exchange_n(&log_async_enq, &pos, pos + 1, 1,
+							__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		} else if (diff < 0)
+			return -1; /* the writer has not emptied this slot yet */
+		else
+			pos = __atomic_load_n(&log_async_enq, __ATOMIC_RELAXED);
+	}
+
+	slot->rec = rec;
+	__atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Take the oldest record off the ring.  Only the writer thread calls this.
+ *
+ * @return struct log_async_rec *
+ * @retval the record
+ * @retval NULL - the ring is empty
+ */
+static struct log_async_rec *
+log_async_pop(void)
+{
+	struct log_async_slot *slot;
+	struct log_async_rec *rec;
+
+	slot = &log_async_ring[log_async_deq & (LOG_ASYNC_RING_SIZE - 1)];
+	if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != log_async_deq + 1)
+		return NULL;
+
+	rec = slot->rec;
+	__atomic_store_n(&slot->seq, log_async_deq + LOG_ASYNC_RING_SIZE, __ATOMIC_RELEASE);
+	log_async_deq++;
+	return rec;
+}
+
+/**
+ * @brief
+ *	Queue a record for the writer thread
+ *
+ * @param[in] eventtype - event type
+ * @param[in] objclass - event object class
+ * @param[in] objname - object name stating log msg related to which object
+ * @param[in] text - log msg to be logged
+ *
+ * @return int
+ * @retval 0 - the record was queued (or dropped because the ring was full)
+ * @retval -1 - the caller must write the record itself
+ *
+ * @par MT-safe: Yes
+ */
+static int
+log_async_put(int eventtype, int objclass, const char *objname, const char *text)
+{
+	struct log_async_rec *rec;
+	size_t namelen;
+	size_t textlen;
+	int rc = -1;
+
+	/* log_async_stop_writer() waits for us to leave before stopping the writer */
+	__atomic_add_fetch(&log_async_users, 1, __ATOMIC_SEQ_CST);
+	if (!__atomic_load_n(&log_async_running, __ATOMIC_SEQ_CST) ||
+	    pthread_equal(pthread_self(), log_async_tid))
+		goto done;
+
+	namelen = strlen(objname);
+	textlen = strlen(text);
+	rec = malloc(sizeof(struct log_async_rec) + namelen + textlen + 1);
+	if (rec == NULL)
+		goto done;
+	gettimeofday(&rec->tv, NULL);
+	rec->eventtype = eventtype;
+	rec->objclass = objclass;
+	memcpy(rec->objname, objname, namelen + 1);
+	rec->text = rec->objname + namelen + 1;
+	memcpy(rec->text, text, textlen + 1);
+
+	while (log_async_push(rec) != 0) {
+		if (log_async_drop) {
+			free(rec);
+			__atomic_add_fetch(&log_async_dropped, 1, __ATOMIC_RELAXED);
+			break;
+		}
+		/* wait for the writer to make room */
+		log_async_wake();
+		sched_yield();
+	}
+	log_async_wake();
+	rc = 0;
+
+done:
+	__atomic_sub_fetch(&log_async_users, 1, __ATOMIC_SEQ_CST);
+	return rc;
+}
+
+/**
+ * @brief
+ *	Write out the writer's formatting buffer
+ *
+ * @param[in,out] len - length of the data in the buffer, reset to 0
+ *
+ * Call with the log mutex held.
+ */
+static void
+log_async_write_buf(size_t *len)
+{
+	if (*len == 0)
+		return;
+
+	if (log_opened == 1 && (locallog != 0 || syslogfac == 0)) {
+		if (fwrite(log_async_buf, 1, *len, logfile) != *len)
+			log_console_error("PBS cannot write to its log");
+		(void)fflush(logfile);
+	}
+	*len = 0;
+}
+
+/**
+ * @brief
+ *	Format a record into the writer's buffer, writing the buffer out
+ *	first if the record does not fit
+ *
+ * @param[in,out] len - length of the data in the buffer
+ * @param[in] eventtype - event type
+ * @param[in] objclass - event object class
+ * @param[in] objname - object name
+ * @param[in] text - log msg
+ * @param[in] mst - timestamp of the record
+ *
+ * Call with the log mutex held.
+ */
+static void
+log_async_format(size_t *len, int eventtype, int objclass, const char *objname, const char *text, ms_time *mst)
+{
+	int n;
+
+	if (log_opened != 1 || (locallog == 0 && syslogfac != 0))
+		return;
+
+	for (;;) {
+		n = snprintf(log_async_buf + *len, sizeof(log_async_buf) - *len, LOG_RECORD_FMT,
+			     mst->ptm.tm_mon + 1, mst->ptm.tm_mday, mst->ptm.tm_year + 1900,
+			     mst->ptm.tm_hour, mst->ptm.tm_min, mst->ptm.tm_sec, mst->microsec_buf,
+			     eventtype & ~PBSEVENT_FORCE, msg_daemonname,
+			     class_names[objclass], objname, text);
+		if (n < 0)
+			return;
+		if ((size_t) n < sizeof(log_async_buf) - *len) {
+			*len += n;
+			return;
+		}
+		if (*len == 0) {
+			/* too big for the buffer on its own */
+			log_record_inner(eventtype, objclass, 0, objname, text, mst);
+			return;
+		}
+		log_async_write_buf(len);
+	}
+}
+
+/**
+ * @brief
+ *	Write up to LOG_ASYNC_BATCH records from the ring to the log
+ *
+ * @return int
+ * @retval number of records taken off the ring
+ */
+static int
+log_async_write_batch(void)
+{
+	struct log_async_rec *recs[LOG_ASYNC_BATCH];
+	unsigned long dropped;
+	size_t len = 0;
+	ms_time mst;
+	int ct;
+	int i;
+
+	for (ct = 0; ct < LOG_ASYNC_BATCH; ct++)
+		if ((recs[ct] = log_async_pop()) == NULL)
+			break;
+	dropped = __atomic_exchange_n(&log_async_dropped, 0, __ATOMIC_RELAXED);
+	if (ct == 0 && dropped == 0)
+		return 0;
+
+	if (log_mutex_lock() == 0) {
+		for (i = 0; i < ct; i++) {
+			tv_to_timestamp(&recs[i]->tv, &mst);
+
+			/* Do we need to switch the log? */
+			if (log_auto_switch && (mst.ptm.tm_yday != log_open_day)) {
+				log_async_write_buf(&len);
+				log_close(1);
+				log_open(NULL, log_directory);
+				if (log_opened < 1)
+					log_console_error("PBS cannot open its log");
+			}
+			log_async_format(&len, recs[i]->eventtype, recs[i]->objclass,
+					 recs[i]->objname, recs[i]->text, &mst);
+		}
+		if (dropped > 0) {
+			char msg[128];
+
+			get_timestamp(&mst);
+			snprintf(msg, sizeof(msg), "%lu log records dropped, log queue was full", dropped);
+			log_async_format(&len, PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, "Log", msg, &mst);
+		}
+		log_async_write_buf(&len);
+		log_mutex_unlock();
+	}
+
+	for (i = 0; i < ct; i++)
+		free(recs[i]);
+
+	return ct;
+}
+
+/**
+ * @brief
+ *	The writer thread: write batches of records until told to stop
+ *
+ * @param[in] arg - unused
+ *
+ * @return void *
+ */
+static void *
+log_async_writer(void *arg)
+{
+	sigset_t block_mask;
+	struct timespec ts;
+	struct log_async_rec *rec;
+
+	/* signals are for the daemon's main thread */
+	sigfillset(&block_mask);
+	pthread_sigmask(SIG_BLOCK, &block_mask, NULL);
+
+	for (;;) {
+		if (__atomic_load_n(&log_async_stop, __ATOMIC_ACQUIRE) && !log_async_flush)
+			break;
+		if (log_async_write_batch() > 0)
+			continue;
+		if (__atomic_load_n(&log_async_stop, __ATOMIC_ACQUIRE))
+			break;
+
+		pthread_mutex_lock(&log_async_wait_mutex);
+		__atomic_store_n(&log_async_idle, 1, __ATOMIC_SEQ_CST);
+		/* a record may have arrived before we said we are idle */
+		if (__atomic_load_n(&log_async_ring[log_async_deq & (LOG_ASYNC_RING_SIZE - 1)].seq,
+				    __ATOMIC_ACQUIRE) != log_async_deq + 1 &&
+		    !__atomic_load_n(&log_async_stop, __ATOMIC_ACQUIRE)) {
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_nsec += LOG_ASYNC_IDLE_MS * 1000000L;
+			if (ts.tv_nsec >= 1000000000L) {
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000L;
+			}
+			pthread_cond_timedwait(&log_async_wait_cond, &log_async_wait_mutex, &ts);
+		}
+		__atomic_store_n(&log_async_idle, 0, __ATOMIC_SEQ_CST);
+		pthread_mutex_unlock(&log_async_wait_mutex);
+	}
+
+	/* not flushing at shutdown: throw away what is left */
+	while ((rec = log_async_pop()) != NULL)
+		free(rec);
+
+	pthread_mutex_lock(&log_async_wait_mutex);
+	log_async_done = 1;
+	pthread_cond_broadcast(&log_async_done_cond);
+	pthread_mutex_unlock(&log_async_wait_mutex);
+
+	return NULL;
+}
+
+/**
+ * @brief
+ *	Start the writer thread if asynchronous logging is configured and the
+ *	log is open
+ *
+ */
+static void
+log_async_start(void)
+{
+	unsigned long i;
+
+	if (!log_async_enabled || log_async_running || log_opened != 1)
+		return;
+
+	if (log_async_ring == NULL) {
+		log_async_ring = calloc(LOG_ASYNC_RING_SIZE, sizeof(struct log_async_slot));
+		if (log_async_ring == NULL) {
+			log_console_error("PBS cannot allocate its log queue");
+			return;
+		}
+		for (i = 0; i < LOG_ASYNC_RING_SIZE; i++)
+			log_async_ring[i].seq = i;
+		log_async_enq = 0;
+		log_async_deq = 0;
+	}
+
+	__atomic_store_n(&log_async_stop, 0, __ATOMIC_SEQ_CST);
+	log_async_done = 0;
+	if (pthread_create(&log_async_tid, NULL, log_async_writer, NULL) != 0) {
+		log_console_error("PBS cannot start its log writer thread");
+		return;
+	}
+	__atomic_store_n(&log_async_running, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief
+ *	Stop the writer thread.  Queued records are written first unless
+ *	shutdown flushing was turned off by set_log_async().
+ *
+ *	Does nothing when called from the writer thread itself, which closes
+ *	and reopens the log when it switches files at midnight.  The caller
+ *	must not hold the log mutex: the writer takes it to write its last
+ *	batch.
+ *
+ * @param[in] timeout - seconds to wait for the writer to finish, 0 waits
+ *			as long as it takes
+ *
+ * @return int
+ * @retval 0 - the writer is stopped
+ * @retval -1 - the writer did not finish in time and was left running
+ */
+static int
+log_async_stop_writer(int timeout)
+{
+	struct timespec ts;
+	int rc = 0;
+
+	if (!__atomic_load_n(&log_async_running, __ATOMIC_SEQ_CST) ||
+	    pthread_equal(pthread_self(), log_async_tid))
+		return 0;
+
+	/* no new records; let the producers already queueing finish */
+	__atomic_store_n(&log_async_running, 0, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&log_async_users, __ATOMIC_SEQ_CST) > 0)
+		sched_yield();
+
+	__atomic_store_n(&log_async_stop, 1, __ATOMIC_SEQ_CST);
+	pthread_mutex_lock(&log_async_wait_mutex);
+	pthread_cond_signal(&log_async_wait_cond);
+	if (timeout > 0) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += timeout;
+		while (!log_async_done && rc == 0)
+			rc = pthread_cond_timedwait(&log_async_done_cond, &log_async_wait_mutex, &ts);
+		rc = log_async_done ? 0 : -1;
+	}
+	pthread_mutex_unlock(&log_async_wait_mutex);
+
+	if (rc != 0) {
+		log_console_error("PBS log writer thread did not stop, queued log records lost");
+		return -1;
+	}
+	pthread_join(log_async_tid, NULL);
+	return 0;
+}
+
+/**
+ * @brief
+ *	atexit() handler, so a daemon exiting without log_close() does not
+ *	lose its queued records
+ *
+ */
+static void
+log_async_atexit(void)
+{
+	/* the writer may be stuck behind a log mutex the exiting thread holds */
+	log_async_stop_writer(LOG_ASYNC_EXIT_WAIT);
+}
+#endif
+
 /**
  * @brief
  * 	log_close - close the current open log file
@@ -1092,6 +1675,10 @@ log_record_inner(int eventtype, int objclass, int sev, const char *objname, cons
 void
 log_close(int msg)
 {
+#ifndef WIN32
+	/* records queued before the close belong to the old file */
+	log_async_stop_writer(0);
+#endif
 	if (log_opened == 1) {
 		log_auto_switch = 0;
 		if (msg) {
@@ -51,6 +51,7 @@
 #include "net_connect.h"
 #include "pbs_error.h"
 #include "pbs_internal.h"
+#include "libutil.h"
 
 #if !defined(H_ERRNO_DECLARED)
 extern int h_errno;
@@ -85,52 +86,28 @@ extern int h_errno;
 pbs_net_t
 get_hostaddr(char *hostname)
 {
-	struct addrinfo *aip, *pai;
-	struct addrinfo hints;
-	struct sockaddr_in *inp;
+	unsigned long	addr;
+	int		naddrs;
 	int		err;
-	pbs_net_t	res;
 
 	if ((hostname == 0) || (*hostname == '\0')) {
 		pbs_errno = PBS_NET_RC_FATAL;
 		return ((pbs_net_t)0);
 	}
 
-	memset(&hints, 0, sizeof(struct addrinfo));
-	/*
-	 *      Why do we use AF_UNSPEC rather than AF_INET?  Some
-	 *      implementations of getaddrinfo() will take an IPv6
-	 *      address and map it to an IPv4 one if we ask for AF_INET
-	 *      only.  We don't want that - we want only the addresses
-	 *      that are genuinely, natively, IPv4 so we start with
-	 *      AF_UNSPEC and filter ai_family below.
-	 */
-	hints.ai_family = AF_UNSPEC;
-	hints.ai_socktype = SOCK_STREAM;
-	hints.ai_protocol = IPPROTO_TCP;
-	if ((err = getaddrinfo(hostname, NULL, &hints, &pai)) != 0) {
+	if ((err = pbs_resolve_addrs(hostname, &addr, 1, &naddrs)) != 0) {
 		if (err == EAI_AGAIN)
 			pbs_errno = PBS_NET_RC_RETRY;
 		else
 			pbs_errno = PBS_NET_RC_FATAL;
 		return ((pbs_net_t)0);
 	}
-	for (aip = pai; aip != NULL; aip = aip->ai_next) {
-		/* skip non-IPv4 addresses */
-		if (aip->ai_family == AF_INET) {
-			inp = (struct sockaddr_in *) aip->ai_addr;
-			break;
-		}
-	}
-	if (aip == NULL) {
+	if (naddrs == 0) {
 		/* treat no IPv4 addresses as fatal getaddrinfo() failure */
 		pbs_errno = PBS_NET_RC_FATAL;
-		freeaddrinfo(pai);
 		return ((pbs_net_t)0);
 	}
-	res = ntohl(inp->sin_addr.s_addr);
-	freeaddrinfo(pai);
-	return (res);
+	return ((pbs_net_t)addr);
 }
 
 /**
@@ -198,34 +175,22 @@ compare_short_hostname(char *shost, char *lhost)
 int
 comp_svraddr(pbs_net_t svr_addr, char *hostname)
 {
-	struct addrinfo *aip, *pai;
-	struct addrinfo hints;
-	struct sockaddr_in *inp;
-	pbs_net_t	res;
+	unsigned long	addrs[PBS_RESOLVE_MAXADDRS];
+	int		naddrs;
+	int		i;
 
 	if ((hostname == NULL) || (*hostname == '\0')) {
 		return (2);
 	}
 
-	memset(&hints, 0, sizeof(struct addrinfo));
-	hints.ai_family = AF_UNSPEC;
-	hints.ai_socktype = SOCK_STREAM;
-	hints.ai_protocol = IPPROTO_TCP;
-	if (getaddrinfo(hostname, NULL, &hints, &pai) != 0) {
+	if (pbs_resolve_addrs(hostname, addrs, PBS_RESOLVE_MAXADDRS, &naddrs) != 0) {
 		pbs_errno = PBSE_BADHOST;
 		return (2);
 	}
-	for (aip = pai; aip != NULL; aip = aip->ai_next) {
-		if (aip->ai_family == AF_INET) {
-			inp = (struct sockaddr_in *) aip->ai_addr;
-			res = ntohl(inp->sin_addr.s_addr);
-			if (res == svr_addr) {
-				freeaddrinfo(pai);
-				return 0;
-			}
-		}
+	for (i = 0; i < naddrs; i++) {
+		if (addrs[i] == svr_addr)
+			return 0;
 	}
 	/* no match found */
-	freeaddrinfo(pai);
 	return (1);
 }
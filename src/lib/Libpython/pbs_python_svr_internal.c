@@ -159,6 +159,7 @@ typedef struct _pbs_python_types_entry {
 #define  PP_ENV_IDX			26
 #define  PP_MANAGEMENT_IDX	27
 #define  PP_SERVER_ATTRIBUTE_IDX 28
+#define  PP_LAZY_DICT_IDX	29
 
 pbs_python_types_entry pbs_python_types_table [] = {
 	{PY_TYPE_ATTR_DESCRIPTOR, 		NULL},	/* 0 Always first */
@@ -190,6 +191,7 @@ pbs_python_types_entry pbs_python_types_table [] = {
 	{PY_TYPE_ENV, 				NULL},		 /* 26 */
 	{PY_TYPE_MANAGEMENT,		NULL},		 /* 27 */
 	{PY_TYPE_SERVER_ATTRIBUTE, 		NULL},		 /* 28 */
+	{PY_TYPE_LAZY_DICT,			NULL},		 /* 29 */
 
 
 	/* ADD ENTRIES ONLY BELOW, OR CHANGE THE PP_XXX_IDX above the table */
@@ -4756,6 +4758,274 @@ create_py_resvlist_exit:
 	return (py_resvlist_ret);
 }
 
+/**
+ * @brief
+ *	Instantiates 'py_class' as object 'name', and populates it with the
+ *	attributes in 'pattr' encoded for a hook, the same way entries of a
+ *	vns_list or resv_list are populated by create_py_vnodelist() and
+ *	create_py_resvlist().
+ *
+ * @param[in]	py_class - the Python class to instantiate (vnode or resv)
+ * @param[in]	name - name of the object
+ * @param[in]	pattr - the object's attribute array
+ * @param[in]	padef - the attribute definitions for 'pattr'
+ * @param[in]	limit - number of entries in 'pattr'
+ *
+ * @return	PyObject *
+ * @retval	<object>	- the new Python object
+ * @retval	NULL		- error, with a Python exception set
+ */
+static PyObject *
+_pps_lazy_load_object(PyObject *py_class, char *name, attribute *pattr,
+			attribute_def *padef, int limit)
+{
+	pbs_list_head	attrs;
+	svrattrl	*plist;
+	PyObject	*py_args;
+	PyObject	*py_obj;
+	char		*p;
+	int		mode = hook_set_mode;
+	int		i;
+
+	CLEAR_HEAD(attrs);
+	for (i = 0; i < limit; i++) {
+		if (((padef + i)->at_flags & ATR_VFLAG_SET) == 0)
+			continue;
+		if ((padef + i)->at_encode(&pattr[i], &attrs,
+				(padef + i)->at_name, NULL,
+				ATR_ENCODE_HOOK, NULL) < 0) {
+			snprintf(log_buffer, sizeof(log_buffer),
+				"error on encoding attributes: %s.%s",
+				name, (padef + i)->at_name);
+			log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK,
+				LOG_ERR, __func__, log_buffer);
+			break;
+		}
+	}
+
+	/* resources are encoded as "<resc_name>,<type>" */
+	for (plist = (svrattrl *)GET_NEXT(attrs); plist != NULL;
+		plist = (svrattrl *)GET_NEXT(plist->al_link)) {
+		if ((plist->al_resc != NULL) &&
+			((p = strchr(plist->al_resc, ',')) != NULL))
+			*p = '\0';
+	}
+
+	py_obj = NULL;
+	py_args = Py_BuildValue("(s)", name); /* NEW ref */
+	if (py_args != NULL) {
+		py_obj = PyObject_Call(py_class, py_args, NULL); /* NEW ref */
+		Py_DECREF(py_args);
+	}
+	if (py_obj != NULL) {
+		hook_set_mode = C_MODE;
+		if (pbs_python_populate_python_class_from_svrattrl(py_obj,
+				&attrs, NULL, NULL) == -1) {
+			snprintf(log_buffer, sizeof(log_buffer),
+				"failed to fully populate Python object %s",
+				name);
+			log_err(PBSE_INTERNAL, __func__, log_buffer);
+		}
+		hook_set_mode = mode;
+	}
+
+	free_attrlist(&attrs);
+	return py_obj;
+}
+
+/**
+ * @brief
+ *	Loader of the lazy pbs.event().vnode_list: returns the Python vnode
+ *	object for vnode args[0], populated from the server's vnode table.
+ */
+static PyObject *
+_pps_lazy_load_vnode(PyObject *self, PyObject *args)
+{
+	char		*vname = NULL;
+	struct pbsnode	*pnode;
+
+	if (!PyArg_ParseTuple(args, "s", &vname))
+		return NULL;
+
+	if ((pnode = find_nodebyname(vname)) == NULL) {
+		PyErr_SetString(PyExc_KeyError, vname);
+		return NULL;
+	}
+
+	return (_pps_lazy_load_object(pbs_python_types_table[PP_VNODE_IDX].t_class,
+		pnode->nd_name, pnode->nd_attr, node_attr_def, ND_ATR_LAST));
+}
+
+/**
+ * @brief
+ *	Loader of the lazy pbs.event().resv_list: returns the Python resv
+ *	object for reservation args[0], populated from the server's
+ *	reservation list.
+ */
+static PyObject *
+_pps_lazy_load_resv(PyObject *self, PyObject *args)
+{
+	char		*resvid = NULL;
+	resc_resv	*presv;
+
+	if (!PyArg_ParseTuple(args, "s", &resvid))
+		return NULL;
+
+	if ((presv = find_resv(resvid)) == NULL) {
+		PyErr_SetString(PyExc_KeyError, resvid);
+		return NULL;
+	}
+
+	return (_pps_lazy_load_object(pbs_python_types_table[PP_RESV_IDX].t_class,
+		presv->ri_qs.ri_resvID, presv->ri_wattr, resv_attr_def,
+		RESV_ATR_LAST));
+}
+
+static PyMethodDef pps_lazy_vnode_loader = {
+	"load_vnode", (PyCFunction)_pps_lazy_load_vnode, METH_VARARGS, NULL
+};
+
+static PyMethodDef pps_lazy_resv_loader = {
+	"load_resv", (PyCFunction)_pps_lazy_load_resv, METH_VARARGS, NULL
+};
+
+/**
+ * @brief
+ *	Returns a lazy_dict keyed by the names in 'py_keys', whose values
+ *	are created by 'loader' the first time a hook looks them up.
+ *
+ * @param[in]	py_keys - Python list of object names
+ * @param[in]	loader - the C function that creates one object
+ *
+ * @return 	PyObject *
+ * @retval	<object>	- the lazy_dict object
+ * @retval	NULL		- if an error occured.
+ */
+static PyObject *
+create_py_lazy_dict(PyObject *py_keys, PyMethodDef *loader)
+{
+	PyObject	*py_loader;
+	PyObject	*py_args;
+	PyObject	*py_dict = NULL;
+
+	py_loader = PyCFunction_New(loader, NULL); /* NEW ref */
+	if (py_loader == NULL)
+		return NULL;
+
+	py_args = Py_BuildValue("(OO)", py_keys, py_loader); /* NEW ref */
+	if (py_args != NULL) {
+		py_dict = PyObject_Call(
+			pbs_python_types_table[PP_LAZY_DICT_IDX].t_class,
+			py_args, NULL); /* NEW ref */
+		Py_DECREF(py_args);
+	}
+	Py_DECREF(py_loader);
+
+	if (py_dict == NULL)
+		pbs_python_write_error_to_log(__func__);
+	return py_dict;
+}
+
+/**
+ * @brief
+ *	Appends the string 'name' to the Python list 'py_list'.
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- error
+ */
+static int
+_pps_list_append_name(PyObject *py_list, char *name)
+{
+	PyObject	*py_str;
+	int		rc;
+
+	py_str = PyUnicode_FromString(name); /* NEW ref */
+	if (py_str == NULL)
+		return -1;
+	rc = PyList_Append(py_list, py_str);
+	Py_DECREF(py_str);
+	return rc;
+}
+
+/**
+ * @brief
+ *	Returns a Python dictionary of all the server's vnodes, indexed by
+ *	vnode name, whose vnode objects are only created and populated the
+ *	first time a hook accesses them.
+ *
+ * @param[in]	perf_label - data passed on to hook_perf_stat* call
+ * @param[in]	perf_action - data passed on to hook_perf_stat* call
+ *
+ * @return 	PyObject *
+ * @retval	<object>	- the vnode list dictionary
+ * @retval	NULL		- if an error occured.
+ */
+static PyObject *
+create_py_lazy_vnodelist(char *perf_label, char *perf_action)
+{
+	PyObject	*py_keys;
+	PyObject	*py_vnodelist = NULL;
+	int		i;
+
+	hook_perf_stat_start(perf_label, perf_action, 0);
+
+	py_keys = PyList_New(0); /* NEW ref */
+	for (i = 0; (py_keys != NULL) && (i < svr_totnodes); i++) {
+		if (_pps_list_append_name(py_keys,
+				pbsndlist[i]->nd_name) == -1)
+			Py_CLEAR(py_keys);
+	}
+	if (py_keys != NULL) {
+		py_vnodelist = create_py_lazy_dict(py_keys,
+			&pps_lazy_vnode_loader);
+		Py_DECREF(py_keys);
+	}
+
+	hook_perf_stat_stop(perf_label, perf_action, 0);
+	return py_vnodelist;
+}
+
+/**
+ * @brief
+ *	Returns a Python dictionary of all the server's reservations,
+ *	indexed by reservation id, whose resv objects are only created and
+ *	populated the first time a hook accesses them.
+ *
+ * @param[in]	perf_label - data passed on to hook_perf_stat* call
+ * @param[in]	perf_action - data passed on to hook_perf_stat* call
+ *
+ * @return 	PyObject *
+ * @retval	<object>	- the reservation list dictionary
+ * @retval	NULL		- if an error occured.
+ */
+static PyObject *
+create_py_lazy_resvlist(char *perf_label, char *perf_action)
+{
+	PyObject	*py_keys;
+	PyObject	*py_resvlist = NULL;
+	resc_resv	*presv;
+
+	hook_perf_stat_start(perf_label, perf_action, 0);
+
+	py_keys = PyList_New(0); /* NEW ref */
+	for (presv = (resc_resv *)GET_NEXT(svr_allresvs);
+		(py_keys != NULL) && (presv != NULL);
+		presv = (resc_resv *)GET_NEXT(presv->ri_allresvs)) {
+		if (_pps_list_append_name(py_keys,
+				presv->ri_qs.ri_resvID) == -1)
+			Py_CLEAR(py_keys);
+	}
+	if (py_keys != NULL) {
+		py_resvlist = create_py_lazy_dict(py_keys,
+			&pps_lazy_resv_loader);
+		Py_DECREF(py_keys);
+	}
+
+	hook_perf_stat_stop(perf_label, perf_action, 0);
+	return py_resvlist;
+}
+
 /**
  *
  * @brief
@@ -5635,7 +5905,10 @@ _pbs_python_event_set(unsigned int hook_event, char *req_user, char *req_host,
 		/* SET VNODE_LIST param */
 		(void)PyDict_SetItemString(py_event_param, PY_EVENT_PARAM_VNODELIST,
 			Py_None);
-		py_vnodelist = create_py_vnodelist(vnlist, perf_label, HOOK_PERF_POPULATE_VNODELIST);
+		if (vnlist == NULL)
+			py_vnodelist = create_py_lazy_vnodelist(perf_label, HOOK_PERF_POPULATE_VNODELIST);
+		else
+			py_vnodelist = create_py_vnodelist(vnlist, perf_label, HOOK_PERF_POPULATE_VNODELIST);
 		if (py_vnodelist == NULL) {
 			LOG_ERROR_ARG2("%s: failed to create a Python vnodelist object for param['%s']",
 				PY_TYPE_EVENT, PY_EVENT_PARAM_VNODELIST);
@@ -5657,7 +5930,10 @@ _pbs_python_event_set(unsigned int hook_event, char *req_user, char *req_host,
 
 		(void)PyDict_SetItemString(py_event_param, PY_EVENT_PARAM_RESVLIST,
 			Py_None);
-		py_resvlist = create_py_resvlist(resvlist, perf_label, HOOK_PERF_POPULATE_RESVLIST);
+		if (resvlist == NULL)
+			py_resvlist = create_py_lazy_resvlist(perf_label, HOOK_PERF_POPULATE_RESVLIST);
+		else
+			py_resvlist = create_py_resvlist(resvlist, perf_label, HOOK_PERF_POPULATE_RESVLIST);
 		if (py_resvlist == NULL) {
 			LOG_ERROR_ARG2("%s: failed to create a Python resvlist object for param['%s']",
 				PY_TYPE_EVENT, PY_EVENT_PARAM_RESVLIST);
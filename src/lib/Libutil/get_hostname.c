@@ -43,6 +43,10 @@
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -51,6 +55,355 @@
 #include <string.h>
 #include "pbs_ifl.h"
 #include "pbs_internal.h"
+#include "pbs_idx.h"
+#include "libutil.h"
+
+/*
+ * Host name resolution cache
+ *
+ * Forward (name to IPv4 addresses) and reverse (address to name) lookups
+ * are remembered for PBS_DNS_CACHE_TTL seconds, failed lookups for
+ * PBS_DNS_CACHE_NEG_TTL seconds.  Temporary resolver failures (EAI_AGAIN)
+ * are never cached.  The resolver itself is called without holding the
+ * cache lock.
+ */
+#define RESOLVE_MAXENTS	8192	/* flush the cache when it grows past */
+
+struct resolve_ent {
+	time_t		re_expire;	/* when the entry goes stale */
+	int		re_err;		/* resolver error, 0 if resolved */
+	int		re_naddrs;	/* forward: number of addresses */
+	unsigned long	re_addrs[PBS_RESOLVE_MAXADDRS]; /* forward: host order */
+	char		re_name[PBS_MAXHOSTNAME + 1]; /* reverse: host name */
+};
+
+static pthread_mutex_t	resolve_mutex = PTHREAD_MUTEX_INITIALIZER;
+static void		*resolve_fwd_idx = NULL;
+static void		*resolve_rev_idx = NULL;
+static int		resolve_nents = 0;
+static unsigned long	resolve_hits = 0;
+static unsigned long	resolve_misses = 0;
+
+/**
+ * @brief
+ *	Free all entries of a resolution cache index and the index.
+ *
+ * @param[in] idx - the index
+ *
+ * @return void
+ */
+static void
+resolve_idx_free(void *idx)
+{
+	void	*ctx = NULL;
+	void	*key = NULL;
+	struct resolve_ent *ent;
+
+	if (idx == NULL)
+		return;
+	while (pbs_idx_find(idx, &key, (void **)&ent, &ctx) == PBS_IDX_RET_OK) {
+		free(ent);
+		key = NULL;
+	}
+	pbs_idx_free_ctx(ctx);
+	pbs_idx_destroy(idx);
+}
+
+/**
+ * @brief
+ *	Find an unexpired entry in a resolution cache index.
+ *	Must be called with resolve_mutex held.
+ *
+ * @param[in] idx - the index
+ * @param[in] key - the name or address key
+ *
+ * @return struct resolve_ent *
+ * @retval entry	cache hit
+ * @retval NULL		not cached or expired; an expired entry is dropped
+ */
+static struct resolve_ent *
+resolve_find(void *idx, char *key)
+{
+	struct resolve_ent *ent = NULL;
+
+	if (idx == NULL)
+		return NULL;
+	if (pbs_idx_find(idx, (void **)&key, (void **)&ent, NULL) != PBS_IDX_RET_OK)
+		return NULL;
+	if (ent->re_expire > time(NULL))
+		return ent;
+	pbs_idx_delete(idx, key);
+	free(ent);
+	resolve_nents--;
+	return NULL;
+}
+
+/**
+ * @brief
+ *	Remember a lookup result in a resolution cache index.  A failed
+ *	lookup is remembered only if its error is given a ttl.
+ *
+ * @param[in,out] pidx - the index, created on first use
+ * @param[in]     key  - the name or address key
+ * @param[in]     res  - the lookup result, copied into the cache
+ *
+ * @return void
+ */
+static void
+resolve_store(void **pidx, char *key, struct resolve_ent *res)
+{
+	unsigned int		ttl;
+	struct resolve_ent	*ent;
+
+	if (res->re_err == 0)
+		ttl = pbs_conf.pbs_dns_cache_ttl;
+	else if (res->re_err != EAI_AGAIN)
+		ttl = pbs_conf.pbs_dns_cache_neg_ttl;
+	else
+		ttl = 0;
+	if (ttl == 0)
+		return;
+
+	if ((ent = malloc(sizeof(struct resolve_ent))) == NULL)
+		return;
+	*ent = *res;
+	ent->re_expire = time(NULL) + ttl;
+
+	pthread_mutex_lock(&resolve_mutex);
+	if (resolve_nents >= RESOLVE_MAXENTS) {
+		resolve_idx_free(resolve_fwd_idx);
+		resolve_idx_free(resolve_rev_idx);
+		resolve_fwd_idx = resolve_rev_idx = NULL;
+		resolve_nents = 0;
+	}
+	if (*pidx == NULL)
+		*pidx = pbs_idx_create(0, 0);
+	if (*pidx != NULL) {
+		struct resolve_ent *old = NULL;
+
+		/* another thread may have stored the same key meanwhile */
+		if (pbs_idx_find(*pidx, (void **)&key, (void **)&old, NULL) == PBS_IDX_RET_OK) {
+			pbs_idx_delete(*pidx, key);
+			free(old);
+			resolve_nents--;
+		}
+		if (pbs_idx_insert(*pidx, key, ent) == PBS_IDX_RET_OK) {
+			resolve_nents++;
+			ent = NULL;
+		}
+	}
+	pthread_mutex_unlock(&resolve_mutex);
+	free(ent);
+}
+
+/**
+ * @brief
+ *	Make the forward cache key for a host name.
+ *
+ * @param[in]  host - the host name
+ * @param[out] key  - buffer of PBS_MAXHOSTNAME + 1 bytes
+ *
+ * @return int
+ * @retval 0	key made
+ * @retval -1	name too long to be cached
+ */
+static int
+resolve_fwd_key(char *host, char *key)
+{
+	int	i;
+
+	for (i = 0; host[i] != '\0'; i++) {
+		if (i >= PBS_MAXHOSTNAME)
+			return -1;
+		key[i] = tolower((int)host[i]);
+	}
+	key[i] = '\0';
+	return 0;
+}
+
+/**
+ * @brief
+ *	Resolve a host name to its IPv4 addresses, through the cache.
+ *
+ * @param[in]  host     - host name or dotted address
+ * @param[out] addrs    - the addresses, in host byte order
+ * @param[in]  maxaddrs - room in addrs
+ * @param[out] naddrs   - number of addresses returned, which may be 0
+ *			  when the host has no IPv4 address
+ *
+ * @return int
+ * @retval 0		resolved
+ * @retval EAI_*	getaddrinfo() error
+ */
+int
+pbs_resolve_addrs(char *host, unsigned long *addrs, int maxaddrs, int *naddrs)
+{
+	char			key[PBS_MAXHOSTNAME + 1];
+	int			cacheable;
+	struct resolve_ent	*ent;
+	struct resolve_ent	res;
+	struct addrinfo		*aip, *pai;
+	struct addrinfo		hints;
+	int			i;
+
+	*naddrs = 0;
+	cacheable = (resolve_fwd_key(host, key) == 0);
+	if (cacheable) {
+		pthread_mutex_lock(&resolve_mutex);
+		if ((ent = resolve_find(resolve_fwd_idx, key)) != NULL) {
+			resolve_hits++;
+			for (i = 0; i < ent->re_naddrs && i < maxaddrs; i++)
+				addrs[i] = ent->re_addrs[i];
+			*naddrs = i;
+			i = ent->re_err;
+			pthread_mutex_unlock(&resolve_mutex);
+			return i;
+		}
+		resolve_misses++;
+		pthread_mutex_unlock(&resolve_mutex);
+	}
+
+	memset(&res, 0, sizeof(res));
+	memset(&hints, 0, sizeof(struct addrinfo));
+	/*
+	 *	Why do we use AF_UNSPEC rather than AF_INET?  Some
+	 *	implementations of getaddrinfo() will take an IPv6
+	 *	address and map it to an IPv4 one if we ask for AF_INET
+	 *	only.  We don't want that - we want only the addresses
+	 *	that are genuinely, natively, IPv4 so we start with
+	 *	AF_UNSPEC and filter ai_family below.
+	 */
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+	if ((res.re_err = getaddrinfo(host, NULL, &hints, &pai)) == 0) {
+		for (aip = pai; aip != NULL; aip = aip->ai_next) {
+			if (aip->ai_family != AF_INET)
+				continue;  /* skip non-IPv4 addresses */
+			if (res.re_naddrs == PBS_RESOLVE_MAXADDRS)
+				break;
+			res.re_addrs[res.re_naddrs++] =
+				ntohl(((struct sockaddr_in *)aip->ai_addr)->sin_addr.s_addr);
+		}
+		freeaddrinfo(pai);
+	}
+	if (cacheable)
+		resolve_store(&resolve_fwd_idx, key, &res);
+
+	for (i = 0; i < res.re_naddrs && i < maxaddrs; i++)
+		addrs[i] = res.re_addrs[i];
+	*naddrs = i;
+	return res.re_err;
+}
+
+/**
+ * @brief
+ *	Resolve an IPv4 address to a host name, through the cache.
+ *
+ * @param[in]  addr - address in host byte order
+ * @param[out] name - the host name
+ * @param[in]  len  - size of name
+ *
+ * @return int
+ * @retval 0		resolved
+ * @retval EAI_*	getnameinfo() error
+ */
+int
+pbs_resolve_name(unsigned long addr, char *name, size_t len)
+{
+	char			key[32];
+	struct resolve_ent	*ent;
+	struct resolve_ent	res;
+	struct sockaddr_in	sin;
+
+	snprintf(key, sizeof(key), "%lu", addr);
+	pthread_mutex_lock(&resolve_mutex);
+	if ((ent = resolve_find(resolve_rev_idx, key)) != NULL) {
+		int	err = ent->re_err;
+
+		resolve_hits++;
+		if (err == 0)
+			snprintf(name, len, "%s", ent->re_name);
+		pthread_mutex_unlock(&resolve_mutex);
+		return err;
+	}
+	resolve_misses++;
+	pthread_mutex_unlock(&resolve_mutex);
+
+	memset(&res, 0, sizeof(res));
+	memset(&sin, 0, sizeof(sin));
+	sin.sin_family = AF_INET;
+	sin.sin_addr.s_addr = htonl(addr);
+	res.re_err = getnameinfo((struct sockaddr *)&sin, sizeof(sin),
+		res.re_name, sizeof(res.re_name), NULL, 0, 0);
+	resolve_store(&resolve_rev_idx, key, &res);
+	if (res.re_err == 0)
+		snprintf(name, len, "%s", res.re_name);
+	return res.re_err;
+}
+
+/**
+ * @brief
+ *	Drop cached resolutions.
+ *
+ * @param[in] host - drop the entries of this host name and of its cached
+ *		     addresses; NULL drops everything
+ *
+ * @return void
+ */
+void
+pbs_resolve_cache_invalidate(char *host)
+{
+	char			key[PBS_MAXHOSTNAME + 1];
+	char			akey[32];
+	struct resolve_ent	*ent = NULL;
+	struct resolve_ent	*aent;
+	void			*pkey;
+	int			i;
+
+	pthread_mutex_lock(&resolve_mutex);
+	if (host == NULL) {
+		resolve_idx_free(resolve_fwd_idx);
+		resolve_idx_free(resolve_rev_idx);
+		resolve_fwd_idx = resolve_rev_idx = NULL;
+		resolve_nents = 0;
+	} else if ((resolve_fwd_key(host, key) == 0) && (resolve_fwd_idx != NULL)) {
+		pkey = key;
+		if (pbs_idx_find(resolve_fwd_idx, &pkey, (void **)&ent, NULL) == PBS_IDX_RET_OK) {
+			for (i = 0; i < ent->re_naddrs && resolve_rev_idx != NULL; i++) {
+				snprintf(akey, sizeof(akey), "%lu", ent->re_addrs[i]);
+				pkey = akey;
+				if (pbs_idx_find(resolve_rev_idx, &pkey, (void **)&aent, NULL) == PBS_IDX_RET_OK) {
+					pbs_idx_delete(resolve_rev_idx, akey);
+					free(aent);
+					resolve_nents--;
+				}
+			}
+			pbs_idx_delete(resolve_fwd_idx, key);
+			free(ent);
+			resolve_nents--;
+		}
+	}
+	pthread_mutex_unlock(&resolve_mutex);
+}
+
+/**
+ * @brief
+ *	Get the hit and miss counts of the host name resolution cache.
+ *
+ * @param[out] hits   - lookups answered from the cache
+ * @param[out] misses - lookups that went to the resolver
+ *
+ * @return void
+ */
+void
+pbs_resolve_cache_stats(unsigned long *hits, unsigned long *misses)
+{
+	pthread_mutex_lock(&resolve_mutex);
+	*hits = resolve_hits;
+	*misses = resolve_misses;
+	pthread_mutex_unlock(&resolve_mutex);
+}
 
 
 /**
@@ -75,9 +428,8 @@ get_fullhostname(char *shortname, char *namebuf, int bufsize)
 	char           *pcolon = 0;
 	char            extname[PBS_MAXHOSTNAME+1] = {'\0'};
 	char            localname[PBS_MAXHOSTNAME+1] = {'\0'};
-	struct addrinfo *aip, *pai;
-	struct addrinfo hints;
-	struct sockaddr_in *inp;
+	unsigned long	addrs[PBS_RESOLVE_MAXADDRS];
+	int		naddrs;
 
 	if ((pcolon = strchr(shortname, (int)':')) != NULL) {
 		*pcolon = '\0';
@@ -85,20 +437,7 @@ get_fullhostname(char *shortname, char *namebuf, int bufsize)
 			*(pbkslh = pcolon-1) = '\0';
 	}
 
-	memset(&hints, 0, sizeof(struct addrinfo));
-	/*
-	 *	Why do we use AF_UNSPEC rather than AF_INET?  Some
-	 *	implementations of getaddrinfo() will take an IPv6
-	 *	address and map it to an IPv4 one if we ask for AF_INET
-	 *	only.  We don't want that - we want only the addresses
-	 *	that are genuinely, natively, IPv4 so we start with
-	 *	AF_UNSPEC and filter ai_family below.
-	 */
-	hints.ai_family = AF_UNSPEC;
-	hints.ai_socktype = SOCK_STREAM;
-	hints.ai_protocol = IPPROTO_TCP;
-
-	if (getaddrinfo(shortname, NULL, &hints, &pai) != 0)
+	if (pbs_resolve_addrs(shortname, addrs, PBS_RESOLVE_MAXADDRS, &naddrs) != 0)
 		return (-1);
 
 	if (pcolon) {
@@ -110,23 +449,18 @@ get_fullhostname(char *shortname, char *namebuf, int bufsize)
 	/*
 	 *	This loop tries to find a non-loopback IPv4 address suitable
 	 *	for use by, in particular, pbs_server (which doesn't want to
-	 *	name its jobs <N>.localhost), so we ignore non-IPv4 addresses,
-	 *	those that aren't invertible, and those on a loopback net.
+	 *	name its jobs <N>.localhost), so we ignore those that aren't
+	 *	invertible, and those on a loopback net.
 	 */
-	for (aip = pai; aip != NULL; aip = aip->ai_next) {
-		if (aip->ai_family != AF_INET)
-			continue;  /* skip non-IPv4 addresses */
-		if (getnameinfo(aip->ai_addr, aip->ai_addrlen, namebuf,
-			bufsize, NULL, 0, 0) != 0)
+	for (i = 0; i < naddrs; i++) {
+		if (pbs_resolve_name(addrs[i], namebuf, bufsize) != 0)
 			continue; /* skip non-invertible addresses */
-		inp = (struct sockaddr_in *) aip->ai_addr;
-		if (ntohl(inp->sin_addr.s_addr) >> 24 != IN_LOOPBACKNET) {
+		if (addrs[i] >> 24 != IN_LOOPBACKNET) {
 			strncpy(extname, namebuf, (sizeof(extname) - 1));
 			break;          /* skip loopback addresses */
 		} else
 			strncpy(localname, namebuf, (sizeof(localname) - 1));
 	}
-	freeaddrinfo(pai);
 	if (extname[0] == '\0')
 		strncpy(namebuf, localname, bufsize);
 	else
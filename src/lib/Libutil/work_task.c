@@ -63,6 +63,135 @@ extern pbs_list_head task_list_event; /* list of tasks responding to an event */
 extern int svr_delay_entry;
 extern time_t	time_now;
 
+/*
+ * The timed tasks are also kept in a binary min-heap ordered by
+ * (wt_event, insertion sequence) so that adding a task and finding the next
+ * one to run are O(log n) no matter how many are pending.  task_list_timed
+ * still holds every timed task (in no particular order) for the searches
+ * below.  Each task remembers its slot in wt_timed_idx so it can be taken
+ * off the heap when it is deleted.
+ */
+struct timed_entry {
+	long			 te_event;	/* copy of wt_event */
+	unsigned long		 te_seq;	/* keeps equal times in FIFO order */
+	struct work_task	*te_task;
+};
+
+static struct timed_entry *timed_heap = NULL;
+static int timed_heap_size = 0;
+static int timed_heap_max = 0;
+static unsigned long timed_seq = 0;
+
+#define TIMED_HEAP_INIT	1024
+#define TIMED_BEFORE(a, b) \
+	((a)->te_event < (b)->te_event || \
+	((a)->te_event == (b)->te_event && (a)->te_seq < (b)->te_seq))
+
+/**
+ * @brief
+ * 	Place a heap entry at a slot and record the slot in its task
+ *
+ * @param[in]	idx	- slot in timed_heap
+ * @param[in]	ent	- entry to place
+ */
+static void
+timed_heap_set(int idx, struct timed_entry *ent)
+{
+	timed_heap[idx] = *ent;
+	timed_heap[idx].te_task->wt_timed_idx = idx;
+}
+
+/**
+ * @brief
+ * 	Restore the heap order for the entry at 'idx' by moving it up or
+ *	down as needed
+ *
+ * @param[in]	idx	- slot whose entry may be out of order
+ */
+static void
+timed_heap_fix(int idx)
+{
+	struct timed_entry ent = timed_heap[idx];
+	int parent;
+	int child;
+
+	while (idx > 0) {
+		parent = (idx - 1) / 2;
+		if (!TIMED_BEFORE(&ent, &timed_heap[parent]))
+			break;
+		timed_heap_set(idx, &timed_heap[parent]);
+		idx = parent;
+	}
+
+	while ((child = 2 * idx + 1) < timed_heap_size) {
+		if (child + 1 < timed_heap_size &&
+			TIMED_BEFORE(&timed_heap[child + 1], &timed_heap[child]))
+			child++;
+		if (!TIMED_BEFORE(&timed_heap[child], &ent))
+			break;
+		timed_heap_set(idx, &timed_heap[child]);
+		idx = child;
+	}
+
+	timed_heap_set(idx, &ent);
+}
+
+/**
+ * @brief
+ * 	Add a task to the timed task heap
+ *
+ * @param[in]	ptask	- task, wt_event is the time it is due
+ *
+ * @return int
+ * @retval 0: success
+ * @retval -1: out of memory
+ */
+static int
+timed_heap_add(struct work_task *ptask)
+{
+	struct timed_entry ent;
+
+	if (timed_heap_size == timed_heap_max) {
+		int newmax = timed_heap_max ? timed_heap_max * 2 : TIMED_HEAP_INIT;
+		struct timed_entry *tmp;
+
+		tmp = realloc(timed_heap, newmax * sizeof(struct timed_entry));
+		if (tmp == NULL)
+			return -1;
+		timed_heap = tmp;
+		timed_heap_max = newmax;
+	}
+
+	ent.te_event = ptask->wt_event;
+	ent.te_seq = timed_seq++;
+	ent.te_task = ptask;
+	timed_heap_set(timed_heap_size++, &ent);
+	timed_heap_fix(timed_heap_size - 1);
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 	Take a task off the timed task heap if it is on it
+ *
+ * @param[in]	ptask	- task to remove
+ */
+static void
+timed_heap_remove(struct work_task *ptask)
+{
+	int idx = ptask->wt_timed_idx;
+
+	if (idx < 0 || idx >= timed_heap_size || timed_heap[idx].te_task != ptask)
+		return;
+
+	ptask->wt_timed_idx = -1;
+	if (idx != --timed_heap_size) {
+		timed_heap_set(idx, &timed_heap[timed_heap_size]);
+		timed_heap_fix(idx);
+	}
+}
+
 /**
  *
  * @brief
@@ -84,7 +213,6 @@ extern time_t	time_now;
 struct work_task *set_task(enum work_type type, long event_id, void (*func)(struct work_task *) , void *parm)
 {
 	struct work_task *pnew;
-	struct work_task *pold;
 
 	pnew = (struct work_task *)malloc(sizeof(struct work_task));
 	if (pnew == NULL)
@@ -101,21 +229,16 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 	pnew->wt_parm3 = NULL;
 	pnew->wt_aux   = 0;
 	pnew->wt_aux2  = 0;
+	pnew->wt_timed_idx = -1;
 
 	if (type == WORK_Immed)
 		append_link(&task_list_immed, &pnew->wt_linkevent, pnew);
 	else if (type == WORK_Timed) {
-		pold = (struct work_task *)GET_NEXT(task_list_timed);
-		while (pold) {
-			if (pold->wt_event > pnew->wt_event)
-				break;
-			pold = (struct work_task *)GET_NEXT(pold->wt_linkevent);
+		if (timed_heap_add(pnew) == -1) {
+			free(pnew);
+			return NULL;
 		}
-		if (pold)
-			insert_link(&pold->wt_linkevent, &pnew->wt_linkevent, pnew,
-				LINK_INSET_BEFORE);
-		else
-			append_link(&task_list_timed, &pnew->wt_linkevent, pnew);
+		append_link(&task_list_timed, &pnew->wt_linkevent, pnew);
 	} else
 		append_link(&task_list_event, &pnew->wt_linkevent, pnew);
 	return (pnew);
@@ -152,6 +275,12 @@ convert_work_task(struct work_task *ptask, enum work_type wtype)
 		list = &task_list_event;
 	}
 
+	if (wtype == WORK_Timed) {
+		if (ptask->wt_timed_idx < 0 && timed_heap_add(ptask) == -1)
+			return -1;
+	} else
+		timed_heap_remove(ptask);
+
 	delete_link(&ptask->wt_linkevent);
 	append_link(list, &ptask->wt_linkevent, ptask);
 
@@ -174,6 +303,7 @@ convert_work_task(struct work_task *ptask, enum work_type wtype)
 void
 dispatch_task(struct work_task *ptask)
 {
+	timed_heap_remove(ptask);
 	delete_link(&ptask->wt_linkevent);
 	delete_link(&ptask->wt_linkobj);
 	delete_link(&ptask->wt_linkobj2);
@@ -193,6 +323,7 @@ dispatch_task(struct work_task *ptask)
 void
 delete_task(struct work_task *ptask)
 {
+	timed_heap_remove(ptask);
 	delete_link(&ptask->wt_linkobj);
 	delete_link(&ptask->wt_linkobj2);
 	delete_link(&ptask->wt_linkevent);
@@ -385,7 +516,8 @@ default_next_task(void)
 	while ((ptask=(struct work_task *)GET_NEXT(task_list_immed)) != NULL)
 		dispatch_task(ptask);
 
-	while ((ptask=(struct work_task *)GET_NEXT(task_list_timed))!=NULL) {
+	while (timed_heap_size > 0) {
+		ptask = timed_heap[0].te_task;
 		if ((delay = ptask->wt_event - time_now) > 0) {
 			if (tilwhen > delay)
 				tilwhen = delay;
@@ -60,6 +60,7 @@ Motivation:
 
 from . import _base_types as pbs_types
 from ._svr_types import (_queue, _job, _server, _resv, _vnode, _event, pbs_iter,
+                         lazy_dict,
                          _management, _server_attribute)
 from ._exc_types import *
 
@@ -153,6 +154,7 @@ EXPORTED_TYPES_DICT = {
                        'vnode'              : _vnode,
                        'event'              : _event,
 		       'pbs_iter'	    : pbs_iter,
+		       'lazy_dict'	    : lazy_dict,
 		       'state'   	    : pbs_types.vnode_state,
 		       'sharing'   	    : pbs_types.vnode_sharing,
 		       'ntype'   	    : pbs_types.vnode_ntype,
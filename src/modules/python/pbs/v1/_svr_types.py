@@ -1418,6 +1418,117 @@ class pbs_iter():
                                              self.filter1, self.filter2)
 #: C(pbs_iter)
 
+#:------------------------------------------------------------------------
+#                  PBS Lazy Dictionary Type
+#:-------------------------------------------------------------------------
+
+
+class lazy_dict(dict):
+    """
+    A dictionary whose keys are all known up front, but whose values are
+    only created, by calling loader(key), the first time a key is looked
+    up. Used for event parameters such as pbs.event().vnode_list of a
+    periodic hook, where building every value eagerly is expensive and a
+    hook typically looks at only a few of them.
+
+    Only loaded values are stored in the underlying dict, so a C caller
+    walking it with the PyDict_* API sees exactly the objects a hook
+    could have modified.
+    """
+
+    def __init__(self, keys, loader):
+        super().__init__()
+        self._pending = dict.fromkeys(keys)
+        self._loader = loader
+
+    def _load(self, key):
+        del self._pending[key]
+        value = self._loader(key)
+        dict.__setitem__(self, key, value)
+        return value
+
+    def _load_all(self):
+        for key in list(self._pending):
+            self._load(key)
+
+    def __missing__(self, key):
+        if key in self._pending:
+            return self._load(key)
+        raise KeyError(key)
+
+    def __contains__(self, key):
+        return dict.__contains__(self, key) or key in self._pending
+
+    def __len__(self):
+        return dict.__len__(self) + len(self._pending)
+
+    def __iter__(self):
+        return iter(list(dict.keys(self)) + list(self._pending))
+
+    def __setitem__(self, key, value):
+        self._pending.pop(key, None)
+        dict.__setitem__(self, key, value)
+
+    def __delitem__(self, key):
+        if key in self._pending:
+            del self._pending[key]
+        else:
+            dict.__delitem__(self, key)
+
+    def __eq__(self, other):
+        self._load_all()
+        return dict.__eq__(self, other)
+
+    def __ne__(self, other):
+        return not self.__eq__(other)
+
+    def __repr__(self):
+        self._load_all()
+        return dict.__repr__(self)
+
+    def get(self, key, default=None):
+        if key in self:
+            return self[key]
+        return default
+
+    def keys(self):
+        return list(self)
+
+    def values(self):
+        self._load_all()
+        return dict.values(self)
+
+    def items(self):
+        self._load_all()
+        return dict.items(self)
+
+    def pop(self, key, *default):
+        if key in self._pending:
+            self._load(key)
+        return dict.pop(self, key, *default)
+
+    def popitem(self):
+        self._load_all()
+        return dict.popitem(self)
+
+    def setdefault(self, key, default=None):
+        if key not in self:
+            self[key] = default
+        return self[key]
+
+    def update(self, *args, **kwds):
+        for key, value in dict(*args, **kwds).items():
+            self[key] = value
+
+    def clear(self):
+        self._pending.clear()
+        dict.clear(self)
+
+    def copy(self):
+        self._load_all()
+        return dict.copy(self)
+#: C(lazy_dict)
+
 #:------------------------------------------------------------------------
 #                  SERVER ATTRIBUTE TYPE
 #:-------------------------------------------------------------------------
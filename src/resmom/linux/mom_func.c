@@ -272,6 +272,7 @@ process_hup(void)
 		tpp_shutdown();
 		exit(1);
 	}
+	hook_worker_config();
 
 	cleanup();
 	initialize();
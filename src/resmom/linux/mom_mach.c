@@ -141,6 +141,27 @@ proc_stat_t	*proc_info = NULL;
 int		nproc = 0;
 int		max_proc = 0;
 
+/*
+ * proc_info[] indices ordered by session id, rebuilt by mom_get_sample()
+ * so the per-job sums only visit the processes of the job's sessions.
+ * If the index could not be built, the sums scan all of proc_info[].
+ */
+static int	*sess_idx = NULL;
+static int	nsess_idx = 0;
+static int	max_sess_idx = 0;
+static int	sess_idx_valid = 0;
+
+/* proc_info[] index of the k-th process returned by session_procs() */
+#define SESS_PROC(k)	(sess_idx_valid ? sess_idx[(k)] : (k))
+
+/*
+ * Mount points of the cgroup hierarchies used when $cgroup_usage is set,
+ * found once by mom_open_poll().
+ */
+#define	CGROUP_DEFAULT_PREFIX	"pbs_jobs"
+static char	*cg_cpuacct = NULL;	/* cgroup v1 cpuacct controller */
+static char	*cg_memory = NULL;	/* cgroup v1 memory controller */
+
 extern	char	*ret_string;
 extern	char	extra_parm[];
 extern	char	no_parm[];
@@ -148,6 +169,8 @@ extern	int	exiting_tasks;
 extern	vnl_t	*vnlp;
 
 extern	time_t	time_now;
+extern	int	cgroup_usage;
+extern	char	*cgroup_usage_prefix;
 
 /*
  ** external functions and data
@@ -487,27 +510,124 @@ dep_cleanup(void)
 
 /**
  * @brief
- *	 Scan a list of tasks and return true if one of them matches sid
+ *	qsort comparator for sess_idx[], orders by session id and keeps the
+ *	proc_info[] order within a session.
+ *
+ * @param[in] a - pointer to first index
+ * @param[in] b - pointer to second index
+ *
+ * @return	int
+ * @retval	<0, 0, >0 as for qsort()
+ *
+ */
+static int
+sess_idx_cmp(const void *a, const void *b)
+{
+	int	i = *(const int *)a;
+	int	j = *(const int *)b;
+
+	if (proc_info[i].session != proc_info[j].session)
+		return (proc_info[i].session < proc_info[j].session ? -1 : 1);
+	return (i - j);
+}
+
+/**
+ * @brief
+ *	Rebuild sess_idx[] from the current contents of proc_info[].
+ *
+ * @return	int
+ * @retval	0	Success
+ * @retval	-1	Error, the index is left invalid
+ *
+ */
+static int
+build_session_index(void)
+{
+	int	i;
+
+	sess_idx_valid = 0;
+	if (nproc > max_sess_idx) {
+		int	*hold;
+
+		hold = (int *)realloc(sess_idx, max_proc * sizeof(int));
+		if (hold == NULL) {
+			log_err(errno, __func__, "realloc");
+			return -1;
+		}
+		sess_idx = hold;
+		max_sess_idx = max_proc;
+	}
+	for (i = 0; i < nproc; i++)
+		sess_idx[i] = i;
+	if (nproc > 1)
+		qsort(sess_idx, nproc, sizeof(int), sess_idx_cmp);
+	nsess_idx = nproc;
+	sess_idx_valid = 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Find the processes of a session in the last sample.
+ *
+ * @param[in]  sid   - session id
+ * @param[out] first - position of the first process
+ *
+ * @return	int
+ * @retval	number of processes to look at, they are found in
+ *		proc_info[SESS_PROC(*first)] .. proc_info[SESS_PROC(*first + count - 1)]
+ *
+ * @par	If the session index is not valid, all of proc_info[] is returned
+ *	and the caller must skip the processes of other sessions.
+ *
+ */
+static int
+session_procs(pid_t sid, int *first)
+{
+	int	lo = 0;
+	int	hi = nsess_idx;
+	int	mid;
+
+	*first = 0;
+	if (!sess_idx_valid)
+		return nproc;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (proc_info[sess_idx[mid]].session < sid)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*first = lo;
+	for (hi = lo; hi < nsess_idx; hi++) {
+		if (proc_info[sess_idx[hi]].session != sid)
+			break;
+	}
+	return (hi - lo);
+}
+
+/**
+ * @brief
+ *	Check whether an earlier task of the job has the same session as
+ *	ptask, so the processes of a session are only counted once.
  *
  * @param[in] pjob - job pointer
- * @param[in] sid - session id
+ * @param[in] ptask - task to check
  *
  * @return	Bool
- * @retval	TRUE
- * @retval	FALSE	Error
+ * @retval	TRUE	session already seen
+ * @retval	FALSE	first task with this session
  *
  */
 static int
-injob(job *pjob, pid_t sid)
+session_seen(job *pjob, task *ptask)
 {
-	task	*ptask;
+	task	*prev;
 
-	for (ptask = (task *)GET_NEXT(pjob->ji_tasks);
-		ptask;
-		ptask = (task *)GET_NEXT(ptask->ti_jobtask)) {
-		if (ptask->ti_qs.ti_sid <= 1)
-			continue;
-		if (ptask->ti_qs.ti_sid == sid)
+	for (prev = (task *)GET_NEXT(pjob->ji_tasks);
+		prev && prev != ptask;
+		prev = (task *)GET_NEXT(prev->ti_jobtask)) {
+		if (prev->ti_qs.ti_sid == ptask->ti_qs.ti_sid)
 			return TRUE;
 	}
 	return FALSE;
@@ -528,10 +648,12 @@ static ulong
 cput_sum(job *pjob)
 {
 	int		i;
+	int		first;
 	ulong		cputime = 0;
 	int		nps = 0;
 	int		active_tasks = 0;
 	int		taskprocs;
+	int		sessprocs;
 	proc_stat_t	*ps;
 	task		*ptask;
 	ulong		pcput,tcput;
@@ -549,8 +671,9 @@ cput_sum(job *pjob)
 		active_tasks++;
 		tcput = 0;
 		taskprocs = 0;
-		for (i=0; i<nproc; i++) {
-			ps = &proc_info[i];
+		sessprocs = session_procs(ptask->ti_qs.ti_sid, &first);
+		for (i = first; i < first + sessprocs; i++) {
+			ps = &proc_info[SESS_PROC(i)];
 
 			/* is this process part of the task? */
 			if (ptask->ti_qs.ti_sid != ps->session)
@@ -693,20 +816,32 @@ static ulong
 mem_sum(job *pjob)
 {
 	int		i;
+	int		first;
+	int		sessprocs;
 	ulong		segadd;
 	proc_stat_t	*ps;
+	task		*ptask;
 
 	segadd = 0;
 
-	for (i=0; i<nproc; i++) {
-
-		ps = &proc_info[i];
+	for (ptask = (task *)GET_NEXT(pjob->ji_tasks);
+		ptask != NULL;
+		ptask = (task *)GET_NEXT(ptask->ti_jobtask)) {
 
-		if (!injob(pjob, ps->session))
+		if (ptask->ti_qs.ti_sid <= 1 || session_seen(pjob, ptask))
 			continue;
-		segadd += ps->vsize;
-		DBPRT(("%s: pid: %d  pr_size: %lu  total: %lu\n",
-			__func__, ps->pid, (ulong)ps->vsize, segadd))
+
+		sessprocs = session_procs(ptask->ti_qs.ti_sid, &first);
+		for (i = first; i < first + sessprocs; i++) {
+
+			ps = &proc_info[SESS_PROC(i)];
+			if (ptask->ti_qs.ti_sid != ps->session)
+				continue;
+
+			segadd += ps->vsize;
+			DBPRT(("%s: pid: %d  pr_size: %lu  total: %lu\n",
+				__func__, ps->pid, (ulong)ps->vsize, segadd))
+		}
 	}
 
 	return (segadd);
@@ -727,18 +862,29 @@ static ulong
 resi_sum(job *pjob)
 {
 	int		i;
+	int		first;
+	int		sessprocs;
 	ulong		resisize;
 	proc_stat_t	*ps;
+	task		*ptask;
 
 	resisize = 0;
-	for (i=0; i<nproc; i++) {
-
-		ps = &proc_info[i];
+	for (ptask = (task *)GET_NEXT(pjob->ji_tasks);
+		ptask != NULL;
+		ptask = (task *)GET_NEXT(ptask->ti_jobtask)) {
 
-		if (!injob(pjob, ps->session))
+		if (ptask->ti_qs.ti_sid <= 1 || session_seen(pjob, ptask))
 			continue;
 
-		resisize += ps->rss * pagesize;
+		sessprocs = session_procs(ptask->ti_qs.ti_sid, &first);
+		for (i = first; i < first + sessprocs; i++) {
+
+			ps = &proc_info[SESS_PROC(i)];
+			if (ptask->ti_qs.ti_sid != ps->session)
+				continue;
+
+			resisize += ps->rss * pagesize;
+		}
 	}
 
 	return (resisize);
@@ -920,6 +1066,144 @@ mom_do_poll(job *pjob)
 	return (FALSE);
 }
 
+/**
+ * @brief
+ *	Record the mount points of the cgroup v1 cpuacct and memory
+ *	controllers from /proc/mounts.  The cgroups hook does not manage
+ *	cgroup v2, which is not used.
+ *
+ * @return	void
+ *
+ */
+static void
+cgroup_find_mounts(void)
+{
+	FILE	*fp;
+	char	line[MAXPATHLEN * 2];
+	char	*dir;
+	char	*type;
+	char	*opts;
+	char	*tok;
+	char	*save;
+
+	if ((fp = fopen("/proc/mounts", "r")) == NULL)
+		return;
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		/* <device> <mount point> <type> <options> ... */
+		if ((strtok_r(line, " \t", &save) == NULL) ||
+			((dir = strtok_r(NULL, " \t", &save)) == NULL) ||
+			((type = strtok_r(NULL, " \t", &save)) == NULL) ||
+			((opts = strtok_r(NULL, " \t", &save)) == NULL))
+			continue;
+		if (strcmp(type, "cgroup") != 0)
+			continue;
+		for (tok = strtok_r(opts, ",", &save); tok != NULL;
+			tok = strtok_r(NULL, ",", &save)) {
+			if ((strcmp(tok, "cpuacct") == 0) && (cg_cpuacct == NULL))
+				cg_cpuacct = strdup(dir);
+			else if ((strcmp(tok, "memory") == 0) && (cg_memory == NULL))
+				cg_memory = strdup(dir);
+		}
+	}
+	fclose(fp);
+}
+
+/**
+ * @brief
+ *	Read a value from a file in the cgroup of a job.
+ *
+ * @param[in]  mnt  - mount point of the cgroup hierarchy
+ * @param[in]  pjob - job pointer
+ * @param[in]  file - name of the cgroup file
+ * @param[out] val  - the value read
+ *
+ * @return	int
+ * @retval	0	Success
+ * @retval	-1	no such cgroup or file
+ *
+ */
+static int
+cgroup_read_value(char *mnt, job *pjob, char *file, unsigned long long *val)
+{
+	char	path[MAXPATHLEN + 1];
+	char	buf[64];
+	char	*end;
+	ssize_t	len;
+	int	fd;
+
+	if (mnt == NULL)
+		return -1;
+	snprintf(path, sizeof(path), "%s/%s.service/jobid/%s/%s", mnt,
+		cgroup_usage_prefix ? cgroup_usage_prefix : CGROUP_DEFAULT_PREFIX,
+		pjob->ji_qs.ji_jobid, file);
+	if ((fd = open(path, O_RDONLY)) == -1)
+		return -1;
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len <= 0)
+		return -1;
+	buf[len] = '\0';
+
+	*val = strtoull(buf, &end, 10);
+	if (end == buf)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Get the cpu time used by a job from its cgroup.
+ *
+ * @param[in]  pjob - job pointer
+ * @param[out] cput - cpu time in seconds, adjusted by cputfactor
+ *
+ * @return	int
+ * @retval	0	Success
+ * @retval	-1	the job has no cgroup to read from
+ *
+ */
+static int
+cgroup_cput(job *pjob, ulong *cput)
+{
+	unsigned long long	val;
+
+	if (cgroup_read_value(cg_cpuacct, pjob, "cpuacct.usage", &val) == -1)
+		return -1;
+	val /= 1000000000ULL;		/* nanoseconds */
+	*cput = (ulong)((double)val * cputfactor);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Get the peak memory used by a job from its cgroup.
+ *
+ * @param[in]  pjob - job pointer
+ * @param[out] mem  - peak memory in bytes
+ * @param[out] vmem - peak memory plus swap in bytes, 0 when the kernel
+ *		      does not account swap
+ *
+ * @return	int
+ * @retval	0	Success
+ * @retval	-1	the job has no cgroup to read from
+ *
+ */
+static int
+cgroup_mem(job *pjob, ulong *mem, ulong *vmem)
+{
+	unsigned long long	val;
+
+	*vmem = 0;
+	if (cgroup_read_value(cg_memory, pjob,
+		"memory.max_usage_in_bytes", &val) == -1)
+		return -1;
+	*mem = (ulong)val;
+	if (cgroup_read_value(cg_memory, pjob,
+		"memory.memsw.max_usage_in_bytes", &val) == 0)
+		*vmem = (ulong)val;
+	return 0;
+}
+
 /**
  * @brief
  * 	Setup for polling.
@@ -941,6 +1225,7 @@ mom_open_poll(void)
 		return (PBSE_SYSTEM);
 	}
 	max_proc = TBL_INC;
+	cgroup_find_mounts();
 
 	return (PBSE_NONE);
 }
@@ -983,6 +1268,8 @@ mom_get_sample(void)
 
 	rewinddir(pdir);
 	nproc = 0;
+	nsess_idx = 0;
+	sess_idx_valid = 0;
 	fd = NULL;
 	if (hz == 0)
 		hz = sysconf(_SC_CLK_TCK);
@@ -1090,6 +1377,9 @@ mom_get_sample(void)
 	}
 	if (errno != 0 && errno != ENOENT)
 		log_err(errno, __func__, "readdir");
+	if (build_session_index() != 0)
+		log_event(PBSEVENT_DEBUG, 0, LOG_DEBUG, __func__,
+			"no session index, scanning all processes");
 	sampletime_ceil = time_last_sample;
 	sprintf(log_buffer,
 		"nprocs:  %d, cantstat:  %d, nomem:  %d, skipped:  %d, "
@@ -1128,6 +1418,8 @@ mom_set_use(job *pjob)
 	u_Long 		*lp_sz, lnum_sz;
 	ulong		*lp, lnum, oldcput;
 	long		ncpus_req;
+	int		cg_mem_ok = 0;
+	ulong		cg_cput, cg_mem, cg_vmem;
 
 	assert(pjob != NULL);
 	at = &pjob->ji_wattr[(int)JOB_ATR_resc_used];
@@ -1174,6 +1466,12 @@ mom_set_use(job *pjob)
 	lp = (ulong *)&pres->rs_value.at_val.at_long;
 	oldcput = *lp;
 	lnum = cput_sum(pjob);
+	if (cgroup_usage) {
+		/* cput_sum() still runs, it notices the tasks that exited */
+		if (cgroup_cput(pjob, &cg_cput) == 0)
+			lnum = cg_cput;
+		cg_mem_ok = (cgroup_mem(pjob, &cg_mem, &cg_vmem) == 0);
+	}
 	lnum = MAX(*lp, lnum);
 	if ((pres->rs_value.at_flags & ATR_VFLAG_HOOK) == 0) {
 		/* don't conflict with hook setting a value */
@@ -1205,7 +1503,10 @@ mom_set_use(job *pjob)
 		pres->rs_value.at_val.at_size.atsv_units = ATR_SV_BYTESZ;
 	} else if ((pres->rs_value.at_flags & ATR_VFLAG_HOOK) == 0) {
 		lp_sz = &pres->rs_value.at_val.at_size.atsv_num;
-		lnum_sz = (mem_sum(pjob) + 1023) >> 10;		/* as KB */
+		if (cg_mem_ok && cg_vmem != 0)
+			lnum_sz = (cg_vmem + 1023) >> 10;	/* as KB */
+		else
+			lnum_sz = (mem_sum(pjob) + 1023) >> 10;	/* as KB */
 		*lp_sz = MAX(*lp_sz, lnum_sz);
 	}
 
@@ -1222,7 +1523,10 @@ mom_set_use(job *pjob)
 		pres->rs_value.at_val.at_size.atsv_units = ATR_SV_BYTESZ;
 	} else if ((pres->rs_value.at_flags & ATR_VFLAG_HOOK) == 0) {
 		lp_sz = &pres->rs_value.at_val.at_size.atsv_num;
-		lnum_sz = (resi_sum(pjob) + 1023) >> 10; /* as KB */
+		if (cg_mem_ok)
+			lnum_sz = (cg_mem + 1023) >> 10; /* as KB */
+		else
+			lnum_sz = (resi_sum(pjob) + 1023) >> 10; /* as KB */
 		*lp_sz = MAX(*lp_sz, lnum_sz);
 	}
 
@@ -1250,6 +1554,7 @@ bld_ptree(pid_t sid)
 {
 	int	myproc_ct;		/* count of processes in a session */
 	int	i, j;
+	int	k, first, sessprocs;
 
 	if (Proc_lnks == NULL) {
 		Proc_lnks = (pbs_plinks *)malloc(TBL_INC * sizeof(pbs_plinks));
@@ -1263,25 +1568,27 @@ bld_ptree(pid_t sid)
 	 */
 
 	myproc_ct = 0;
-	for (i = 0; i < nproc; i++) {
+	sessprocs = session_procs(sid, &first);
+	for (k = first; k < first + sessprocs; k++) {
+		i = SESS_PROC(k);
+		if ((int)PBS_PROC_SID(i) != sid)
+			continue;
 		if (PBS_PROC_PID(i) <= 1)
 			continue;
-		if ((int)PBS_PROC_SID(i) == sid) {
-			Proc_lnks[myproc_ct].pl_pid = PBS_PROC_PID(i);
-			Proc_lnks[myproc_ct].pl_ppid = PBS_PROC_PPID(i);
-			Proc_lnks[myproc_ct].pl_parent = -1;
-			Proc_lnks[myproc_ct].pl_sib = -1;
-			Proc_lnks[myproc_ct].pl_child = -1;
-			Proc_lnks[myproc_ct].pl_done = 0;
-			if (++myproc_ct == myproc_max) {
-				void * hold;
-
-				myproc_max += TBL_INC;
-				hold = realloc((void *)Proc_lnks,
-					myproc_max*sizeof(pbs_plinks));
-				assert(hold != NULL);
-				Proc_lnks = (pbs_plinks *)hold;
-			}
+		Proc_lnks[myproc_ct].pl_pid = PBS_PROC_PID(i);
+		Proc_lnks[myproc_ct].pl_ppid = PBS_PROC_PPID(i);
+		Proc_lnks[myproc_ct].pl_parent = -1;
+		Proc_lnks[myproc_ct].pl_sib = -1;
+		Proc_lnks[myproc_ct].pl_child = -1;
+		Proc_lnks[myproc_ct].pl_done = 0;
+		if (++myproc_ct == myproc_max) {
+			void * hold;
+
+			myproc_max += TBL_INC;
+			hold = realloc((void *)Proc_lnks,
+				myproc_max*sizeof(pbs_plinks));
+			assert(hold != NULL);
+			Proc_lnks = (pbs_plinks *)hold;
 		}
 	}
 
@@ -1438,6 +1745,13 @@ mom_close_poll(void)
 		proc_info = NULL;
 		max_proc = 0;
 	}
+	if (sess_idx) {
+		free(sess_idx);
+		sess_idx = NULL;
+		nsess_idx = 0;
+		max_sess_idx = 0;
+	}
+	sess_idx_valid = 0;
 
 	return (PBSE_NONE);
 }
@@ -86,6 +86,11 @@
 #include "tpp.h"
 #include "dis.h"
 #include <openssl/sha.h>
+#ifndef WIN32
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 
 
 #define	RESCASSN_NCPUS	"resources_assigned.ncpus"
@@ -98,6 +103,19 @@
 /* Global Data items */
 static int	run_exit = 0;	/* run exit of child */
 
+#ifndef WIN32
+#define HOOK_WORKER_RETRY	60	/* seconds in fork mode after a worker failure */
+#define HOOK_WORKER_BACKLOG	64
+
+extern int	hook_worker;		/* $hook_worker */
+extern char	*hook_worker_exclude;	/* $hook_worker_exclude */
+
+static pid_t	hook_worker_pid = -1;	/* persistent pbs_python hook worker */
+static time_t	hook_worker_retry = 0;
+static int	hook_worker_enabled = 0;	/* $hook_worker as last configured */
+static char	hook_worker_sock[MAXPATHLEN + 1];
+#endif
+
 extern int              exiting_tasks;
 extern int       resc_access_perm;
 extern	char		*path_hooks;
@@ -683,6 +701,291 @@ mom_process_hooks_params_t
 	return new_php;
 }
 
+#ifndef WIN32
+/**
+ * @brief
+ *	Returns 1 if hook 'hook_name' is listed in the $hook_worker_exclude
+ *	MoM config option, i.e. is not safe to run in the persistent worker.
+ *
+ * @param[in]	hook_name - name of the hook
+ *
+ * @return int
+ * @retval 1	hook must not use the worker
+ * @retval 0	hook may use the worker
+ */
+static int
+hook_worker_excluded(char *hook_name)
+{
+	char	*p;
+	size_t	len;
+
+	if (hook_worker_exclude == NULL)
+		return 0;
+	len = strlen(hook_name);
+	for (p = hook_worker_exclude; *p != '\0'; p += strcspn(p, ", ")) {
+		p += strspn(p, ", ");
+		if ((strncmp(p, hook_name, len) == 0) &&
+			((p[len] == '\0') || (p[len] == ',') || (p[len] == ' ')))
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Work task run when the hook worker process has been reaped.
+ *
+ * @param[in]	ptask - work task whose wt_event is the worker pid
+ *
+ * @return void
+ */
+static void
+hook_worker_exited(struct work_task *ptask)
+{
+	if (ptask->wt_event != hook_worker_pid)
+		return;
+
+	hook_worker_pid = -1;
+	if (ptask->wt_aux != 0) {
+		/* don't keep restarting a worker that cannot start */
+		hook_worker_retry = time_now + HOOK_WORKER_RETRY;
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_HOOK, LOG_WARNING, __func__,
+			   "hook worker exited with status %d, using fork mode for %d seconds",
+			   ptask->wt_aux, HOOK_WORKER_RETRY);
+	}
+}
+
+/**
+ * @brief
+ *	Make sure the persistent pbs_python hook worker is running,
+ *	starting it if needed.  Called in MoM itself before forking the
+ *	child that runs a hook.
+ *
+ * @param[in]	pypath - path to pbs_python
+ *
+ * @return int
+ * @retval 0	worker is (being) started, hook children may use it
+ * @retval -1	worker not available, use fork mode
+ */
+static int
+hook_worker_start(char *pypath)
+{
+	struct sockaddr_un	addr;
+	struct work_task	*ptask;
+	struct stat		sbuf;
+	char			fdstr[16];
+	char			logmask[32];
+	char			rescdef[MAXPATHLEN + 1];
+	char			*arg[7];
+	int			sock;
+	pid_t			pid;
+
+	if (hook_worker_pid > 0)
+		return 0;
+	if (time_now < hook_worker_retry)
+		return -1;
+
+	snprintf(hook_worker_sock, sizeof(hook_worker_sock), "%s%s", path_hooks_workdir, HOOK_WORKER_SOCK);
+	if (strlen(hook_worker_sock) >= sizeof(addr.sun_path)) {
+		log_errf(-1, __func__, "hook worker socket path %s too long", hook_worker_sock);
+		hook_worker_retry = time_now + HOOK_WORKER_RETRY;
+		return -1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	pbs_strncpy(addr.sun_path, hook_worker_sock, sizeof(addr.sun_path));
+
+	/* listen before the worker exists, so hook children never race its startup */
+	(void)unlink(hook_worker_sock);
+	if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
+		log_err(errno, __func__, "socket");
+		return -1;
+	}
+	if ((bind(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1) ||
+		(chmod(hook_worker_sock, 0600) == -1) ||
+		(listen(sock, HOOK_WORKER_BACKLOG) == -1)) {
+		log_errf(errno, __func__, "unable to listen on %s", hook_worker_sock);
+		close(sock);
+		(void)unlink(hook_worker_sock);
+		hook_worker_retry = time_now + HOOK_WORKER_RETRY;
+		return -1;
+	}
+
+	snprintf(fdstr, sizeof(fdstr), "%d", sock);
+	snprintf(logmask, sizeof(logmask), "%ld", *log_event_mask);
+	snprintf(rescdef, sizeof(rescdef), "%s%s", path_hooks, PBS_RESCDEF);
+	if (stat(rescdef, &sbuf) != 0)
+		rescdef[0] = '\0';
+	arg[0] = pypath;
+	arg[1] = HOOK_WORKER_MODE;
+	arg[2] = fdstr;
+	arg[3] = path_log;
+	arg[4] = logmask;
+	arg[5] = rescdef;
+	arg[6] = NULL;
+
+	pid = fork();
+	if (pid == -1) {
+		log_err(errno, __func__, "fork failed");
+		close(sock);
+		return -1;
+	}
+	if (pid == 0) {
+		tpp_terminate();
+		net_close(-1);
+		setsid();
+		if (chdir(path_hooks_workdir) != 0)
+			exit(1);
+		if (pbs_conf.pbs_conf_file != NULL)
+			(void)setenv("PBS_CONF_FILE", pbs_conf.pbs_conf_file, 1);
+		execve(pypath, arg, environ);
+		exit(1);
+	}
+	close(sock);
+
+	ptask = set_task(WORK_Deferred_Child, pid, hook_worker_exited, NULL);
+	if (ptask == NULL) {
+		log_err(errno, __func__, msg_err_malloc);
+		kill(pid, SIGTERM);
+		return -1;
+	}
+	hook_worker_pid = pid;
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK, LOG_INFO, __func__,
+		   "started hook worker pid=%d", pid);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Stop the hook worker, if one is running.
+ *
+ * @return void
+ */
+static void
+hook_worker_stop(void)
+{
+	if (hook_worker_pid > 0)
+		kill(hook_worker_pid, SIGTERM);
+}
+
+/**
+ * @brief
+ *	Act on a (re)read of the MoM config file: stop the hook worker
+ *	when $hook_worker has just been turned off.
+ *
+ * @return void
+ */
+void
+hook_worker_config(void)
+{
+	if (hook_worker_enabled && !hook_worker)
+		hook_worker_stop();
+	hook_worker_enabled = hook_worker;
+}
+
+/**
+ * @brief
+ *	Append a length-prefixed string to a hook worker request.
+ *
+ * @param[in]	buf - request buffer
+ * @param[in/out] len - bytes used in 'buf'
+ * @param[in]	size - size of 'buf'
+ * @param[in]	str - string to append
+ *
+ * @return int
+ * @retval 0	success
+ * @retval -1	request too large
+ */
+static int
+hook_worker_put(char *buf, size_t *len, size_t size, char *str)
+{
+	uint32_t slen = strlen(str);
+
+	if (*len + sizeof(slen) + slen > size)
+		return -1;
+	memcpy(buf + *len, &slen, sizeof(slen));
+	memcpy(buf + *len + sizeof(slen), str, slen);
+	*len += sizeof(slen) + slen;
+	return 0;
+}
+
+/**
+ * @brief
+ *	Run a hook in the persistent hook worker and wait for it to finish.
+ *	Called in the MoM child in place of executing pbs_python.
+ *
+ * @param[in]	arg - the pbs_python "--hook" argument vector
+ * @param[in]	hook_config_path - the hook config file, or empty string
+ *
+ * @return int
+ * @retval	wait status of the hook process
+ * @retval	HOOK_WORKER_DECLINED	the hook was not run, execute pbs_python
+ */
+static int
+hook_worker_run(char **arg, char *hook_config_path)
+{
+	struct sockaddr_un	addr;
+	static char		buf[HOOK_WORKER_MAXREQ];
+	char			cwd[MAXPATHLEN + 1];
+	uint32_t		count;
+	int32_t			st;
+	size_t			len = sizeof(count);
+	ssize_t			n;
+	size_t			off;
+	int			sock;
+	int			i;
+
+	if (getcwd(cwd, sizeof(cwd)) == NULL)
+		return HOOK_WORKER_DECLINED;
+	if ((hook_worker_put(buf, &len, sizeof(buf), cwd) != 0) ||
+		(hook_worker_put(buf, &len, sizeof(buf), hook_config_path) != 0))
+		return HOOK_WORKER_DECLINED;
+	for (i = 0; arg[i] != NULL; i++) {
+		if ((i + 2 >= HOOK_WORKER_MAXSTRS) ||
+			(hook_worker_put(buf, &len, sizeof(buf), arg[i]) != 0))
+			return HOOK_WORKER_DECLINED;
+	}
+	count = i + 2;
+	memcpy(buf, &count, sizeof(count));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	pbs_strncpy(addr.sun_path, hook_worker_sock, sizeof(addr.sun_path));
+	if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) == -1)
+		return HOOK_WORKER_DECLINED;
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+		close(sock);
+		return HOOK_WORKER_DECLINED;
+	}
+	for (off = 0; off < len; off += n) {
+		n = write(sock, buf + off, len - off);
+		if (n == -1 && errno == EINTR) {
+			n = 0;
+			continue;
+		}
+		if (n <= 0) {
+			close(sock);
+			return HOOK_WORKER_DECLINED;
+		}
+	}
+
+	/* the hook is running now; a lost reply is a hook failure, not a retry */
+	for (off = 0; off < sizeof(st); off += n) {
+		n = read(sock, (char *)&st + off, sizeof(st) - off);
+		if (n == -1 && errno == EINTR) {
+			n = 0;
+			continue;
+		}
+		if (n <= 0) {
+			close(sock);
+			return (255 << 8);
+		}
+	}
+	close(sock);
+	return (int)st;
+}
+#endif /* !WIN32 */
+
 /**
  * @brief
  *	Runs the hook 'phook' in a child process in response to 'event_type'
@@ -770,6 +1073,10 @@ run_hook(hook *phook, unsigned int event_type, mom_hook_input_t *hook_input,
 	int keeping = 0;
 	char *std_file = NULL;
 	reliable_job_node *rjn;
+#ifndef WIN32
+	int use_worker = 0;
+	int worker_st;
+#endif
 
 	if ((phook == NULL) || (req_user == NULL) || (req_host == NULL)) {
 		log_err(-1, __func__, "Bad input received!");
@@ -838,6 +1145,12 @@ run_hook(hook *phook, unsigned int event_type, mom_hook_input_t *hook_input,
 	if ((phook->user == HOOK_PBSUSER) && (event_type & USER_MOM_EVENTS))
 		runas_jobuser = 1;
 
+#ifndef WIN32
+	/* hooks running as the job user always execute their own pbs_python */
+	if (hook_worker && !runas_jobuser && !hook_worker_excluded(phook->hook_name))
+		use_worker = (hook_worker_start(pypath) == 0);
+#endif
+
 	child = fork();
 	if (child > 0) { /* parent */
 
@@ -1308,6 +1621,17 @@ run_hook(hook *phook, unsigned int event_type, mom_hook_input_t *hook_input,
 			}
 		}
 
+		if (use_worker && (child == 0)) {
+			worker_st = hook_worker_run(arg, hook_config_path);
+			if (worker_st != HOOK_WORKER_DECLINED) {
+				if (WIFSIGNALED(worker_st)) {
+					signal(WTERMSIG(worker_st), SIG_DFL);
+					kill(getpid(), WTERMSIG(worker_st));
+				}
+				exit(WIFEXITED(worker_st) ? WEXITSTATUS(worker_st) : 255);
+			}
+		}
+
 		execve(pypath, arg, environ);
 run_hook_exit:
 		if (fp != NULL) {
@@ -281,6 +281,10 @@ static resource_def *rdwall;
 int restart_background = FALSE;
 int reject_root_scripts = FALSE;
 int report_hook_checksums = TRUE;
+int hook_worker = FALSE;		/* run hooks in the persistent pbs_python worker */
+char *hook_worker_exclude = NULL;	/* hooks that must not use the worker */
+int cgroup_usage = FALSE;		/* take job usage from the job's cgroup */
+char *cgroup_usage_prefix = NULL;	/* cgroup_prefix of the cgroups hook */
 int restart_transmogrify = FALSE;
 int attach_allow = TRUE;
 extern double wallfactor;
@@ -481,6 +485,10 @@ static handler_ret_t setidealload(char *);
 static handler_ret_t setlogevent(char *);
 static handler_ret_t set_reject_root_scripts(char *);
 static handler_ret_t set_report_hook_checksums(char *);
+static handler_ret_t set_hook_worker(char *);
+static handler_ret_t set_hook_worker_exclude(char *);
+static handler_ret_t set_cgroup_usage(char *);
+static handler_ret_t set_cgroup_usage_prefix(char *);
 static handler_ret_t setmaxload(char *);
 static handler_ret_t set_max_poll_downtime(char *);
 static handler_ret_t usecp(char *);
@@ -514,11 +522,15 @@ static struct	specials {
 	{ "alps_confirm_switch_timeout",set_alps_confirm_switch_timeout },
 #endif	/* MOM_ALPS */
 	{ "attach_allow",		set_attach_allow },
+	{ "cgroup_usage",		set_cgroup_usage },
+	{ "cgroup_usage_prefix",	set_cgroup_usage_prefix },
 	{ "checkpoint_path",		set_checkpoint_path },
 	{ "clienthost",			addclient },
 	{ "configversion",		config_verscheck },
 	{ "cputmult",			cputmult },
 	{ "enforce",			set_enforcement },
+	{ "hook_worker",		set_hook_worker },
+	{ "hook_worker_exclude",	set_hook_worker_exclude },
 	{ "ideal_load",			setidealload },
 	{ "jobdir_root",		set_jobdir_root },
 	{ "kbd_idle",			set_kbd_idle },
@@ -1589,20 +1601,20 @@ done:
 static u_long
 addclient_byname(char *name)
 {
-	struct	hostent		*host;
-	struct	in_addr		saddr;
+	unsigned long		addrs[PBS_RESOLVE_MAXADDRS];
+	int			naddrs;
 	u_long			ipaddr = 0;
 	int			i;
 
-	if ((host = gethostbyname(name)) == NULL) {
+	if ((pbs_resolve_addrs(name, addrs, PBS_RESOLVE_MAXADDRS, &naddrs) != 0) ||
+		(naddrs == 0)) {
 		sprintf(log_buffer, "host %s not found", name);
 		log_err(-1, __func__, log_buffer);
 		return 0;
 	}
 
-	for (i=0; host->h_addr_list[i]; i++) {
-		memcpy((char *)&saddr, host->h_addr_list[i], host->h_length);
-		ipaddr = ntohl(saddr.s_addr);
+	for (i = 0; i < naddrs; i++) {
+		ipaddr = addrs[i];
 		addrinsert(ipaddr);
 	}
 	return ipaddr;
@@ -1688,6 +1700,102 @@ set_report_hook_checksums(char *value)
 	return (set_boolean(__func__, value, &report_hook_checksums));
 }
 
+/**
+ * @brief
+ *	Set the hook_worker flag.  When set, hooks that run as root are
+ *	handed to a persistent, pre-initialized pbs_python worker instead of
+ *	executing pbs_python for every hook event.
+ *
+ * @param[in] value - value for hook_worker
+ *
+ * @return	handler_ret_t
+ * @retval	HANDLER_FAIL(0)		Failure
+ * @retval	HANDLER_SUCCESS		Success
+ *
+ */
+static handler_ret_t
+set_hook_worker(char *value)
+{
+	return (set_boolean(__func__, value, &hook_worker));
+}
+
+/**
+ * @brief
+ *	Set the list of hooks that are not safe to run in the persistent
+ *	hook worker; these always get a freshly executed pbs_python.
+ *
+ * @param[in] value - comma or space separated hook names
+ *
+ * @return	handler_ret_t
+ * @retval	HANDLER_FAIL(0)		Failure
+ * @retval	HANDLER_SUCCESS		Success
+ *
+ */
+static handler_ret_t
+set_hook_worker_exclude(char *value)
+{
+	char	*dup;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__, value);
+	if ((dup = strdup(value)) == NULL) {
+		log_err(errno, __func__, "strdup failed");
+		return HANDLER_FAIL;
+	}
+	free(hook_worker_exclude);
+	hook_worker_exclude = dup;
+	return HANDLER_SUCCESS;
+}
+
+/**
+ * @brief
+ *	Set the cgroup_usage flag.  When set, the cput, mem and vmem used by
+ *	a job are read from the job's cgroup, if it has one, instead of being
+ *	summed over the job's processes.
+ *
+ * @param[in] value - value for cgroup_usage
+ *
+ * @return	handler_ret_t
+ * @retval	HANDLER_FAIL(0)		Failure
+ * @retval	HANDLER_SUCCESS		Success
+ *
+ */
+static handler_ret_t
+set_cgroup_usage(char *value)
+{
+	return (set_boolean(__func__, value, &cgroup_usage));
+}
+
+/**
+ * @brief
+ *	Set the name under which the cgroups hook creates the job cgroups,
+ *	this must match cgroup_prefix in the hook configuration.
+ *
+ * @param[in] value - the cgroup prefix
+ *
+ * @return	handler_ret_t
+ * @retval	HANDLER_FAIL(0)		Failure
+ * @retval	HANDLER_SUCCESS		Success
+ *
+ */
+static handler_ret_t
+set_cgroup_usage_prefix(char *value)
+{
+	char	*dup;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__, value);
+	if ((*value == '\0') || (strchr(value, '/') != NULL)) {
+		log_err(-1, __func__, "invalid cgroup prefix");
+		return HANDLER_FAIL;
+	}
+	if ((dup = strdup(value)) == NULL) {
+		log_err(errno, __func__, "strdup failed");
+		return HANDLER_FAIL;
+	}
+	free(cgroup_usage_prefix);
+	cgroup_usage_prefix = dup;
+	return HANDLER_SUCCESS;
+}
+
 /**
  * @brief
  *	sets log event if host is restricted.
@@ -3965,10 +4073,19 @@ read_config(char *file)
 	struct	config		*ap;
 	int			i, j;
 	int			addconfig_ret;
+	unsigned long		hits, misses;
 
 	/*	initialize variable that can be set by config entries in case	*/
 	/*	they are removed and we are HUPped				*/
 
+	/* look the $clienthost and $restricted hosts up again */
+	pbs_resolve_cache_stats(&hits, &misses);
+	sprintf(log_buffer, "host resolution cache: %lu hits, %lu misses",
+		hits, misses);
+	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, __func__,
+		log_buffer);
+	pbs_resolve_cache_invalidate(NULL);
+
 	for (i=0; i<mask_num; i++)
 		free(maskclient[i]);
 	mask_num = 0;
@@ -3999,6 +4116,12 @@ read_config(char *file)
 	restart_background   = FALSE;
 	reject_root_scripts  = FALSE;
 	report_hook_checksums = TRUE;
+	hook_worker	     = FALSE;
+	free(hook_worker_exclude);
+	hook_worker_exclude  = NULL;
+	cgroup_usage	     = FALSE;
+	free(cgroup_usage_prefix);
+	cgroup_usage_prefix  = NULL;
 	restart_transmogrify = FALSE;
 	attach_allow	     = TRUE;
 	max_check_poll	     = MAX_CHECK_POLL_TIME;
@@ -4774,22 +4897,19 @@ log_verbose(char *id, char *buf, int len)
 int
 bad_restrict(u_long ipadd)
 {
-	struct	hostent		*host;
-	struct	in_addr	in;
+	char	h_name[PBS_MAXHOSTNAME + 1];
 	int	i, len1, len2;
 	char	*cp1, *cp2;
 
-	in.s_addr = htonl(ipadd);
-	if ((host = gethostbyaddr((void *)&in,
-		sizeof(struct in_addr), AF_INET)) == NULL)
+	if (pbs_resolve_name(ipadd, h_name, sizeof(h_name)) != 0)
 		return 1;
-	len1 = strlen(host->h_name) - 1;
+	len1 = strlen(h_name) - 1;
 
 	for (i=0; i<mask_num; i++) {
 		len2 = strlen(maskclient[i]) - 1;
 		if (len1 < len2)
 			continue;
-		cp1 = &host->h_name[len1];
+		cp1 = &h_name[len1];
 		cp2 = &maskclient[i][len2];
 		while (len2 >= 0 && tolower(*cp1) == tolower(*cp2)) {
 			cp1--;
@@ -4992,6 +5112,10 @@ rm_request(int iochan, int version, int prot)
 				goto bad;
 			}
 			len = read_config(body);
+#ifndef WIN32
+			if (len == 0)
+				hook_worker_config();
+#endif
 
 			ret = diswsi(iochan, len ? RM_RSP_ERROR : RM_RSP_OK);
 			if (ret != DIS_SUCCESS) {
@@ -7652,6 +7776,9 @@ main(int argc, char *argv[])
 #endif	/* WIN32 */
 		return (1);
 	}
+#ifndef WIN32
+	hook_worker_config();
+#endif
 	if (pbs_rm_port != (pbs_mom_port + 1)) {
 		fprintf(stderr, "Mom RM port must be one greater than the Mom Service port\n");
 #ifdef	WIN32
@@ -8349,6 +8476,8 @@ main(int argc, char *argv[])
 	pbs_pmix_server_init(msg_daemonname);
 #endif
 
+	set_log_async(pbs_conf.pbs_log_async, pbs_conf.pbs_log_async_drop, pbs_conf.pbs_log_async_flush);
+
 	/*
 	 * Now at last, we are ready to do some work, the following section
 	 * constitutes the "main" loop of MOM
@@ -57,6 +57,7 @@
 #include "sort.h"
 #include "node_partition.h"
 #include "check.h"
+#include "profile.h"
 
 /* bucket_bitpool constructor */
 bucket_bitpool *
@@ -399,6 +400,7 @@ create_node_buckets(status *policy, node_info **nodes, queue_info **queues, unsi
 	node_bucket **buckets = NULL;
 	node_bucket **tmp;
 	int node_ct;
+	prof_timer pt(PROF_NODE_BUCKETS);
 
 	if (policy == NULL || nodes == NULL)
 		return NULL;
@@ -629,6 +631,7 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 	int j;
 	int k;
 	static pbs_bitmap *zeromap = NULL;
+	static pbs_bitmap *takemap = NULL;
 	server_info *sinfo;
 
 	if (cmap == NULL || resresv == NULL || resresv->select == NULL)
@@ -684,6 +687,30 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 
 			}
 
+			/* Without provisioning, every free node fits.  Take the first
+			 * nodes we need a word at a time instead of bit by bit.
+			 */
+			if (resresv->aoename == NULL && num_chunks_needed > chunks_added &&
+			    bkt->free_pool->working_ct > 0 && cmap[i]->bkt_cnts[j]->chunk_count > 0) {
+				int chunk_count = cmap[i]->bkt_cnts[j]->chunk_count;
+				unsigned long nodes_needed = (num_chunks_needed - chunks_added + chunk_count - 1) / chunk_count;
+				unsigned long taken;
+
+				if (takemap == NULL) {
+					takemap = pbs_bitmap_alloc(NULL, 1);
+					if (takemap == NULL)
+						return 0;
+				}
+				clear_schd_error(err);
+				taken = pbs_bitmap_first_n_on_bits(takemap, bkt->free_pool->working, nodes_needed);
+				pbs_bitmap_andnot(bkt->free_pool->working, takemap);
+				bkt->free_pool->working_ct -= taken;
+				pbs_bitmap_or(bkt->busy_pool->working, takemap);
+				bkt->busy_pool->working_ct += taken;
+				pbs_bitmap_or(cmap[i]->node_bits, takemap);
+				chunks_added += taken * chunk_count;
+			}
+
 			for (k = pbs_bitmap_first_on_bit(bkt->free_pool->working);
 			     num_chunks_needed > chunks_added && k >= 0;
 			     k = pbs_bitmap_next_on_bit(bkt->free_pool->working, k)) {
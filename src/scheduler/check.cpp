@@ -51,6 +51,8 @@
  *	shrink_job_algorithm()
  *	is_ok_to_run_STF()
  *	is_ok_to_run()
+ *	speculate_resresv_sets_chunk()
+ *	speculate_resresv_sets()
  *	check_avail_resources()
  *	dynamic_avail()
  *	find_counts_elm()
@@ -101,6 +103,8 @@
 #include "resource.h"
 #include "buckets.h"
 #include "pbs_bitmap.h"
+#include "profile.h"
+#include "multi_threading.h"
 
 
 /**
@@ -722,6 +726,7 @@ is_ok_to_run(status *policy, server_info *sinfo,
 	schd_error	*prev_err = NULL;
 	schd_error	*err;
 	resource_req	*resreq = NULL;
+	prof_timer pt(PROF_IS_OK_TO_RUN);
 
 	if (sinfo == NULL || resresv == NULL || perr == NULL)
 		return NULL;
@@ -1057,6 +1062,20 @@ is_ok_to_run(status *policy, server_info *sinfo,
 		}
 	}
 
+	/* The equivalence class was found not to fit on any host before the
+	 * main loop started.  Nothing has been freed since, so it still doesn't.
+	 */
+	if (resresv->is_job && resresv->job->resv == NULL &&
+	    sinfo->equiv_classes != NULL && resresv->ec_index != UNSPECIFIED &&
+	    !(flags & (IGNORE_EQUIV_CLASS | RETURN_ALL_ERR))) {
+		resresv_set *rset = sinfo->equiv_classes[resresv->ec_index];
+
+		if (rset->spec_no_fit && rset->spec_gen == sinfo->spec_gen) {
+			copy_schd_error(err, rset->spec_err);
+			return NULL;
+		}
+	}
+
 	ns_arr = check_nodes(policy, sinfo, qinfo, resresv, flags, err);
 
 	if (err->error_code != SUCCESS)
@@ -1075,6 +1094,353 @@ is_ok_to_run(status *policy, server_info *sinfo,
 	return ns_arr;
 }
 
+/* free and total amounts of the consumable resources on each host */
+struct spec_host_table
+{
+	std::vector<resdef *> defs;		/* consumable resources tracked */
+	std::vector<int> pos;			/* resdef->rindex -> index into defs or -1 */
+	std::vector<sch_resource_t> free;	/* num_hosts * defs.size() free amounts */
+	std::vector<sch_resource_t> total;	/* num_hosts * defs.size() total amounts */
+	int num_hosts;
+};
+
+/**
+ * @brief
+ *		add a vnode's amount of a resource to its host's amount
+ *
+ * @param[in,out]	hamt	-	the host's amount
+ * @param[in]	amt	-	the vnode's amount
+ *
+ * @return	void
+ */
+static void
+add_spec_amount(sch_resource_t *hamt, sch_resource_t amt)
+{
+	if (*hamt == SCHD_INFINITY_RES || amt == SCHD_INFINITY_RES)
+		*hamt = SCHD_INFINITY_RES;
+	else
+		*hamt += amt;
+}
+
+/**
+ * @brief
+ *		sum the free and total consumable resources of sinfo's vnodes per host.
+ *		A resource unset on a vnode is taken as infinite and vnodes which are
+ *		down or offline are left out, so a chunk which does not fit on any
+ *		host in the table can not be placed by check_nodes() either.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	sinfo	-	the server whose nodes to sum
+ *
+ * @return	spec_host_table *
+ * @retval	the host table (caller frees with delete)
+ * @retval	NULL	: nothing to track
+ */
+static spec_host_table *
+create_spec_host_table(status *policy, server_info *sinfo)
+{
+	spec_host_table *ht;
+	std::unordered_map<std::string, int> host_ind;
+	size_t ndefs;
+	int i;
+
+	if (policy->resdef_to_check == NULL || sinfo->nodes == NULL)
+		return NULL;
+
+	ht = new spec_host_table;
+	for (i = 0; policy->resdef_to_check[i] != NULL; i++) {
+		resdef *def = policy->resdef_to_check[i];
+
+		if (!def->type.is_consumable || def->rindex < 0)
+			continue;
+		if (static_cast<size_t>(def->rindex) >= ht->pos.size())
+			ht->pos.resize(def->rindex + 1, -1);
+		ht->pos[def->rindex] = ht->defs.size();
+		ht->defs.push_back(def);
+	}
+	ndefs = ht->defs.size();
+	if (ndefs == 0) {
+		delete ht;
+		return NULL;
+	}
+
+	ht->num_hosts = 0;
+	for (i = 0; sinfo->nodes[i] != NULL; i++) {
+		node_info *node = sinfo->nodes[i];
+		schd_resource *hostres;
+		const char *host;
+		int h;
+		size_t j;
+
+		if (node->is_down || node->is_offline)
+			continue;
+
+		hostres = find_resource(node->res, getallres(RES_HOST));
+		if (hostres != NULL && hostres->str_avail != NULL && hostres->str_avail[0] != NULL)
+			host = hostres->str_avail[0];
+		else
+			host = node->name;
+
+		auto hi = host_ind.find(host);
+		if (hi == host_ind.end()) {
+			h = ht->num_hosts++;
+			host_ind[host] = h;
+			ht->free.resize(ht->num_hosts * ndefs, 0);
+			ht->total.resize(ht->num_hosts * ndefs, 0);
+		} else
+			h = hi->second;
+
+		for (j = 0; j < ndefs; j++) {
+			schd_resource *res;
+
+			res = find_resource(node->res, ht->defs[j]);
+			if (res != NULL && res->indirect_res != NULL)
+				res = res->indirect_res;
+
+			if (res == NULL) {
+				ht->free[h * ndefs + j] = SCHD_INFINITY_RES;
+				ht->total[h * ndefs + j] = SCHD_INFINITY_RES;
+			} else {
+				add_spec_amount(&ht->free[h * ndefs + j], dynamic_avail(res));
+				add_spec_amount(&ht->total[h * ndefs + j], res->avail);
+			}
+		}
+	}
+
+	return ht;
+}
+
+/**
+ * @brief
+ *		speculatively check whether a chunk fits on any host of a host table
+ *
+ * @param[in]	ht	-	the host table
+ * @param[in]	chk	-	the chunk
+ * @param[out]	err	-	why the chunk does not fit if it doesn't
+ *
+ * @return	int
+ * @retval	1	: the chunk fits on a host or the check can't tell
+ * @retval	0	: the chunk fits on no host now, but does on a host's totals
+ */
+static int
+spec_chunk_fits(spec_host_table *ht, chunk *chk, schd_error *err)
+{
+	size_t ndefs = ht->defs.size();
+	std::vector<int> fail_ct(ndefs, 0);
+	std::vector<sch_resource_t> max_free(ndefs, 0);
+	std::vector<sch_resource_t> max_total(ndefs, 0);
+	resource_req *req;
+	resource_req *worst_req = NULL;
+	int worst = -1;
+	int fits_total = 0;
+	int h;
+	char resbuf1[MAX_LOG_SIZE];
+	char resbuf2[MAX_LOG_SIZE];
+	char resbuf3[MAX_LOG_SIZE];
+	char buf[MAX_LOG_SIZE];
+
+	for (h = 0; h < ht->num_hosts; h++) {
+		sch_resource_t *hfree = &ht->free[h * ndefs];
+		sch_resource_t *htotal = &ht->total[h * ndefs];
+		int fits = 1;
+		int host_fits_total = 1;
+
+		for (req = chk->req; req != NULL; req = req->next) {
+			int p;
+
+			if (req->amount == 0 || req->def == NULL || req->def->rindex < 0 ||
+			    static_cast<size_t>(req->def->rindex) >= ht->pos.size() ||
+			    (p = ht->pos[req->def->rindex]) < 0)
+				continue;
+
+			if (hfree[p] != SCHD_INFINITY_RES && hfree[p] < req->amount) {
+				fits = 0;
+				fail_ct[p]++;
+			}
+			if (htotal[p] != SCHD_INFINITY_RES && htotal[p] < req->amount)
+				host_fits_total = 0;
+			if (hfree[p] > max_free[p])
+				max_free[p] = hfree[p];
+			if (htotal[p] > max_total[p])
+				max_total[p] = htotal[p];
+		}
+		if (fits)
+			return 1;
+		if (host_fits_total)
+			fits_total = 1;
+	}
+
+	/* no host at all or it may never fit: leave it to check_nodes() */
+	if (ht->num_hosts == 0 || !fits_total)
+		return 1;
+
+	/* report the resource which is short on the most hosts */
+	for (req = chk->req; req != NULL; req = req->next) {
+		int p;
+
+		if (req->def == NULL || req->def->rindex < 0 ||
+		    static_cast<size_t>(req->def->rindex) >= ht->pos.size() ||
+		    (p = ht->pos[req->def->rindex]) < 0)
+			continue;
+		if (fail_ct[p] > worst) {
+			worst = fail_ct[p];
+			worst_req = req;
+		}
+	}
+	if (worst_req == NULL)
+		return 1;
+
+	set_schd_error_codes(err, NOT_RUN, INSUFFICIENT_RESOURCE);
+	err->rdef = worst_req->def;
+	res_to_str_r(worst_req, RF_REQUEST, resbuf1, sizeof(resbuf1));
+	res_to_str_c(max_free[ht->pos[worst_req->def->rindex]], worst_req->def, RF_AVAIL, resbuf2, sizeof(resbuf2));
+	res_to_str_c(max_total[ht->pos[worst_req->def->rindex]], worst_req->def, RF_AVAIL, resbuf3, sizeof(resbuf3));
+	snprintf(buf, sizeof(buf), "(R: %s A: %s T: %s)", resbuf1, resbuf2, resbuf3);
+	set_schd_error_arg(err, ARG1, buf);
+
+	return 0;
+}
+
+/**
+ * @brief
+ *		speculatively check a range of equivalence classes against a host
+ *		table.  Only reads the universe, so it is safe to call from the
+ *		worker threads.
+ *
+ * @param[in,out]	data	-	the equivalence classes and host table
+ *
+ * @return	void
+ */
+void
+speculate_resresv_sets_chunk(th_data_spec_rsets *data)
+{
+	int i;
+	int j;
+
+	for (i = data->sidx; i <= data->eidx && data->rsets[i] != NULL; i++) {
+		resresv_set *rset = data->rsets[i];
+
+		rset->spec_no_fit = 0;
+		free_schd_error(rset->spec_err);
+		rset->spec_err = NULL;
+
+		/* queues with nodes have their own universe of nodes */
+		if (rset->qinfo != NULL || rset->select_spec == NULL)
+			continue;
+
+		rset->spec_err = new_schd_error();
+		if (rset->spec_err == NULL)
+			continue;
+		for (j = 0; rset->select_spec->chunks[j] != NULL; j++) {
+			if (spec_chunk_fits(data->hosts, rset->select_spec->chunks[j], rset->spec_err) == 0) {
+				rset->spec_no_fit = 1;
+				rset->spec_gen = data->spec_gen;
+				break;
+			}
+		}
+		if (!rset->spec_no_fit) {
+			free_schd_error(rset->spec_err);
+			rset->spec_err = NULL;
+		}
+	}
+}
+
+/**
+ * @brief
+ *		speculatively find the equivalence classes which can not fit on any
+ *		host with the resources free at the start of the main loop.  The
+ *		classes are checked in parallel on the worker threads against a
+ *		snapshot of the free resources per host.  While the main loop runs
+ *		jobs, resources are only consumed so a class found not to fit stays
+ *		that way, and is_ok_to_run() skips check_nodes() for it.  Once
+ *		resources are freed (e.g. by preemption) sinfo->spec_gen moves on
+ *		and the classes are checked by check_nodes() again.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	sinfo	-	the server
+ *
+ * @return	void
+ */
+void
+speculate_resresv_sets(status *policy, server_info *sinfo)
+{
+	spec_host_table *ht;
+	th_data_spec_rsets *tdata;
+	th_task_info *task;
+	int num_rsets;
+	int num_tasks;
+	int chunk_size;
+	int tid;
+	int i;
+	int j;
+
+	if (policy == NULL || sinfo == NULL || sinfo->equiv_classes == NULL)
+		return;
+
+	for (num_rsets = 0; sinfo->equiv_classes[num_rsets] != NULL; num_rsets++)
+		;
+	if (num_rsets == 0)
+		return;
+
+	ht = create_spec_host_table(policy, sinfo);
+	if (ht == NULL)
+		return;
+
+	tid = *((int *) pthread_getspecific(th_id_key));
+	if (tid != 0 || num_threads <= 1) {
+		th_data_spec_rsets data = {sinfo->equiv_classes, ht, sinfo->spec_gen, 0, num_rsets - 1};
+		speculate_resresv_sets_chunk(&data);
+	} else {
+		chunk_size = num_rsets / num_threads;
+		chunk_size = (chunk_size > MT_SPEC_CHUNK_SIZE_MIN) ? chunk_size : MT_SPEC_CHUNK_SIZE_MIN;
+		for (j = 0, num_tasks = 0; j < num_rsets; j += chunk_size) {
+			tdata = static_cast<th_data_spec_rsets *>(malloc(sizeof(th_data_spec_rsets)));
+			if (tdata == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				break;
+			}
+			task = static_cast<th_task_info *>(malloc(sizeof(th_task_info)));
+			if (task == NULL) {
+				free(tdata);
+				log_err(errno, __func__, MEM_ERR_MSG);
+				break;
+			}
+			tdata->rsets = sinfo->equiv_classes;
+			tdata->hosts = ht;
+			tdata->spec_gen = sinfo->spec_gen;
+			tdata->sidx = j;
+			tdata->eidx = j + chunk_size - 1;
+			task->task_id = num_tasks;
+			task->task_type = TS_SPEC_RSETS;
+			task->thread_data = (void *) tdata;
+
+			queue_work_for_threads(task);
+			num_tasks++;
+		}
+
+		/* Get results from worker threads */
+		for (i = 0; i < num_tasks;) {
+			pthread_mutex_lock(&result_lock);
+			while (ds_queue_is_empty(result_queue))
+				pthread_cond_wait(&result_cond, &result_lock);
+			while (!ds_queue_is_empty(result_queue)) {
+				task = static_cast<th_task_info *>(ds_dequeue(result_queue));
+				free(task->thread_data);
+				free(task);
+				i++;
+			}
+			pthread_mutex_unlock(&result_lock);
+		}
+	}
+	delete ht;
+
+	for (i = 0, j = 0; i < num_rsets; i++)
+		if (sinfo->equiv_classes[i]->spec_no_fit)
+			j++;
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+		"%d of %d equivalence classes can not fit on any host", j, num_rsets);
+}
+
 /**
  *
  * @brief
@@ -1331,7 +1697,7 @@ find_counts_elm(counts *cts_list, const char *name, resdef *rdef, counts **cnt,
 			*cnt = cts;
 		if (rdef == NULL)
 			return cts->running;
-		else if ((res_lim = find_resource_count(cts->rescts, rdef)) != NULL) {
+		else if ((res_lim = find_counts_res(cts, rdef)) != NULL) {
 			if (rcount != NULL)
 				*rcount = res_lim;
 			return res_lim->amount;
@@ -95,6 +95,17 @@ nspec **
 shrink_to_run_event(status *policy, server_info *sinfo,
 	queue_info *qinfo, resource_resv *njob, unsigned int flags, schd_error *err);
 
+/*
+ *	speculate_resresv_sets - find the equivalence classes which can not
+ *		fit on any host, in parallel on the worker threads
+ */
+void speculate_resresv_sets(status *policy, server_info *sinfo);
+
+/*
+ *	speculate_resresv_sets_chunk - worker thread part of speculate_resresv_sets()
+ */
+void speculate_resresv_sets_chunk(th_data_spec_rsets *data);
+
 /*
  *      check_avail_resources - This function will calculate the number of
  *				multiples of the requested resources in reqlist
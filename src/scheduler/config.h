@@ -142,6 +142,9 @@
 #define PARSE_STRICT_ORDERING "strict_ordering"
 #define PARSE_RES_UNSET_INFINITE "resource_unset_infinite"
 #define PARSE_SELECT_PROVISION "provision_policy"
+#define PARSE_CYCLE_PROFILE "cycle_profile"
+#define PARSE_EST_START_TIME_FREQ "est_start_time_freq"
+#define PARSE_SPECULATIVE_JOB_EVAL "speculative_job_eval"
 
 #ifdef NAS
 /* localmod 034 */
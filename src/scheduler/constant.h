@@ -176,7 +176,8 @@ enum thread_task_type
 	TS_FREE_ND_INFO,
 	TS_DUP_RESRESV,
 	TS_QUERY_JOB_INFO,
-	TS_FREE_RESRESV
+	TS_FREE_RESRESV,
+	TS_SPEC_RSETS
 };
 
 /* return codes for is_ok_to_run_* functions
@@ -321,6 +322,11 @@ enum resv_conf {
 	RESV_CONFIRM_RETRY
 };
 
+/* number of jobs whose delayed attribute updates are collected before
+ * they are sent to the server in one bulk request
+ */
+#define MAX_PENDING_JOB_UPDATES 1000
+
 /* job substate meaning suspended by scheduler */
 #define SUSP_BY_SCHED_SUBSTATE "45"
 
@@ -340,6 +346,9 @@ enum fairshare_flags
 
 #define FAIRSHARE_MIN_USAGE 1
 
+/* counts lists of at least this many entities get a name index */
+#define COUNTS_INDEX_MIN 8
+
 /* flags used for copy constructors - bit field */
 enum dup_flags
 {
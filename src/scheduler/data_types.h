@@ -67,6 +67,8 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <unordered_map>
 
 struct server_info;
 struct state_count;
@@ -81,8 +83,11 @@ struct prev_job_info;
 struct group_info;
 struct usage_info;
 struct counts;
+struct counts_index;
+struct spec_host_table;
 struct nspec;
 struct node_partition;
+struct nodepart_snap;
 struct range;
 struct resource_resv;
 struct place;
@@ -92,6 +97,7 @@ struct chunk;
 struct selspec;
 struct resdef;
 struct event_list;
+struct event_index;
 struct status;
 struct fairshare_head;
 struct node_scratch;
@@ -116,8 +122,10 @@ typedef struct group_info group_info;
 typedef struct prev_job_info prev_job_info;
 typedef struct resv_info resv_info;
 typedef struct counts counts;
+typedef struct counts_index counts_index;
 typedef struct nspec nspec;
 typedef struct node_partition node_partition;
+typedef struct nodepart_snap nodepart_snap;
 typedef struct resource_resv resource_resv;
 typedef struct place place;
 typedef struct schd_error schd_error;
@@ -127,6 +135,7 @@ typedef struct selspec selspec;
 typedef struct resdef resdef;
 typedef struct timed_event timed_event;
 typedef struct event_list event_list;
+typedef struct event_index event_index;
 typedef struct status status;
 typedef struct fairshare_head fairshare_head;
 typedef struct node_scratch node_scratch;
@@ -145,6 +154,8 @@ typedef struct th_data_free_ninfo th_data_free_ninfo;
 typedef struct th_data_dup_resresv th_data_dup_resresv;
 typedef struct th_data_query_jinfo th_data_query_jinfo;
 typedef struct th_data_free_resresv th_data_free_resresv;
+typedef struct th_data_spec_rsets th_data_spec_rsets;
+typedef struct spec_host_table spec_host_table;
 typedef struct server_psets server_psets;
 
 
@@ -211,6 +222,8 @@ struct th_data_query_ninfo
 	struct batch_status *nodes;
 	server_info *sinfo;
 	node_info **oarr;
+	node_info **cached;	/* per node: unchanged node from last cycle or NULL */
+	int *num_res;		/* per node: number of resources of the cached node when parsed */
 	int sidx;
 	int eidx;
 };
@@ -253,6 +266,15 @@ struct th_data_free_resresv
 	int eidx;
 };
 
+struct th_data_spec_rsets
+{
+	resresv_set **rsets;
+	spec_host_table *hosts;
+	int spec_gen;
+	int sidx;
+	int eidx;
+};
+
 struct schd_error
 {
 	enum sched_error_code error_code;	/* scheduler error code (see constant.h) */
@@ -308,6 +330,7 @@ struct selspec
 	int total_cpus;			/* # of cpus requested in this select spec */
 	resdef **defs;			/* the resources requested by this select spec*/
 	chunk **chunks;
+	int refct;			/* number of owners, see share_selspec() */
 };
 
 /* for description of these bits, check the PBS admin guide or scheduler IDS */
@@ -410,6 +433,7 @@ struct server_info
 	unsigned has_nonCPU_licenses:1;	/* server has non-CPU (e.g. socket-based) licenses */
 	unsigned use_hard_duration:1;	/* use hard duration when creating the calendar */
 	unsigned pset_metadata_stale:1;	/* The placement set meta data is stale and needs to be regenerated before the next use */
+	unsigned pset_metadata_rebuild:1; /* The placement set meta data needs to be recomputed from all nodes */
 	char *name;			/* name of server */
 	struct schd_resource *res;	/* list of resources */
 	void *liminfo;			/* limit storage information */
@@ -417,6 +441,7 @@ struct server_info
 	int num_nodes;			/* number of nodes associated with the server */
 	int num_resvs;			/* number of reservations on the server */
 	int num_preempted;		/* number of jobs currently preempted */
+	int spec_gen;			/* bumped each time resources are freed */
 	char **node_group_key;		/* the node grouping resources */
 	state_count sc;			/* number of jobs in each state */
 	queue_info **queues;		/* array of queues */
@@ -478,6 +503,9 @@ struct server_info
 	node_bucket **buckets;		/* node bucket array */
 	node_info **unordered_nodes;
 	std::vector<server_psets> svr_to_psets;
+	std::vector<node_info *> pset_dirty_nodes;	/* nodes changed since the placement sets were last updated */
+	std::unordered_map<std::string, node_info *> nodes_by_name;		/* index of nodes by name */
+	std::unordered_map<std::string, resource_resv *> resresv_by_name;	/* index of all_resresv by name */
 #ifdef NAS
 	/* localmod 034 */
 	share_head *share_head;	/* root of share info */
@@ -746,6 +774,7 @@ struct node_info
 	int bucket_ind;			/* index in server's bucket array */
 	int node_ind;			/* node's index into sinfo->unordered_nodes */
 	node_partition **np_arr;	/* array of node partitions node is in */
+	nodepart_snap *np_snap;		/* node as last folded into np_arr (NULL if unchanged) */
 	char *svr_inst_id;
 };
 
@@ -888,6 +917,7 @@ struct resdef
 	char *name;			/* name of resource */
 	struct resource_type type;	/* resource type */
 	unsigned int flags;		/* resource flags (see pbs_ifl.h) */
+	int rindex;			/* position in allres or -1 */
 };
 
 struct prev_job_info
@@ -903,9 +933,19 @@ struct counts
 	int running;			/* count of running jobs in object */
 	int soft_limit_preempt_bit;	/* Place to store preempt bit if entity is over limits */
 	resource_count *rescts;		/* resources used */
+	resource_count **rescts_by_def;	/* rescts indexed by resdef rindex */
+	int rescts_by_def_size;		/* number of slots in rescts_by_def, -1 if not indexed */
+	counts_index *index;		/* name index of the list (list head only) */
 	counts *next;
 };
 
+/* index of a counts list by entity name, hung off the head of the list */
+struct counts_index
+{
+	std::unordered_map<std::string, counts *> by_name;
+	counts *tail;			/* last element of the list */
+};
+
 struct resource_count
 {
 	char *name;		    /* resource name */
@@ -922,6 +962,8 @@ struct fairshare_head
 {
 	group_info *root;			/* root of fairshare tree */
 	time_t last_decay;			/* last time tree was decayed */
+	unsigned long usage_gen;		/* bumped whenever the usage of the tree changes */
+	std::unordered_map<std::string, group_info *> ginfo_by_name;	/* index of the tree by entity name */
 };
 
 /* a path from the root to a group_info in the tree */
@@ -949,6 +991,7 @@ struct group_info
 	usage_t usage;				/* calculated usage info */
 	usage_t temp_usage;			/* usage plus any temporary usage */
 	float usage_factor;			/* usage calculation taking parent's usage into account: number between 0 and 1 */
+	unsigned long usage_factor_gen;		/* fairshare_head usage_gen usage_factor was calculated at */
 
 	struct group_path *gpath;		/* path from the root of the tree */
 
@@ -974,6 +1017,9 @@ struct resresv_set
 	place *place_spec;		/* place spec of set */
 	resource_req *req;		/* ATTR_L (qsub -l) resources of set.  Only contains resources on the resources line */
 	queue_info *qinfo;		/* The queue the resresv is in if the queue has nodes associated */
+	unsigned spec_no_fit:1;		/* speculatively found not to fit on any host */
+	int spec_gen;			/* sinfo->spec_gen the speculation was done at */
+	schd_error *spec_err;		/* why the set does not fit if spec_no_fit */
 };
 
 struct node_partition
@@ -992,6 +1038,21 @@ struct node_partition
 	int rank;		/* unique numeric identifier for node partition */
 };
 
+/* a node's consumable resource as it was last folded into its node partitions */
+struct nodepart_res_snap
+{
+	resdef *def;
+	sch_resource_t avail;
+	sch_resource_t assigned;
+};
+
+/* a node as it was last folded into its node partitions' meta data */
+struct nodepart_snap
+{
+	unsigned int is_free:1;
+	std::vector<nodepart_res_snap> res;
+};
+
 struct np_cache
 {
 	char **resnames;		/* resource names used to create partitions */
@@ -1145,6 +1206,8 @@ struct config
 	unsigned node_sort_unused:1;	/* node sorting by unused/assigned is used */
 	unsigned resv_conf_ignore:1;  /* if we want to ignore dedicated time when confirming reservations.  Move to enum if ever expanded */
 	unsigned allow_aoe_calendar:1;        /* allow jobs requesting aoe in calendar*/
+	unsigned cycle_profile:1;	/* time the phases of each cycle */
+	unsigned speculative_job_eval:1;	/* pre-screen equivalence classes in parallel */
 #ifdef NAS /* localmod 034 */
 	unsigned prime_sto	:1;	/* shares_track_only--no enforce shares */
 	unsigned non_prime_sto:1;
@@ -1180,6 +1243,7 @@ struct config
 	char **ignore_res;			/* resources - unset implies infinite */
 	int num_res_to_check;			/* the size of res_to_check */
 	time_t max_starve;			/* starving threshold */
+	time_t est_start_time_freq;		/* how often to estimate all jobs' start times */
 	/* order to preempt jobs */
 	struct sort_info *prime_node_sort;	/* node sorting primetime */
 	struct sort_info *non_prime_node_sort;	/* node sorting non primetime */
@@ -1214,6 +1278,15 @@ struct event_list
 	timed_event *next_event;	/* the next event to be performed */
 	timed_event *first_run_event;	/* The first run event in the calendar */
 	time_t *current_time;		/* [reference] current time in the calendar */
+	event_index *index;		/* index into events */
+};
+
+/* index of an event list, kept in step by add_event()/delete_event() */
+struct event_index
+{
+	std::map<time_t, timed_event *> first_at;	/* first event at each time */
+	std::unordered_multimap<std::string, timed_event *> by_name;	/* events by name */
+	timed_event *tail;		/* last event in the list */
 };
 
 struct timed_event
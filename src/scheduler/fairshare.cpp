@@ -83,6 +83,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
 
 #include <log.h>
 
@@ -105,18 +106,22 @@
 
 extern time_t last_decay;
 
+/* serializes find_alloc_ginfo(): jobs are queried by the worker threads */
+static pthread_mutex_t ginfo_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * @brief
  *		add_child - add a group_info to the resource group tree
  *
  * @param[out]	ginfo	-	ginfo to add to the tree
  * @param[in,out]	parent	-	parent ginfo
+ * @param[in,out]	fhead	-	head of the tree, whose index ginfo is added to
  *
  * @return	nothing
  *
  */
 void
-add_child(group_info *ginfo, group_info *parent)
+add_child(group_info *ginfo, group_info *parent, fairshare_head *fhead)
 {
 	if (parent != NULL) {
 		ginfo->sibling = parent->child;
@@ -124,6 +129,7 @@ add_child(group_info *ginfo, group_info *parent)
 		ginfo->parent = parent;
 		ginfo->resgroup = parent->cresgroup;
 		ginfo->gpath = create_group_path(ginfo);
+		fhead->ginfo_by_name[ginfo->name] = ginfo;
 	}
 }
 
@@ -132,44 +138,44 @@ add_child(group_info *ginfo, group_info *parent)
  * 		add a ginfo to the "unknown" group
  *
  * @param[in]	ginfo	-	ginfo to add
- * @param[in]	root	-	root of fairshare tree
+ * @param[in]	fhead	-	head of fairshare tree
  *
  * @return	nothing
  *
  */
 void
-add_unknown(group_info *ginfo, group_info *root)
+add_unknown(group_info *ginfo, fairshare_head *fhead)
 {
 	group_info *unknown;		/* ptr to the "unknown" group */
 
-	unknown = find_group_info("unknown", root);
-	add_child(ginfo, unknown);
+	unknown = find_group_info("unknown", fhead);
+	add_child(ginfo, unknown, fhead);
 	calc_fair_share_perc(unknown->child, UNSPECIFIED);
+	/* the group percentages of the unknown group just changed */
+	fhead->usage_gen++;
 }
 
 /**
  * @brief
- *		find_group_info - recursive function to find a group_info in the
- *			  resgroup tree
+ *		find_group_info - find a group_info in the resgroup tree
  *
  * @param[in]	name	-	name of the ginfo to find
- * @param[in]	root	-	the root of the current sub-tree
+ * @param[in]	fhead	-	head of the fairshare tree
  *
  * @return	the found group_info or NULL
  *
  */
 group_info *
-find_group_info(const char *name, group_info *root)
+find_group_info(const char *name, fairshare_head *fhead)
 {
-	group_info *ginfo;		/* the found group */
-	if (root == NULL || name == NULL || !strcmp(name, root->name))
-		return root;
+	if (fhead == NULL || name == NULL)
+		return NULL;
 
-	ginfo = find_group_info(name, root->sibling);
-	if (ginfo == NULL)
-		ginfo = find_group_info(name, root->child);
+	auto it = fhead->ginfo_by_name.find(name);
+	if (it == fhead->ginfo_by_name.end())
+		return NULL;
 
-	return ginfo;
+	return it->second;
 }
 
 /**
@@ -179,29 +185,36 @@ find_group_info(const char *name, group_info *root)
  *			  add it to the "unknown" group
  *
  * @param[in]	name	-	name of the ginfo to find
- * @param[in]	root	-	root of the fairshare tree
+ * @param[in]	fhead	-	head of the fairshare tree
  *
  * @return	the found ginfo or the newly allocated ginfo
  *
+ * @par MT-safe: Yes
+ *
  */
 group_info *
-find_alloc_ginfo(char *name, group_info *root)
+find_alloc_ginfo(char *name, fairshare_head *fhead)
 {
 	group_info *ginfo;		/* the found group or allocated group */
 
-	if (name == NULL || root == NULL)
+	if (name == NULL || fhead == NULL || fhead->root == NULL)
 		return NULL;
 
-	ginfo = find_group_info(name, root);
+	pthread_mutex_lock(&ginfo_lock);
+	ginfo = find_group_info(name, fhead);
 
 	if (ginfo == NULL) {
-		if ((ginfo = new_group_info()) == NULL)
-			return NULL;
-
-		ginfo->name = string_dup(name);
-		ginfo->shares = 1;
-		add_unknown(ginfo, root);
+		if ((ginfo = new_group_info()) != NULL) {
+			if ((ginfo->name = string_dup(name)) == NULL) {
+				free_fairshare_node(ginfo);
+				ginfo = NULL;
+			} else {
+				ginfo->shares = 1;
+				add_unknown(ginfo, fhead);
+			}
+		}
 	}
+	pthread_mutex_unlock(&ginfo_lock);
 	return ginfo;
 }
 
@@ -231,6 +244,7 @@ new_group_info()
 	ngi->usage = FAIRSHARE_MIN_USAGE;
 	ngi->temp_usage = FAIRSHARE_MIN_USAGE;
 	ngi->usage_factor = 0.0;
+	ngi->usage_factor_gen = 0;
 	ngi->gpath = NULL;
 	ngi->parent = NULL;
 	ngi->sibling = NULL;
@@ -244,7 +258,7 @@ new_group_info()
  * 		parse the resource group file
  *
  * @param[in]	fname	-	name of the file
- * @param[in]	root	-	root of fairshare tree
+ * @param[in]	fhead	-	head of fairshare tree
  *
  * @return	success/failure
  *
@@ -257,7 +271,7 @@ new_group_info()
  *
  */
 int
-parse_group(const char *fname, group_info *root)
+parse_group(const char *fname, fairshare_head *fhead)
 {
 	group_info *ginfo;		/* ptr to parent group */
 	group_info *new_ginfo;	/* used to add each new group */
@@ -294,7 +308,7 @@ parse_group(const char *fname, group_info *root)
 				grouptok == NULL || sharestok == NULL) {
 				error = 1;
 			}
-			else if (find_group_info(nametok, root) != NULL) {
+			else if (find_group_info(nametok, fhead) != NULL) {
 				error = 1;
 				sprintf(log_buffer, "entity %s is not unique", nametok);
 				fprintf(stderr, "%s\n", log_buffer);
@@ -303,9 +317,9 @@ parse_group(const char *fname, group_info *root)
 			}
 			else {
 				if (!strcmp(grouptok, "root"))
-					ginfo = find_group_info(FAIRSHARE_ROOT_NAME, root);
+					ginfo = find_group_info(FAIRSHARE_ROOT_NAME, fhead);
 				else
-					ginfo = find_group_info(grouptok, root);
+					ginfo = find_group_info(grouptok, fhead);
 
 				if (ginfo != NULL) {
 					shares = strtol(sharestok, &endp, 10);
@@ -318,7 +332,7 @@ parse_group(const char *fname, group_info *root)
 							new_ginfo->resgroup = ginfo->cresgroup;
 							new_ginfo->cresgroup = cgroup;
 							new_ginfo->shares = shares;
-							add_child(new_ginfo, ginfo);
+							add_child(new_ginfo, ginfo, fhead);
 						}
 						else
 							error = 1;
@@ -384,6 +398,7 @@ preload_tree()
 	root->resgroup = -1;
 	root->cresgroup = 0;
 	root->tree_percentage = 1.0;
+	head->ginfo_by_name[root->name] = root;
 
 	if ((unknown = new_group_info()) == NULL) {
 		free_fairshare_head(head);
@@ -398,7 +413,7 @@ preload_tree()
 	unknown->resgroup = 0;
 	unknown->cresgroup = 1;
 	unknown->parent = root;
-	add_child(unknown, root);
+	add_child(unknown, root, head);
 	return head;
 }
 
@@ -723,7 +738,7 @@ read_usage(const char *filename, int flags, fairshare_head *fhead)
 						error = 1;
 				}
 				if (!error)
-					read_usage_v2(fp, flags, fhead->root);
+					read_usage_v2(fp, flags, fhead);
 			}
 			else
 				error = 1;
@@ -735,7 +750,7 @@ read_usage(const char *filename, int flags, fairshare_head *fhead)
 		}
 		else	 { /* original headerless usage file */
 			rewind(fp);
-			read_usage_v1(fp, fhead->root);
+			read_usage_v1(fp, fhead);
 		}
 	}
 
@@ -747,7 +762,7 @@ read_usage(const char *filename, int flags, fairshare_head *fhead)
  * 		read version 1 usage file
  *
  * @param[in]	fp	-	the file pointer to the open file
- * @param[in]	root	-	root of the fairshare tree
+ * @param[in]	fhead	-	head of the fairshare tree
  *
  * @return	int
  *	@retval	1	: success
@@ -755,7 +770,7 @@ read_usage(const char *filename, int flags, fairshare_head *fhead)
  *
  */
 int
-read_usage_v1(FILE *fp, group_info *root)
+read_usage_v1(FILE *fp, fairshare_head *fhead)
 {
 	struct group_node_usage_v1 grp;
 	group_info *ginfo;
@@ -766,7 +781,7 @@ read_usage_v1(FILE *fp, group_info *root)
 	memset(&grp, 0, sizeof(struct group_node_usage_v1));
 	while (fread(&grp, sizeof(struct group_node_usage_v1), 1, fp)) {
 		if (grp.usage >= 0 && is_valid_pbs_name(grp.name, USAGE_NAME_MAX)) {
-			ginfo = find_alloc_ginfo(grp.name, root);
+			ginfo = find_alloc_ginfo(grp.name, fhead);
 			if (ginfo != NULL) {
 				ginfo->usage = grp.usage;
 				ginfo->temp_usage = grp.usage;
@@ -795,14 +810,14 @@ read_usage_v1(FILE *fp, group_info *root)
  *
  * @param[in]	fp	- the file pointer to the open file
  * @param[in]	flags	- flags to check whether to trim or not.
- * @param[in]	root	- root of the fairshare tree
+ * @param[in]	fhead	- head of the fairshare tree
  *
  *	@retval 1 success
  *	@retval 0 failure
  *
  */
 int
-read_usage_v2(FILE *fp, int flags, group_info *root)
+read_usage_v2(FILE *fp, int flags, fairshare_head *fhead)
 {
 	struct group_node_usage_v2 grp;
 	group_info *ginfo;
@@ -818,9 +833,9 @@ read_usage_v2(FILE *fp, int flags, group_info *root)
 			 * already in the resource_group file
 			 */
 			if (flags & FS_TRIM)
-				ginfo = find_group_info(grp.name, root);
+				ginfo = find_group_info(grp.name, fhead);
 			else
-				ginfo = find_alloc_ginfo(grp.name, root);
+				ginfo = find_alloc_ginfo(grp.name, fhead);
 
 			if (ginfo != NULL) {
 				ginfo->usage = grp.usage;
@@ -953,11 +968,12 @@ over_fs_usage(group_info *ginfo)
  *
  * @param[in]	root	-	root of the tree
  * @param[in] nparent	-	the parent of the root in the new dup'd tree
+ * @param[in,out] nfhead	-	head of the new dup'd tree
  *
  * @return	duplicated fairshare tree
  */
 group_info *
-dup_fairshare_tree(group_info *root, group_info *nparent)
+dup_fairshare_tree(group_info *root, group_info *nparent, fairshare_head *nfhead)
 {
 	group_info *nroot;
 	if (root == NULL)
@@ -976,6 +992,7 @@ dup_fairshare_tree(group_info *root, group_info *nparent)
 	nroot->group_percentage = root->group_percentage;
 	nroot->usage = root->usage;
 	nroot->usage_factor = root->usage_factor;
+	nroot->usage_factor_gen = root->usage_factor_gen;
 	nroot->temp_usage = root->temp_usage;
 	nroot->name = string_dup(root->name);
 
@@ -984,11 +1001,14 @@ dup_fairshare_tree(group_info *root, group_info *nparent)
 		return NULL;
 	}
 
-	add_child(nroot, nparent);
+	if (nparent == NULL)
+		nfhead->ginfo_by_name[nroot->name] = nroot;
+	else
+		add_child(nroot, nparent, nfhead);
 
 
-	nroot->sibling = dup_fairshare_tree(root->sibling, nparent);
-	nroot->child = dup_fairshare_tree(root->child, nroot);
+	nroot->sibling = dup_fairshare_tree(root->sibling, nparent, nfhead);
+	nroot->child = dup_fairshare_tree(root->child, nroot, nfhead);
 
 	return nroot;
 }
@@ -1036,13 +1056,14 @@ new_fairshare_head()
 {
 	fairshare_head *fhead;
 
-	if ((fhead = static_cast<fairshare_head *>(malloc(sizeof(fairshare_head)))) == NULL) {
+	if ((fhead = new fairshare_head()) == NULL) {
 		log_err(errno, __func__, MEM_ERR_MSG);
 		return NULL;
 	}
 
 	fhead->root = NULL;
 	fhead->last_decay = 0;
+	fhead->usage_gen = 1;
 
 	return fhead;
 }
@@ -1070,7 +1091,9 @@ dup_fairshare_head(fairshare_head *ofhead)
 		return NULL;
 
 	nfhead->last_decay = ofhead->last_decay;
-	nfhead->root = dup_fairshare_tree(ofhead->root, NULL);
+	nfhead->usage_gen = ofhead->usage_gen;
+	nfhead->ginfo_by_name.reserve(ofhead->ginfo_by_name.size());
+	nfhead->root = dup_fairshare_tree(ofhead->root, NULL, nfhead);
 	if (nfhead->root == NULL) {
 		free_fairshare_head(nfhead);
 		return NULL;
@@ -1093,7 +1116,7 @@ free_fairshare_head(fairshare_head *fhead)
 
 	free_fairshare_tree(fhead->root);
 
-	free(fhead);
+	delete fhead;
 }
 
 /**
@@ -1117,54 +1140,62 @@ reset_temp_usage(group_info *head)
 
 /**
  * @brief
- *		recursive helper function to calc_usage_factor()
- * @param root	- parent fairshare tree node
- * @param ginfo	- child fairshare tree node
+ *		invalidate the usage_factor numbers of the entire tree.  Call it
+ *		whenever the usage of the tree changed.  Since every usage_factor
+ *		is relative to the root's usage, any change touches the whole tree,
+ *		so the numbers are only recalculated by get_usage_factor(), for the
+ *		paths that are actually consulted.
+ *
+ * @param[in] tree - fairshare tree
  *
  * @return void
  */
-static void
-calc_usage_factor_rec(group_info *root, group_info *ginfo)
+void
+calc_usage_factor(fairshare_head *tree)
 {
-	float usage;
-
-	if (root == NULL || ginfo == NULL)
+	if (tree == NULL)
 		return;
 
-	usage = ginfo->usage / root->usage;
-	ginfo->usage_factor = usage + ((ginfo->parent->usage_factor - usage) * ginfo->group_percentage);
-
-	calc_usage_factor_rec(root, ginfo->sibling);
-	calc_usage_factor_rec(root, ginfo->child);
+	tree->usage_gen++;
 }
 
 /**
  * @brief
- *		calculate usage_factor numbers for entire tree.
+ *		return the usage_factor of a fairshare tree node.
  *		The usage_factor is a number that takes the node's usage
  *		plus part of its parent's usage_factor into account.  This
  *		will give a number that is comparable across the tree.
+ *		It is recalculated, along with any stale usage_factor up the
+ *		path to the root, if the tree's usage changed since it was
+ *		last calculated.
  *
  * @param[in] tree - fairshare tree
+ * @param[in] ginfo - the node
  *
- * @return void
+ * @return usage_factor of ginfo
  */
-void
-calc_usage_factor(fairshare_head *tree)
+float
+get_usage_factor(fairshare_head *tree, group_info *ginfo)
 {
-	group_info *ginfo;
 	group_info *root;
+	float usage;
 
-	if (tree == NULL)
-		return;
+	if (tree == NULL || ginfo == NULL)
+		return 0;
 
 	root = tree->root;
+	if (ginfo == root || ginfo->usage_factor_gen == tree->usage_gen)
+		return ginfo->usage_factor;
+
+	usage = ginfo->usage / root->usage;
 	/* Root's children use their real usage as their arbitrary usage */
-	for (ginfo = root->child; ginfo != NULL; ginfo = ginfo->sibling) {
-		ginfo->usage_factor = ginfo->usage / root->usage;
-		calc_usage_factor_rec(root, ginfo->child);
-	}
+	if (ginfo->parent == root)
+		ginfo->usage_factor = usage;
+	else
+		ginfo->usage_factor = usage + ((get_usage_factor(tree, ginfo->parent) - usage) * ginfo->group_percentage);
+	ginfo->usage_factor_gen = tree->usage_gen;
 
+	return ginfo->usage_factor;
 }
 
 /**
@@ -44,20 +44,19 @@
 /*
  *      add_child - add a ginfo to the resource group tree
  */
-void add_child(group_info *ginfo, group_info *parent);
+void add_child(group_info *ginfo, group_info *parent, fairshare_head *fhead);
 
 /*
- *      find_group_info - recursive function to find a ginfo in the
- resgroup tree
+ *      find_group_info - find a ginfo in the resgroup tree by name
  */
-group_info *find_group_info(const char *name, group_info *root);
+group_info *find_group_info(const char *name, fairshare_head *fhead);
 
 /*
  *      find_alloc_ginfo - trys to find a ginfo in the fair share tree.  If it
  *                        can not find the ginfo, then allocate a new one and
  *                        add it to the "unknown" group
  */
-group_info *find_alloc_ginfo(char *name, group_info *root);
+group_info *find_alloc_ginfo(char *name, fairshare_head *fhead);
 
 
 /*
@@ -87,7 +86,7 @@ group_info * new_group_info();
  *	  shares  - the amount of shares the user/group has in its resgroup
  *
  */
-int parse_group(const char *fname, group_info *root);
+int parse_group(const char *fname, fairshare_head *fhead);
 
 /*
  *
@@ -151,12 +150,12 @@ void read_usage(const char *filename, int flags, fairshare_head *fhead);
 /*
  *      read_usage_v1 - read version 1 usage file
  */
-int read_usage_v1(FILE *fp, group_info *root);
+int read_usage_v1(FILE *fp, fairshare_head *fhead);
 
 /*
  *      read_usage_v2 - read version 2 usage file
  */
-int read_usage_v2(FILE *fp, int flags, group_info *root);
+int read_usage_v2(FILE *fp, int flags, fairshare_head *fhead);
 
 /*
  *      new_group_path - create a new group_path structure and init it
@@ -196,10 +195,11 @@ int over_fs_usage(group_info *ginfo);
  *
  *	  root - root of the tree
  *	  nparent - the parent of the root in the "new" duplicated tree
+ *	  nfhead - head of the "new" duplicated tree
  *
  *	return duplicated fairshare tree
  */
-group_info *dup_fairshare_tree(group_info *root, group_info *nparent);
+group_info *dup_fairshare_tree(group_info *root, group_info *nparent, fairshare_head *nfhead);
 
 /*
  *	free_fairshare_tree - free the entire fairshare tree
@@ -240,12 +240,12 @@ void free_fairshare_head(fairshare_head *fhead);
  *	add_unknown - add a ginfo to the "unknown" group
  *
  *	  ginfo - ginfo to add
- *	  root  - root of fairshare tre
+ *	  fhead - head of fairshare tree
  *
  *	return nothing
  *
  */
-void add_unknown(group_info *ginfo, group_info *root);
+void add_unknown(group_info *ginfo, fairshare_head *fhead);
 
 /*
  * 	reset_temp_usage - walk the fairshare tree resetting temp_usage = usage
@@ -259,9 +259,12 @@ void reset_temp_usage(group_info *head);
 /* reset the tree to 1 usage */
 void reset_usage(group_info *node);
 
-/* Calculate the arbitrary usage of the tree */
+/* Invalidate the arbitrary usage of the tree after its usage changed */
 void calc_usage_factor(fairshare_head *tree);
 
+/* Return the arbitrary usage of a node, calculating it if stale */
+float get_usage_factor(fairshare_head *tree, group_info *ginfo);
+
 
 
 #endif	/* _FAIRSHARE_H */
@@ -61,8 +61,10 @@
 #include <time.h>
 #include <log.h>
 #include <pwd.h>
+#include <signal.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <fcntl.h>
 #include "fifo.h"
 #include "queue_info.h"
@@ -95,6 +97,7 @@
 #include "multi_threading.h"
 #include "pbs_python.h"
 #include "libpbs.h"
+#include "profile.h"
 
 #ifdef NAS
 #include "site_code.h"
@@ -104,6 +107,11 @@
 static prev_job_info *last_running = NULL;
 static int last_running_size = 0;
 
+/* background start time estimation helper (see estimate_start_times()) */
+static pid_t est_helper_pid = -1;	/* pid of the running helper or -1 */
+static time_t last_est_time = 0;	/* when the last helper was started */
+static int in_est_helper = 0;		/* are we the helper process? */
+
 /**
  * @brief
  * 		initialize conf struct and parse conf files
@@ -150,7 +158,7 @@ schedinit(int nthreads)
 	/* preload the static members to the fairshare tree */
 	conf.fairshare = preload_tree();
 	if (conf.fairshare != NULL) {
-		parse_group(RESGROUP_FILE, conf.fairshare->root);
+		parse_group(RESGROUP_FILE, conf.fairshare);
 		calc_fair_share_perc(conf.fairshare->root->child, UNSPECIFIED);
 		read_usage(USAGE_FILE, 0, conf.fairshare);
 
@@ -354,7 +362,7 @@ init_scheduling_cycle(status *policy, int pbs_sd, server_info *sinfo)
 			for (i = 0; i < last_running_size ; i++) {
 				if (last_running[i].name != NULL) {
 					user = find_alloc_ginfo(last_running[i].entity_name,
-								sinfo->fairshare->root);
+								sinfo->fairshare);
 
 					if (user != NULL) {
 						for (j = 0; sinfo->running_jobs[j] != NULL &&
@@ -613,6 +621,9 @@ scheduling_cycle(int sd, const sched_cmd *cmd)
 	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
 		  "", "Starting Scheduling Cycle");
 
+	/* the helper's estimates are older than the ones this cycle will send */
+	reap_est_helper(1);
+
 	/* Decide whether we need to send "can't run" type updates this cycle */
 	if (time(NULL) - last_attr_updates >= sc_attrs.attr_update_period)
 		send_job_attr_updates = 1;
@@ -620,6 +631,7 @@ scheduling_cycle(int sd, const sched_cmd *cmd)
 		send_job_attr_updates = 0;
 
 	update_cycle_status(&cstat, 0);
+	prof_cycle_start();
 
 #ifdef NAS /* localmod 030 */
 	do_soft_cycle_interrupt = 0;
@@ -691,6 +703,10 @@ scheduling_cycle(int sd, const sched_cmd *cmd)
 	if (error == 0)
 		rc = main_sched_loop(policy, sd, sinfo, &err);
 
+	/* estimate the jobs the main loop did not calendar off to the side */
+	if (error == 0 && rc >= 0 && cmd->jid == NULL)
+		estimate_start_times(policy, sinfo);
+
 	if (cmd->jid != NULL) {
 		int def_rc = -1;
 		int i;
@@ -841,6 +857,7 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 	int sort_again = DONT_SORT_JOBS;
 	schd_error *err;
 	schd_error *chk_lim_err;
+	std::vector<resource_resv *> pending_updates;	/* jobs with attribute updates to send */
 
 
 	if (policy == NULL || sinfo == NULL || rerr == NULL)
@@ -859,6 +876,10 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		return -1;
 	}
 
+	/* find the equivalence classes which can't fit anywhere up front */
+	if (conf.speculative_job_eval && sinfo->qrun_job == NULL)
+		speculate_resresv_sets(policy, sinfo);
+
 	/* main scheduling loop */
 #ifdef NAS
 	/* localmod 030 */
@@ -1120,10 +1141,17 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		}
 #endif /* localmod 030 */
 
-		/* send any attribute updates to server that we've collected */
-		send_job_updates(sd, njob);
+		/* collect attribute updates to send to the server in bulk */
+		if (njob->job->attr_updates != NULL) {
+			pending_updates.push_back(njob);
+			if (pending_updates.size() >= MAX_PENDING_JOB_UPDATES)
+				send_jobs_updates(sd, pending_updates);
+		}
 	}
 
+	/* send any attribute updates to server that we've collected */
+	send_jobs_updates(sd, pending_updates);
+
 	*rerr = err;
 
 	free_schd_error(chk_lim_err);
@@ -1153,6 +1181,9 @@ schedexit(void)
 		}
 	}
 
+	/* don't leave an estimation helper behind */
+	reap_est_helper(1);
+
 	/* Kill all worker threads */
 	if (num_threads > 1) {
 		int *thid;
@@ -1187,6 +1218,8 @@ end_cycle_tasks(server_info *sinfo)
 	 */
 	if (sinfo != NULL) {
 		sinfo->fairshare = NULL;
+		/* keep the nodes which can be reused by the next cycle's query */
+		hand_back_queried_nodes(sinfo);
 		free_server(sinfo);	/* free server and queues and jobs */
 	}
 
@@ -1209,6 +1242,8 @@ end_cycle_tasks(server_info *sinfo)
 
 	got_sigpipe = 0;
 
+	prof_cycle_end();
+
 	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
 		"", "Leaving Scheduling Cycle");
 }
@@ -1254,58 +1289,88 @@ clear_last_running()
 
 /**
  * @brief
- *		update_job_can_not_run - do post job 'can't run' processing
+ *		set_job_can_not_run - do post job 'can't run' processing
  *				 mark it 'can_not_run'
  *				 update the job comment and log the reason why
  *				 take care of deleting a 'can_never_run job
  *
+ * @par	The attribute updates are only attached to the job.  It is up to the
+ *	caller to send them, either right away with send_job_updates() or
+ *	together with other jobs' with send_jobs_updates().
+ *
  * @param[in]	pbs_sd	-	the connection descriptor to the server
  * @param[in,out]	job	-	the job to update
  * @param[in]	err	-	the error structure for why the job can't run
  *
  * @return	int
- * @retval	1	: success
- * @retval	0	: failure.
+ * @retval	1	: the job's comment and accrue type were updated
+ * @retval	0	: nothing was updated
  *
  */
 int
-update_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err)
+set_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err)
 {
 	char comment_buf[MAX_LOG_SIZE];	/* buffer for comment message */
 	char log_buf[MAX_LOG_SIZE];		/* buffer for log message */
-	int ret = 1;				/* return code for function */
 
 
 	job->can_not_run = 1;
 
 	if ((job == NULL) || (err == NULL) || (job->job == NULL))
-		return ret;
-
-	if (translate_fail_code(err, comment_buf, log_buf)) {
-		/* don't attempt to update the comment on a remote job and on an array job */
-		if (!job->is_peer_ob && (!job->job->is_array || !job->job->is_begin))
-			update_job_comment(pbs_sd, job, comment_buf);
+		return 0;
 
-		/* not attempting to update accrue type on a remote job */
-		if (!job->is_peer_ob) {
-			if (job->job != NULL)
-				set_preempt_prio(job, job->job->queue, job->server);
-			update_accruetype(pbs_sd, job->server, ACCRUE_CHECK_ERR, err->error_code, job);
-		}
+	if (!translate_fail_code(err, comment_buf, log_buf))
+		return 0;
 
-		if (log_buf[0] != '\0')
-			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO,
-				job->name, log_buf);
+	/* don't attempt to update the comment on a remote job and on an array job */
+	if (!job->is_peer_ob && (!job->job->is_array || !job->job->is_begin))
+		update_job_comment(pbs_sd, job, comment_buf);
 
-		/* We won't be looking at this job in main_sched_loop()
-		 * and we just updated some attributes just above.  Send Now.
-		 */
-		send_job_updates(pbs_sd, job);
+	/* not attempting to update accrue type on a remote job */
+	if (!job->is_peer_ob) {
+		if (job->job != NULL)
+			set_preempt_prio(job, job->job->queue, job->server);
+		update_accruetype(pbs_sd, job->server, ACCRUE_CHECK_ERR, err->error_code, job);
 	}
-	else
-		ret = 0;
 
-	return ret;
+	if (log_buf[0] != '\0')
+		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO,
+			job->name, log_buf);
+
+	return 1;
+}
+
+/**
+ * @brief
+ *		update_job_can_not_run - set_job_can_not_run() and send the
+ *				 job's attribute updates to the server
+ *
+ * @param[in]	pbs_sd	-	the connection descriptor to the server
+ * @param[in,out]	job	-	the job to update
+ * @param[in]	err	-	the error structure for why the job can't run
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure.
+ *
+ */
+int
+update_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err)
+{
+	job->can_not_run = 1;
+
+	if ((job == NULL) || (err == NULL) || (job->job == NULL))
+		return 1;
+
+	if (!set_job_can_not_run(pbs_sd, job, err))
+		return 0;
+
+	/* We won't be looking at this job in main_sched_loop()
+	 * and we just updated some attributes just above.  Send Now.
+	 */
+	send_job_updates(pbs_sd, job);
+
+	return 1;
 }
 
 /**
@@ -1725,20 +1790,8 @@ run_update_resresv(status *policy, int pbs_sd, server_info *sinfo,
 		}
 
 		if (ns != NULL) {
-			int sort_nodepart = 0;
 			for (i = 0; ns[i] != NULL; i++) {
-				int j;
 				update_node_on_run(ns[i], rr, &old_state);
-				if (ns[i]->ninfo->np_arr != NULL) {
-					node_partition **npar = ns[i]->ninfo->np_arr;
-					for (j = 0; npar[j] != NULL; j++) {
-						modify_resource_list(npar[j]->res, ns[i]->resreq, SCHD_INCR);
-						if (!ns[i]->ninfo->is_free)
-							npar[j]->free_nodes--;
-						sort_nodepart = 1;
-						update_buckets_for_node(npar[j]->bkts, ns[i]->ninfo);
-					}
-				}
 				/* if the node is being provisioned, it's brought down in
 				 * update_node_on_run().  We need to add an event in the calendar to
 				 * bring it back up.
@@ -1750,8 +1803,9 @@ run_update_resresv(status *policy, int pbs_sd, server_info *sinfo,
 					}
 				}
 			}
-			if (sort_nodepart)
-				sort_all_nodepart(policy, sinfo);
+			/* fold the nodes' changes into their placement sets */
+			if (sinfo->pset_metadata_stale)
+				update_all_nodepart(policy, sinfo, NO_ALLPART);
 		}
 
 		update_queue_on_run(qinfo, rr, &old_state);
@@ -1989,7 +2043,7 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 		 * Note: We only ever look from now into the future
 		 */
 		nexte = get_next_event(sinfo->calendar);
-		if (find_timed_event(nexte, IGNORE_DISABLED_EVENTS, topjob->name, TIMED_NOEVENT, 0) != NULL)
+		if (find_event_by_name(sinfo->calendar, nexte, IGNORE_DISABLED_EVENTS, topjob->name, TIMED_NOEVENT, 0) != NULL)
 			return 1;
 	}
 	if ((nsinfo = dup_server_info(sinfo)) == NULL)
@@ -2005,8 +2059,12 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
 		   topjob->name, "Estimating the start time for a top job (q=%s schedselect=%.1000s).", topjob->job->queue->name, topjob->job->schedsel);
 #else
-	log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
-		topjob->name, "Estimating the start time for a top job.");
+	if (in_est_helper)
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+			topjob->name, "Estimating the start time for a job in the background.");
+	else
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+			topjob->name, "Estimating the start time for a top job.");
 #endif /* localmod 031 */
 	if(use_buckets)
 		start_time = calc_run_time(njob->name, nsinfo, SIM_RUN_JOB|USE_BUCKETS);
@@ -2108,6 +2166,8 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 
 		for (i = 0; bjob->nspec_arr[i] != NULL; i++) {
 			int ind = bjob->nspec_arr[i]->ninfo->node_ind;
+			/* the node's placement set buckets now need to see it as busy later */
+			mark_node_pset_dirty(bjob->nspec_arr[i]->ninfo);
 			add_te_list(&(bjob->nspec_arr[i]->ninfo->node_events), te_start);
 
 			if (ind != -1 && sinfo->unordered_nodes[ind]->bucket_ind != -1) {
@@ -2136,7 +2196,8 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 				"Fairshare usage of entity %s increased due to job becoming a top job.", bjob->job->ginfo->name);
 		}
 
-		sprintf(log_buf, "Job is a top job and will run at %s",
+		sprintf(log_buf, "Job %s at %s",
+			in_est_helper ? "is estimated to run" : "is a top job and will run",
 			ctime(&bjob->start));
 
 		log_buf[strlen(log_buf)-1] = '\0';	/* ctime adds a \n */
@@ -2153,6 +2214,153 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 }
 
 
+/**
+ * @brief
+ *		reap_est_helper - reap the start time estimation helper if it has
+ *			exited, and optionally stop it if it has not
+ *
+ * @par
+ *		A helper works from the universe of the cycle which started it.  Once
+ *		a new cycle starts, the estimates the helper has yet to send are older
+ *		than the ones the new cycle sends for its top jobs and would overwrite
+ *		them, so it is stopped.  What it already sent is kept.
+ *
+ * @param[in]	stop	-	stop the helper if it is still running
+ *
+ * @return	void
+ */
+void
+reap_est_helper(int stop)
+{
+	if (est_helper_pid <= 0)
+		return;
+
+	if (waitpid(est_helper_pid, NULL, WNOHANG) != 0) {
+		est_helper_pid = -1;
+		return;
+	}
+
+	if (!stop)
+		return;
+
+	log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+		"Stopping the start time estimation of the previous cycle");
+	kill(est_helper_pid, SIGTERM);
+	waitpid(est_helper_pid, NULL, 0);
+	est_helper_pid = -1;
+}
+
+/**
+ * @brief
+ *		estimate_start_times - estimate the start times of the queued jobs
+ *			the main loop did not add to the calendar
+ *
+ * @par
+ *		The main loop only estimates its top jobs.  Estimating every other
+ *		queued job would hold up the next cycle, so it is done by a forked
+ *		helper working on its copy of the universe as the main loop left it.
+ *		The helper adds the jobs to its calendar in priority order, as if
+ *		each one were a top job, and sends the estimated attributes to the
+ *		server in bulk over its own connection.  A helper is started at most
+ *		every est_start_time_freq seconds and only one runs at a time.  It is
+ *		stopped when the next cycle starts, see reap_est_helper().
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	sinfo	-	the universe at the end of the main loop
+ *
+ * @return	void
+ */
+void
+estimate_start_times(status *policy, server_info *sinfo)
+{
+	int pbs_sd;
+	int i;
+	int num_est = 0;
+	time_t now;
+	std::vector<resource_resv *> pending_updates;
+
+	if (policy == NULL || sinfo == NULL || sinfo->jobs == NULL || sinfo->calendar == NULL)
+		return;
+
+	if (conf.est_start_time_freq <= 0)
+		return;
+
+	reap_est_helper(0);
+	if (est_helper_pid > 0) {
+		log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Previous start time estimation is still running");
+		return;
+	}
+
+	now = time(NULL);
+	if (now - last_est_time < conf.est_start_time_freq)
+		return;
+
+	switch (est_helper_pid = fork()) {
+		case -1:
+			log_err(errno, __func__, "fork failed");
+			return;
+		case 0:
+			break;
+		default:
+			last_est_time = now;
+			return;
+	}
+
+	/* child: don't take the scheduler's signal handling with us */
+	signal(SIGHUP, SIG_DFL);
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+	signal(SIGSEGV, SIG_DFL);
+	signal(SIGBUS, SIG_DFL);
+
+	/* the worker threads were not carried across the fork */
+	num_threads = 1;
+	in_est_helper = 1;
+	est_helper_pid = -1;
+
+	/* the helper only runs every est_start_time_freq, so send all estimates */
+	send_job_attr_updates = 1;
+
+	pbs_sd = pbs_connect(NULL);
+	if (pbs_sd < 0) {
+		log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, __func__,
+			"Could not connect to the server to estimate start times: %d", pbs_errno);
+		_exit(1);
+	}
+
+	for (i = 0; sinfo->jobs[i] != NULL && !got_sigpipe; i++) {
+		resource_resv *job = sinfo->jobs[i];
+
+		if (time(NULL) - now >= conf.est_start_time_freq) {
+			log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+				"Start time estimation ran out of time");
+			break;
+		}
+
+		if (job->job == NULL || job->is_peer_ob || job->can_never_run ||
+			job->job->resv != NULL || !in_runnable_state(job))
+			continue;
+
+		if (add_job_to_calendar(pbs_sd, policy, sinfo, job, job_should_use_buckets(job)) <= 0)
+			continue;
+
+		if (job->job->attr_updates != NULL) {
+			num_est++;
+			pending_updates.push_back(job);
+			if (pending_updates.size() >= MAX_PENDING_JOB_UPDATES)
+				send_jobs_updates(pbs_sd, pending_updates);
+		}
+	}
+	send_jobs_updates(pbs_sd, pending_updates);
+
+	log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+		"Estimated the start times of %d jobs in %ld seconds", num_est, (long)(time(NULL) - now));
+
+	pbs_disconnect(pbs_sd);
+	_exit(0);
+}
+
 /**
  * @brief
  *		find_ready_resv_job - find a job in a reservation which can run
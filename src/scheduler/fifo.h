@@ -172,11 +172,17 @@ run_update_resresv(status *policy, int pbs_sd, server_info *sinfo, queue_info *q
 
 
 /*
- *	update_job_can_not_run - do post job 'can't run' processing
+ *	set_job_can_not_run - do post job 'can't run' processing
  *				 mark it 'can_not_run'
  *				 update the job comment and log the reason why
  *				 take care of deleting a 'can_never_run job
  */
+int set_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err);
+
+/*
+ *	update_job_can_not_run - set_job_can_not_run() and send the job's
+ *				 attribute updates to the server
+ */
 int update_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err);
 
 /*
@@ -195,6 +201,18 @@ void end_cycle_tasks(server_info *sinfo);
  */
 int add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo, resource_resv *topjob, int use_buckets);
 
+/*
+ *	estimate_start_times - estimate the start times of the queued jobs
+ *		the main loop did not add to the calendar in a forked helper
+ */
+void estimate_start_times(status *policy, server_info *sinfo);
+
+/*
+ *	reap_est_helper - reap the start time estimation helper if it has
+ *		exited, and optionally stop it if it has not
+ */
+void reap_est_helper(int stop);
+
 /*
  * 	run_job - handle the running of a pbs job.  If it's a peer job
  *	       first move it to the local server and then run it.
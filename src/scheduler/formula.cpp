@@ -0,0 +1,711 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+/**
+ * @file    formula.cpp
+ *
+ * @brief
+ * 		formula.cpp - This file contains the scheduler's native evaluator for
+ *		math formulas such as job_sort_formula and fairshare_usage_res.
+ *
+ *		A formula is compiled once into a small postfix program and the
+ *		program is then run for every job.  Only the part of python's
+ *		expression syntax which formulas use is understood: numbers,
+ *		resource names, formula keywords, + - * / // % **, unary + and -,
+ *		parentheses and the min(), max(), abs() and pow() builtins.  Any
+ *		other formula is left to the embedded python interpreter.
+ *
+ * Functions included are:
+ * 	formula_native_evaluate()
+ * 	clear_formula_cache()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <pbs_ifl.h>
+#include <log.h>
+#include <pbs_share.h>
+#include "formula.h"
+#include "constant.h"
+#include "globals.h"
+#include "resource_resv.h"
+#include "fairshare.h"
+
+/* instructions of a compiled formula */
+enum formula_op {
+	FOP_CONST,
+	FOP_RES,
+	FOP_ELIGIBLE_TIME,
+	FOP_QUEUE_PRIO,
+	FOP_JOB_PRIO,
+	FOP_FSPERC,
+	FOP_TREE_USAGE,
+	FOP_FSFACTOR,
+	FOP_ACCRUE_TYPE,
+	FOP_NEG,
+	FOP_ABS,
+	FOP_ADD,
+	FOP_SUB,
+	FOP_MUL,
+	FOP_DIV,
+	FOP_FLOORDIV,
+	FOP_MOD,
+	FOP_POW,
+	FOP_MIN,
+	FOP_MAX
+};
+
+struct formula_insn {
+	enum formula_op op;
+	double value;	/* FOP_CONST: the constant */
+	resdef *def;	/* FOP_RES: the resource */
+	int nargs;	/* FOP_MIN/FOP_MAX: number of arguments */
+};
+
+/* deepest evaluation stack (and parser nesting) a compiled formula may use */
+#define FORMULA_MAX_DEPTH 64
+
+struct formula_parser {
+	const char *p;				/* current position in the formula */
+	std::vector<formula_insn> code;		/* program compiled so far */
+	int depth;				/* stack depth after code runs */
+	int nest;				/* recursion depth of the parser */
+	int ok;					/* 0 if the formula can't be compiled */
+};
+
+static const struct {
+	const char *name;
+	enum formula_op op;
+} formula_keywords[] = {
+	{FORMULA_ELIGIBLE_TIME, FOP_ELIGIBLE_TIME},
+	{FORMULA_QUEUE_PRIO, FOP_QUEUE_PRIO},
+	{FORMULA_JOB_PRIO, FOP_JOB_PRIO},
+	{FORMULA_FSPERC, FOP_FSPERC},
+	{FORMULA_FSPERC_DEP, FOP_FSPERC},
+	{FORMULA_TREE_USAGE, FOP_TREE_USAGE},
+	{FORMULA_FSFACTOR, FOP_FSFACTOR},
+	{FORMULA_ACCRUE_TYPE, FOP_ACCRUE_TYPE}
+};
+
+/*
+ * compiled formulas keyed by formula text.  An empty program means the
+ * formula uses syntax we don't understand and python has to evaluate it.
+ * Resource references point into consres, so the cache is cleared whenever
+ * the resource definitions are.
+ */
+static std::unordered_map<std::string, std::vector<formula_insn>> formula_cache;
+
+static void parse_expr(formula_parser *fp);
+static void parse_unary(formula_parser *fp);
+
+/**
+ * @brief
+ *		append an instruction to the program being compiled and track
+ *		how deep the evaluation stack gets
+ *
+ * @param[in,out]	fp	-	parser
+ * @param[in]	op	-	instruction
+ * @param[in]	value	-	constant for FOP_CONST
+ * @param[in]	def	-	resource for FOP_RES
+ * @param[in]	nargs	-	number of arguments for FOP_MIN/FOP_MAX
+ *
+ * @return	void
+ */
+static void
+emit_insn(formula_parser *fp, enum formula_op op, double value, resdef *def, int nargs)
+{
+	formula_insn insn;
+
+	insn.op = op;
+	insn.value = value;
+	insn.def = def;
+	insn.nargs = nargs;
+	fp->code.push_back(insn);
+
+	switch (op) {
+		case FOP_NEG:
+		case FOP_ABS:
+			break;
+		case FOP_ADD:
+		case FOP_SUB:
+		case FOP_MUL:
+		case FOP_DIV:
+		case FOP_FLOORDIV:
+		case FOP_MOD:
+		case FOP_POW:
+			fp->depth--;
+			break;
+		case FOP_MIN:
+		case FOP_MAX:
+			fp->depth -= nargs - 1;
+			break;
+		default:
+			fp->depth++;
+	}
+	if (fp->depth > FORMULA_MAX_DEPTH)
+		fp->ok = 0;
+}
+
+/**
+ * @brief
+ *		skip the blanks python would ignore inside an expression
+ *
+ * @param[in,out]	fp	-	parser
+ *
+ * @return	void
+ */
+static void
+skip_blanks(formula_parser *fp)
+{
+	while (*fp->p == ' ' || *fp->p == '\t')
+		fp->p++;
+}
+
+/**
+ * @brief
+ *		parse a python number literal.  Hex/octal/binary literals,
+ *		underscores and imaginary numbers are not supported.
+ *
+ * @param[in,out]	fp	-	parser
+ *
+ * @return	void
+ */
+static void
+parse_number(formula_parser *fp)
+{
+	const char *start = fp->p;
+	const char *s = fp->p;
+	int is_int = 1;
+	std::string num;
+
+	while (isdigit(*s))
+		s++;
+	if (*s == '.') {
+		is_int = 0;
+		s++;
+		while (isdigit(*s))
+			s++;
+	}
+	if (*s == 'e' || *s == 'E') {
+		is_int = 0;
+		s++;
+		if (*s == '+' || *s == '-')
+			s++;
+		if (!isdigit(*s)) {
+			fp->ok = 0;
+			return;
+		}
+		while (isdigit(*s))
+			s++;
+	}
+	if (isalnum(*s) || *s == '_' || *s == '.') {
+		fp->ok = 0;
+		return;
+	}
+	/* python rejects integers with leading zeros like 012 */
+	if (is_int && start[0] == '0' && strspn(start, "0") < (size_t)(s - start)) {
+		fp->ok = 0;
+		return;
+	}
+
+	num.assign(start, s - start);
+	fp->p = s;
+	emit_insn(fp, FOP_CONST, strtod(num.c_str(), NULL), NULL, 0);
+}
+
+/**
+ * @brief
+ *		parse a name: a builtin function call, a formula keyword or a
+ *		consumable resource
+ *
+ * @param[in,out]	fp	-	parser
+ *
+ * @return	void
+ */
+static void
+parse_name(formula_parser *fp)
+{
+	const char *start = fp->p;
+	std::string name;
+	int i;
+
+	while (isalnum(*fp->p) || *fp->p == '_')
+		fp->p++;
+	name.assign(start, fp->p - start);
+	skip_blanks(fp);
+
+	if (*fp->p == '(') {
+		enum formula_op op;
+		int nargs = 0;
+
+		if (name == "min")
+			op = FOP_MIN;
+		else if (name == "max")
+			op = FOP_MAX;
+		else if (name == "abs")
+			op = FOP_ABS;
+		else if (name == "pow")
+			op = FOP_POW;
+		else {
+			fp->ok = 0;
+			return;
+		}
+
+		fp->p++;
+		skip_blanks(fp);
+		if (*fp->p != ')') {
+			while (fp->ok) {
+				parse_expr(fp);
+				nargs++;
+				skip_blanks(fp);
+				if (*fp->p != ',')
+					break;
+				fp->p++;
+			}
+		}
+		if (!fp->ok || *fp->p != ')') {
+			fp->ok = 0;
+			return;
+		}
+		fp->p++;
+
+		if ((op == FOP_ABS && nargs != 1) || (op == FOP_POW && nargs != 2) ||
+			((op == FOP_MIN || op == FOP_MAX) && nargs < 2)) {
+			fp->ok = 0;
+			return;
+		}
+		emit_insn(fp, op, 0, NULL, nargs);
+		return;
+	}
+
+	/* keywords are set after the resources, so they win on a name clash */
+	for (i = 0; i < (int)(sizeof(formula_keywords) / sizeof(formula_keywords[0])); i++) {
+		if (name == formula_keywords[i].name) {
+			emit_insn(fp, formula_keywords[i].op, 0, NULL, 0);
+			return;
+		}
+	}
+
+	if (consres != NULL) {
+		for (i = 0; consres[i] != NULL; i++) {
+			if (name == consres[i]->name) {
+				emit_insn(fp, FOP_RES, 0, consres[i], 0);
+				return;
+			}
+		}
+	}
+
+	/* python would raise a NameError: let it */
+	fp->ok = 0;
+}
+
+/**
+ * @brief
+ *		primary := number | name | name '(' args ')' | '(' expr ')'
+ *
+ * @param[in,out]	fp	-	parser
+ *
+ * @return	void
+ */
+static void
+parse_primary(formula_parser *fp)
+{
+	skip_blanks(fp);
+	if (*fp->p == '(') {
+		fp->p++;
+		parse_expr(fp);
+		skip_blanks(fp);
+		if (*fp->p != ')') {
+			fp->ok = 0;
+			return;
+		}
+		fp->p++;
+	} else if (isdigit(*fp->p) || (*fp->p == '.' && isdigit(fp->p[1])))
+		parse_number(fp);
+	else if (isalpha(*fp->p) || *fp->p == '_')
+		parse_name(fp);
+	else
+		fp->ok = 0;
+}
+
+/**
+ * @brief
+ *		power := primary ['**' unary]
+ *		** is right associative and binds tighter than a unary minus
+ *		on its left, but not on its right (-2**-1 == -(2**(-1)))
+ *
+ * @param[in,out]	fp	-	parser
+ *
+ * @return	void
+ */
+static void
+parse_power(formula_parser *fp)
+{
+	parse_primary(fp);
+	if (!fp->ok)
+		return;
+	skip_blanks(fp);
+	if (fp->p[0] == '*' && fp->p[1] == '*') {
+		fp->p += 2;
+		parse_unary(fp);
+		emit_insn(fp, FOP_POW, 0, NULL, 0);
+	}
+}
+
+/**
+ * @brief
+ *		unary := ('-' | '+') unary | power
+ *
+ * @param[in,out]	fp	-	parser
+ *
+ * @return	void
+ */
+static void
+parse_unary(formula_parser *fp)
+{
+	if (!fp->ok || ++fp->nest > FORMULA_MAX_DEPTH) {
+		fp->ok = 0;
+		return;
+	}
+	skip_blanks(fp);
+	if (*fp->p == '-') {
+		fp->p++;
+		parse_unary(fp);
+		emit_insn(fp, FOP_NEG, 0, NULL, 0);
+	} else if (*fp->p == '+') {
+		fp->p++;
+		parse_unary(fp);
+	} else
+		parse_power(fp);
+	fp->nest--;
+}
+
+/**
+ * @brief
+ *		term := unary (('*' | '/' | '//' | '%') unary)*
+ *
+ * @param[in,out]	fp	-	parser
+ *
+ * @return	void
+ */
+static void
+parse_term(formula_parser *fp)
+{
+	enum formula_op op;
+
+	parse_unary(fp);
+	while (fp->ok) {
+		skip_blanks(fp);
+		if (fp->p[0] == '*' && fp->p[1] != '*') {
+			op = FOP_MUL;
+			fp->p++;
+		} else if (fp->p[0] == '/' && fp->p[1] == '/') {
+			op = FOP_FLOORDIV;
+			fp->p += 2;
+		} else if (fp->p[0] == '/') {
+			op = FOP_DIV;
+			fp->p++;
+		} else if (fp->p[0] == '%') {
+			op = FOP_MOD;
+			fp->p++;
+		} else
+			break;
+		parse_unary(fp);
+		emit_insn(fp, op, 0, NULL, 0);
+	}
+}
+
+/**
+ * @brief
+ *		expr := term (('+' | '-') term)*
+ *
+ * @param[in,out]	fp	-	parser
+ *
+ * @return	void
+ */
+static void
+parse_expr(formula_parser *fp)
+{
+	enum formula_op op;
+
+	if (!fp->ok || ++fp->nest > FORMULA_MAX_DEPTH) {
+		fp->ok = 0;
+		return;
+	}
+	parse_term(fp);
+	while (fp->ok) {
+		skip_blanks(fp);
+		if (*fp->p == '+')
+			op = FOP_ADD;
+		else if (*fp->p == '-')
+			op = FOP_SUB;
+		else
+			break;
+		fp->p++;
+		parse_term(fp);
+		emit_insn(fp, op, 0, NULL, 0);
+	}
+	fp->nest--;
+}
+
+/**
+ * @brief
+ *		compile a formula into a postfix program
+ *
+ * @param[in]	formula	-	formula to compile
+ *
+ * @return	the program
+ * @retval	empty program	: formula can't be compiled
+ */
+static std::vector<formula_insn>
+compile_formula(const char *formula)
+{
+	formula_parser fp;
+
+	fp.p = formula;
+	fp.depth = 0;
+	fp.nest = 0;
+	fp.ok = 1;
+
+	parse_expr(&fp);
+	skip_blanks(&fp);
+	if (!fp.ok || *fp.p != '\0' || fp.depth != 1)
+		fp.code.clear();
+
+	return fp.code;
+}
+
+/**
+ * @brief
+ *		run a compiled formula for a job
+ *
+ * @param[in]	code	-	compiled formula
+ * @param[in]	resresv	-	job for the formula keywords
+ * @param[in]	resreq	-	resources to use for resource names
+ * @param[out]	ans	-	the answer
+ * @param[out]	errmsg	-	python's error message if evaluation fails
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: python would have raised an exception
+ */
+static int
+run_formula(const std::vector<formula_insn>& code, resource_resv *resresv,
+	resource_req *resreq, double *ans, const char **errmsg)
+{
+	double stack[FORMULA_MAX_DEPTH + 1];
+	group_info *ginfo = resresv->job->ginfo;
+	resource_req *req;
+	double a;
+	double b;
+	int sp = 0;
+	int i;
+
+	for (const auto& insn : code) {
+		switch (insn.op) {
+			case FOP_CONST:
+				stack[sp++] = insn.value;
+				break;
+			case FOP_RES:
+				req = find_resource_req(resreq, insn.def);
+				stack[sp++] = req != NULL ? req->amount : 0;
+				break;
+			case FOP_ELIGIBLE_TIME:
+				stack[sp++] = resresv->job->eligible_time;
+				break;
+			case FOP_QUEUE_PRIO:
+				stack[sp++] = resresv->job->queue != NULL ? resresv->job->queue->priority : 0;
+				break;
+			case FOP_JOB_PRIO:
+				stack[sp++] = resresv->job->priority;
+				break;
+			case FOP_FSPERC:
+				stack[sp++] = ginfo != NULL ? ginfo->tree_percentage : 0;
+				break;
+			case FOP_TREE_USAGE:
+				stack[sp++] = ginfo != NULL ? get_usage_factor(resresv->server->fairshare, ginfo) : 0;
+				break;
+			case FOP_FSFACTOR:
+				if (ginfo == NULL || ginfo->tree_percentage == 0)
+					stack[sp++] = 0;
+				else
+					stack[sp++] = pow(2, -(get_usage_factor(resresv->server->fairshare, ginfo) / ginfo->tree_percentage));
+				break;
+			case FOP_ACCRUE_TYPE:
+				stack[sp++] = resresv->job->accrue_type;
+				break;
+			case FOP_NEG:
+				stack[sp - 1] = -stack[sp - 1];
+				break;
+			case FOP_ABS:
+				stack[sp - 1] = fabs(stack[sp - 1]);
+				break;
+			case FOP_MIN:
+			case FOP_MAX:
+				sp -= insn.nargs;
+				a = stack[sp];
+				for (i = 1; i < insn.nargs; i++) {
+					b = stack[sp + i];
+					if (insn.op == FOP_MIN ? b < a : b > a)
+						a = b;
+				}
+				stack[sp++] = a;
+				break;
+			default:
+				/* binary operators */
+				b = stack[--sp];
+				a = stack[sp - 1];
+				switch (insn.op) {
+					case FOP_ADD:
+						a += b;
+						break;
+					case FOP_SUB:
+						a -= b;
+						break;
+					case FOP_MUL:
+						a *= b;
+						break;
+					case FOP_DIV:
+					case FOP_FLOORDIV:
+					case FOP_MOD:
+						if (b == 0) {
+							*errmsg = "division by zero";
+							return 0;
+						}
+						if (insn.op == FOP_DIV)
+							a /= b;
+						else if (insn.op == FOP_FLOORDIV)
+							a = floor(a / b);
+						else {
+							/* python's modulo takes the sign of the divisor */
+							a = fmod(a, b);
+							if (a != 0 && ((a < 0) != (b < 0)))
+								a += b;
+						}
+						break;
+					case FOP_POW:
+						if (a == 0 && b < 0) {
+							*errmsg = "0.0 cannot be raised to a negative power";
+							return 0;
+						}
+						a = pow(a, b);
+						break;
+					default:
+						break;
+				}
+				stack[sp - 1] = a;
+		}
+	}
+
+	*ans = stack[0];
+	return 1;
+}
+
+/**
+ * @brief
+ *		evaluate a formula for a job with the compiled evaluator.
+ *		The formula is compiled the first time it is seen.
+ *
+ * @param[in]	formula	-	formula to evaluate
+ * @param[in]	resresv	-	job for special case key words
+ * @param[in]	resreq	-	resources to use when evaluating
+ * @param[out]	ans	-	evaluated formula answer or 0 on error
+ *
+ * @return	int
+ * @retval	1	: *ans is set
+ * @retval	0	: the formula needs to be evaluated by python
+ *
+ * @par MT-Safe:	no
+ */
+int
+formula_native_evaluate(const char *formula, resource_resv *resresv,
+	resource_req *resreq, sch_resource_t *ans)
+{
+	const char *errmsg = NULL;
+	double val;
+
+	if (formula == NULL || resresv == NULL || resresv->job == NULL || ans == NULL)
+		return 0;
+
+	auto it = formula_cache.find(formula);
+	if (it == formula_cache.end()) {
+		it = formula_cache.emplace(formula, compile_formula(formula)).first;
+		if (it->second.empty())
+			log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG, __func__,
+				"Formula \"%s\" will be evaluated by python", formula);
+	}
+	if (it->second.empty())
+		return 0;
+
+	if (run_formula(it->second, resresv, resreq, &val, &errmsg) == 0) {
+		log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name,
+			"Formula evaluation for job had an error.  Zero value will be used: %s", errmsg);
+		*ans = 0;
+		return 1;
+	}
+
+	/* overflows and complex results: leave python's behavior alone */
+	if (!isfinite(val))
+		return 0;
+
+	*ans = val;
+	return 1;
+}
+
+/**
+ * @brief
+ *		free all compiled formulas.  Must be called when the resource
+ *		definitions the programs point into go away.
+ *
+ * @return	void
+ */
+void
+clear_formula_cache(void)
+{
+	formula_cache.clear();
+}
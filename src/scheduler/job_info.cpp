@@ -51,6 +51,7 @@
  * 	set_job_state()
  * 	update_job_attr()
  * 	send_job_updates()
+ * 	send_jobs_updates()
  * 	send_attr_updates()
  * 	unset_job_attr()
  * 	update_job_comment()
@@ -99,6 +100,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <math.h>
+#include <unordered_map>
 #include <pbs_ifl.h>
 #include <log.h>
 #include <libutil.h>
@@ -108,6 +110,7 @@
 #include "queue_info.h"
 #include "job_info.h"
 #include "resv_info.h"
+#include "formula.h"
 #include "constant.h"
 #include "misc.h"
 #include "config.h"
@@ -126,6 +129,7 @@
 #include "attribute.h"
 #include "multi_threading.h"
 #include "libpbs.h"
+#include "profile.h"
 
 #ifdef NAS
 #include "site_code.h"
@@ -758,7 +762,7 @@ query_jobs_chunk(th_data_query_jinfo *data)
 		if (!strcmp(conf.fairshare_ent, "queue")) {
 			if (resresv->server->fairshare !=NULL) {
 				resresv->job->ginfo =
-					find_alloc_ginfo(qinfo->name, resresv->server->fairshare->root);
+					find_alloc_ginfo(qinfo->name, resresv->server->fairshare);
 			}
 			else
 				resresv->job->ginfo = NULL;
@@ -776,7 +780,7 @@ query_jobs_chunk(th_data_query_jinfo *data)
 			sprintf(fairshare_name, "%s:%s", resresv->group, resresv->user);
 #endif /* localmod 058 */
 			if (resresv->server->fairshare !=NULL) {
-				resresv->job->ginfo = find_alloc_ginfo(fairshare_name, resresv->server->fairshare->root);
+				resresv->job->ginfo = find_alloc_ginfo(fairshare_name, resresv->server->fairshare);
 			}
 			else
 				resresv->job->ginfo = NULL;
@@ -1200,7 +1204,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 				if (strchr(attrp->value, ':') != NULL) {
 					/* moved to query_jobs() in order to include the queue name
 					 resresv->job->ginfo = find_alloc_ginfo( attrp->value,
-					 sinfo->fairshare->root );
+					 sinfo->fairshare );
 					 */
 					/* localmod 034 */
 					resresv->job->sh_info = site_find_alloc_share(sinfo,
@@ -1208,7 +1212,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 				}
 #else
 				resresv->job->ginfo = find_alloc_ginfo(attrp->value,
-					sinfo->fairshare->root);
+					sinfo->fairshare);
 #endif /* localmod 059 */
 			}
 			else
@@ -1796,6 +1800,31 @@ update_job_attr(int pbs_sd, resource_resv *resresv, const char *attr_name,
 	return 0;
 }
 
+/**
+ * @brief
+ * 		can a job's delayed attribute updates be sent to the server now?
+ *
+ * @param[in]	job	-	job to check
+ *
+ * @return	int
+ * @retval	1	- yes
+ * @retval	0	- no
+ */
+static int
+job_updates_sendable(resource_resv *job)
+{
+	struct attrl *iter_attr;
+
+	if (send_job_attr_updates)
+		return 1;
+
+	for (iter_attr = job->job->attr_updates; iter_attr != NULL; iter_attr = iter_attr->next) {
+		if (can_send_update(iter_attr->name))
+			return 1;
+	}
+	return 0;
+}
+
 /**
  * @brief
  * 		send delayed job attribute updates for job using send_attr_updates().
@@ -1815,22 +1844,12 @@ update_job_attr(int pbs_sd, resource_resv *resresv, const char *attr_name,
 int send_job_updates(int pbs_sd, resource_resv *job)
 {
 	int rc;
-	struct attrl *iter_attr = NULL;
 
 	if(job == NULL)
 		return 0;
 
-	if (!send_job_attr_updates) {
-		int send = 0;
-		for (iter_attr = job->job->attr_updates; iter_attr != NULL; iter_attr = iter_attr->next) {
-			if (can_send_update(iter_attr->name)) {
-				send = 1;
-				break;
-			}
-		}
-		if (!send)
-			return 0;
-	}
+	if (!job_updates_sendable(job))
+		return 0;
 
 	rc = send_attr_updates(get_svr_inst_fd(pbs_sd, job->job->svr_inst_id), job->name, job->job->attr_updates);
 
@@ -1839,6 +1858,44 @@ int send_job_updates(int pbs_sd, resource_resv *job)
 	return rc;
 }
 
+/**
+ * @brief
+ * 		send the delayed job attribute updates of many jobs.  The updates
+ *		are grouped by the server owning each job and sent with one
+ *		send_attr_updates_bulk() call per server instead of one request
+ *		per job.
+ *
+ * @param[in]	pbs_sd	-	server connection descriptor
+ * @param[in,out]	jobs	-	jobs to send attributes for, emptied on return
+ *
+ * @return	void
+ */
+void
+send_jobs_updates(int pbs_sd, std::vector<resource_resv *>& jobs)
+{
+	std::unordered_map<int, std::vector<alterjob_info>> svr_updates;
+	std::vector<resource_resv *> sent;
+
+	for (auto job : jobs) {
+		if (job == NULL || job->job == NULL || job->job->attr_updates == NULL)
+			continue;
+		if (!job_updates_sendable(job))
+			continue;
+
+		svr_updates[get_svr_inst_fd(pbs_sd, job->job->svr_inst_id)].push_back({job->name, job->job->attr_updates});
+		sent.push_back(job);
+	}
+
+	for (auto& su : svr_updates)
+		send_attr_updates_bulk(su.first, su.second.data(), su.second.size());
+
+	for (auto job : sent) {
+		free_attrl_list(job->job->attr_updates);
+		job->job->attr_updates = NULL;
+	}
+	jobs.clear();
+}
+
 /**
  *	@brief
  *		unset job attributes on the server
@@ -1920,6 +1977,7 @@ update_jobs_cant_run(int pbs_sd, resource_resv **resresv_arr,
 	resource_resv *start, struct schd_error *err, int start_where)
 {
 	int i = 0;
+	std::vector<resource_resv *> updated;
 
 	if (resresv_arr == NULL)
 		return;
@@ -1941,9 +1999,11 @@ update_jobs_cant_run(int pbs_sd, resource_resv **resresv_arr,
 
 		for (; resresv_arr[i] != NULL; i++) {
 			if (!resresv_arr[i]->can_not_run) {
-				update_job_can_not_run(pbs_sd, resresv_arr[i], err);
+				if (set_job_can_not_run(pbs_sd, resresv_arr[i], err))
+					updated.push_back(resresv_arr[i]);
 			}
 		}
+		send_jobs_updates(pbs_sd, updated);
 	}
 }
 
@@ -2241,6 +2301,9 @@ new_resresv_set(void)
 	rset->req = NULL;
 	rset->select_spec = NULL;
 	rset->qinfo = NULL;
+	rset->spec_no_fit = 0;
+	rset->spec_gen = 0;
+	rset->spec_err = NULL;
 
 	return rset;
 }
@@ -2253,6 +2316,7 @@ free_resresv_set(resresv_set *rset) {
 		return;
 
 	free_schd_error(rset->err);
+	free_schd_error(rset->spec_err);
 	free(rset->user);
 	free(rset->group);
 	free(rset->project);
@@ -2315,7 +2379,7 @@ dup_resresv_set(resresv_set *oset, server_info *nsinfo)
 		free_resresv_set(rset);
 		return NULL;
 	}
-	rset->select_spec = dup_selspec(oset->select_spec);
+	rset->select_spec = share_selspec(oset->select_spec);
 	if (rset->select_spec == NULL) {
 		free_resresv_set(rset);
 		return NULL;
@@ -2565,7 +2629,7 @@ create_resresv_set_by_resresv(status *policy, server_info *sinfo, resource_resv
 	if (resresv_set_use_proj(sinfo, rset->qinfo))
 		rset->project = string_dup(resresv->project);
 
-	rset->select_spec = dup_selspec(resresv_set_which_selspec(resresv));
+	rset->select_spec = share_selspec(resresv_set_which_selspec(resresv));
 	if (rset->select_spec == NULL) {
 		free_resresv_set(rset);
 		return NULL;
@@ -2819,7 +2883,7 @@ dup_job_info(job_info *ojinfo, queue_info *nqinfo, server_info *nsinfo)
 
 	if (nqinfo->server->fairshare !=NULL) {
 		njinfo->ginfo = find_group_info(ojinfo->ginfo->name,
-			nqinfo->server->fairshare->root);
+			nqinfo->server->fairshare);
 	}
 	else
 		njinfo->ginfo = NULL;
@@ -3010,6 +3074,7 @@ find_and_preempt_jobs(status *policy, int pbs_sd, resource_resv *hjob, server_in
 	int no_of_jobs = 0;
 	char **preempt_jobs_list = NULL;
 	preempt_job_info *preempt_jobs_reply = NULL;
+	prof_timer pt(PROF_PREEMPT);
 
 	/* jobs with AOE cannot preempt (atleast for now) */
 	if (hjob->aoename != NULL)
@@ -4249,10 +4314,11 @@ queue_subjob(resource_resv *array, server_info *sinfo,
 	return rresv;
 }
 
+#ifdef PYTHON
 /**
  * @brief
  * 		evaluate a math formula for jobs based on their resources
- *		NOTE: currently done through embedded python interpreter
+ *		through the embedded python interpreter
  *
  * @param[in]	formula	-	formula to evaluate
  * @param[in]	resresv	-	job for special case key words
@@ -4261,10 +4327,8 @@ queue_subjob(resource_resv *array, server_info *sinfo,
  * @return	evaluated formula answer or 0 on exception
  *
  */
-
-#ifdef PYTHON
-sch_resource_t
-formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
+static sch_resource_t
+formula_evaluate_python(char *formula, resource_resv *resresv, resource_req *resreq)
 {
 	char buf[1024];
 	char *globals;
@@ -4330,9 +4394,9 @@ formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
 		FORMULA_JOB_PRIO, resresv->job->priority,
 		FORMULA_FSPERC, resresv->job->ginfo->tree_percentage,
 		FORMULA_FSPERC_DEP, resresv->job->ginfo->tree_percentage,
-		FORMULA_TREE_USAGE, resresv->job->ginfo->usage_factor,
+		FORMULA_TREE_USAGE, get_usage_factor(resresv->server->fairshare, resresv->job->ginfo),
 		FORMULA_FSFACTOR, resresv->job->ginfo->tree_percentage == 0 ? 0 :
-			pow(2, -(resresv->job->ginfo->usage_factor/resresv->job->ginfo->tree_percentage)),
+			pow(2, -(get_usage_factor(resresv->server->fairshare, resresv->job->ginfo)/resresv->job->ginfo->tree_percentage)),
 		FORMULA_ACCRUE_TYPE, resresv -> job -> accrue_type);
 	if (pbs_strcat(&globals, &globals_size, buf) == NULL) {
 		free(globals);
@@ -4378,16 +4442,42 @@ formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
 	}
 
 
-
 	return ans;
 }
-#else
+#endif
+
+/**
+ * @brief
+ * 		evaluate a math formula for jobs based on their resources
+ *		NOTE: formulas are compiled and evaluated natively when possible.
+ *		Any syntax the native evaluator doesn't understand is evaluated
+ *		through the embedded python interpreter.
+ *
+ * @param[in]	formula	-	formula to evaluate
+ * @param[in]	resresv	-	job for special case key words
+ * @param[in]	resreq	-	resources to use when evaluating
+ *
+ * @return	evaluated formula answer or 0 on exception
+ *
+ */
 sch_resource_t
 formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
 {
+	sch_resource_t ans = 0;
+
+	if (formula == NULL || resresv == NULL ||
+		resresv->job == NULL || consres == NULL)
+		return 0;
+
+	if (formula_native_evaluate(formula, resresv, resreq, &ans))
+		return ans;
+
+#ifdef PYTHON
+	return formula_evaluate_python(formula, resresv, resreq);
+#else
 	return 0;
-}
 #endif
+}
 
 /**
  * @brief
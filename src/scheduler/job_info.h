@@ -86,9 +86,15 @@ update_job_attr(int pbs_sd, resource_resv *resresv, const char *attr_name,
 /* send delayed job attribute updates for job using send_attr_updates() */
 int send_job_updates(int pbs_sd, resource_resv *job);
 
+/* send delayed job attribute updates for many jobs in bulk requests */
+void send_jobs_updates(int pbs_sd, std::vector<resource_resv *>& jobs);
+
 /* send delayed attributes to the server for a job */
 int send_attr_updates(int job_owner_sd, char *job_name, struct attrl *pattr);
 
+/* send delayed attributes to the server for many jobs at once */
+int send_attr_updates_bulk(int job_owner_sd, alterjob_info *jobs, int njobs);
+
 preempt_job_info *send_preempt_jobs(int virtual_sd, char **preempt_jobs_list);
 
 
@@ -1797,7 +1797,7 @@ check_queue_max_res(server_info *si, queue_info *qi, resource_resv *rr,
 		if (max_res == SCHD_INFINITY)
 			continue;
 
-		if ((used_res = find_resource_count(c->rescts, res->def)) == NULL)
+		if ((used_res = find_counts_res(c, res->def)) == NULL)
 			used = 0;
 		else
 			used = used_res->amount;
@@ -1871,7 +1871,7 @@ check_server_max_res(server_info *si, queue_info *qi, resource_resv *rr,
 		if (max_res == SCHD_INFINITY)
 			continue;
 
-		if ((used_res = find_resource_count(c->rescts, res->def)) == NULL)
+		if ((used_res = find_counts_res(c, res->def)) == NULL)
 			used = 0;
 		else
 			used = used_res->amount;
@@ -2552,7 +2552,7 @@ check_server_max_res_soft(server_info *si, queue_info *qi, resource_resv *rr)
 		if (max_res_soft == SCHD_INFINITY)
 			continue;
 
-		if ((used_res = find_resource_count(c->rescts, res->def)) == NULL)
+		if ((used_res = find_counts_res(c, res->def)) == NULL)
 			used = 0;
 		else
 			used = used_res->amount;
@@ -2621,7 +2621,7 @@ check_queue_max_res_soft(server_info *si, queue_info *qi, resource_resv *rr)
 		if (max_res_soft == SCHD_INFINITY)
 			continue;
 
-		if ((used_res = find_resource_count(c->rescts, res->def)) == NULL)
+		if ((used_res = find_counts_res(c, res->def)) == NULL)
 			used = 0;
 		else
 			used = used_res->amount;
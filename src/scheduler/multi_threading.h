@@ -44,6 +44,7 @@
 #include "data_types.h"
 
 #define MT_CHUNK_SIZE_MIN 1024
+#define MT_SPEC_CHUNK_SIZE_MIN 8
 #define MT_CHUNK_SIZE_MAX 8192
 
 int init_multi_threading(int nthreads);
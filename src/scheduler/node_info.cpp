@@ -47,6 +47,8 @@
  * Functions included are:
  * 	query_nodes()
  * 	query_node_info()
+ * 	hand_back_queried_nodes()
+ * 	clear_node_query_cache()
  * 	new_node_info()
  * 	free_nodes()
  * 	free_node_info()
@@ -56,6 +58,7 @@
  * 	add_node_state()
  * 	node_filter()
  * 	find_node_info()
+ * 	index_nodes_by_name()
  * 	find_node_by_host()
  * 	dup_nodes()
  * 	dup_node_info()
@@ -126,6 +129,8 @@
 #include <math.h>
 #include <errno.h>
 #include <time.h>
+#include <unordered_map>
+#include <string>
 #include <pbs_ifl.h>
 #include <log.h>
 #include <grunt.h>
@@ -159,6 +164,484 @@
 /* name of the last node a job ran on - used in smp_dist = round robin */
 static char last_node_name[PBS_MAXSVRJOBID];
 
+/*
+ * Vnodes reused from the previous cycle.  The status each vnode was parsed
+ * from is kept flattened for change detection, with a hash of it as a quick
+ * check before the status is compared byte by byte.  At the end of a
+ * cycle the vnodes of the scheduler's universe are handed back to the cache
+ * by hand_back_queried_nodes() instead of being freed, and the next
+ * query_nodes() takes them over again if the server returns the same status.
+ */
+struct node_query_cache_entry {
+	unsigned long long sig;		/* hash of the attribute list the node was parsed from */
+	char *status;			/* flattened attribute list the node was parsed from */
+	size_t status_len;		/* length of the flattened attribute list */
+	int num_res;			/* number of resources on the node when it was parsed */
+	unsigned int power_provisioning:1; /* sinfo->power_provisioning when parsed */
+	unsigned int seen:1;		/* node was returned by the server this cycle */
+	node_info *owner;		/* node the last query_nodes() returned for this entry */
+	node_info *ninfo;		/* node handed back at the end of the last cycle or NULL */
+};
+
+static std::unordered_map<std::string, node_query_cache_entry *> node_query_cache;
+
+/**
+ * @brief	compute the signature of a node's attribute list.  This is a
+ *		64 bit FNV-1a hash of the list flattened into name, resource and
+ *		value strings including their terminating NUL bytes.
+ *
+ * @param[in]	attrp	-	attribute list of the node
+ * @param[out]	len	-	length of the flattened attribute list
+ *
+ * @return	unsigned long long - the signature
+ */
+static unsigned long long
+node_status_sig(struct attrl *attrp, size_t *len)
+{
+	unsigned long long h = 14695981039346656037ULL;
+	const char *fields[3];
+	const char *p;
+	size_t l = 0;
+	int i;
+
+	for (; attrp != NULL; attrp = attrp->next) {
+		fields[0] = attrp->name;
+		fields[1] = attrp->resource != NULL ? attrp->resource : "";
+		fields[2] = attrp->value != NULL ? attrp->value : "";
+		for (i = 0; i < 3; i++) {
+			p = fields[i];
+			do {
+				h ^= (unsigned char) *p;
+				h *= 1099511628211ULL;
+				l++;
+			} while (*p++ != '\0');
+		}
+	}
+	*len = l;
+
+	return h;
+}
+
+/**
+ * @brief	compare a node's attribute list to a flattened one made by
+ *		flatten_node_status()
+ *
+ * @param[in]	attrp	-	attribute list of the node
+ * @param[in]	status	-	the flattened attribute list
+ * @param[in]	len	-	length of status
+ *
+ * @return	int
+ * @retval	1	: the attribute list is the same as status
+ * @retval	0	: it differs
+ */
+static int
+node_status_equal(struct attrl *attrp, const char *status, size_t len)
+{
+	const char *fields[3];
+	size_t flen;
+	size_t off = 0;
+	int i;
+
+	for (; attrp != NULL; attrp = attrp->next) {
+		fields[0] = attrp->name;
+		fields[1] = attrp->resource != NULL ? attrp->resource : "";
+		fields[2] = attrp->value != NULL ? attrp->value : "";
+		for (i = 0; i < 3; i++) {
+			flen = strlen(fields[i]) + 1;
+			if (off + flen > len || memcmp(status + off, fields[i], flen) != 0)
+				return 0;
+			off += flen;
+		}
+	}
+
+	return off == len;
+}
+
+/**
+ * @brief	flatten a node's attribute list into name, resource and value
+ *		strings including their terminating NUL bytes
+ *
+ * @param[in]	attrp	-	attribute list of the node
+ * @param[in]	len	-	length of the flattened list from node_status_sig()
+ *
+ * @return	char *
+ * @retval	the flattened attribute list - the caller frees it
+ * @retval	NULL	: out of memory
+ */
+static char *
+flatten_node_status(struct attrl *attrp, size_t len)
+{
+	const char *fields[3];
+	char *status;
+	size_t flen;
+	size_t off = 0;
+	int i;
+
+	if ((status = static_cast<char *>(malloc(len > 0 ? len : 1))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	for (; attrp != NULL; attrp = attrp->next) {
+		fields[0] = attrp->name;
+		fields[1] = attrp->resource != NULL ? attrp->resource : "";
+		fields[2] = attrp->value != NULL ? attrp->value : "";
+		for (i = 0; i < 3; i++) {
+			flen = strlen(fields[i]) + 1;
+			memcpy(status + off, fields[i], flen);
+			off += flen;
+		}
+	}
+
+	return status;
+}
+
+/**
+ * @brief	free a node query cache entry
+ *
+ * @param[in]	ent	-	the entry to free
+ *
+ * @return void
+ */
+static void
+free_node_query_cache_entry(node_query_cache_entry *ent)
+{
+	if (ent == NULL)
+		return;
+
+	free_node_info(ent->ninfo);
+	free(ent->status);
+	free(ent);
+}
+
+/**
+ * @brief	look up a node returned from the server in the node query cache.
+ *		The entry's signature is updated to the node's current status.
+ *
+ * @param[in]	node	-	the node returned from pbs_statvnode()
+ * @param[in]	sinfo	-	server information
+ * @param[out]	num_res	-	number of resources of the returned node when it was parsed
+ *
+ * @return	node_info *
+ * @retval	the node handed back at the end of the last cycle if the node
+ *		is unchanged since it was parsed - the caller takes ownership
+ * @retval	NULL	: node has to be parsed
+ *
+ * @par MT-Safe:	no
+ */
+static node_info *
+take_node_query_cache(struct batch_status *node, server_info *sinfo, int *num_res)
+{
+	node_query_cache_entry *ent;
+	struct attrl *attrp;
+	unsigned long long sig;
+	size_t len;
+	node_info *ninfo;
+	int same;
+
+	/* cloud licenses are checked against the current time while parsing */
+	for (attrp = node->attribs; attrp != NULL; attrp = attrp->next) {
+		if (!strcmp(attrp->name, ATTR_NODE_License) &&
+			attrp->value != NULL && attrp->value[0] == ND_LIC_TYPE_cloud)
+			return NULL;
+	}
+
+	sig = node_status_sig(node->attribs, &len);
+
+	auto it = node_query_cache.find(node->name);
+	if (it == node_query_cache.end()) {
+		if ((ent = static_cast<node_query_cache_entry *>(malloc(sizeof(node_query_cache_entry)))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+		ent->ninfo = NULL;
+		ent->status = NULL;
+		ent->status_len = 0;
+		ent->num_res = -1;
+		node_query_cache[node->name] = ent;
+	} else
+		ent = it->second;
+
+	/* the hash only rules changes out quickly, equal hashes still need the bytes compared */
+	same = ent->status != NULL && ent->sig == sig && ent->status_len == len &&
+		node_status_equal(node->attribs, ent->status, len);
+	if (!same) {
+		free(ent->status);
+		ent->status = flatten_node_status(node->attribs, len);
+	}
+
+	ninfo = ent->ninfo;
+	ent->ninfo = NULL;
+	if (ninfo != NULL && (!same || ent->power_provisioning != sinfo->power_provisioning)) {
+		free_node_info(ninfo);
+		ninfo = NULL;
+	}
+	ent->sig = sig;
+	ent->status_len = len;
+	ent->power_provisioning = sinfo->power_provisioning;
+	ent->seen = 1;
+	ent->owner = NULL;
+	if (ninfo == NULL)
+		ent->num_res = -1;
+	*num_res = ent->num_res;
+
+	return ninfo;
+}
+
+/**
+ * @brief	remove nodes from the node query cache which were not returned by
+ *		the server this cycle and reset the seen flag for the next cycle
+ *
+ * @return void
+ */
+static void
+prune_node_query_cache(void)
+{
+	for (auto it = node_query_cache.begin(); it != node_query_cache.end();) {
+		if (!it->second->seen) {
+			free_node_query_cache_entry(it->second);
+			it = node_query_cache.erase(it);
+		} else {
+			it->second->seen = 0;
+			++it;
+		}
+	}
+}
+
+/**
+ * @brief	free the per node array of reused nodes used by query_nodes()
+ *
+ * @param[in]	cached	-	reused nodes which were not taken by a query chunk
+ * @param[in]	num_nodes -	size of the array
+ *
+ * @return void
+ */
+static void
+free_node_query_arrays(node_info **cached, int num_nodes)
+{
+	int i;
+
+	if (cached == NULL)
+		return;
+
+	for (i = 0; i < num_nodes; i++)
+		free_node_info(cached[i]);
+	free(cached);
+}
+
+/**
+ * @brief
+ *      init_node_info_cycle - initialize the parts of a node_info which the
+ *      scheduler builds during a cycle rather than parses from the server
+ *
+ * @par	new_node_info() calls this, and reset_cached_node() calls it on a
+ *	vnode reused from the last cycle.  Any new field which is set during a
+ *	cycle must be initialized here and not in new_node_info(), and freed in
+ *	free_node_info_cycle(), or it leaks from one cycle into the next.
+ *
+ * @param[out]	nnode	-	the node to initialize
+ *
+ * @return	nothing
+ */
+static void
+init_node_info_cycle(node_info *nnode)
+{
+	nnode->has_ghost_job = 0;
+
+	nnode->num_jobs = 0;
+	nnode->num_run_resv = 0;
+	nnode->num_susp_jobs = 0;
+
+	nnode->rank = 0;
+
+	nnode->nodesig_ind = -1;
+
+	nnode->job_arr = NULL;
+	nnode->run_resvs_arr = NULL;
+	nnode->server = NULL;
+	nnode->group_counts = NULL;
+	nnode->user_counts = NULL;
+	nnode->nodesig = NULL;
+
+	nnode->svr_node = NULL;
+	nnode->hostset = NULL;
+
+	nnode->node_events = NULL;
+	nnode->bucket_ind = -1;
+	nnode->node_ind = -1;
+
+	nnode->nscr = NSCR_NONE;
+
+	nnode->np_arr = NULL;
+	nnode->np_snap = NULL;
+}
+
+/**
+ * @brief
+ *      free_node_info_cycle - free the parts of a node_info which
+ *      init_node_info_cycle() initializes
+ *
+ * @param[in,out]	ninfo	-	the node
+ *
+ * @return	nothing
+ */
+static void
+free_node_info_cycle(node_info *ninfo)
+{
+	if (ninfo->job_arr != NULL)
+		free(ninfo->job_arr);
+
+	if (ninfo->run_resvs_arr != NULL)
+		free(ninfo->run_resvs_arr);
+
+	if (ninfo->group_counts != NULL)
+		free_counts_list(ninfo->group_counts);
+
+	if (ninfo->user_counts != NULL)
+		free_counts_list(ninfo->user_counts);
+
+	if (ninfo->nodesig != NULL)
+		free(ninfo->nodesig);
+
+	if(ninfo->node_events != NULL)
+		free_te_list(ninfo->node_events);
+
+	if (ninfo->np_arr != NULL)
+		free(ninfo->np_arr);
+
+	if (ninfo->np_snap != NULL)
+		delete ninfo->np_snap;
+}
+
+/**
+ * @brief	reset a node handed back at the end of the last cycle to the
+ *		state query_node_info() would have parsed from the server.  What
+ *		the last cycle built is freed and initialized again like
+ *		new_node_info() does, and the attributes which the scheduler
+ *		changes during a cycle are applied again.
+ *
+ * @param[in,out]	ninfo	-	the node to reset
+ * @param[in]	node	-	the node returned from pbs_statvnode()
+ * @param[in]	sinfo	-	server information
+ * @param[in]	num_res	-	number of resources on the node when it was parsed
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+reset_cached_node(node_info *ninfo, struct batch_status *node, server_info *sinfo, int num_res)
+{
+	struct attrl *attrp;
+	schd_resource *res;
+	schd_resource *prev = NULL;
+	int i;
+
+	/* drop what the last cycle built on top of the node */
+	free_node_info_cycle(ninfo);
+	init_node_info_cycle(ninfo);
+	ninfo->is_offline = 0;
+	ninfo->server = sinfo;
+
+	/* remove resources which were added to the node during the last cycle */
+	for (i = 0, res = ninfo->res; res != NULL && i < num_res; i++, res = res->next)
+		prev = res;
+	free_resource_list(res);
+	if (prev != NULL)
+		prev->next = NULL;
+	else
+		ninfo->res = NULL;
+
+	for (res = ninfo->res; res != NULL; res = res->next) {
+		res->assigned = 0;
+		free(res->str_assigned);
+		res->str_assigned = NULL;
+		res->indirect_res = NULL;
+	}
+	free(ninfo->current_aoe);
+	ninfo->current_aoe = NULL;
+	free(ninfo->current_eoe);
+	ninfo->current_eoe = NULL;
+
+	for (attrp = node->attribs; attrp != NULL; attrp = attrp->next) {
+		if (!strcmp(attrp->name, ATTR_NODE_state))
+			set_node_info_state(ninfo, attrp->value);
+		else if (!strcmp(attrp->name, ATTR_rescassn)) {
+			res = find_alloc_resource_by_str(ninfo->res, attrp->resource);
+			if (ninfo->res == NULL)
+				ninfo->res = res;
+			if (res != NULL && set_resource(res, attrp->value, RF_ASSN) == 0)
+				return 0;
+		} else if (!strcmp(attrp->name, ATTR_NODE_current_aoe)) {
+			if (attrp->value != NULL)
+				set_current_aoe(ninfo, attrp->value);
+		} else if (!strcmp(attrp->name, ATTR_NODE_current_eoe)) {
+			if (attrp->value != NULL)
+				set_current_eoe(ninfo, attrp->value);
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief	hand the nodes of the scheduler's universe back to the node
+ *		query cache at the end of a cycle.  Nodes which can be reused by
+ *		the next query_nodes() are removed from sinfo->nodes, the rest are
+ *		left for free_server() to free.
+ *
+ * @param[in,out]	sinfo	-	the universe which is about to be freed
+ *
+ * @return void
+ *
+ * @par MT-Safe:	no
+ */
+void
+hand_back_queried_nodes(server_info *sinfo)
+{
+	int i;
+	int j;
+
+	if (sinfo == NULL || sinfo->nodes == NULL)
+		return;
+
+	for (i = 0, j = 0; sinfo->nodes[i] != NULL; i++) {
+		node_info *ninfo = sinfo->nodes[i];
+		auto it = node_query_cache.find(ninfo->name);
+
+		if (it != node_query_cache.end() && it->second->owner == ninfo &&
+			it->second->ninfo == NULL) {
+			it->second->ninfo = ninfo;
+			it->second->owner = NULL;
+			ninfo->server = NULL;
+		} else
+			sinfo->nodes[j++] = ninfo;
+	}
+	sinfo->nodes[j] = NULL;
+	sinfo->num_nodes = j;
+}
+
+/**
+ * @brief	free the node query cache.  This must be called when the
+ *		resource definitions the cached nodes point into are freed.
+ *
+ * @return void
+ */
+void
+clear_node_query_cache(void)
+{
+	for (auto &it : node_query_cache)
+		free_node_query_cache_entry(it.second);
+	node_query_cache.clear();
+}
+
+/**
+ * @brief	pthread routine for querying a chunk of nodes
+ *
+ * @param[in,out]	data - th_data_query_ninfo object for the querying
+ *
+ * @return void
+ */
 void
 query_node_info_chunk(th_data_query_ninfo *data)
 {
@@ -191,11 +674,27 @@ query_node_info_chunk(th_data_query_ninfo *data)
 		;
 
 	for (i = start, nidx = 0; i <= end && cur_node != NULL; cur_node = cur_node->next, i++) {
-		/* get node info from the batch_status */
-		if ((ninfo = query_node_info(cur_node, sinfo)) == NULL) {
-			free_nodes(ninfo_arr);
-			data->error = 1;
-			return;
+		if (data->cached != NULL && data->cached[i] != NULL) {
+			/* node is unchanged since last cycle, reuse what we parsed then */
+			ninfo = data->cached[i];
+			data->cached[i] = NULL;
+			if (!reset_cached_node(ninfo, cur_node, sinfo, data->num_res[i])) {
+				free_node_info(ninfo);
+				free_nodes(ninfo_arr);
+				data->error = 1;
+				return;
+			}
+			if (ninfo->is_multivnoded)
+				sinfo->has_multi_vnode = 1;
+			if (ninfo->lic_lock)
+				sinfo->has_nonCPU_licenses = 1;
+		} else {
+			/* get node info from the batch_status */
+			if ((ninfo = query_node_info(cur_node, sinfo)) == NULL) {
+				free_nodes(ninfo_arr);
+				data->error = 1;
+				return;
+			}
 		}
 
 		if (node_in_partition(ninfo, sc_attrs.partition)) {
@@ -213,6 +712,8 @@ query_node_info_chunk(th_data_query_ninfo *data)
  *
  * @param[in]	nodes	-	batch_status of nodes queried from server
  * @param[in]	sinfo	-	server information
+ * @param[in,out]	cached	-	per node unchanged node to reuse (may be NULL)
+ * @param[in]	num_res	-	per node number of resources of the cached node
  * @param[in]	sidx	-	start index for the jobs list for the thread
  * @param[in]	eidx	-	end index for the jobs list for the thread
  *
@@ -221,7 +722,8 @@ query_node_info_chunk(th_data_query_ninfo *data)
  * @retval NULL for malloc error
  */
 static inline th_data_query_ninfo *
-alloc_tdata_nd_query(struct batch_status *nodes, server_info *sinfo, int sidx, int eidx)
+alloc_tdata_nd_query(struct batch_status *nodes, server_info *sinfo,
+	node_info **cached, int *num_res, int sidx, int eidx)
 {
 	th_data_query_ninfo *tdata = NULL;
 
@@ -233,6 +735,8 @@ alloc_tdata_nd_query(struct batch_status *nodes, server_info *sinfo, int sidx, i
 	tdata->error = 0;
 	tdata->nodes = nodes;
 	tdata->oarr = NULL; /* Will be filled by the thread routine */
+	tdata->cached = cached;
+	tdata->num_res = num_res;
 	tdata->sinfo = sinfo;
 	tdata->sidx = sidx;
 	tdata->eidx = eidx;
@@ -269,6 +773,10 @@ query_nodes(int pbs_sd, server_info *sinfo)
 	int th_err = 0;
 	node_info ***ninfo_arrs_tasks = NULL;
 	int tid;
+	node_info **cached;			/* node from last cycle to reuse for each node */
+	int *num_res;				/* resources of each reused node when parsed */
+	int num_reused = 0;
+	int num_nodes_total;
 	const char *nodeattrs[] = {
 			ATTR_NODE_state,
 			ATTR_NODE_Mom,
@@ -324,17 +832,44 @@ query_nodes(int pbs_sd, server_info *sinfo)
 		num_nodes++;
 		cur_node = cur_node->next;
 	}
+	num_nodes_total = num_nodes;
+
+	cached = static_cast<node_info **>(calloc(num_nodes, sizeof(node_info *)));
+	num_res = static_cast<int *>(calloc(num_nodes, sizeof(int)));
+	if (cached == NULL || num_res == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(cached);
+		free(num_res);
+		pbs_statfree(nodes);
+		return NULL;
+	}
+
+	/* take back the nodes which have not changed since the last cycle */
+	for (i = 0, cur_node = nodes; cur_node != NULL; cur_node = cur_node->next, i++) {
+		if ((cached[i] = take_node_query_cache(cur_node, sinfo, &num_res[i])) != NULL)
+			num_reused++;
+	}
+	prune_node_query_cache();
 
 	tid = *((int *) pthread_getspecific(th_id_key));
 	if (tid != 0 || num_threads <= 1) {
 		/* don't use multi-threading if I am a worker thread or num_threads is 1 */
-		tdata = alloc_tdata_nd_query(nodes, sinfo, 0, num_nodes - 1);
+		tdata = alloc_tdata_nd_query(nodes, sinfo, cached, num_res, 0, num_nodes - 1);
 		if (tdata == NULL) {
+			free_node_query_arrays(cached, num_nodes_total);
+			free(num_res);
 			pbs_statfree(nodes);
 			return NULL;
 		}
 		query_node_info_chunk(tdata);
 		ninfo_arr = tdata->oarr;
+		if (tdata->error || ninfo_arr == NULL) {
+			free_node_query_arrays(cached, num_nodes_total);
+			free(num_res);
+			free(tdata);
+			pbs_statfree(nodes);
+			return NULL;
+		}
 		free(tdata);
 
 		for (nidx = 0; ninfo_arr[nidx] != NULL; nidx++)
@@ -344,6 +879,8 @@ query_nodes(int pbs_sd, server_info *sinfo)
 	} else {
 		if ((ninfo_arr = static_cast<node_info **>(malloc((num_nodes + 1) * sizeof(node_info *)))) == NULL) {
 			log_err(errno, __func__, MEM_ERR_MSG);
+			free_node_query_arrays(cached, num_nodes_total);
+			free(num_res);
 			pbs_statfree(nodes);
 			return NULL;
 		}
@@ -352,7 +889,7 @@ query_nodes(int pbs_sd, server_info *sinfo)
 		chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN) ? chunk_size : MT_CHUNK_SIZE_MIN;
 		for (j = 0, num_tasks = 0; num_nodes > 0;
 				j += chunk_size, num_tasks++, num_nodes -= chunk_size) {
-			tdata = alloc_tdata_nd_query(nodes, sinfo, j, j + chunk_size - 1);
+			tdata = alloc_tdata_nd_query(nodes, sinfo, cached, num_res, j, j + chunk_size - 1);
 			if (tdata == NULL) {
 				th_err = 1;
 				break;
@@ -393,6 +930,8 @@ query_nodes(int pbs_sd, server_info *sinfo)
 			pthread_mutex_unlock(&result_lock);
 		}
 		if (th_err) {
+			free_node_query_arrays(cached, num_nodes_total);
+			free(num_res);
 			pbs_statfree(nodes);
 			free_nodes(ninfo_arr);
 			return NULL;
@@ -413,6 +952,28 @@ query_nodes(int pbs_sd, server_info *sinfo)
 		free(ninfo_arrs_tasks);
 	}
 
+	/* remember which nodes this query returned and how many resources
+	 * they were parsed with, for when they are handed back
+	 */
+	for (i = 0; i < nidx; i++) {
+		auto it = node_query_cache.find(ninfo_arr[i]->name);
+		schd_resource *res;
+		int n;
+
+		if (it == node_query_cache.end())
+			continue;
+		if (it->second->num_res < 0) {
+			for (n = 0, res = ninfo_arr[i]->res; res != NULL; res = res->next)
+				n++;
+			it->second->num_res = n;
+		}
+		it->second->owner = ninfo_arr[i];
+	}
+	free_node_query_arrays(cached, num_nodes_total);
+	free(num_res);
+	log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG, __func__,
+		"Reused %d of %d unchanged vnodes from the last cycle", num_reused, num_nodes_total);
+
 	if (nidx == 0) {
 		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__,
 			"No nodes found in partitions serviced by scheduler");
@@ -642,6 +1203,9 @@ query_node_info(struct batch_status *node, server_info *sinfo)
  * @brief
  *      new_node_info - allocates a new node_info
  *
+ * @par	Fields the scheduler sets during a cycle are initialized in
+ *	init_node_info_cycle() so vnodes reused from the last cycle are reset.
+ *
  * @return	the new node_info
  *
  */
@@ -672,7 +1236,6 @@ new_node_info()
 	nnode->is_provisioning = 0;
 	nnode->is_sleeping = 0;
 	nnode->is_multivnoded = 0;
-	nnode->has_ghost_job = 0;
 
 	nnode->lic_lock = 0;
 
@@ -684,29 +1247,16 @@ new_node_info()
 
 	nnode->sharing = VNS_DFLT_SHARED;
 
-	nnode->num_jobs = 0;
-	nnode->num_run_resv = 0;
-	nnode->num_susp_jobs = 0;
-
 	nnode->priority = 0;
 
 	nnode->pcpus = 0;
 
-	nnode->rank = 0;
-
-	nnode->nodesig_ind = -1;
-
 	nnode->name = NULL;
 	nnode->mom = NULL;
 	nnode->jobs = NULL;
 	nnode->resvs = NULL;
-	nnode->job_arr = NULL;
-	nnode->run_resvs_arr = NULL;
 	nnode->res = NULL;
-	nnode->server = NULL;
 	nnode->queue_name = NULL;
-	nnode->group_counts = NULL;
-	nnode->user_counts = NULL;
 
 	nnode->max_running = SCHD_INFINITY;
 	nnode->max_user_run = SCHD_INFINITY;
@@ -714,26 +1264,17 @@ new_node_info()
 
 	nnode->current_aoe = NULL;
 	nnode->current_eoe = NULL;
-	nnode->nodesig = NULL;
 	nnode->last_state_change_time = 0;
 	nnode->last_used_time = 0;
 
-	nnode->svr_node = NULL;
-	nnode->hostset = NULL;
-
-	nnode->node_events = NULL;
-	nnode->bucket_ind = -1;
-	nnode->node_ind = -1;
-
-	nnode->nscr = NSCR_NONE;
-
 #ifdef NAS
 	/* localmod 034 */
 	nnode->sh_type = 0;
 	nnode->sh_cls = 0;
 #endif
 	nnode->partition = NULL;
-	nnode->np_arr = NULL;
+	init_node_info_cycle(nnode);
+
 	return nnode;
 }
 
@@ -892,38 +1433,19 @@ free_node_info(node_info *ninfo)
 		if (ninfo->resvs != NULL)
 			free_string_array(ninfo->resvs);
 
-		if (ninfo->job_arr != NULL)
-			free(ninfo->job_arr);
-
-		if (ninfo->run_resvs_arr != NULL)
-			free(ninfo->run_resvs_arr);
-
 		if (ninfo->res != NULL)
 			free_resource_list(ninfo->res);
 
-		if (ninfo->group_counts != NULL)
-			free_counts_list(ninfo->group_counts);
-
-		if (ninfo->user_counts != NULL)
-			free_counts_list(ninfo->user_counts);
-
 		if (ninfo->current_aoe != NULL)
 			free(ninfo->current_aoe);
 
 		if (ninfo->current_eoe != NULL)
 			free(ninfo->current_eoe);
 
-		if (ninfo->nodesig != NULL)
-			free(ninfo->nodesig);
-
-		if(ninfo->node_events != NULL)
-			free_te_list(ninfo->node_events);
-
 		if (ninfo->partition != NULL)
 			free(ninfo->partition);
 
-		if (ninfo->np_arr != NULL)
-			free(ninfo->np_arr);
+		free_node_info_cycle(ninfo);
 
 		if (ninfo->svr_inst_id != NULL)
 			free(ninfo->svr_inst_id);
@@ -1198,6 +1720,8 @@ node_filter(node_info **nodes, int size,
 /**
  * @brief
  *		find_node_info - find a node in a node array
+ *		If the array is the server's node array, the server's name index
+ *		is used instead of searching the array.
  *
  * @param[in]	nodename	-	the node to find
  * @param[in]	ninfo_arr	-	the array of nodes to look in
@@ -1209,11 +1733,21 @@ node_filter(node_info **nodes, int size,
 node_info *
 find_node_info(node_info **ninfo_arr, char *nodename)
 {
+	server_info *sinfo;
 	int i;
 
 	if (nodename == NULL || ninfo_arr == NULL)
 		return NULL;
 
+	if (ninfo_arr[0] != NULL && (sinfo = ninfo_arr[0]->server) != NULL &&
+		(ninfo_arr == sinfo->nodes || ninfo_arr == sinfo->unordered_nodes) &&
+		!sinfo->nodes_by_name.empty()) {
+		auto it = sinfo->nodes_by_name.find(nodename);
+		if (it == sinfo->nodes_by_name.end())
+			return NULL;
+		return it->second;
+	}
+
 	for (i = 0; ninfo_arr[i] != NULL &&
 		strcmp(nodename, ninfo_arr[i]->name) ; i++)
 		;
@@ -1221,6 +1755,35 @@ find_node_info(node_info **ninfo_arr, char *nodename)
 	return ninfo_arr[i];
 }
 
+/**
+ * @brief
+ *		index_nodes_by_name - (re)build the server's index of its nodes by
+ *				      name.  The first node wins if two share a name
+ *				      just like a search of the array would.
+ *
+ * @param[in,out]	sinfo	-	server whose nodes to index
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+void
+index_nodes_by_name(server_info *sinfo)
+{
+	int i;
+
+	if (sinfo == NULL)
+		return;
+
+	sinfo->nodes_by_name.clear();
+	if (sinfo->nodes == NULL)
+		return;
+
+	sinfo->nodes_by_name.reserve(sinfo->num_nodes);
+	for (i = 0; sinfo->nodes[i] != NULL; i++)
+		sinfo->nodes_by_name.emplace(sinfo->nodes[i]->name, sinfo->nodes[i]);
+}
+
 /**
  * @brief
  *		find_node_by_host - find a node by its host resource rather then
@@ -1525,6 +2088,7 @@ dup_node_info(node_info *onode, server_info *nsinfo,
 	nnode->is_stale = onode->is_stale;
 	nnode->is_maintenance = onode->is_maintenance;
 	nnode->is_provisioning = onode->is_provisioning;
+	nnode->is_sleeping = onode->is_sleeping;
 	nnode->is_multivnoded = onode->is_multivnoded;
 
 	nnode->sharing = onode->sharing;
@@ -1701,10 +2265,18 @@ collect_jobs_on_nodes(node_info **ninfo_arr, resource_resv **resresv_arr, int si
 	int i, j, k;
 	node_info *node;	/* used to store pointer of node in ninfo_arr */
 	resource_resv **temp_ninfo_arr = NULL;
+	std::unordered_map<std::string, resource_resv *> jobs_by_name;
 
 	if (ninfo_arr == NULL || ninfo_arr[0] == NULL)
 		return 0;
 
+	/* resresv_arr is usually a filtered list, so index it here by name */
+	if (resresv_arr != NULL) {
+		jobs_by_name.reserve(size);
+		for (i = 0; resresv_arr[i] != NULL; i++)
+			jobs_by_name.emplace(resresv_arr[i]->name, resresv_arr[i]);
+	}
+
 	for (i = 0; ninfo_arr[i] != NULL; i++) {
 		if ((ninfo_arr[i]->job_arr = static_cast<resource_resv **>(malloc((size + 1) * sizeof(resource_resv *)))) == NULL)
 		{
@@ -1734,7 +2306,8 @@ collect_jobs_on_nodes(node_info **ninfo_arr, resource_resv **resresv_arr, int si
 				if (ptr != NULL)
 					*ptr = '\0';
 
-				job = find_resource_resv(resresv_arr, ninfo_arr[i]->jobs[j]);
+				auto jit = jobs_by_name.find(ninfo_arr[i]->jobs[j]);
+				job = jit != jobs_by_name.end() ? jit->second : NULL;
 				if ((job != NULL) && (job->nspec_arr != NULL)) {
 					/* if a distributed job has more then one instance on this node
 					 * it'll show up more then once.  If this is the case, we only
@@ -1848,6 +2421,9 @@ update_node_on_run(nspec *ns, resource_resv *resresv, const char *job_state)
 	if (ninfo->is_offline || ninfo->is_down)
 		return;
 
+	mark_node_pset_dirty(ninfo);
+	mark_node_pset_dirty(ninfo->svr_node);
+
 	if (resresv->is_job) {
 		ninfo->num_jobs++;
 		if (find_resource_resv_by_indrank(ninfo->job_arr, resresv->resresv_ind, resresv->rank) == NULL) {
@@ -2005,6 +2581,9 @@ update_node_on_end(node_info *ninfo, resource_resv *resresv, const char *job_sta
 	if (ninfo->is_offline || ninfo->is_down)
 		return;
 
+	mark_node_pset_dirty(ninfo);
+	mark_node_pset_dirty(ninfo->svr_node);
+
 	if (resresv->is_job) {
 		ninfo->num_jobs--;
 		if (ninfo->num_jobs < 0)
@@ -5323,6 +5902,8 @@ node_up_event(node_info *node, void *arg)
 	if (node == NULL)
 		return 0;
 
+	mark_node_pset_dirty(node);
+
 	/* Preserve the resv-exclusive state when previously set */
 	if (node->is_resv_exclusive)
 		set_node_info_state(node, ND_resv_exclusive);
@@ -5330,11 +5911,6 @@ node_up_event(node_info *node, void *arg)
 		set_node_info_state(node, ND_free);
 
 	sinfo = node->server;
-	if (sinfo->node_group_enable && sinfo->node_group_key != NULL) {
-		node_partition_update_array(sinfo->policy, sinfo->nodepart);
-		qsort(sinfo->nodepart, sinfo->num_parts,
-			sizeof(node_partition *), cmp_placement_sets);
-	}
 	update_all_nodepart(sinfo->policy, sinfo, NO_ALLPART);
 
 	return 1;
@@ -5376,13 +5952,9 @@ node_down_event(node_info *node, void *arg)
 		}
 	}
 
+	mark_node_pset_dirty(node);
 	set_node_info_state(node, ND_down);
 
-	if (sinfo->node_group_enable && sinfo->node_group_key != NULL) {
-		node_partition_update_array(sinfo->policy, sinfo->nodepart);
-		qsort(sinfo->nodepart, sinfo->num_parts,
-			sizeof(node_partition *), cmp_placement_sets);
-	}
 	update_all_nodepart(sinfo->policy, sinfo, NO_ALLPART);
 
 	return 1;
@@ -56,6 +56,17 @@ node_info **query_nodes(int pbs_sd, server_info *sinfo);
  */
 node_info *query_node_info(struct batch_status *node, server_info *sinfo);
 
+/*
+ *      hand_back_queried_nodes - hand the nodes of a universe back to the
+ *                                node query cache for the next cycle
+ */
+void hand_back_queried_nodes(server_info *sinfo);
+
+/*
+ *      clear_node_query_cache - free the nodes cached from previous cycles
+ */
+void clear_node_query_cache(void);
+
 /*
  * pthread routine for freeing up a node_info array
  */
@@ -115,6 +126,11 @@ int is_node_timeshared(node_info *node, void *arg);
  */
 node_info *find_node_info(node_info **ninfo_arr, char *nodename);
 
+/*
+ *      index_nodes_by_name - (re)build the server's index of nodes by name
+ */
+void index_nodes_by_name(server_info *sinfo);
+
 /*
  *      dup_node_info - duplicate a node by creating a new one and coping all
  *                      the data into the new
@@ -50,6 +50,7 @@
  * 	free_node_partition()
  * 	dup_node_partition_array()
  * 	dup_node_partition()
+ * 	link_all_nodepart_to_nodes()
  * 	find_node_partition()
  * 	find_node_partition_by_rank()
  * 	create_node_partitions()
@@ -63,6 +64,8 @@
  * 	resresv_can_fit_nodepart()
  * 	create_specific_nodepart()
  * 	create_placement_sets()
+ * 	mark_node_pset_dirty()
+ * 	update_all_nodepart()
  *
  */
 #include <pbs_config.h>
@@ -92,7 +95,10 @@
 #include "globals.h"
 #include "sort.h"
 #include "buckets.h"
+#include "profile.h"
 
+#include <algorithm>
+#include <unordered_set>
 #include <vector>
 
 /**
@@ -276,33 +282,76 @@ dup_node_partition(node_partition *onp, server_info *nsinfo)
 }
 
 /**
- * @brief copy a node partition array from pointers out of another.
- * @param[in] onp_arr - old node partition array
- * @param[in] new_nps - node partition array with new pointers
+ * @brief add a node partition to the np_arr of each of its nodes
  *
- * @return node_partition **
+ * @param[in] np - the node partition
+ *
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
  */
-node_partition **
-copy_node_partition_ptr_array(node_partition **onp_arr, node_partition **new_nps)
+static int
+link_nodepart_to_nodes(node_partition *np)
 {
-	int cnt;
 	int i;
-	node_partition **nnp_arr;
 
-	if (onp_arr == NULL || new_nps == NULL)
-		return NULL;
+	if (np == NULL || np->ninfo_arr == NULL)
+		return 1;
 
-	cnt = count_array(onp_arr);
-	if ((nnp_arr = static_cast<node_partition **>(malloc((cnt + 1) * sizeof(node_partition *)))) == NULL) {
-		log_err(errno, __func__, MEM_ERR_MSG);
-		return NULL;
+	for (i = 0; np->ninfo_arr[i] != NULL; i++) {
+		node_partition **tmp_arr;
+
+		tmp_arr = static_cast<node_partition **>(add_ptr_to_array(np->ninfo_arr[i]->np_arr, np));
+		if (tmp_arr == NULL)
+			return 0;
+		np->ninfo_arr[i]->np_arr = tmp_arr;
 	}
 
-	for (i = 0; i < cnt; i++)
-		nnp_arr[i] = find_node_partition_by_rank(new_nps, onp_arr[i]->rank);
-	nnp_arr[i] = NULL;
+	return 1;
+}
 
-	return nnp_arr;
+/**
+ * @brief add the server's and queues' node partitions to their nodes' np_arr.
+ *	  Used when a server is duplicated: each node's np_arr has to point at
+ *	  the partitions of its own universe.
+ *
+ * @param[in] sinfo - server universe
+ *
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+link_all_nodepart_to_nodes(server_info *sinfo)
+{
+	int i;
+	int j;
+
+	if (sinfo == NULL)
+		return 0;
+
+	if (!link_nodepart_to_nodes(sinfo->allpart))
+		return 0;
+
+	for (i = 0; sinfo->hostsets != NULL && sinfo->hostsets[i] != NULL; i++)
+		if (!link_nodepart_to_nodes(sinfo->hostsets[i]))
+			return 0;
+
+	for (i = 0; sinfo->nodepart != NULL && sinfo->nodepart[i] != NULL; i++)
+		if (!link_nodepart_to_nodes(sinfo->nodepart[i]))
+			return 0;
+
+	for (i = 0; sinfo->queues != NULL && sinfo->queues[i] != NULL; i++) {
+		queue_info *qinfo = sinfo->queues[i];
+
+		if (!link_nodepart_to_nodes(qinfo->allpart))
+			return 0;
+		for (j = 0; qinfo->nodepart != NULL && qinfo->nodepart[j] != NULL; j++)
+			if (!link_nodepart_to_nodes(qinfo->nodepart[j]))
+				return 0;
+	}
+
+	return 1;
 }
 
 /**
@@ -1235,6 +1284,7 @@ create_placement_sets(status *policy, server_info *sinfo)
 	int is_success = 1;
 	const char *resstr[] = {"host", NULL};
 	int num;
+	prof_timer pt(PROF_PLACEMENT_SETS);
 
 	sinfo->allpart = create_specific_nodepart(policy, "all", sinfo->unassoc_nodes, NO_FLAGS);
 	if (sinfo->has_multi_vnode) {
@@ -1242,6 +1292,9 @@ create_placement_sets(status *policy, server_info *sinfo)
 			resstr, sc_attrs.only_explicit_psets ? NP_NONE : NP_CREATE_REST, &num);
 		if (sinfo->hostsets != NULL) {
 			sinfo->num_hostsets = num;
+			/* update_all_nodepart() only moves the host sets which change */
+			if (policy->node_sort[0].res_name != NULL && conf.node_sort_unused)
+				qsort(sinfo->hostsets, sinfo->num_hostsets, sizeof(node_partition *), multi_nodepart_sort);
 			for (i = 0; sinfo->nodes[i] != NULL; i++) {
 				schd_resource *hostres;
 				char hostbuf[256];
@@ -1351,18 +1404,185 @@ sort_all_nodepart(status *policy, server_info *sinfo)
 	}
 }
 
+/**
+ * @brief
+ *		remember a node's contribution to its node partitions before the
+ *		node changes.  Call this before a node's resources or state are
+ *		modified.  The partitions are brought up to date by applying the
+ *		difference in update_all_nodepart() rather than by re-adding every
+ *		node in them.
+ *
+ * @param[in]	ninfo	-	the node about to change
+ *
+ * @return	nothing
+ */
+void
+mark_node_pset_dirty(node_info *ninfo)
+{
+	nodepart_snap *snap;
+	schd_resource *res;
+
+	/* nodes not in any partition (e.g., reservation nodes) have nothing to update */
+	if (ninfo == NULL || ninfo->np_arr == NULL || ninfo->np_snap != NULL)
+		return;
+
+	if ((snap = new nodepart_snap()) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		ninfo->server->pset_metadata_rebuild = 1;
+		ninfo->server->pset_metadata_stale = 1;
+		return;
+	}
+
+	snap->is_free = ninfo->is_free;
+	ninfo->np_snap = snap;
+	for (res = ninfo->res; res != NULL; res = res->next) {
+		if (res->type.is_consumable)
+			snap->res.push_back({res->def, res->avail, res->assigned});
+		/* consuming an indirect resource changes the node which holds it */
+		if (res->indirect_res != NULL)
+			mark_node_pset_dirty(find_node_info(ninfo->server->nodes, res->indirect_vnode_name));
+	}
+
+	ninfo->server->pset_dirty_nodes.push_back(ninfo);
+	ninfo->server->pset_metadata_stale = 1;
+}
+
+/**
+ * @brief
+ *		what a node's consumable resource adds to a node partition.  This
+ *		mirrors node_partition_update(): a node which is not free counts
+ *		all of its resources as assigned.
+ *
+ * @param[in]	avail	-	node's resources available
+ * @param[in]	assigned	-	node's resources assigned
+ * @param[in]	is_free	-	is the node free
+ * @param[out]	np_avail	-	amount added to the partition's available
+ * @param[out]	np_assn	-	amount added to the partition's assigned
+ *
+ * @return	nothing
+ */
+static void
+nodepart_res_contrib(sch_resource_t avail, sch_resource_t assigned, int is_free,
+	sch_resource_t *np_avail, sch_resource_t *np_assn)
+{
+	*np_avail = avail == RES_DEFAULT_AVAIL ? 0 : avail;
+	if (is_free)
+		*np_assn = assigned;
+	else
+		*np_assn = *np_avail;
+}
+
+/**
+ * @brief
+ *		apply the change of a node since mark_node_pset_dirty() to the
+ *		meta data of one of its node partitions
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	np	-	the node partition to update
+ * @param[in]	ninfo	-	the changed node
+ *
+ * @return	nothing
+ */
+static void
+node_partition_update_node(status *policy, node_partition *np, node_info *ninfo)
+{
+	nodepart_snap *snap = ninfo->np_snap;
+	schd_resource *res;
+
+	for (res = np->res; res != NULL; res = res->next) {
+		schd_resource *nres;
+		sch_resource_t old_avail = 0;
+		sch_resource_t old_assn = 0;
+		sch_resource_t new_avail = 0;
+		sch_resource_t new_assn = 0;
+
+		if (!res->type.is_consumable ||
+		    !resdef_exists_in_array(policy->resdef_to_check, res->def))
+			continue;
+
+		for (const auto &ores : snap->res) {
+			if (ores.def == res->def) {
+				nodepart_res_contrib(ores.avail, ores.assigned, snap->is_free,
+					&old_avail, &old_assn);
+				break;
+			}
+		}
+		nres = find_resource(ninfo->res, res->def);
+		if (nres != NULL)
+			nodepart_res_contrib(nres->avail, nres->assigned, ninfo->is_free,
+				&new_avail, &new_assn);
+
+		/* no node sets this resource, leave it unset */
+		if (res->avail != RES_DEFAULT_AVAIL)
+			res->avail += new_avail - old_avail;
+		res->assigned += new_assn - old_assn;
+	}
+
+	if (ninfo->is_free && !snap->is_free)
+		np->free_nodes++;
+	else if (!ninfo->is_free && snap->is_free)
+		np->free_nodes--;
+
+	update_buckets_for_node(np->bkts, ninfo);
+}
+
+/**
+ * @brief
+ *		restore the order of a sorted array after some of its elements'
+ *		sort keys have changed.  The moved elements are pulled out and
+ *		put back with a binary search instead of sorting the whole array.
+ *
+ * @param[in,out]	arr	-	array sorted by cmp except for the moved elements
+ * @param[in]	size	-	size of arr
+ * @param[in]	is_moved	-	returns true for the elements whose key changed
+ * @param[in]	cmp	-	qsort() style comparison function
+ *
+ * @return	nothing
+ */
+template<typename T, typename Pred> static void
+resort_moved(T **arr, int size, Pred is_moved, int (*cmp)(const void *, const void *))
+{
+	std::vector<T *> moved;
+	int len = 0;
+	int i;
+
+	if (arr == NULL)
+		return;
+
+	for (i = 0; i < size; i++) {
+		if (is_moved(arr[i]))
+			moved.push_back(arr[i]);
+		else
+			arr[len++] = arr[i];
+	}
+
+	for (auto elem : moved) {
+		T **pos = std::upper_bound(arr, arr + len, elem,
+			[cmp](T *a, T *b) { return cmp(&a, &b) < 0; });
+		memmove(pos + 1, pos, (arr + len - pos) * sizeof(T *));
+		*pos = elem;
+		len++;
+	}
+}
+
 /**
  *
  *	@brief update all node partitions of all queues on the server
  *	@note Call update_all_nodepart() after all nodes have been processed
  *		by update_node_on_end/update_node_on_run
  *
+ *	  Only the nodes which changed since the last update (see
+ *	  mark_node_pset_dirty()) are applied to the partitions they are in,
+ *	  and only those nodes and partitions are moved to keep their arrays
+ *	  sorted.  Everything is recomputed from scratch if the resources we
+ *	  track have changed.
+ *
  *	  @param[in] policy - policy info
  *	  @param[in] sinfo - server info
  *	  @param[in] flags - flags to modify behavior
- *	  			NO_ALLPART - do not update the metadata in the allpart.
- *	  				     There are circumstances (e.g., calendaring) where
- *	  				     the allpart provides limited use and will constantly
+ *	  			NO_ALLPART - do not recompute the metadata of an allpart
+ *	  				     from scratch.  There are circumstances (e.g., calendaring)
+ *	  				     where the allpart provides limited use and will constantly
  *	  				     be updated.  It is best to just skip it.
  *
  *	@return nothing
@@ -1373,6 +1593,9 @@ update_all_nodepart(status *policy, server_info *sinfo, unsigned int flags)
 {
 	queue_info *qinfo;
 	int i;
+	int sort_nodes;
+	int stale = 0;
+	std::unordered_set<node_partition *> touched;
 
 	if (sinfo == NULL || sinfo->queues == NULL)
 		return;
@@ -1380,29 +1603,91 @@ update_all_nodepart(status *policy, server_info *sinfo, unsigned int flags)
 	if(sinfo->allpart == NULL)
 		return;
 
-	if (sinfo->node_group_enable && sinfo->node_group_key != NULL)
-		node_partition_update_array(policy, sinfo->nodepart);
+	sort_nodes = policy->node_sort[0].res_name != NULL && conf.node_sort_unused;
 
-	/* Update and resort the placement sets on the queues */
-	for (i = 0; sinfo->queues[i] != NULL; i++) {
-		qinfo = sinfo->queues[i];
+	for (auto ninfo : sinfo->pset_dirty_nodes) {
+		for (i = 0; ninfo->np_arr != NULL && ninfo->np_arr[i] != NULL; i++) {
+			node_partition *np = ninfo->np_arr[i];
 
-		if (sinfo->node_group_enable && qinfo->node_group_key != NULL)
-			node_partition_update_array(policy, qinfo->nodepart);
+			/* partitions without meta data are recomputed below */
+			if (np->res == NULL)
+				continue;
+			node_partition_update_node(policy, np, ninfo);
+			touched.insert(np);
+		}
+	}
+
+	if (sort_nodes) {
+		for (auto np : touched)
+			resort_moved(np->ninfo_arr, np->tot_nodes,
+				[](node_info *n) { return n->np_snap != NULL; }, multi_node_sort);
+	}
 
-		if ((flags & NO_ALLPART) == 0) {
-			if(qinfo->allpart != NULL && qinfo->allpart->res == NULL)
+	if (sinfo->pset_metadata_rebuild) {
+		if (sinfo->node_group_enable && sinfo->node_group_key != NULL)
+			node_partition_update_array(policy, sinfo->nodepart);
+
+		for (i = 0; sinfo->queues[i] != NULL; i++) {
+			qinfo = sinfo->queues[i];
+
+			if (sinfo->node_group_enable && qinfo->node_group_key != NULL)
+				node_partition_update_array(policy, qinfo->nodepart);
+
+			/* recomputed below (or on the next update if NO_ALLPART) */
+			if (qinfo->allpart != NULL) {
+				free_resource_list(qinfo->allpart->res);
+				qinfo->allpart->res = NULL;
+			}
+		}
+
+		node_partition_update_array(policy, sinfo->hostsets);
+		free_resource_list(sinfo->allpart->res);
+		sinfo->allpart->res = NULL;
+	}
+
+	for (auto ninfo : sinfo->pset_dirty_nodes) {
+		delete ninfo->np_snap;
+		ninfo->np_snap = NULL;
+	}
+	sinfo->pset_dirty_nodes.clear();
+
+	/* allparts which lost their meta data (see update_universe_on_end()) */
+	for (i = 0; sinfo->queues[i] != NULL; i++) {
+		qinfo = sinfo->queues[i];
+		if (qinfo->allpart != NULL && qinfo->allpart->res == NULL) {
+			if ((flags & NO_ALLPART) == 0)
 				node_partition_update(policy, qinfo->allpart);
+			else
+				stale = 1;
 		}
 	}
 
-	/* Update and resort the hostsets */
-	node_partition_update_array(policy, sinfo->hostsets);
+	if (sinfo->allpart->res == NULL) {
+		if ((flags & NO_ALLPART) == 0)
+			node_partition_update(policy, sinfo->allpart);
+		else
+			stale = 1;
+	}
+
+	if (sinfo->pset_metadata_rebuild) {
+		sort_all_nodepart(policy, sinfo);
+		sinfo->pset_metadata_rebuild = 0;
+	} else if (!touched.empty()) {
+		auto is_touched = [&touched](node_partition *np) { return touched.count(np) != 0; };
 
-	if ((flags & NO_ALLPART) == 0)
-		node_partition_update(policy, sinfo->allpart);
+		if (sinfo->node_group_enable && sinfo->node_group_key != NULL)
+			resort_moved(sinfo->nodepart, sinfo->num_parts, is_touched, cmp_placement_sets);
 
-	sort_all_nodepart(policy, sinfo);
+		for (i = 0; sinfo->queues[i] != NULL; i++) {
+			qinfo = sinfo->queues[i];
+
+			if (sinfo->node_group_enable && qinfo->node_group_key != NULL)
+				resort_moved(qinfo->nodepart, qinfo->num_parts, is_touched, cmp_placement_sets);
+		}
+
+		if (sort_nodes && sinfo->hostsets != NULL)
+			resort_moved(sinfo->hostsets, sinfo->num_hostsets, is_touched, multi_nodepart_sort);
+	}
 
-	sinfo->pset_metadata_stale = 0;
+	sinfo->pset_metadata_stale = stale;
 }
@@ -101,8 +101,8 @@ node_partition **dup_node_partition_array(node_partition **onp_arr, server_info
  */
 node_partition *dup_node_partition(node_partition *onp, server_info *nsinfo);
 
-/* copy a node partition array from pointers out of another.*/
-node_partition **copy_node_partition_ptr_array(node_partition **onp_arr, node_partition **new_nps);
+/* add the server's and queues' node partitions to their nodes' np_arr */
+int link_all_nodepart_to_nodes(server_info *sinfo);
 
 /*
  *
@@ -224,6 +224,9 @@ void update_all_nodepart(status *policy, server_info *sinfo, unsigned int flags)
 /* Sort all placement sets (server's psets, queue's psets, and hostsets) */
 void sort_all_nodepart(status *policy, server_info *sinfo);
 
+/* Remember a node's placement set contribution before it changes */
+void mark_node_pset_dirty(node_info *ninfo);
+
 /*
  * update the node buckets associated with a node
  */
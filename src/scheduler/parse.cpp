@@ -274,6 +274,10 @@ parse_config(const char *fname)
 					conf.enforce_no_shares = num ? 1 : 0;
 				else if (!strcmp(config_name, PARSE_ALLOW_AOE_CALENDAR))
 					conf.allow_aoe_calendar = 1;
+				else if (!strcmp(config_name, PARSE_CYCLE_PROFILE))
+					conf.cycle_profile = num ? 1 : 0;
+				else if (!strcmp(config_name, PARSE_SPECULATIVE_JOB_EVAL))
+					conf.speculative_job_eval = num ? 1 : 0;
 				else if (!strcmp(config_name, PARSE_PRIME_SPILL)) {
 					if (prime == PRIME || prime == PT_ALL)
 						conf.prime_spill = res_to_num(config_value, &type);
@@ -288,6 +292,11 @@ parse_config(const char *fname)
 					if (!type.is_time)
 						error = 1;
 				}
+				else if (!strcmp(config_name, PARSE_EST_START_TIME_FREQ)) {
+					conf.est_start_time_freq = res_to_num(config_value, &type);
+					if (!type.is_time)
+						error = 1;
+				}
 				else if (!strcmp(config_name, PARSE_HALF_LIFE) || !strcmp(config_name, PARSE_FAIRSHARE_DECAY_TIME)) {
 					if(!strcmp(config_name, PARSE_HALF_LIFE)) {
 						obsolete[0] = PARSE_HALF_LIFE;
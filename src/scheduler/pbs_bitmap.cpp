@@ -44,6 +44,144 @@
 #include "pbs_bitmap.h"
 
 #define BYTES_TO_BITS(x) ((x) * 8)
+#define BITS_PER_LONG BYTES_TO_BITS(sizeof(unsigned long))
+
+/*
+ * The bulk operations work a word at a time.  On x86_64 the AND/OR/ANDNOT
+ * loops use AVX2 and popcount uses the POPCNT instruction when the CPU
+ * running us has them.  Otherwise the plain loops below are used.
+ */
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define PBS_BITMAP_X86
+#endif
+
+enum bitmap_op {
+	BITMAP_AND,
+	BITMAP_OR,
+	BITMAP_ANDNOT
+};
+
+/**
+ * @brief scalar version of L op= R over n longs
+ */
+static void
+bits_op_scalar(enum bitmap_op op, unsigned long *l, const unsigned long *r, unsigned long n)
+{
+	unsigned long i;
+
+	switch (op) {
+		case BITMAP_AND:
+			for (i = 0; i < n; i++)
+				l[i] &= r[i];
+			break;
+		case BITMAP_OR:
+			for (i = 0; i < n; i++)
+				l[i] |= r[i];
+			break;
+		case BITMAP_ANDNOT:
+			for (i = 0; i < n; i++)
+				l[i] &= ~r[i];
+			break;
+	}
+}
+
+/**
+ * @brief scalar popcount over n longs
+ */
+static unsigned long
+bits_popcount_scalar(const unsigned long *bits, unsigned long n)
+{
+	unsigned long i;
+	unsigned long ct = 0;
+
+	for (i = 0; i < n; i++)
+		ct += __builtin_popcountl(bits[i]);
+
+	return ct;
+}
+
+#ifdef PBS_BITMAP_X86
+/**
+ * @brief AVX2 version of L op= R over n longs
+ */
+__attribute__((target("avx2"))) static void
+bits_op_avx2(enum bitmap_op op, unsigned long *l, const unsigned long *r, unsigned long n)
+{
+	unsigned long i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		__m256i a = _mm256_loadu_si256((const __m256i *) (l + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *) (r + i));
+
+		switch (op) {
+			case BITMAP_AND:
+				a = _mm256_and_si256(a, b);
+				break;
+			case BITMAP_OR:
+				a = _mm256_or_si256(a, b);
+				break;
+			case BITMAP_ANDNOT:
+				/* _mm256_andnot_si256(x, y) is ~x & y */
+				a = _mm256_andnot_si256(b, a);
+				break;
+		}
+		_mm256_storeu_si256((__m256i *) (l + i), a);
+	}
+	bits_op_scalar(op, l + i, r + i, n - i);
+}
+
+/**
+ * @brief popcount over n longs with the POPCNT instruction
+ */
+__attribute__((target("popcnt"))) static unsigned long
+bits_popcount_hw(const unsigned long *bits, unsigned long n)
+{
+	unsigned long i;
+	unsigned long ct = 0;
+
+	for (i = 0; i < n; i++)
+		ct += __builtin_popcountl(bits[i]);
+
+	return ct;
+}
+#endif
+
+/**
+ * @brief L op= R over n longs using the best instructions available
+ */
+static void
+bits_op(enum bitmap_op op, unsigned long *l, const unsigned long *r, unsigned long n)
+{
+#ifdef PBS_BITMAP_X86
+	static int have_avx2 = -1;
+
+	if (have_avx2 == -1)
+		have_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+	if (have_avx2) {
+		bits_op_avx2(op, l, r, n);
+		return;
+	}
+#endif
+	bits_op_scalar(op, l, r, n);
+}
+
+/**
+ * @brief popcount over n longs using the best instructions available
+ */
+static unsigned long
+bits_popcount(const unsigned long *bits, unsigned long n)
+{
+#ifdef PBS_BITMAP_X86
+	static int have_popcnt = -1;
+
+	if (have_popcnt == -1)
+		have_popcnt = __builtin_cpu_supports("popcnt") ? 1 : 0;
+	if (have_popcnt)
+		return bits_popcount_hw(bits, n);
+#endif
+	return bits_popcount_scalar(bits, n);
+}
 
 
 /**
@@ -216,8 +354,8 @@ int
 pbs_bitmap_next_on_bit(pbs_bitmap *pbm, unsigned long start_bit)
 {
 	unsigned long long_ind;
-	long bit;
-	size_t i;
+	unsigned long bit;
+	unsigned long w;
 
 	if (pbm == NULL)
 		return -1;
@@ -225,34 +363,19 @@ pbs_bitmap_next_on_bit(pbs_bitmap *pbm, unsigned long start_bit)
 	if (start_bit >= pbm->num_bits)
 		return -1;
 
-	long_ind = start_bit / BYTES_TO_BITS(sizeof(unsigned long));
-	bit = start_bit % BYTES_TO_BITS(sizeof(unsigned long));
+	long_ind = start_bit / BITS_PER_LONG;
+	bit = start_bit % BITS_PER_LONG;
 
-	/* special case - look at first long that contains start_bit */
-	if (pbm->bits[long_ind] != 0) {
-		for (i = bit + 1; i < BYTES_TO_BITS(sizeof(unsigned long)); i++) {
-			if (pbm->bits[long_ind] & (1UL << i)) {
-				return (long_ind * BYTES_TO_BITS(sizeof(unsigned long)) + i);
-			}
-		}
-
-		/* didn't find an on bit after start_bit_index in the long that contained start_bit */
-		if (long_ind < pbm->num_longs) {
-			long_ind++;
-		}
+	/* special case - look at the rest of the long that contains start_bit */
+	if (bit + 1 < BITS_PER_LONG) {
+		w = pbm->bits[long_ind] & (~0UL << (bit + 1));
+		if (w != 0)
+			return (long_ind * BITS_PER_LONG + __builtin_ctzl(w));
 	}
 
-	for( ; long_ind < pbm->num_longs && pbm->bits[long_ind] == 0; long_ind++)
-		;
-
-	if (long_ind == pbm->num_longs)
-		return -1;
-
-	for (i = 0 ; i < BYTES_TO_BITS(sizeof(unsigned long)) ; i++) {
-		if (pbm->bits[long_ind] & (1UL << i)) {
-			return (long_ind * BYTES_TO_BITS(sizeof(unsigned long)) + i);
-		}
-	}
+	for (long_ind++; long_ind < pbm->num_longs; long_ind++)
+		if (pbm->bits[long_ind] != 0)
+			return (long_ind * BITS_PER_LONG + __builtin_ctzl(pbm->bits[long_ind]));
 
 	return -1;
 }
@@ -334,3 +457,146 @@ pbs_bitmap_is_equal(pbs_bitmap *L, pbs_bitmap *R)
 
 	return 1;
 }
+
+/**
+ * @brief pbs_bitmap version of L &= R
+ * @param L - bitmap lvalue
+ * @param R - bitmap rvalue
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_and(pbs_bitmap *L, pbs_bitmap *R)
+{
+	unsigned long n;
+	unsigned long i;
+
+	if (L == NULL || R == NULL)
+		return 0;
+
+	n = L->num_longs < R->num_longs ? L->num_longs : R->num_longs;
+	bits_op(BITMAP_AND, L->bits, R->bits, n);
+	/* bits past the end of R are off in R */
+	for (i = n; i < L->num_longs; i++)
+		L->bits[i] = 0;
+
+	return 1;
+}
+
+/**
+ * @brief pbs_bitmap version of L |= R
+ * @param L - bitmap lvalue
+ * @param R - bitmap rvalue
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_or(pbs_bitmap *L, pbs_bitmap *R)
+{
+	if (L == NULL || R == NULL)
+		return 0;
+
+	if (R->num_longs > L->num_longs)
+		if (pbs_bitmap_alloc(L, BYTES_TO_BITS(R->num_longs * sizeof(unsigned long))) == NULL)
+			return 0;
+	if (R->num_bits > L->num_bits)
+		L->num_bits = R->num_bits;
+
+	bits_op(BITMAP_OR, L->bits, R->bits, R->num_longs);
+
+	return 1;
+}
+
+/**
+ * @brief pbs_bitmap version of L &= ~R
+ * @param L - bitmap lvalue
+ * @param R - bitmap rvalue
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_andnot(pbs_bitmap *L, pbs_bitmap *R)
+{
+	unsigned long n;
+
+	if (L == NULL || R == NULL)
+		return 0;
+
+	n = L->num_longs < R->num_longs ? L->num_longs : R->num_longs;
+	bits_op(BITMAP_ANDNOT, L->bits, R->bits, n);
+
+	return 1;
+}
+
+/**
+ * @brief count the on bits in a bitmap
+ * @param bm - the bitmap
+ * @return unsigned long
+ * @retval number of on bits
+ */
+unsigned long
+pbs_bitmap_popcount(pbs_bitmap *bm)
+{
+	if (bm == NULL)
+		return 0;
+
+	return bits_popcount(bm->bits, bm->num_longs);
+}
+
+/**
+ * @brief set L to the first n on bits of R (in bit order).  If R has fewer
+ *	  than n on bits, L becomes a copy of R.
+ * @param L - bitmap lvalue
+ * @param R - bitmap rvalue
+ * @param n - number of on bits to take
+ * @return unsigned long
+ * @retval number of on bits in L
+ */
+unsigned long
+pbs_bitmap_first_n_on_bits(pbs_bitmap *L, pbs_bitmap *R, unsigned long n)
+{
+	unsigned long taken = 0;
+	unsigned long i;
+
+	if (L == NULL || R == NULL)
+		return 0;
+
+	if (pbs_bitmap_assign(L, R) == 0)
+		return 0;
+
+	for (i = 0; i < L->num_longs; i++) {
+		unsigned long w = L->bits[i];
+		unsigned long ct;
+
+		if (taken == n) {
+			L->bits[i] = 0;
+			continue;
+		}
+		if (w == 0)
+			continue;
+
+		ct = __builtin_popcountl(w);
+		if (taken + ct <= n) {
+			taken += ct;
+			continue;
+		}
+
+		/* only part of this word is needed: keep its lowest bits */
+		{
+			unsigned long keep = 0;
+
+			for (; taken < n; taken++) {
+				unsigned long low = w & -w;
+
+				keep |= low;
+				w &= w - 1;
+			}
+			L->bits[i] = keep;
+		}
+	}
+
+	return taken;
+}
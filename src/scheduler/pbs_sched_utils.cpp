@@ -1073,6 +1073,7 @@ sched_main(int argc, char *argv[], schedule_func sched_ptr)
 #endif
 	pid = getpid();
 	daemon_protect(0, PBS_DAEMON_PROTECT_ON);
+	set_log_async(pbs_conf.pbs_log_async, pbs_conf.pbs_log_async_drop, pbs_conf.pbs_log_async_flush);
 	freopen("/dev/null", "r", stdin);
 
 	/* write schedulers pid into lockfile */
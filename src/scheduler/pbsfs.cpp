@@ -211,7 +211,7 @@ main(int argc, char *argv[])
 		fprintf(stderr, "Error in preloading fairshare information\n");
 		return 1;
 	}
-	if (parse_group(RESGROUP_FILE, conf.fairshare->root) == 0)
+	if (parse_group(RESGROUP_FILE, conf.fairshare) == 0)
 		return 1;
 
 	if (flags & FS_TRIM_TREE)
@@ -231,14 +231,14 @@ main(int argc, char *argv[])
 	else if (flags & FS_DECAY)
 		decay_fairshare_tree(conf.fairshare->root);
 	else if (flags & (FS_GET | FS_SET | FS_COMP)) {
-		ginfo = find_group_info(argv[optind], conf.fairshare->root);
+		ginfo = find_group_info(argv[optind], conf.fairshare);
 
 		if (ginfo == NULL) {
 			fprintf(stderr, "Fairshare Entity %s does not exist.\n", argv[optind]);
 			return 1;
 		}
 		if (flags & FS_COMP) {
-			ginfo2 = find_group_info(argv[optind + 1], conf.fairshare->root);
+			ginfo2 = find_group_info(argv[optind + 1], conf.fairshare);
 
 			if (ginfo2 == NULL) {
 				fprintf(stderr, "Fairshare Entity %s does not exist.\n", argv[optind + 1]);
@@ -305,7 +305,7 @@ print_fairshare_entity(group_info *ginfo)
 		ginfo->cresgroup,
 		ginfo->shares,
 		ginfo->tree_percentage * 100,
-		ginfo->usage_factor,
+		get_usage_factor(conf.fairshare, ginfo),
 		ginfo->usage, conf.fairshare_res,
 		ginfo->tree_percentage == 0 ? -1 : ginfo->usage / ginfo->tree_percentage);
 
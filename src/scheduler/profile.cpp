@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+/**
+ * @file    profile.cpp
+ *
+ * @brief
+ * 		profile.cpp - per-phase timing of scheduling cycles.
+ *		When cycle_profile is set in the sched config, the time spent
+ *		in each phase of a cycle is summed up, logged at the end of the
+ *		cycle and written as JSON to PROF_FILE in sched_priv.
+ *
+ * Functions included are:
+ * 	prof_cycle_start()
+ * 	prof_add()
+ * 	prof_cycle_end()
+ */
+
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/param.h>
+
+#include "log.h"
+#include "constant.h"
+#include "data_types.h"
+#include "globals.h"
+#include "profile.h"
+
+struct prof_stat
+{
+	unsigned long calls;		/* number of timed calls */
+	double total;			/* total seconds */
+	double max;			/* longest call in seconds */
+	unsigned long hist[PROF_HIST_SIZE];	/* calls by log2 of microseconds */
+};
+
+static const char *prof_names[PROF_HIGH] = {
+	"cycle",
+	"query_server",
+	"sort_jobs",
+	"create_node_buckets",
+	"placement_sets",
+	"is_ok_to_run",
+	"calendar",
+	"preemption",
+	"run_job"
+};
+
+int prof_enabled = 0;
+
+static struct prof_stat cycle_stats[PROF_HIGH];	/* the current cycle */
+static struct prof_stat total_stats[PROF_HIGH];	/* all cycles since start */
+static unsigned long prof_cycles = 0;
+static struct timespec cycle_start;
+static time_t cycle_start_wall;
+static pthread_t prof_thread;
+
+/**
+ * @brief
+ * 		prof_cycle_start - start profiling a scheduling cycle.  Nothing
+ *		is timed unless cycle_profile is set in the sched config.
+ *
+ * @return void
+ */
+void
+prof_cycle_start(void)
+{
+	prof_enabled = conf.cycle_profile;
+	if (!prof_enabled)
+		return;
+
+	memset(cycle_stats, 0, sizeof(cycle_stats));
+	prof_thread = pthread_self();
+	cycle_start_wall = time(NULL);
+	clock_gettime(CLOCK_MONOTONIC, &cycle_start);
+}
+
+/**
+ * @brief
+ * 		prof_add - add one call of a phase to the cycle profile.  Only
+ *		calls made from the thread running the cycle are counted.
+ *
+ * @param[in]	phase	-	the phase which was timed
+ * @param[in]	start	-	when the call started
+ *
+ * @return void
+ */
+void
+prof_add(enum prof_phase phase, const struct timespec *start)
+{
+	struct timespec now;
+	struct prof_stat *ps;
+	double secs;
+	long usecs;
+	int b;
+
+	if (!prof_enabled || phase >= PROF_HIGH)
+		return;
+
+	if (!pthread_equal(pthread_self(), prof_thread))
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	secs = (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+
+	ps = &cycle_stats[phase];
+	ps->calls++;
+	ps->total += secs;
+	if (secs > ps->max)
+		ps->max = secs;
+
+	usecs = (long) (secs * 1e6);
+	for (b = 0; b < PROF_HIST_SIZE - 1 && usecs >= (1L << b); b++)
+		;
+	ps->hist[b]++;
+}
+
+/**
+ * @brief
+ * 		write_prof_stats - write the stats of all phases as a JSON object
+ *
+ * @param[in]	fp	-	file to write to
+ * @param[in]	stats	-	PROF_HIGH stats to write
+ *
+ * @return void
+ */
+static void
+write_prof_stats(FILE *fp, struct prof_stat *stats)
+{
+	int i, j;
+
+	fprintf(fp, "{");
+	for (i = 0; i < PROF_HIGH; i++) {
+		fprintf(fp, "%s\n\t\t\"%s\": {\"calls\": %lu, \"total\": %.6f, \"max\": %.6f, \"hist_usec_log2\": [",
+			i ? "," : "", prof_names[i], stats[i].calls, stats[i].total, stats[i].max);
+		for (j = 0; j < PROF_HIST_SIZE; j++)
+			fprintf(fp, "%s%lu", j ? ", " : "", stats[i].hist[j]);
+		fprintf(fp, "]}");
+	}
+	fprintf(fp, "\n\t}");
+}
+
+/**
+ * @brief
+ * 		prof_cycle_end - finish the profile of a scheduling cycle.
+ *		The phase totals are logged and the profile of the cycle and of
+ *		all profiled cycles since the scheduler started is written to
+ *		PROF_FILE.  The file is replaced, so readers never see a partial
+ *		profile.
+ *
+ * @return void
+ */
+void
+prof_cycle_end(void)
+{
+	char buf[MAX_LOG_SIZE];
+	char tmpfile[MAXPATHLEN + 1];
+	FILE *fp;
+	int i, j;
+	size_t len = 0;
+
+	if (!prof_enabled)
+		return;
+
+	prof_add(PROF_CYCLE, &cycle_start);
+	prof_enabled = 0;
+	prof_cycles++;
+
+	for (i = 0; i < PROF_HIGH; i++) {
+		total_stats[i].calls += cycle_stats[i].calls;
+		total_stats[i].total += cycle_stats[i].total;
+		if (cycle_stats[i].max > total_stats[i].max)
+			total_stats[i].max = cycle_stats[i].max;
+		for (j = 0; j < PROF_HIST_SIZE; j++)
+			total_stats[i].hist[j] += cycle_stats[i].hist[j];
+
+		if (len < sizeof(buf))
+			len += snprintf(buf + len, sizeof(buf) - len, "%s%s=%.3fs/%lu",
+				i ? " " : "", prof_names[i], cycle_stats[i].total, cycle_stats[i].calls);
+	}
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG, __func__, "Cycle profile: %s", buf);
+
+	snprintf(tmpfile, sizeof(tmpfile), "%s.tmp", PROF_FILE);
+	if ((fp = fopen(tmpfile, "w")) == NULL) {
+		log_err(errno, __func__, "Unable to write " PROF_FILE);
+		return;
+	}
+	fprintf(fp, "{\n\t\"cycle_start\": %ld,\n\t\"cycles\": %lu,\n\t\"phases\": ",
+		(long) cycle_start_wall, prof_cycles);
+	write_prof_stats(fp, cycle_stats);
+	fprintf(fp, ",\n\t\"totals\": ");
+	write_prof_stats(fp, total_stats);
+	fprintf(fp, "\n}\n");
+
+	if (fclose(fp) != 0 || rename(tmpfile, PROF_FILE) == -1) {
+		log_err(errno, __func__, "Unable to write " PROF_FILE);
+		unlink(tmpfile);
+	}
+}
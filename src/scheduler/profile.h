@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <time.h>
+
+/* phases of a scheduling cycle timed by the cycle profiler.
+ * Phases nest: e.g. PROF_IS_OK_TO_RUN is also counted while inside
+ * PROF_CALENDAR, and PROF_SORT_JOBS while inside PROF_QUERY_SERVER.
+ */
+enum prof_phase {
+	PROF_CYCLE,
+	PROF_QUERY_SERVER,
+	PROF_SORT_JOBS,
+	PROF_NODE_BUCKETS,
+	PROF_PLACEMENT_SETS,
+	PROF_IS_OK_TO_RUN,
+	PROF_CALENDAR,
+	PROF_PREEMPT,
+	PROF_RUN_JOB,
+	PROF_HIGH
+};
+
+/* histogram buckets: bucket i counts calls taking < 2^i microseconds,
+ * the last bucket counts everything longer
+ */
+#define PROF_HIST_SIZE 24
+
+/* file in sched_priv the profile of the last cycle is written to */
+#define PROF_FILE "cycle_profile.json"
+
+/* start a new cycle profile if cycle_profile is set in the sched config */
+void prof_cycle_start(void);
+
+/* finish the cycle profile: log a summary and write PROF_FILE */
+void prof_cycle_end(void);
+
+/* add one timed call of a phase to the current cycle */
+void prof_add(enum prof_phase phase, const struct timespec *start);
+
+extern int prof_enabled;
+
+/* times a phase from construction to the end of its scope */
+class prof_timer
+{
+	enum prof_phase phase;
+	struct timespec start;
+	bool active;
+public:
+	explicit prof_timer(enum prof_phase ph) : phase(ph), active(false)
+	{
+		if (prof_enabled) {
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			active = true;
+		}
+	}
+	~prof_timer()
+	{
+		if (active)
+			prof_add(phase, &start);
+	}
+};
+
+#endif	/* _PROFILE_H */
@@ -94,6 +94,8 @@
 #include "parse.h"
 #include "limits_if.h"
 #include "fifo.h"
+#include "node_info.h"
+#include "formula.h"
 
 
 
@@ -221,6 +223,11 @@ query_resources(int pbs_sd)
 		free_resdef_array(defarr);
 		return NULL;
 	}
+
+	/* used to index per-resource arrays like counts::rescts_by_def */
+	for (i = 0; defarr[i] != NULL; i++)
+		defarr[i]->rindex = i;
+
 	return defarr;
 }
 
@@ -327,6 +334,7 @@ new_resdef(void)
 	}
 
 	newdef->name = NULL;
+	newdef->rindex = -1;
 	/* calloc will have zeroed flags and the type structure */
 
 	return newdef;
@@ -352,6 +360,7 @@ dup_resdef(resdef *olddef)
 
 	newdef->type = olddef->type;
 	newdef->flags = olddef->flags;
+	newdef->rindex = olddef->rindex;
 	newdef->name = string_dup(olddef->name);
 
 	if (newdef->name == NULL) {
@@ -579,6 +588,8 @@ reset_global_resource_ptrs(void)
 	update_sorting_defs(SD_FREE);
 
 	clear_last_running();
+	clear_node_query_cache();
+	clear_formula_cache();
 
 	/* The above references into this array.  We now free the memory */
 	if (allres != NULL) {
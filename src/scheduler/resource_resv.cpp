@@ -52,6 +52,7 @@
  * 	dup_resource_resv_array()
  * 	dup_resource_resv()
  * 	find_resource_resv()
+ * 	index_resresv_by_name()
  * 	find_resource_resv_by_indrank()
  * 	find_resource_resv_by_time()
  * 	find_resource_resv_func()
@@ -85,6 +86,7 @@
  * 	free_chunk()
  * 	new_selspec()
  * 	dup_selspec()
+ * 	share_selspec()
  * 	free_selspec()
  * 	compare_res_to_str()
  * 	compare_non_consumable()
@@ -617,8 +619,9 @@ dup_resource_resv(resource_resv *oresresv, server_info *nsinfo, queue_info *nqin
 	nresresv->project = string_dup(oresresv->project);
 
 	nresresv->nodepart_name = string_dup(oresresv->nodepart_name);
-	nresresv->select = dup_selspec(oresresv->select); /* must come before calls to dup_nspecs() below */
-	nresresv->execselect = dup_selspec(oresresv->execselect);
+	/* select specs are read-only: share them rather than copy them */
+	nresresv->select = share_selspec(oresresv->select); /* must come before calls to dup_nspecs() below */
+	nresresv->execselect = share_selspec(oresresv->execselect);
 
 	nresresv->is_invalid = oresresv->is_invalid;
 	nresresv->can_not_fit = oresresv->can_not_fit;
@@ -705,6 +708,8 @@ dup_resource_resv(resource_resv *oresresv, server_info *nsinfo, queue_info *nqin
 /**
  * @brief
  * 		find a resource_resv by name
+ *		If the array is the server's all_resresv or jobs array, the
+ *		server's name index is used instead of searching the array.
  *
  * @param[in]	resresv_arr	-	array of resource_resvs to search
  * @param[in]	name        -	name of resource_resv to find
@@ -717,16 +722,58 @@ dup_resource_resv(resource_resv *oresresv, server_info *nsinfo, queue_info *nqin
 resource_resv *
 find_resource_resv(resource_resv **resresv_arr, char *name)
 {
+	server_info *sinfo;
 	int i;
 	if (resresv_arr == NULL || name == NULL)
 		return NULL;
 
+	if (resresv_arr[0] != NULL && (sinfo = resresv_arr[0]->server) != NULL &&
+		(resresv_arr == sinfo->all_resresv || resresv_arr == sinfo->jobs) &&
+		!sinfo->resresv_by_name.empty()) {
+		auto it = sinfo->resresv_by_name.find(name);
+
+		if (it == sinfo->resresv_by_name.end())
+			return NULL;
+		if (resresv_arr == sinfo->jobs && !it->second->is_job)
+			return NULL;
+		return it->second;
+	}
+
 	for (i = 0; resresv_arr[i] != NULL && strcmp(resresv_arr[i]->name, name);i++)
 		;
 
 	return resresv_arr[i];
 }
 
+/**
+ * @brief
+ * 		(re)build the server's index of all_resresv by name.  The first
+ *		resource_resv wins if two share a name, just like a search of the
+ *		array would.
+ *
+ * @param[in,out]	sinfo	-	server whose jobs and reservations to index
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+void
+index_resresv_by_name(server_info *sinfo)
+{
+	int i;
+
+	if (sinfo == NULL)
+		return;
+
+	sinfo->resresv_by_name.clear();
+	if (sinfo->all_resresv == NULL)
+		return;
+
+	sinfo->resresv_by_name.reserve(sinfo->sc.total + sinfo->num_resvs);
+	for (i = 0; sinfo->all_resresv[i] != NULL; i++)
+		sinfo->resresv_by_name.emplace(sinfo->all_resresv[i]->name, sinfo->all_resresv[i]);
+}
+
 /**
  * @brief
  * 		find a resource_resv by index in all_resresv array or by unique numeric rank
@@ -1942,8 +1989,12 @@ add_resresv_to_array(resource_resv **resresv_arr,
 	if (new_arr != NULL) {
 		new_arr[size] = resresv;
 		new_arr[size+1] = NULL;
-		if (flags & SET_RESRESV_INDEX)
+		if (flags & SET_RESRESV_INDEX) {
 		    resresv->resresv_ind = size;
+		    /* this is the server's all_resresv: keep its name index current */
+		    if (resresv->server != NULL && !resresv->server->resresv_by_name.empty())
+			resresv->server->resresv_by_name.emplace(resresv->name, resresv);
+		}
 	}
 	else {
 		log_err(errno, __func__, MEM_ERR_MSG);
@@ -2313,6 +2364,7 @@ new_selspec()
 	spec->total_cpus = 0;
 	spec->defs = NULL;
 	spec->chunks = NULL;
+	spec->refct = 1;
 
 	return spec;
 }
@@ -2354,7 +2406,34 @@ dup_selspec(selspec *oldspec)
 
 /**
  * @brief
- *		free_selspec - destructor for selspec
+ *		share_selspec - take another reference to a selspec instead of
+ *				copying it.  Select specs are not modified once
+ *				they are parsed, so a duplicated universe can share
+ *				them with the universe it was duplicated from.
+ *				Callers which want to modify a selspec must use
+ *				dup_selspec() instead.
+ *
+ * @param[in]	spec	-	selspec to share
+ *
+ * @return	spec
+ *
+ * @par MT-Safe:	yes
+ */
+selspec *
+share_selspec(selspec *spec)
+{
+	if (spec == NULL)
+		return NULL;
+
+	__atomic_add_fetch(&spec->refct, 1, __ATOMIC_RELAXED);
+
+	return spec;
+}
+
+/**
+ * @brief
+ *		free_selspec - destructor for selspec.  The selspec is only freed
+ *			       when its last reference is dropped.
  *
  * @param[in,out]	spec	-	selspec to be freed.
  */
@@ -2364,6 +2443,9 @@ free_selspec(selspec *spec)
 	if (spec == NULL)
 		return;
 
+	if (__atomic_sub_fetch(&spec->refct, 1, __ATOMIC_ACQ_REL) > 0)
+		return;
+
 	if (spec->defs != NULL)
 		free(spec->defs);
 
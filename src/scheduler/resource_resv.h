@@ -96,6 +96,11 @@ int is_resource_resv_valid(resource_resv *resresv, schd_error *err);
  */
 resource_resv *find_resource_resv(resource_resv **resresv_arr, char *name);
 
+/*
+ *      index_resresv_by_name - (re)build the server's index of all_resresv by name
+ */
+void index_resresv_by_name(server_info *sinfo);
+
 /*
  * find a resource_resv by unique numeric rank
 
@@ -339,6 +344,11 @@ selspec *new_selspec();
  */
 selspec *dup_selspec(selspec *oldspec);
 
+/*
+ *	share_selspec - take another reference to a read-only selspec
+ */
+selspec *share_selspec(selspec *spec);
+
 /*
  *	free_selspec - destructor for selspec
  */
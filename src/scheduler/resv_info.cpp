@@ -970,9 +970,9 @@ dup_resv_info(resv_info *rinfo, server_info *sinfo)
 	if (rinfo->partition != NULL)
 		nrinfo->partition = string_dup(rinfo->partition);
 	if (rinfo->select_orig != NULL)
-		nrinfo->select_orig = dup_selspec(rinfo->select_orig);
+		nrinfo->select_orig = share_selspec(rinfo->select_orig);
 	if (rinfo->select_standing != NULL)
-		nrinfo->select_standing = dup_selspec(rinfo->select_standing);
+		nrinfo->select_standing = share_selspec(rinfo->select_standing);
 
 	/* the queues may not be available right now.  If they aren't, we'll
 	 * catch this when we duplicate the queues
@@ -47,6 +47,7 @@
 #include "globals.h"
 #include "job_info.h"
 #include "log.h"
+#include "profile.h"
 
 
 /**
@@ -68,6 +69,7 @@ send_run_job(int virtual_sd, int has_runjob_hook, char *jobid, char *execvnode,
 {
 	char extend[PBS_MAXHOSTNAME + 6];
  	int job_owner_sd;
+	prof_timer pt(PROF_RUN_JOB);
 
 	if (jobid == NULL || execvnode == NULL || svr_id_node == NULL || svr_id_job == NULL)
 		return 1;
@@ -144,6 +146,48 @@ send_attr_updates(int job_owner_sd, char *job_name, struct attrl *pattr)
 	return 0;
 }
 
+/**
+ * @brief
+ * 		send delayed attributes to the server for many jobs in one
+ *		pbs_asyalterjobs() call
+ *
+ * @param[in]	job_owner_sd	-	server connection descriptor of the jobs' owner
+ * @param[in]	jobs	-	job ids and the attrl lists to update on the server
+ * @param[in]	njobs	-	number of entries in jobs
+ *
+ * @return	int
+ * @retval	1	success
+ * @retval	0	failure to update
+ */
+int
+send_attr_updates_bulk(int job_owner_sd, alterjob_info *jobs, int njobs)
+{
+	const char *errbuf;
+
+	if (jobs == NULL || njobs <= 0)
+		return 0;
+
+	if (job_owner_sd == SIMULATE_SD)
+		return 1; /* simulation always successful */
+
+	if (njobs == 1)
+		return send_attr_updates(job_owner_sd, jobs[0].job_id, jobs[0].attrib);
+
+	if (pbs_asyalterjobs(job_owner_sd, jobs, njobs, NULL) == 0) {
+		last_attr_updates = time(NULL);
+		return 1;
+	}
+
+	errbuf = pbs_geterrmsg(job_owner_sd);
+	if (errbuf == NULL)
+		errbuf = "";
+	log_eventf(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, __func__,
+		"Failed to update attributes of %d jobs: %s (%d)",
+		njobs, errbuf, pbs_errno);
+
+	return 0;
+}
+
 /**
  * @brief	Wrapper for pbs_preempt_jobs
  *
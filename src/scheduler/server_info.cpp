@@ -87,6 +87,9 @@
  * 	dup_counts_list()
  * 	find_counts()
  * 	find_alloc_counts()
+ * 	index_counts_list()
+ * 	find_counts_res()
+ * 	find_alloc_counts_res()
  * 	update_counts_on_run()
  * 	update_counts_on_end()
  * 	counts_max()
@@ -152,6 +155,7 @@
 #include "parse.h"
 #include "hook.h"
 #include "libpbs.h"
+#include "profile.h"
 #ifdef NAS
 #include "site_code.h"
 #endif
@@ -193,6 +197,7 @@ query_server(status *pol, int pbs_sd)
 	resource_resv **jobs_alive;
 	status *policy;
 	int job_arrays_associated = FALSE;
+	prof_timer pt(PROF_QUERY_SERVER);
 
 	if (pol == NULL)
 		return NULL;
@@ -258,6 +263,7 @@ query_server(status *pol, int pbs_sd)
 		pbs_statfree(bs_resvs);
 		return NULL;
 	}
+	index_nodes_by_name(sinfo);
 
 	/* sort the nodes before we filter them down to more useful lists */
 	if (policy->node_sort[0].res_name != NULL)
@@ -1183,6 +1189,7 @@ new_server_info(int limallocflag)
 	sinfo->has_nonCPU_licenses = 0;
 	sinfo->use_hard_duration = 0;
 	sinfo->pset_metadata_stale = 0;
+	sinfo->pset_metadata_rebuild = 0;
 	sinfo->num_parts = 0;
 	sinfo->name = NULL;
 	sinfo->res = NULL;
@@ -1220,6 +1227,7 @@ new_server_info(int limallocflag)
 	sinfo->num_nodes = 0;
 	sinfo->num_resvs = 0;
 	sinfo->num_hostsets = 0;
+	sinfo->spec_gen = 0;
 	sinfo->server_time = 0;
 	sinfo->job_sort_formula = NULL;
 
@@ -1923,6 +1931,7 @@ copy_server_arrays(server_info *nsinfo, server_info *osinfo)
 	nsinfo->jobs = job_arr;
 	nsinfo->all_resresv = all_arr;
 	nsinfo->num_resvs = osinfo->num_resvs;
+	index_resresv_by_name(nsinfo);
 	return 1;
 }
 
@@ -2009,6 +2018,7 @@ create_server_arrays(server_info *sinfo)
 
 	sinfo->jobs = job_arr;
 	sinfo->all_resresv = all_arr;
+	index_resresv_by_name(sinfo);
 
 	return 1;
 }
@@ -2227,6 +2237,7 @@ dup_server_info(server_info *osinfo)
 	nsinfo->has_nonCPU_licenses = osinfo->has_nonCPU_licenses;
 	nsinfo->use_hard_duration = osinfo->use_hard_duration;
 	nsinfo->pset_metadata_stale = osinfo->pset_metadata_stale;
+	nsinfo->pset_metadata_rebuild = osinfo->pset_metadata_rebuild;
 	nsinfo->name = string_dup(osinfo->name);
 	nsinfo->liminfo = lim_dup_liminfo(osinfo->liminfo);
 	nsinfo->server_time = osinfo->server_time;
@@ -2248,6 +2259,7 @@ dup_server_info(server_info *osinfo)
 
 	/* dup the nodes, if there are any nodes */
 	nsinfo->nodes = dup_nodes(osinfo->nodes, nsinfo, NO_FLAGS);
+	index_nodes_by_name(nsinfo);
 
 	if (nsinfo->has_nodes_assoc_queue) {
 		nsinfo->unassoc_nodes =
@@ -2372,10 +2384,17 @@ dup_server_info(server_info *osinfo)
 	for (i = 0; osinfo->nodes[i] != NULL; i++) {
 		nsinfo->nodes[i]->run_resvs_arr =
 			copy_resresv_array(osinfo->nodes[i]->run_resvs_arr, nsinfo->resvs);
-		nsinfo->nodes[i]->np_arr =
-			copy_node_partition_ptr_array(osinfo->nodes[i]->np_arr, nsinfo->nodepart);
+		if (osinfo->nodes[i]->np_snap != NULL) {
+			/* carry over changes not yet folded into the placement sets */
+			nsinfo->nodes[i]->np_snap = new nodepart_snap(*osinfo->nodes[i]->np_snap);
+			nsinfo->pset_dirty_nodes.push_back(nsinfo->nodes[i]);
+		}
 		if (nsinfo->calendar != NULL)
-			nsinfo->nodes[i]->node_events = dup_te_lists(osinfo->nodes[i]->node_events, nsinfo->calendar->next_event);
+			nsinfo->nodes[i]->node_events = dup_te_lists(osinfo->nodes[i]->node_events, nsinfo->calendar);
+	}
+	if (link_all_nodepart_to_nodes(nsinfo) == 0) {
+		free_server(nsinfo);
+		return NULL;
 	}
 	nsinfo->buckets = dup_node_bucket_array(osinfo->buckets, nsinfo);
 	/* Now that all job information has been created, time to associate
@@ -2631,7 +2650,10 @@ new_counts(void)
 	cts->name = NULL;
 	cts->running = 0;
 	cts->rescts = NULL;
+	cts->rescts_by_def = NULL;
+	cts->rescts_by_def_size = 0;
 	cts->soft_limit_preempt_bit = 0;
+	cts->index = NULL;
 	cts->next = NULL;
 
 	return cts;
@@ -2659,6 +2681,9 @@ free_counts(counts *cts)
 	if (cts->rescts != NULL)
 		free_resource_count_list(cts->rescts);
 
+	free(cts->rescts_by_def);
+	delete cts->index;
+
 	cts->next = NULL;
 
 	free(cts);
@@ -2688,6 +2713,55 @@ free_counts_list(counts *ctslist)
 	}
 }
 
+/**
+ * @brief
+ * 		add_counts_res_index - add a resource_count of a counts structure
+ *		to the structure's by-resdef array.  resdefs which are not part
+ *		of allres are not indexed and are found by searching cts->rescts.
+ *		If the array can't be grown, it is dropped and the structure's
+ *		resources are found by searching cts->rescts from then on.
+ *
+ * @param[in,out]	cts - the counts structure
+ * @param[in]	rc	- resource_count which is already on cts->rescts
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+static void
+add_counts_res_index(counts *cts, resource_count *rc)
+{
+	resource_count **tmp;
+	int i;
+
+	if (rc->def == NULL || rc->def->rindex < 0 || cts->rescts_by_def_size < 0)
+		return;
+
+	if (rc->def->rindex >= cts->rescts_by_def_size) {
+		int nsize = rc->def->rindex + 1;
+
+		if (cts->rescts_by_def_size * 2 > nsize)
+			nsize = cts->rescts_by_def_size * 2;
+
+		tmp = static_cast<resource_count **>(realloc(cts->rescts_by_def, nsize * sizeof(resource_count *)));
+		if (tmp == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			/* a partial index would hide rc and have it allocated twice */
+			free(cts->rescts_by_def);
+			cts->rescts_by_def = NULL;
+			cts->rescts_by_def_size = -1;
+			return;
+		}
+		for (i = cts->rescts_by_def_size; i < nsize; i++)
+			tmp[i] = NULL;
+		cts->rescts_by_def = tmp;
+		cts->rescts_by_def_size = nsize;
+	}
+
+	if (cts->rescts_by_def[rc->def->rindex] == NULL)
+		cts->rescts_by_def[rc->def->rindex] = rc;
+}
+
 /**
  * @brief
  * 		dup_counts - duplicate a counts structure
@@ -2703,6 +2777,7 @@ counts *
 dup_counts(counts *octs)
 {
 	counts *ncts;
+	resource_count *rc;
 
 	ncts = new_counts();
 
@@ -2714,6 +2789,8 @@ dup_counts(counts *octs)
 		ncts->soft_limit_preempt_bit = octs->soft_limit_preempt_bit;
 
 		ncts->rescts = dup_resource_count_list(octs->rescts);
+		for (rc = ncts->rescts; rc != NULL; rc = rc->next)
+			add_counts_res_index(ncts, rc);
 	}
 
 	return ncts;
@@ -2754,6 +2831,9 @@ dup_counts_list(counts *ctslist)
 		cur = cur->next;
 	}
 
+	if (ctslist != NULL && ctslist->index != NULL)
+		index_counts_list(nhead);
+
 	return nhead;
 }
 
@@ -2777,6 +2857,13 @@ find_counts(counts *ctslist, const char *name)
 	if (ctslist == NULL || name == NULL)
 		return NULL;
 
+	if (ctslist->index != NULL) {
+		auto it = ctslist->index->by_name.find(name);
+		if (it == ctslist->index->by_name.end())
+			return NULL;
+		return it->second;
+	}
+
 	cur = ctslist;
 
 	while (cur != NULL && strcmp(cur->name, name))
@@ -2788,7 +2875,9 @@ find_counts(counts *ctslist, const char *name)
 /**
  * @brief
  * 		find_alloc_counts - find a counts structure by name or allocate
- *		 a new counts, name it, and add it to the end of the list
+ *		 a new counts, name it, and add it to the end of the list.
+ *		 Once a list reaches COUNTS_INDEX_MIN elements, its head is
+ *		 given a name index.
  *
  * @param[in]	ctslist - the counts list to search
  * @param[in]	name 	- the name to find
@@ -2803,15 +2892,32 @@ find_alloc_counts(counts *ctslist, const char *name)
 {
 	counts *cur, *prev;
 	counts *ncounts;
+	int len = 0;
 
 	if (name == NULL)
 		return NULL;
 
+	if (ctslist != NULL && ctslist->index != NULL) {
+		auto it = ctslist->index->by_name.find(name);
+		if (it != ctslist->index->by_name.end())
+			return it->second;
+
+		ncounts = new_counts();
+		if (ncounts != NULL) {
+			ncounts->name = string_dup(name);
+			ctslist->index->tail->next = ncounts;
+			ctslist->index->tail = ncounts;
+			ctslist->index->by_name.emplace(name, ncounts);
+		}
+		return ncounts;
+	}
+
 	prev = cur = ctslist;
 
 	while (cur != NULL && strcmp(cur->name, name)) {
 		prev = cur;
 		cur = cur->next;
+		len++;
 	}
 
 	if (cur == NULL) {
@@ -2820,14 +2926,117 @@ find_alloc_counts(counts *ctslist, const char *name)
 		if (ncounts != NULL)
 			ncounts->name = string_dup(name);
 
-		if (prev != NULL)
+		if (prev != NULL) {
 			prev->next = ncounts;
+			if (ncounts != NULL && len + 1 >= COUNTS_INDEX_MIN)
+				index_counts_list(ctslist);
+		}
 
 		return ncounts;
 	} else
 		return cur;
 }
 
+/**
+ * @brief
+ * 		index_counts_list - (re)build the name index on the head of a
+ *		counts list.  The first element wins if two share a name just
+ *		like a search of the list would.
+ *
+ * @param[in,out]	ctslist - the counts list to index
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+void
+index_counts_list(counts *ctslist)
+{
+	counts *cur;
+
+	if (ctslist == NULL)
+		return;
+
+	if (ctslist->index == NULL)
+		ctslist->index = new counts_index();
+	else
+		ctslist->index->by_name.clear();
+
+	for (cur = ctslist; cur != NULL; cur = cur->next) {
+		ctslist->index->by_name.emplace(cur->name, cur);
+		ctslist->index->tail = cur;
+	}
+}
+
+/**
+ * @brief
+ * 		find_counts_res - find the resource_count of a resource in a
+ *		counts structure
+ *
+ * @param[in]	cts - the counts structure to search
+ * @param[in]	def - the resource to find
+ *
+ * @return	resource_count *
+ * @retval	NULL	: not found
+ *
+ * @par MT-Safe:	no
+ */
+resource_count *
+find_counts_res(counts *cts, resdef *def)
+{
+	resource_count *rc;
+
+	if (cts == NULL || def == NULL)
+		return NULL;
+
+	if (def->rindex >= 0 && cts->rescts_by_def_size >= 0) {
+		if (def->rindex >= cts->rescts_by_def_size)
+			rc = NULL;
+		else
+			rc = cts->rescts_by_def[def->rindex];
+		/* a resdef from a different allres may share the slot */
+		if (rc == NULL || rc->def == def)
+			return rc;
+	}
+
+	return find_resource_count(cts->rescts, def);
+}
+
+/**
+ * @brief
+ * 		find_alloc_counts_res - find the resource_count of a resource in a
+ *		counts structure or allocate a new one and add it to the end of
+ *		cts->rescts
+ *
+ * @param[in,out]	cts - the counts structure
+ * @param[in]	def - the resource to find
+ *
+ * @return	resource_count *
+ * @retval	NULL	: error
+ *
+ * @par MT-Safe:	no
+ */
+resource_count *
+find_alloc_counts_res(counts *cts, resdef *def)
+{
+	resource_count *rc;
+
+	if (cts == NULL || def == NULL)
+		return NULL;
+
+	if ((rc = find_counts_res(cts, def)) != NULL)
+		return rc;
+
+	rc = find_alloc_resource_count(cts->rescts, def);
+	if (rc != NULL) {
+		if (cts->rescts == NULL)
+			cts->rescts = rc;
+		add_counts_res_index(cts, rc);
+	}
+
+	return rc;
+}
+
 /**
  * @brief
  * 		update_counts_on_run - update a counts struct on the running of
@@ -2857,14 +3066,11 @@ update_counts_on_run(counts *cts, resource_req *resreq)
 	req = resreq;
 
 	while (req != NULL) {
-		ctsreq = find_alloc_resource_count(cts->rescts, req->def);
-
-		if (ctsreq != NULL) {
-			if (cts->rescts == NULL)
-				cts->rescts = ctsreq;
+		ctsreq = find_alloc_counts_res(cts, req->def);
 
+		if (ctsreq != NULL)
 			ctsreq->amount += req->amount;
-		}
+
 		req = req->next;
 	}
 }
@@ -2895,7 +3101,7 @@ update_counts_on_end(counts *cts, resource_req *resreq)
 
 	req = resreq;
 	while (req != NULL) {
-		ctsreq = find_resource_count(cts->rescts, req->def);
+		ctsreq = find_counts_res(cts, req->def);
 		if (ctsreq != NULL)
 			ctsreq->amount -= req->amount;
 
@@ -2936,7 +3142,7 @@ counts_max(counts *cmax, counts *ncounts)
 	cmax_head = cmax;
 
 	for (cur = ncounts; cur != NULL; cur = cur->next) {
-		cur_fmax = find_counts(cmax, cur->name);
+		cur_fmax = find_counts(cmax_head, cur->name);
 		if (cur_fmax == NULL) {
 			cur_fmax = dup_counts(cur);
 			if (cur_fmax == NULL) {
@@ -2945,13 +3151,19 @@ counts_max(counts *cmax, counts *ncounts)
 			}
 
 			cur_fmax->next = cmax_head;
+			/* the name index lives on the head of the list */
+			if (cmax_head->index != NULL) {
+				cur_fmax->index = cmax_head->index;
+				cmax_head->index = NULL;
+				cur_fmax->index->by_name.emplace(cur_fmax->name, cur_fmax);
+			}
 			cmax_head = cur_fmax;
 		} else {
 			if (cur->running > cur_fmax->running)
 				cur_fmax->running = cur->running;
 
 			for (cur_res = cur->rescts; cur_res != NULL; cur_res = cur_res->next) {
-				cur_res_max = find_resource_count(cur_fmax->rescts, cur_res->def);
+				cur_res_max = find_counts_res(cur_fmax, cur_res->def);
 				if (cur_res_max == NULL) {
 					cur_res_max = dup_resource_count(cur_res);
 					if (cur_res_max == NULL) {
@@ -2961,6 +3173,7 @@ counts_max(counts *cmax, counts *ncounts)
 
 					cur_res_max->next = cur_fmax->rescts;
 					cur_fmax->rescts = cur_res_max;
+					add_counts_res_index(cur_fmax, cur_res_max);
 				} else {
 					if (cur_res->amount > cur_res_max->amount)
 						cur_res_max->amount = cur_res->amount;
@@ -3021,6 +3234,7 @@ update_universe_on_end(status *policy, resource_resv *resresv, const char *job_s
 				/* Since a new resource was added to resdef_to_check, the meta data needs to be recreated.
 				 * This will happen on the next call to node_partition_update()
 				 */
+				sinfo->pset_metadata_rebuild = 1;
 				if (sinfo->allpart != NULL) {
 					free_resource_list(sinfo->allpart->res);
 					sinfo->allpart->res = NULL;
@@ -3051,6 +3265,8 @@ update_universe_on_end(status *policy, resource_resv *resresv, const char *job_s
 		update_soft_limits(sinfo, qinfo, resresv);
 	/* Mark the metadata stale.  It will be updated in the next call to is_ok_to_run() */
 	sinfo->pset_metadata_stale = 1;
+	/* resources were freed: speculative "does not fit" results no longer hold */
+	sinfo->spec_gen++;
 
 	update_resresv_on_end(resresv, job_state);
 
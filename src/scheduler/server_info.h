@@ -281,6 +281,22 @@ counts *find_counts(counts *ctslist, const char *name);
  */
 counts *find_alloc_counts(counts *ctslist, const char *name);
 
+/*
+ *      index_counts_list - (re)build the name index on the head of a counts list
+ */
+void index_counts_list(counts *ctslist);
+
+/*
+ *      find_counts_res - find the resource_count of a resource in a counts
+ */
+resource_count *find_counts_res(counts *cts, resdef *def);
+
+/*
+ *      find_alloc_counts_res - find or allocate the resource_count of a
+ *                              resource in a counts
+ */
+resource_count *find_alloc_counts_res(counts *cts, resdef *def);
+
 /*
  *      update_counts_on_run - update a counts struct on the running of a job
  */
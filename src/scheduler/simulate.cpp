@@ -55,8 +55,10 @@
  * 	find_prev_timed_event()
  * 	set_timed_event_disabled()
  * 	find_timed_event()
+ * 	find_event_by_name()
  * 	perform_event()
  * 	exists_run_event()
+ * 	calc_earliest_node_fit()
  * 	calc_run_time()
  * 	create_event_list()
  * 	create_events()
@@ -69,6 +71,7 @@
  * 	dup_timed_event_list()
  * 	free_timed_event()
  * 	free_timed_event_list()
+ * 	index_event_list()
  * 	add_event()
  * 	add_timed_event()
  * 	delete_event()
@@ -92,6 +95,8 @@
 #include <errno.h>
 #include <log.h>
 
+#include <vector>
+
 #include "simulate.h"
 #include "data_types.h"
 #include "resource_resv.h"
@@ -109,6 +114,8 @@
 #include "globals.h"
 #include "check.h"
 #include "buckets.h"
+#include "resource.h"
+#include "profile.h"
 #ifdef NAS /* localmod 030 */
 #include "site_code.h"
 #endif /* localmod 030 */
@@ -529,6 +536,90 @@ find_timed_event(timed_event *te_list, int ignore_disabled, const char *name,
 
 	return te;
 }
+
+/**
+ * @brief
+ * 		is event a before event b in an indexed event list?
+ *
+ * @param[in]	idx	-	the event list's index
+ * @param[in]	a	-	first event
+ * @param[in]	b	-	second event
+ *
+ * @return	int
+ * @retval	1	: a comes before b
+ * @retval	0	: a is b or comes after it
+ */
+static int
+event_before(event_index *idx, timed_event *a, timed_event *b)
+{
+	timed_event *te;
+
+	if (a == b)
+		return 0;
+	if (a->event_time != b->event_time)
+		return a->event_time < b->event_time;
+
+	auto fa = idx->first_at.find(a->event_time);
+	if (fa == idx->first_at.end())
+		return 0;
+
+	/* same time: see which one we reach first */
+	for (te = fa->second; te != NULL && te->event_time == a->event_time; te = te->next) {
+		if (te == a)
+			return 1;
+		if (te == b)
+			return 0;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ * 		find_event_by_name - find_timed_event() for an event with a name.
+ *		Uses the calendar's index to only look at the events of that name
+ *		instead of walking the list.
+ *
+ * @param[in]	calendar	-	the event list to search
+ * @param[in]	from	-	first event to consider, earlier events are skipped
+ * @param[in]	ignore_disabled	-	ignore disabled events
+ * @param[in]	name	-	name of the event
+ * @param[in]	event_type	-	event type or TIMED_NOEVENT to ignore
+ * @param[in]	event_time	-	time or 0 to ignore
+ *
+ * @return	timed_event *
+ * @retval	the first matching event at or after from
+ * @retval	NULL	: not found or from is NULL
+ */
+timed_event *
+find_event_by_name(event_list *calendar, timed_event *from, int ignore_disabled,
+	const char *name, enum timed_event_types event_type, time_t event_time)
+{
+	timed_event *found = NULL;
+
+	if (calendar == NULL || from == NULL)
+		return NULL;
+
+	if (calendar->index == NULL || name == NULL)
+		return find_timed_event(from, ignore_disabled, name, event_type, event_time);
+
+	auto range = calendar->index->by_name.equal_range(name);
+	for (auto it = range.first; it != range.second; it++) {
+		timed_event *te = it->second;
+
+		if (ignore_disabled && te->disabled)
+			continue;
+		if (event_type != TIMED_NOEVENT && event_type != te->event_type)
+			continue;
+		if (event_time != 0 && event_time != te->event_time)
+			continue;
+		if (event_before(calendar->index, te, from))
+			continue;
+		if (found == NULL || event_before(calendar->index, te, found))
+			found = te;
+	}
+
+	return found;
+}
 /**
  * @brief
  * 		takes a timed_event and performs any actions
@@ -681,6 +772,134 @@ exists_resv_event(event_list *calendar, time_t end)
 	return 0;
 }
 
+/**
+ * @brief
+ * 		node_fit - helper for calc_earliest_node_fit(): does every needed
+ *		amount fit into what is available
+ *
+ * @param[in]	need	-	amounts needed
+ * @param[in]	avail	-	amounts available, indexed like need
+ *
+ * @return	int
+ * @retval	1	: it fits
+ * @retval	0	: it does not
+ */
+static int
+node_fit(std::vector<sch_resource_t>& need, std::vector<sch_resource_t>& avail)
+{
+	size_t k;
+
+	for (k = 0; k < need.size(); k++)
+		if (avail[k] < need[k])
+			return 0;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		calc_earliest_node_fit - find the earliest calendar event before
+ *		which a job can not possibly fit on the nodes.
+ *
+ *		For each consumable resource the job requests in its select, the
+ *		free amount summed over all nodes is an upper bound of what the
+ *		job could get.  This bound only grows when a job or reservation
+ *		which is running in sinfo ends.  Ends of resresvs which have not
+ *		started yet and all run events are left out; they can only make
+ *		the real amount smaller.  So until the bound covers the request
+ *		there is no point in calling is_ok_to_run().
+ *
+ *		Resources which are not checked, are unset-infinite, infinite on
+ *		a node or indirect are left out since they can't be summed.
+ *
+ * @param[in]	sinfo	-	the universe being simulated
+ * @param[in]	resresv	-	the job to find the time for
+ *
+ * @return	time_t
+ * @retval	0	: no bound, the job may fit at any time
+ * @retval	-1	: the job will not fit before the end of the calendar
+ * @retval	the time of the event after which it may fit
+ */
+static time_t
+calc_earliest_node_fit(server_info *sinfo, resource_resv *resresv)
+{
+	std::vector<resdef *> defs;
+	std::vector<sch_resource_t> need;
+	std::vector<sch_resource_t> avail;
+	timed_event *te;
+	resource_resv *ep;
+	resource_req *req;
+	schd_resource *res;
+	size_t k;
+	int i;
+
+	if (sinfo == NULL || sinfo->nodes == NULL || sinfo->calendar == NULL ||
+		resresv == NULL || !resresv->is_job || resresv->job == NULL ||
+		resresv->job->resv != NULL || resresv->select == NULL)
+		return 0;
+
+	/* total consumable node resources the job requests */
+	for (i = 0; resresv->select->chunks[i] != NULL; i++) {
+		for (req = resresv->select->chunks[i]->req; req != NULL; req = req->next) {
+			if (!req->type.is_consumable || req->amount <= 0)
+				continue;
+			if (sinfo->policy->resdef_to_check_no_hostvnode != NULL &&
+				!resdef_exists_in_array(sinfo->policy->resdef_to_check_no_hostvnode, req->def))
+				continue;
+			if (match_string_to_array(req->name, conf.ignore_res) != SA_NO_MATCH)
+				continue;
+			for (k = 0; k < defs.size() && defs[k] != req->def; k++)
+				;
+			if (k == defs.size()) {
+				defs.push_back(req->def);
+				need.push_back(0);
+				avail.push_back(0);
+			}
+			need[k] += req->amount * resresv->select->chunks[i]->num_chunks;
+		}
+	}
+
+	/* what is free on the nodes now */
+	for (i = 0; sinfo->nodes[i] != NULL && !defs.empty(); i++) {
+		for (k = 0; k < defs.size(); ) {
+			res = find_resource(sinfo->nodes[i]->res, defs[k]);
+			if (res != NULL && (res->indirect_res != NULL || res->avail == SCHD_INFINITY_RES)) {
+				defs.erase(defs.begin() + k);
+				need.erase(need.begin() + k);
+				avail.erase(avail.begin() + k);
+				continue;
+			}
+			if (res != NULL && res->avail > res->assigned)
+				avail[k] += res->avail - res->assigned;
+			k++;
+		}
+	}
+	if (defs.empty() || node_fit(need, avail))
+		return 0;
+
+	for (te = get_next_event(sinfo->calendar); te != NULL; te = te->next) {
+		if (te->disabled || te->event_type != TIMED_END_EVENT)
+			continue;
+
+		ep = (resource_resv *) te->event_ptr;
+		if (ep->nspec_arr == NULL)
+			continue;
+		if (ep->is_job ? !ep->job->is_running : !(ep->is_resv && ep->resv->is_running))
+			continue;
+
+		for (i = 0; ep->nspec_arr[i] != NULL; i++)
+			for (req = ep->nspec_arr[i]->resreq; req != NULL; req = req->next)
+				for (k = 0; k < defs.size(); k++)
+					if (defs[k] == req->def)
+						avail[k] += req->amount;
+
+		if (node_fit(need, avail))
+			return te->event_time;
+	}
+
+	return -1;
+}
+
 /**
  * @brief
  * 		calculate the run time of a resresv through simulation of
@@ -715,6 +934,9 @@ calc_run_time(char *name, server_info *sinfo, int flags)
 	nspec **ns = NULL;
 	unsigned int ok_flags = NO_ALLPART;
 	queue_info *qinfo = NULL;
+	time_t fit_time = 0;		/* don't bother checking before this time */
+	int fit_done = 0;		/* fit_time has been calculated */
+	prof_timer pt(PROF_CALENDAR);
 
 	if (name == NULL || sinfo == NULL)
 		return (time_t) -1;
@@ -744,9 +966,16 @@ calc_run_time(char *name, server_info *sinfo, int flags)
 		 */
 
 		desc = describe_simret(ret);
-		if (desc > 0 || (desc == 0 && policy_change_info(sinfo, resresv))) {
+		if ((desc > 0 || (desc == 0 && policy_change_info(sinfo, resresv))) &&
+			fit_time != -1 && event_time >= fit_time) {
 			clear_schd_error(err);
 			ns = is_ok_to_run(sinfo->policy, sinfo, qinfo, resresv, ok_flags, err);
+
+			/* skip the events before the job's nodes can have enough room */
+			if (ns == NULL && !fit_done) {
+				fit_time = calc_earliest_node_fit(sinfo, resresv);
+				fit_done = 1;
+			}
 		}
 
 		if (ns == NULL) /* event can not run */
@@ -816,6 +1045,132 @@ calc_run_time(char *name, server_info *sinfo, int flags)
 	return event_time;
 }
 
+/**
+ * @brief
+ * 		add a timed_event which has been linked into an event list to the
+ *		list's index
+ *
+ * @param[in,out]	idx	-	the index
+ * @param[in]	te	-	the linked in event
+ *
+ * @return	void
+ */
+static void
+index_timed_event(event_index *idx, timed_event *te)
+{
+	if (te->prev == NULL || te->prev->event_time != te->event_time)
+		idx->first_at[te->event_time] = te;
+	if (te->next == NULL)
+		idx->tail = te;
+	if (te->name != NULL)
+		idx->by_name.emplace(te->name, te);
+}
+
+/**
+ * @brief
+ * 		remove a timed_event from its event list's index.  Must be called
+ *		before the event is unlinked from the list.
+ *
+ * @param[in,out]	idx	-	the index
+ * @param[in]	te	-	the event
+ *
+ * @return	void
+ */
+static void
+unindex_timed_event(event_index *idx, timed_event *te)
+{
+	auto fa = idx->first_at.find(te->event_time);
+	if (fa != idx->first_at.end() && fa->second == te) {
+		if (te->next != NULL && te->next->event_time == te->event_time)
+			fa->second = te->next;
+		else
+			idx->first_at.erase(fa);
+	}
+	if (idx->tail == te)
+		idx->tail = te->prev;
+	if (te->name != NULL) {
+		auto range = idx->by_name.equal_range(te->name);
+		for (auto it = range.first; it != range.second; it++) {
+			if (it->second == te) {
+				idx->by_name.erase(it);
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief
+ * 		insert_timed_event - add_timed_event() using an index to find
+ *		where the event goes instead of walking the list.  Like
+ *		add_timed_event(), end events go before and other events after
+ *		the events already at the same time.
+ *
+ * @param[in,out]	events	-	head of the event list
+ * @param[in,out]	idx	-	the list's index
+ * @param[in]	te	-	timed_event to add to list
+ *
+ * @return	void
+ */
+static void
+insert_timed_event(timed_event **events, event_index *idx, timed_event *te)
+{
+	std::map<time_t, timed_event *>::iterator it;
+	timed_event *before;	/* te goes in front of this event, NULL for the end */
+
+	if (te == NULL)
+		return;
+
+	if (te->event_type == TIMED_END_EVENT)
+		it = idx->first_at.lower_bound(te->event_time);
+	else
+		it = idx->first_at.upper_bound(te->event_time);
+	before = (it == idx->first_at.end()) ? NULL : it->second;
+
+	if (before == NULL) {
+		te->prev = idx->tail;
+		te->next = NULL;
+		if (idx->tail != NULL)
+			idx->tail->next = te;
+		else
+			*events = te;
+	} else {
+		te->next = before;
+		te->prev = before->prev;
+		if (before->prev != NULL)
+			before->prev->next = te;
+		else
+			*events = te;
+		before->prev = te;
+	}
+
+	index_timed_event(idx, te);
+}
+
+/**
+ * @brief
+ * 		index_event_list - (re)build the index of an event list
+ *
+ * @param[in,out]	elist	-	the event list
+ *
+ * @return	void
+ */
+void
+index_event_list(event_list *elist)
+{
+	timed_event *te;
+
+	if (elist == NULL || elist->index == NULL)
+		return;
+
+	elist->index->first_at.clear();
+	elist->index->by_name.clear();
+	elist->index->tail = NULL;
+
+	for (te = elist->events; te != NULL; te = te->next)
+		index_timed_event(elist->index, te);
+}
+
 /**
  * @brief
  * 		create an event_list from running jobs and confirmed resvs
@@ -835,6 +1190,7 @@ create_event_list(server_info *sinfo)
 		return NULL;
 
 	elist->events = create_events(sinfo);
+	index_event_list(elist);
 
 	elist->next_event = elist->events;
 	elist->first_run_event = find_timed_event(elist->events, 0, NULL, TIMED_RUN_EVENT, 0);
@@ -865,6 +1221,9 @@ create_events(server_info *sinfo)
 	time_t 		end = 0;
 	resource_resv	**all_resresv_copy;
 	int		all_resresv_len;
+	event_index	idx;
+
+	idx.tail = NULL;
 
 	/* create a temporary copy of all_resresv array which is sorted such that
 	 * the timed events are in the front of the array.
@@ -892,7 +1251,7 @@ create_events(server_info *sinfo)
 				errflag++;
 				break;
 			}
-			events = add_timed_event(events, te);
+			insert_timed_event(&events, &idx, te);
 		}
 
 		if (sinfo->use_hard_duration)
@@ -904,7 +1263,7 @@ create_events(server_info *sinfo)
 			errflag++;
 			break;
 		}
-		events = add_timed_event(events, te);
+		insert_timed_event(&events, &idx, te);
 	}
 
 	/* for nodes that are in state=sleep add a timed event */
@@ -917,7 +1276,7 @@ create_events(server_info *sinfo)
 				errflag++;
 				break;
 			}
-			events = add_timed_event(events, te);
+			insert_timed_event(&events, &idx, te);
 		}
 	}
 
@@ -955,6 +1314,9 @@ new_event_list()
 	elist->first_run_event = NULL;
 	elist->current_time = NULL;
 
+	elist->index = new event_index();
+	elist->index->tail = NULL;
+
 	return elist;
 }
 
@@ -990,10 +1352,11 @@ dup_event_list(event_list *oelist, server_info *nsinfo)
 			free_event_list(nelist);
 			return NULL;
 		}
+		index_event_list(nelist);
 	}
 
 	if (oelist->next_event != NULL) {
-		nelist->next_event = find_timed_event(nelist->events, 0,
+		nelist->next_event = find_event_by_name(nelist, nelist->events, 0,
 			oelist->next_event->name,
 			oelist->next_event->event_type,
 			oelist->next_event->event_time);
@@ -1007,7 +1370,7 @@ dup_event_list(event_list *oelist, server_info *nsinfo)
 
 	if (oelist->first_run_event != NULL) {
 		nelist->first_run_event =
-		    find_timed_event(nelist->events, 0,
+		    find_event_by_name(nelist, nelist->events, 0,
 				     oelist->first_run_event->name,
 				     TIMED_RUN_EVENT,
 				     oelist->first_run_event->event_time);
@@ -1035,6 +1398,7 @@ free_event_list(event_list *elist)
 		return;
 
 	free_timed_event_list(elist->events);
+	delete elist->index;
 	free(elist);
 }
 
@@ -1140,23 +1504,23 @@ free_te_list(te_list *tel) {
 /*
  * @brief te_list copy constructor
  * @param[in] ote - te_list to copy
- * @param[in] new_timed_even_list - new timed events
+ * @param[in] ncalendar - new calendar, its events from next_event on are searched
  *
  * @return copied te_list
  */
 te_list *
-dup_te_list(te_list *ote, timed_event *new_timed_event_list)
+dup_te_list(te_list *ote, event_list *ncalendar)
 {
 	te_list *nte;
 
-	if(ote == NULL || new_timed_event_list == NULL)
+	if(ote == NULL || ncalendar == NULL || ncalendar->next_event == NULL)
 		return NULL;
 
 	nte = new_te_list();
 	if(nte == NULL)
 		return NULL;
 
-	nte->event = find_timed_event(new_timed_event_list, 0, ote->event->name, ote->event->event_type, ote->event->event_time);
+	nte->event = find_event_by_name(ncalendar, ncalendar->next_event, 0, ote->event->name, ote->event->event_type, ote->event->event_time);
 
 	return nte;
 }
@@ -1164,23 +1528,23 @@ dup_te_list(te_list *ote, timed_event *new_timed_event_list)
 /*
  * @brief copy constructor for a list of te_list structures
  * @param[in] ote - te_list to copy
- * @param[in] new_timed_even_list - new timed events
+ * @param[in] ncalendar - new calendar, its events from next_event on are searched
  *
  * @return copied te_list list
  */
 
 te_list *
-dup_te_lists(te_list *ote, timed_event *new_timed_event_list) {
+dup_te_lists(te_list *ote, event_list *ncalendar) {
 	te_list *nte;
 	te_list *end_te = NULL;
 	te_list *cur;
 	te_list *nte_head = NULL;
 
-	if (ote == NULL || new_timed_event_list == NULL)
+	if (ote == NULL || ncalendar == NULL || ncalendar->next_event == NULL)
 		return NULL;
 
 	for(cur = ote; cur != NULL; cur = cur->next) {
-		nte = dup_te_list(cur, new_timed_event_list);
+		nte = dup_te_list(cur, ncalendar);
 		if (nte == NULL) {
 			free_te_list(nte_head);
 			return NULL;
@@ -1434,7 +1798,10 @@ add_event(event_list *calendar, timed_event *te)
 	if (calendar->events == NULL)
 		events_is_null = 1;
 
-	calendar->events = add_timed_event(calendar->events, te);
+	if (calendar->index != NULL)
+		insert_timed_event(&calendar->events, calendar->index, te);
+	else
+		calendar->events = add_timed_event(calendar->events, te);
 
 	/* empty event list - the new event is the only event */
 	if (events_is_null)
@@ -1447,9 +1814,12 @@ add_event(event_list *calendar, timed_event *te)
 			if (te->event_time < calendar->next_event->event_time)
 				calendar->next_event = te;
 			else if (te->event_time == calendar->next_event->event_time) {
-				calendar->next_event =
-					find_timed_event(calendar->events, 0, NULL,
-					TIMED_NOEVENT, te->event_time);
+				if (calendar->index != NULL)
+					calendar->next_event = calendar->index->first_at[te->event_time];
+				else
+					calendar->next_event =
+						find_timed_event(calendar->events, 0, NULL,
+						TIMED_NOEVENT, te->event_time);
 			}
 		}
 	}
@@ -1545,8 +1915,12 @@ delete_event(server_info *sinfo, timed_event *e)
 	if (calendar->next_event == e)
 		calendar->next_event = e->next;
 
+	/* the first run event is also the first in the list, so look after it */
 	if (calendar->first_run_event == e)
-		calendar->first_run_event = find_timed_event(calendar->events, 0, NULL, TIMED_RUN_EVENT, 0);
+		calendar->first_run_event = find_timed_event(e->next, 0, NULL, TIMED_RUN_EVENT, 0);
+
+	if (calendar->index != NULL)
+		unindex_timed_event(calendar->index, e);
 
 	if (e->prev == NULL)
 		calendar->events = e->next;
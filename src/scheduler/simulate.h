@@ -282,14 +282,19 @@ void free_event_list(event_list *el);
 #endif /* localmod 005 */
 
 /*
- *      find_event_by_name - find an event by event name
+ *	find_event_by_name - find the first event with a name at or after
+ *		an event, using the calendar's index
  *
- *        \param events - list of timed_event structures to search
- *        \param name   - name of event to search for
- *
- *      \return found timed_event or NULL
+ *	\return found timed_event or NULL
+ */
+timed_event *
+find_event_by_name(event_list *calendar, timed_event *from, int ignore_disabled,
+	const char *name, enum timed_event_types event_type, time_t event_time);
+
+/*
+ *	index_event_list - (re)build the index of an event list
  */
-timed_event *find_event_by_name(timed_event *events, char *name);
+void index_event_list(event_list *elist);
 
 
 /*
@@ -446,8 +451,8 @@ generic_sim(event_list *calendar, unsigned int event_mask, time_t end, int defau
 
 te_list *new_te_list();
 
-te_list *dup_te_list(te_list *ote, timed_event *new_timed_event_list);
-te_list *dup_te_lists(te_list *ote, timed_event *new_timed_event_list);
+te_list *dup_te_list(te_list *ote, event_list *ncalendar);
+te_list *dup_te_lists(te_list *ote, event_list *ncalendar);
 
 void free_te_list(te_list *tel);
 
@@ -94,6 +94,7 @@
 #include "constant.h"
 #include "server_info.h"
 #include "resource.h"
+#include "profile.h"
 
 #ifdef NAS
 #include "site_code.h"
@@ -1251,6 +1252,7 @@ sort_jobs(status *policy, server_info *sinfo)
 	int job_index = 0;
 	int index = 0;
 	int count = 0;
+	prof_timer pt(PROF_SORT_JOBS);
 
 	/** sort jobs in such a way that Higher Priority jobs come on top
 	 * followed by preempted jobs and then starving jobs and normal jobs
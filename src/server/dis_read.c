@@ -512,6 +512,10 @@ dis_request_read(int sfds, struct batch_request *request)
 			rc = decode_DIS_Manage(sfds, request);
 			break;
 
+		case PBS_BATCH_ModifyJobs_Async:
+			rc = decode_DIS_ModifyJobs(sfds, request);
+			break;
+
 		case PBS_BATCH_MessJob:
 			rc = decode_DIS_MessageJob(sfds, request);
 			break;
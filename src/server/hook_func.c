@@ -155,8 +155,6 @@ extern	char server_host[PBS_MAXHOSTNAME+1];
 /* Global Data items */
 int	do_sync_mom_hookfiles = 1;
 int	sync_mom_hookfiles_replies_pending = 0;
-pbs_list_head vnode_attr_list;
-pbs_list_head resv_attr_list;
 
 /* Local Data */
 static char merr[] = "malloc failed";
@@ -3637,101 +3635,6 @@ write_hook_accept_debug_output_and_close(void)
 	}
 }
 
-/**
- * @brief
- * 		getting the vnode attributes and resource list
- *			each node attribute will be of the format:
- *			<node_name>.<attr_name>
- *
- * @see
- * 		run_periodic_hook
- *
- * @return void
- */
-pbs_list_head *
-get_vnode_list(void){
-	int i;
-	int index;
-	char name_str_buf[STRBUF + 1] = {'\0'};
-	struct pbsnode	*pnode = NULL;
-	attribute_def *padef = node_attr_def;
-
-	CLEAR_HEAD(vnode_attr_list);
-	for (i = 0; i < svr_totnodes; i++) {
-		pnode = pbsndlist[i];
-		for (index = 0; index < ND_ATR_LAST; index++) {
-			if ((padef+index)->at_flags & ATR_VFLAG_SET) {
-				strncpy(name_str_buf, pnode->nd_name, STRBUF);
-				strcat(name_str_buf, ".");
-				strncat(name_str_buf, (padef+index)->at_name, (STRBUF - strlen(name_str_buf)));
-				if ((padef+index)->at_encode(
-						&pnode->nd_attr[index],
-						&vnode_attr_list, name_str_buf,
-						NULL, ATR_ENCODE_HOOK, NULL) < 0) {
-					char *msgbuf;
-
-					pbs_asprintf(&msgbuf,
-						"error on encoding node attributes: %s",
-						name_str_buf);
-					log_event(PBSEVENT_DEBUG2,
-						PBS_EVENTCLASS_HOOK, LOG_ERR,
-						__func__, msgbuf);
-					free(msgbuf);
-					break;
-				}
-			}
-		}
-	}
-	return &vnode_attr_list;
-}
-
-/**
- * @brief
- * 		getting the reservation attribute and resource list
- *
- * @see
- * 		run_periodic_hook
- *
- * @return void
- */
-pbs_list_head *
-get_resv_list(void) {
-	int 	index;
-	char	name_str_buf[STRBUF + 1] = {'\0'};
-	resc_resv  *presv;
-	attribute_def *padef= resv_attr_def;
-
-	CLEAR_HEAD(resv_attr_list);
-	presv = (resc_resv *)GET_NEXT(svr_allresvs);
-
-	while (presv != NULL) {
-		for (index = 0; index < RESV_ATR_LAST; index++) {
-			if ((padef+index)->at_flags & ATR_VFLAG_SET) {
-				strncpy(name_str_buf, presv->ri_qs.ri_resvID, STRBUF);
-				strcat(name_str_buf, ".");
-				strncat(name_str_buf, (padef+index)->at_name, (STRBUF - strlen(name_str_buf)));
-				if ((padef+index)->at_encode(
-						&presv->ri_wattr[index],
-						&resv_attr_list, name_str_buf,
-						NULL, ATR_ENCODE_HOOK, NULL) < 0) {
-					char *msgbuf;
-
-					pbs_asprintf(&msgbuf,
-						"error on encoding reservation attributes: %s",
-						name_str_buf);
-					log_event(PBSEVENT_DEBUG2,
-						PBS_EVENTCLASS_HOOK, LOG_ERR,
-						__func__, msgbuf);
-					free(msgbuf);
-					break;
-				}
-			}
-		}
-		presv = (resc_resv *)GET_NEXT(presv->ri_allresvs);
-	}
-	return &resv_attr_list;
-}
-
 /**
  * @brief
  *
@@ -6933,10 +6836,11 @@ run_periodic_hook(struct work_task *ptask)
 		/* Unprotect child from being killed by kernel */
 		daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
 
-		/* set vnodes and reservation list to hook input parameter */
-		req_ptr.vns_list = (pbs_list_head *)get_vnode_list();
-		req_ptr.resv_list = (pbs_list_head *)get_resv_list();
-
+		/*
+		 * Leave vns_list and resv_list NULL: the hook's vnode_list and
+		 * resv_list then only encode the vnodes and reservations the
+		 * hook script actually looks at.
+		 */
 		ret = server_process_hooks(PBS_BATCH_HookPeriodic, NULL, NULL, phook,
 					HOOK_EVENT_PERIODIC, NULL, &req_ptr, hook_msg,
 					sizeof(hook_msg), pbs_python_set_interrupt, &num_run, &event_initialized);
@@ -146,6 +146,9 @@ relay_to_mom2(job *pjob, struct batch_request *request,
 
 	mom_tasklist_ptr = &(((mom_svrinfo_t *) (pmom->mi_data))->msr_deferred_cmds);
 
+	/* the job's state must be in the database before the mom acts on it */
+	job_save_db_flush(1);
+
 	conn = svr_connect(momaddr, momport, process_Dreply, ToServerDIS, prot);
 	if (conn < 0) {
 		log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_REQUEST, LOG_WARNING, "", msg_norelytomom);
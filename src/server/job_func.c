@@ -362,6 +362,7 @@ job_alloc(void)
 	pj->ji_prunreq = NULL;
 	pj->ji_pmt_preq = NULL;
 	CLEAR_HEAD(pj->ji_svrtask);
+	CLEAR_LINK(pj->ji_dirtyjobs);
 	CLEAR_HEAD(pj->ji_rejectdest);
 	pj->ji_terminated = 0;
 	pj->ji_deletehistory = 0;
@@ -513,6 +514,8 @@ job_free(job *pj)
 		badplace		*bp;
 
 		free_job_work_tasks(pj);
+		job_save_db_cancel(pj);
+		job_qrank_unindex(pj);
 
 		/* free any bad destination structs */
 
@@ -58,6 +58,7 @@
 #include "job.h"
 #include "reservation.h"
 #include "queue.h"
+#include "server.h"
 #include "log.h"
 #include "pbs_nodes.h"
 #include "svrfunc.h"
@@ -68,6 +69,16 @@
 
 #define MAX_SAVE_TRIES 3
 
+/*
+ * Job saves are deferred and batched when the server attribute
+ * job_save_window is set.  A batch is flushed early once this many
+ * jobs are waiting.
+ */
+#define JOB_SAVE_BATCH_MAX 1000
+
+/* a job's dirty link points to itself unless it is on the dirty list */
+#define JOB_SAVE_PENDING(pjob) ((pjob)->ji_dirtyjobs.ll_next != &(pjob)->ji_dirtyjobs)
+
 extern void *svr_db_conn;
 extern int server_init_type;
 extern pbs_list_head svr_allresvs;
@@ -80,6 +91,15 @@ extern time_t time_now;
 job *recov_job_cb(pbs_db_obj_info_t *dbobj, int *refreshed);
 resc_resv *recov_resv_cb(pbs_db_obj_info_t *dbobj, int *refreshed);
 
+static int job_save_db_now(job *pjob, time_t mtime);
+
+/* jobs whose save has been deferred, oldest first */
+static pbs_list_head svr_dirtyjobs;
+static int dirtyjobs_ct = 0;
+static time_t dirtyjobs_since = 0;
+/* number of job saves deferred so far, see job_save_db_seq() */
+static long dirtyjobs_seq = 0;
+
 /**
  * @brief
  *		convert job structure to DB format
@@ -215,10 +235,34 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
 	return 0;
 }
 
+/**
+ * @brief
+ *		Return the job save window, the number of seconds a job save
+ *		may be deferred.  0 means jobs are saved right away.
+ *
+ * @return	long
+ */
+static long
+job_save_window(void)
+{
+	if ((server.sv_attr[(int)SVR_ATR_JobSaveWindow].at_flags & ATR_VFLAG_SET) == 0)
+		return 0;
+	return server.sv_attr[(int)SVR_ATR_JobSaveWindow].at_val.at_long;
+}
+
 /**
  * @brief
  *		Save job to database
  *
+ * @par Functionality:
+ *		If job_save_window is set, the save of a job already in the
+ *		database is deferred: the job is queued on the dirty list (once,
+ *		however often it is saved) and written later by
+ *		job_save_db_flush() in a single transaction with the other dirty
+ *		jobs.  The job's mtime is set when the save is requested.  A new
+ *		job is always saved right away, since the caller must learn
+ *		about a jobid clash.
+ *
  * @param[in]	pjob - The job to save
  *
  * @return      Error code
@@ -229,6 +273,162 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
  */
 int
 job_save_db(job *pjob)
+{
+	if (pjob->newobj || job_save_window() <= 0) {
+		job_save_db_cancel(pjob);
+		return (job_save_db_now(pjob, time_now));
+	}
+
+	if (svr_dirtyjobs.ll_next == NULL)
+		CLEAR_HEAD(svr_dirtyjobs);
+
+	/* mtime is when the job changed, not when the change is written */
+	set_jattr_l_slim(pjob, JOB_ATR_mtime, time_now, SET);
+	dirtyjobs_seq++;
+	if (!JOB_SAVE_PENDING(pjob)) {
+		if (dirtyjobs_ct == 0)
+			dirtyjobs_since = time_now;
+		append_link(&svr_dirtyjobs, &pjob->ji_dirtyjobs, pjob);
+		dirtyjobs_ct++;
+		if (dirtyjobs_ct >= JOB_SAVE_BATCH_MAX)
+			job_save_db_flush(1);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief
+ *		Write the jobs with a deferred save to the database in one
+ *		transaction.
+ *
+ * @par Functionality:
+ *		Called with force set before anything that depends on the
+ *		jobs being saved leaves the server: a reply to a request which
+ *		deferred a job save, or a job sent to a mom.  This way a job is
+ *		in the database before the client sees the ack.  Called without
+ *		force from the main loop, where it only flushes once the oldest
+ *		deferred save is job_save_window seconds old.
+ *
+ * @param[in]	force - flush even if the window has not expired
+ *
+ * @return	void
+ */
+void
+job_save_db_flush(int force)
+{
+	job *pjob;
+	void *conn = svr_db_conn;
+	char *conn_db_err = NULL;
+	int ct;
+
+	if (dirtyjobs_ct == 0)
+		return;
+
+	if (!force && time_now < dirtyjobs_since + job_save_window())
+		return;
+
+	if (pbs_db_begin_trx(conn) != 0) {
+		pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
+		log_errf(PBSE_INTERNAL, __func__, "Failed to start transaction %s", conn_db_err ? conn_db_err : "");
+		free(conn_db_err);
+		panic_stop_db();
+	}
+
+	while ((pjob = (job *) GET_NEXT(svr_dirtyjobs)) != NULL) {
+		delete_link(&pjob->ji_dirtyjobs);
+		/* job_save_db_now stops the server on error, rolling the batch back */
+		job_save_db_now(pjob, get_jattr_long(pjob, JOB_ATR_mtime));
+	}
+	ct = dirtyjobs_ct;
+	dirtyjobs_ct = 0;
+
+	if (pbs_db_end_trx(conn, 1) != 0) {
+		pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
+		log_errf(PBSE_INTERNAL, __func__, "Failed to commit job saves %s", conn_db_err ? conn_db_err : "");
+		free(conn_db_err);
+		panic_stop_db();
+	}
+
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG, __func__,
+		"Saved %d deferred jobs", ct);
+}
+
+/**
+ * @brief
+ *		Return the number of job saves deferred since the server started
+ *
+ * @par Functionality:
+ *		A request records this when it is created.  If it is unchanged
+ *		when the reply is sent, the request deferred no job save and
+ *		the reply need not wait for a flush.
+ *
+ * @return	long
+ */
+long
+job_save_db_seq(void)
+{
+	return dirtyjobs_seq;
+}
+
+/**
+ * @brief
+ *		Drop a job's deferred save, the job is going away
+ *
+ * @param[in]	pjob - the job
+ *
+ * @return	void
+ */
+void
+job_save_db_cancel(job *pjob)
+{
+	if (!JOB_SAVE_PENDING(pjob))
+		return;
+
+	delete_link(&pjob->ji_dirtyjobs);
+	dirtyjobs_ct--;
+}
+
+/**
+ * @brief
+ *		Shorten the main loop's wait so that deferred job saves are
+ *		flushed when their window expires
+ *
+ * @param[in]	waittime - the time the main loop would wait
+ *
+ * @return	time_t
+ * @retval	the time to wait
+ */
+time_t
+job_save_db_waittime(time_t waittime)
+{
+	time_t due;
+
+	if (dirtyjobs_ct == 0)
+		return waittime;
+
+	due = dirtyjobs_since + job_save_window() - time_now;
+	if (due < 0)
+		due = 0;
+
+	return (due < waittime ? due : waittime);
+}
+
+/**
+ * @brief
+ *		Save job to database right away
+ *
+ * @param[in]	pjob - The job to save
+ * @param[in]	mtime - modification time to save the job with
+ *
+ * @return      Error code
+ * @retval	 0 - Success
+ * @retval	-1 - Failure
+ * @retval	 1 - Jobid clash, retry with new jobid
+ *
+ */
+static int
+job_save_db_now(job *pjob, time_t mtime)
 {
 	pbs_db_job_info_t dbjob = {{0}};
 	pbs_db_obj_info_t obj;
@@ -248,7 +448,7 @@ job_save_db(job *pjob)
 	obj.pbs_db_un.pbs_db_job = &dbjob;
 
 	/* update mtime before save, so the same value gets to the DB as well */
-	set_jattr_l_slim(pjob, JOB_ATR_mtime, time_now, SET);
+	set_jattr_l_slim(pjob, JOB_ATR_mtime, mtime, SET);
 	if ((rc = pbs_db_save_obj(conn, &obj, savetype)) == 0)
 		pjob->newobj = 0;
 
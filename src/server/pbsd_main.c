@@ -1315,6 +1315,8 @@ main(int argc, char **argv)
 	}
 	process_hooks(periodic_req, hook_msg, sizeof(hook_msg), pbs_python_set_interrupt);
 
+	set_log_async(pbs_conf.pbs_log_async, pbs_conf.pbs_log_async_drop, pbs_conf.pbs_log_async_flush);
+
 	/*
 	 * main loop of server
 	 * stays in this loop until server's state is either
@@ -1416,10 +1418,14 @@ main(int argc, char **argv)
 			reap_child();
 
 		/* wait for a request and process it */
+		waittime = job_save_db_waittime(waittime);
 		if (wait_request(waittime, priority_context) != 0) {
 			log_err(-1, msg_daemonname, "wait_requst failed");
 		}
 
+		/* write out deferred job saves whose window has expired */
+		job_save_db_flush(0);
+
 		if (reap_child_flag)	/* check again incase signal arrived */
 			reap_child();	/* before they were blocked          */
 
@@ -1445,6 +1451,8 @@ main(int argc, char **argv)
 	}
 	DBPRT(("Server out of main loop, state is %ld\n", *state))
 
+	job_save_db_flush(1);
+
 	/* set the current seq id to the last id before final save */
 	server.sv_qs.sv_lastid = server.sv_qs.sv_jobidnumber;
 	svr_save_db(&server);	/* final recording of server */
@@ -931,6 +931,10 @@ dispatch_request(int sfds, struct batch_request *request)
 			req_rerunjob(request);
 			break;
 #ifndef PBS_MOM
+		case PBS_BATCH_ModifyJobs_Async:
+			req_modifyjobs(request);
+			break;
+
 		case PBS_BATCH_MoveJob:
 			req_movejob(request);
 			break;
@@ -1276,6 +1280,9 @@ struct batch_request *alloc_br(int type)
 		req->rq_conn = -1;		/* indicate not connected */
 		req->rq_orgconn = -1;		/* indicate not connected */
 		req->rq_time = time_now;
+#ifndef PBS_MOM
+		req->rq_jobsaveseq = job_save_db_seq();
+#endif
 		req->tpp_ack = 1; /* enable acks to be passed by tpp by default */
 		req->prot = PROT_TCP; /* not tpp by default */
 		req->tppcmd_msgid = NULL; /* NULL msgid to boot */
@@ -1315,6 +1322,7 @@ copy_br(struct batch_request *src)
 	req->rq_conn = src->rq_conn;
 	req->rq_orgconn = src->rq_orgconn;
 	req->rq_time = src->rq_time;
+	req->rq_jobsaveseq = src->rq_jobsaveseq;
 	req->tpp_ack = src->tpp_ack;
 	req->prot = src->prot;
 	req->rq_reply.brp_is_part = src->rq_reply.brp_is_part;
@@ -1656,6 +1664,15 @@ free_br(struct batch_request *preq)
 			if (preq->rq_ind.rq_deletejoblist.rq_jobslist)
 				free_string_array(preq->rq_ind.rq_deletejoblist.rq_jobslist);
 			break;
+		case PBS_BATCH_ModifyJobs_Async:
+			if (preq->rq_ind.rq_modifyjobs.rq_jobs) {
+				int i;
+
+				for (i = 0; i < preq->rq_ind.rq_modifyjobs.rq_count; i++)
+					free_attrlist(&preq->rq_ind.rq_modifyjobs.rq_jobs[i].rq_attr);
+				free(preq->rq_ind.rq_modifyjobs.rq_jobs);
+			}
+			break;
 		case PBS_BATCH_CopyFiles:
 		case PBS_BATCH_DelFiles:
 			freebr_cpyfile(&preq->rq_ind.rq_cpyfile);
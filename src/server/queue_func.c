@@ -173,6 +173,8 @@ que_free(pbs_queue *pq)
 		free(pkvp);
 	}
 
+	qrank_idx_free(pq->qu_jobs_rank);
+
 	/* now free the main structure */
 	server.sv_qs.sv_numque--;
 	delete_link(&pq->qu_link);
@@ -246,6 +248,7 @@ que_purge(pbs_queue *pque)
 			state_num = get_job_state_num(pjob);
 			while (pjob) {
 				nxpjob = (job *)GET_NEXT(pjob->ji_jobque);
+				qrank_idx_remove(pjob->ji_que_rank);
 				delete_link(&pjob->ji_jobque);
 				--pque->qu_numjobs;
 				if (state_num != -1)
@@ -73,6 +73,7 @@
 #include "attribute.h"
 #include "credential.h"
 #include "batch_request.h"
+#include "job.h"
 #include "work_task.h"
 #include "pbs_nodes.h"
 #include "svrfunc.h"
@@ -311,7 +312,8 @@ reply_send(struct batch_request *request)
 		rq_type = request->rq_ind.rq_move.orig_rq_type;
 #endif
 
-	if (rq_type == PBS_BATCH_ModifyJob_Async || rq_type == PBS_BATCH_AsyrunJob) {
+	if (rq_type == PBS_BATCH_ModifyJob_Async || rq_type == PBS_BATCH_ModifyJobs_Async ||
+		rq_type == PBS_BATCH_AsyrunJob) {
 		free_br(request);
 		return 0;
 	}
@@ -367,6 +369,14 @@ reply_send(struct batch_request *request)
 		/*
 		 * Otherwise, the reply is to be sent to a remote client
 		 */
+#ifndef PBS_MOM
+		/*
+		 * whatever the request changed must be saved before it is acked,
+		 * a request which deferred no job save (a status) does not flush
+		 */
+		if (request->rq_jobsaveseq != job_save_db_seq())
+			job_save_db_flush(1);
+#endif
 		if (rc == PBSE_NONE) {
 			rc = dis_reply_write(sfds, request);
 		}
@@ -400,7 +410,8 @@ reply_ack(struct batch_request *preq)
 		rq_type = preq->rq_ind.rq_move.orig_rq_type;
 #endif
 
-	if (rq_type == PBS_BATCH_ModifyJob_Async || rq_type == PBS_BATCH_AsyrunJob) {
+	if (rq_type == PBS_BATCH_ModifyJob_Async || rq_type == PBS_BATCH_ModifyJobs_Async ||
+		rq_type == PBS_BATCH_AsyrunJob) {
 		free_br(preq);
 		return;
 	}
@@ -509,7 +520,8 @@ req_reject(int code, int aux, struct batch_request *preq)
 		rq_type = preq->rq_ind.rq_move.orig_rq_type;
 #endif
 
-	if (rq_type == PBS_BATCH_ModifyJob_Async || rq_type == PBS_BATCH_AsyrunJob) {
+	if (rq_type == PBS_BATCH_ModifyJob_Async || rq_type == PBS_BATCH_ModifyJobs_Async ||
+		rq_type == PBS_BATCH_AsyrunJob) {
 		free_br(preq);
 		return;
 	}
@@ -573,7 +585,8 @@ reply_badattr(int code, int aux, svrattrl *pal,
 	if (preq == NULL)
 		return;
 
-	if (preq->rq_type == PBS_BATCH_ModifyJob_Async) {
+	if (preq->rq_type == PBS_BATCH_ModifyJob_Async ||
+		preq->rq_type == PBS_BATCH_ModifyJobs_Async) {
 		free_br(preq);
 		return;
 	}
@@ -631,7 +644,8 @@ reply_text(struct batch_request *preq, int code, char *text)
 	if (preq == NULL)
 		return 0;
 
-	if (preq->rq_type == PBS_BATCH_ModifyJob_Async) {
+	if (preq->rq_type == PBS_BATCH_ModifyJob_Async ||
+		preq->rq_type == PBS_BATCH_ModifyJobs_Async) {
 		free_br(preq);
 		return 0;
 	}
@@ -394,6 +394,57 @@ req_modifyjob(struct batch_request *preq)
 	reply_ack(preq);
 }
 
+/**
+ * @brief
+ * 		Service the Modify Jobs Request, the scheduler's bulk form of
+ *		an asynchronous Modify Job Request.
+ *
+ * @par	Functionality:
+ *		Each entry is handed to req_modifyjob() as its own
+ *		PBS_BATCH_ModifyJob_Async request carrying the credentials of the
+ *		original request, so every job goes through the same checks as a
+ *		single asynchronous alter.  The entries' attribute lists are moved
+ *		to the child requests.  Nothing is replied to the client.
+ *
+ * @param[in] preq - pointer to batch request from client
+ */
+
+void
+req_modifyjobs(struct batch_request *preq)
+{
+	int			 i;
+	struct rq_modifyjobs_ent *pent;
+	struct batch_request	*pchild;
+	svrattrl		*plist;
+
+	for (i = 0; i < preq->rq_ind.rq_modifyjobs.rq_count; i++) {
+		pent = &preq->rq_ind.rq_modifyjobs.rq_jobs[i];
+
+		pchild = alloc_br(PBS_BATCH_ModifyJob_Async);
+		if (pchild == NULL)
+			break;
+		pchild->rq_perm = preq->rq_perm;
+		pchild->rq_fromsvr = preq->rq_fromsvr;
+		pchild->rq_conn = preq->rq_conn;
+		pchild->rq_time = preq->rq_time;
+		strcpy(pchild->rq_user, preq->rq_user);
+		strcpy(pchild->rq_host, preq->rq_host);
+
+		pchild->rq_ind.rq_modify.rq_cmd = MGR_CMD_SET;
+		pchild->rq_ind.rq_modify.rq_objtype = MGR_OBJ_JOB;
+		strcpy(pchild->rq_ind.rq_modify.rq_objname, pent->rq_objname);
+		CLEAR_HEAD(pchild->rq_ind.rq_modify.rq_attr);
+		while ((plist = (svrattrl *)GET_NEXT(pent->rq_attr)) != NULL) {
+			delete_link(&plist->al_link);
+			append_link(&pchild->rq_ind.rq_modify.rq_attr, &plist->al_link, plist);
+		}
+
+		req_modifyjob(pchild);
+	}
+
+	free_br(preq);
+}
+
 /**
  * @brief
  * 		Returns the svrattrl entry matching attribute 'name', or NULL if not found.
@@ -274,6 +274,115 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
 	}
 }
 
+/**
+ * @brief
+ * 	Support function for req_stat_job().
+ * 	Parse the paging options which follow the flag characters of the
+ * 	extend string, see EXTEND_OPT_STAT_PAGE.
+ *
+ * @param[in]  opts  - extend string after the flag characters
+ * @param[out] page  - max number of jobs to status, 0 for all
+ * @param[out] after - job id to resume after, empty for the first page
+ * @param[out] rank  - qrank the 'after' job had, -1 if not given
+ *
+ * @return void
+ */
+static void
+parse_stat_page_opts(char *opts, long *page, char *after, long *rank)
+{
+	size_t len;
+
+	*page = 0;
+	*after = '\0';
+	*rank = -1;
+	while (*opts == ',') {
+		opts++;
+		len = strcspn(opts, ",");
+		if (strncmp(opts, EXTEND_OPT_STAT_PAGE, sizeof(EXTEND_OPT_STAT_PAGE) - 1) == 0)
+			*page = atol(opts + sizeof(EXTEND_OPT_STAT_PAGE) - 1);
+		else if (strncmp(opts, EXTEND_OPT_STAT_RANK, sizeof(EXTEND_OPT_STAT_RANK) - 1) == 0)
+			*rank = atol(opts + sizeof(EXTEND_OPT_STAT_RANK) - 1);
+		else if (strncmp(opts, EXTEND_OPT_STAT_AFTER, sizeof(EXTEND_OPT_STAT_AFTER) - 1) == 0 &&
+			 len - (sizeof(EXTEND_OPT_STAT_AFTER) - 1) <= PBS_MAXSVRJOBID)
+			pbs_strncpy(after, opts + sizeof(EXTEND_OPT_STAT_AFTER) - 1,
+				    len - (sizeof(EXTEND_OPT_STAT_AFTER) - 1) + 1);
+		opts += len;
+	}
+}
+
+/**
+ * @brief
+ * 	Support function for req_stat_job().
+ * 	Find the job a paged status of the jobs in a queue or in the server
+ * 	resumes at.  The job lists are in qrank order, so this is the one
+ * 	following 'after' if 'after' is still where it was when the previous
+ * 	page was sent, i.e. in the list with the same qrank.  Otherwise, if
+ * 	it was deleted, moved or reordered, it is the first job with a higher
+ * 	qrank than 'after' had.  Jobs which have the same qrank were queued in
+ * 	the same millisecond, these are told apart by their sequence number.
+ *
+ * @param[in] pque  - queue whose jobs are statused, NULL for all jobs
+ * @param[in] after - last job of the previous page, empty for the first page
+ * @param[in] rank  - qrank of 'after' when the previous page was sent,
+ *		      -1 if not known
+ *
+ * @return job *
+ * @retval first job to status, NULL if none is left
+ */
+static job *
+stat_page_start(pbs_queue *pque, char *after, long rank)
+{
+	job *pjob;
+	long seq;
+
+	if (*after == '\0')
+		return (job *) GET_NEXT(pque ? pque->qu_jobs : svr_alljobs);
+
+	pjob = find_job(after);
+	if (pjob != NULL && (pque == NULL || pjob->ji_qhdr == pque) &&
+	    (rank == -1 || get_jattr_long(pjob, JOB_ATR_qrank) == rank))
+		return (job *) GET_NEXT(pque ? pjob->ji_jobque : pjob->ji_alljobs);
+
+	if (rank == -1)
+		return (job *) GET_NEXT(pque ? pque->qu_jobs : svr_alljobs);
+
+	seq = strtol(after, NULL, 10);
+	pjob = find_job_by_qrank(pque, rank);
+	while (pjob && get_jattr_long(pjob, JOB_ATR_qrank) == rank &&
+	       strtol(pjob->ji_qs.ji_jobid, NULL, 10) <= seq)
+		pjob = (job *) GET_NEXT(pque ? pjob->ji_jobque : pjob->ji_alljobs);
+	return pjob;
+}
+
+/**
+ * @brief
+ * 	Support function for req_stat_job().
+ * 	Add the paging cursor to the last status of a page which stops short
+ * 	of the end of the list.  It is the qrank of the last job of the page,
+ * 	which the client sends back with EXTEND_OPT_STAT_RANK.
+ *
+ * @param[in,out] preply - the reply to the page
+ * @param[in]     plast  - last job of the page
+ *
+ * @return int
+ * @retval PBSE_NONE   - success
+ * @retval PBSE_SYSTEM - out of memory
+ */
+static int
+stat_page_cursor(struct batch_reply *preply, job *plast)
+{
+	struct brp_status *pstat;
+	char buf[32];
+
+	pstat = (struct brp_status *) GET_PRIOR(preply->brp_un.brp_status);
+	if (pstat == NULL)
+		return PBSE_NONE;
+	snprintf(buf, sizeof(buf), "%ld", get_jattr_long(plast, JOB_ATR_qrank));
+	if (add_to_svrattrl_list(&pstat->brp_attr, STAT_PAGE_CURSOR, NULL, buf, 0, NULL) == -1)
+		return PBSE_SYSTEM;
+	return PBSE_NONE;
+}
+
 /**
  * @brief
  * 	Service the Status Job Request
@@ -286,6 +395,10 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
  * 	job, a subjob or a range of subjobs), a comma separated list of the above,
  * 	a queue name or null (or @...) for all jobs in the Server.
  *
+ * 	The jobs of a queue or of the Server may be requested a page at a
+ * 	time, see EXTEND_OPT_STAT_PAGE.  A page that stops short of the end of
+ * 	the list is replied with an auxcode of STAT_PAGE_MORE.
+ *
  * @param[in/out] preq - pointer to the stat job batch request, reply updated
  *
  * @return void
@@ -304,17 +417,24 @@ req_stat_job(struct batch_request *preq)
 	int rc = 0;
 	int type = 0;
 	char *pnxtjid = NULL;
+	long page = 0;
+	long nstat = 0;
+	long rank = -1;
+	char after[PBS_MAXSVRJOBID + 1] = {'\0'};
 
 	/* check for any extended flag in the batch request. 't' for
 	 * the sub jobs. If 'x' is there, then check if the server is
 	 * configured for history job info. If not set or set to FALSE,
 	 * return with PBSE_JOBHISTNOTSET error. Otherwise select history
-	 * jobs.
+	 * jobs.  Any paging options follow the flags.
 	 */
 	if (preq->rq_extend) {
-		if (strchr(preq->rq_extend, (int) 't'))
+		size_t nflags = strcspn(preq->rq_extend, ",");
+
+		parse_stat_page_opts(preq->rq_extend + nflags, &page, after, &rank);
+		if (memchr(preq->rq_extend, (int) 't', nflags))
 			dosubjobs = 1; /* status sub jobs of an Array Job */
-		if (strchr(preq->rq_extend, (int) 'x')) {
+		if (memchr(preq->rq_extend, (int) 'x', nflags)) {
 			if (svr_history_enable == 0) {
 				req_reject(PBSE_JOBHISTNOTSET, 0, preq);
 				return;
@@ -379,6 +499,10 @@ req_stat_job(struct batch_request *preq)
 		 */
 		pnxtjid = name;
 		while ((name = parse_comma_string_r(&pnxtjid)) != NULL) {
+			if (preply->brp_count >= MAX_JOBS_PER_REPLY) {
+				if (reply_send_status_part(preq) != PBSE_NONE)
+					return;
+			}
 			if ((rc = stat_a_jobidname(preq, name, dohistjobs, dosubjobs)) == PBSE_NONE)
 				at_least_one_success = 1;
 		}
@@ -389,14 +513,28 @@ req_stat_job(struct batch_request *preq)
 		return;
 
 	} else {
-		pjob = (job *) GET_NEXT(type == 2 ? pque->qu_jobs : svr_alljobs);
+		pjob = stat_page_start(type == 2 ? pque : NULL, after, rank);
 		while (pjob) {
+			int count = preply->brp_count;
+			job *plast = pjob;
+
 			rc = do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs);
 			if (rc != PBSE_NONE) {
 				req_reject(rc, bad, preq);
 				return;
 			}
+			if (preply->brp_count > count)
+				nstat++;
 			pjob = (job *) GET_NEXT(type == 2 ? pjob->ji_jobque : pjob->ji_alljobs);
+			if (page > 0 && nstat >= page && pjob) {
+				rc = stat_page_cursor(preply, plast);
+				if (rc != PBSE_NONE) {
+					req_reject(rc, 0, preq);
+					return;
+				}
+				preply->brp_auxcode = STAT_PAGE_MORE;
+				break;
+			}
 			if (preply->brp_count >= MAX_JOBS_PER_REPLY && pjob) {
 				rc = reply_send_status_part(preq);
 				if (rc != PBSE_NONE)
@@ -150,6 +150,8 @@ extern void free_job_work_tasks(job *);
 static void correct_ct(pbs_queue *);
 #endif 	/* NDEBUG */
 
+static struct qrank_node *svr_alljobs_rank = NULL;	/* qrank index of svr_alljobs */
+
 /**
  * @brief
  * 		clear the default resource from structures
@@ -190,6 +192,329 @@ tickle_for_reply(void)
 	(void)set_task(WORK_Timed, time_now + 10, 0, NULL);
 }
 
+/*
+ * Ordered qrank index over svr_alljobs and each queue's qu_jobs.
+ *
+ * The job lists are kept in increasing JOB_ATR_qrank order.  Rather than
+ * walking a list backwards to find where a job belongs, svr_enquejob()
+ * looks up the first indexed job with a higher rank in a skip list and
+ * links the new job in front of it.  A job refers to its nodes through
+ * ji_svr_rank and ji_que_rank; each node records the rank it was filed
+ * under, so it can be removed even if the attribute has changed since.
+ */
+#define QRANK_MAXLEVEL	24
+
+struct qrank_node {
+	long			qr_rank;	/* qrank the job was indexed with */
+	job			*qr_job;
+	struct qrank_node	**qr_owner;	/* job field pointing to this node */
+	struct qrank_node	*qr_idx;	/* header of the index holding the node */
+	int			qr_level;	/* number of qr_next[] entries */
+	struct qrank_node	*qr_next[1];	/* actually qr_level long */
+};
+
+/**
+ * @brief
+ *		Allocate a skip list node with 'level' forward pointers.
+ *
+ * @param[in]	level	-	number of levels
+ *
+ * @return	struct qrank_node *
+ * @retval	NULL	: out of memory
+ */
+static struct qrank_node *
+qrank_node_alloc(int level)
+{
+	struct qrank_node *node;
+
+	node = calloc(1, sizeof(struct qrank_node) + (level - 1) * sizeof(struct qrank_node *));
+	if (node == NULL) {
+		log_err(errno, __func__, "no memory");
+		return NULL;
+	}
+	node->qr_level = level;
+	return node;
+}
+
+/**
+ * @brief
+ *		Pick a level for a new node, each level being 1/4 as likely as the
+ *		one below.
+ *
+ * @return	int
+ */
+static int
+qrank_random_level(void)
+{
+	static unsigned int seed = 2463534242U;
+	int level = 1;
+
+	/* xorshift, good enough to spread levels */
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	for (; (level < QRANK_MAXLEVEL) && ((seed & 3) == 0); seed >>= 2)
+		level++;
+	return level;
+}
+
+/**
+ * @brief
+ *		Add 'pjob' to the index 'idx' under its current qrank, after any
+ *		jobs already indexed with the same rank.
+ *
+ * @param[in]	idx	-	index header
+ * @param[in]	pjob	-	job to index
+ * @param[out]	owner	-	job field to remember the node in
+ *
+ * @return	struct qrank_node *
+ * @retval	the new node
+ * @retval	NULL	: out of memory
+ */
+static struct qrank_node *
+qrank_idx_add(struct qrank_node *idx, job *pjob, struct qrank_node **owner)
+{
+	struct qrank_node *update[QRANK_MAXLEVEL];
+	struct qrank_node *node;
+	struct qrank_node *x;
+	long rank = get_jattr_long(pjob, JOB_ATR_qrank);
+	int level;
+	int i;
+
+	/* equal ranks keep their enqueue order, new one goes after them */
+	x = idx;
+	for (i = idx->qr_level - 1; i >= 0; i--) {
+		while ((x->qr_next[i] != NULL) && (x->qr_next[i]->qr_rank <= rank))
+			x = x->qr_next[i];
+		update[i] = x;
+	}
+
+	level = qrank_random_level();
+	if ((node = qrank_node_alloc(level)) == NULL)
+		return NULL;
+	for (i = idx->qr_level; i < level; i++)
+		update[i] = idx;
+	if (level > idx->qr_level)
+		idx->qr_level = level;
+
+	node->qr_rank = rank;
+	node->qr_job = pjob;
+	node->qr_owner = owner;
+	node->qr_idx = idx;
+	for (i = 0; i < level; i++) {
+		node->qr_next[i] = update[i]->qr_next[i];
+		update[i]->qr_next[i] = node;
+	}
+	*owner = node;
+	return node;
+}
+
+/**
+ * @brief
+ *		Index 'pjob' by its current qrank in the index '*pidx' of the job
+ *		list 'phead', and find the job it must precede in that list.
+ *
+ *		The index always covers every job of the list or does not exist.
+ *		It is built from the list when missing, and dropped altogether if
+ *		memory runs out, in which case the caller must find the place of
+ *		the job by walking the list.
+ *
+ * @param[in,out]	pidx	-	index header, NULL if there is no index
+ * @param[in]	phead	-	the job list, svr_alljobs or a queue's qu_jobs
+ * @param[in]	pjob	-	job being enqueued
+ * @param[out]	pnext	-	first indexed job with a higher qrank, NULL if
+ *				the job goes at the end of the list
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: no index, out of memory
+ */
+static int
+qrank_insert(struct qrank_node **pidx, pbs_list_head *phead, job *pjob, job **pnext)
+{
+	int svr = (phead == &svr_alljobs);
+	struct qrank_node *node;
+	job *pj;
+
+	if (*pidx == NULL) {
+		if ((*pidx = qrank_node_alloc(QRANK_MAXLEVEL)) == NULL)
+			return -1;
+		(*pidx)->qr_level = 1;	/* header: levels in use */
+		for (pj = (job *)GET_NEXT(*phead); pj != NULL;
+			pj = (job *)(svr ? GET_NEXT(pj->ji_alljobs) : GET_NEXT(pj->ji_jobque))) {
+			if (qrank_idx_add(*pidx, pj, svr ? &pj->ji_svr_rank : &pj->ji_que_rank) == NULL)
+				break;
+		}
+		if (pj != NULL) {
+			qrank_idx_free(*pidx);
+			*pidx = NULL;
+			return -1;
+		}
+	}
+
+	node = qrank_idx_add(*pidx, pjob, svr ? &pjob->ji_svr_rank : &pjob->ji_que_rank);
+	if (node == NULL) {
+		/* a partial index would misplace later jobs */
+		qrank_idx_free(*pidx);
+		*pidx = NULL;
+		return -1;
+	}
+
+	*pnext = node->qr_next[0] ? node->qr_next[0]->qr_job : NULL;
+	return 0;
+}
+
+/**
+ * @brief
+ *		Remove a node from its index and clear the job's reference to it.
+ *
+ * @param[in]	node	-	node to remove, may be NULL
+ */
+void
+qrank_idx_remove(struct qrank_node *node)
+{
+	struct qrank_node *idx;
+	struct qrank_node *x;
+	struct qrank_node *y;
+	int i;
+
+	if (node == NULL)
+		return;
+
+	idx = node->qr_idx;
+	x = idx;
+	for (i = idx->qr_level - 1; i >= 0; i--) {
+		while ((x->qr_next[i] != NULL) && (x->qr_next[i]->qr_rank < node->qr_rank))
+			x = x->qr_next[i];
+		if (i >= node->qr_level)
+			continue;
+		for (y = x; (y->qr_next[i] != NULL) && (y->qr_next[i] != node); y = y->qr_next[i]) {
+			if (y->qr_next[i]->qr_rank != node->qr_rank)
+				break;
+		}
+		if (y->qr_next[i] == node)
+			y->qr_next[i] = node->qr_next[i];
+	}
+	while ((idx->qr_level > 1) && (idx->qr_next[idx->qr_level - 1] == NULL))
+		idx->qr_level--;
+
+	*node->qr_owner = NULL;
+	free(node);
+}
+
+/**
+ * @brief
+ *		Free a qrank index and all its nodes, clearing the references the
+ *		jobs hold to them.  Used when a queue is freed.
+ *
+ * @param[in]	idx	-	index header, may be NULL
+ */
+void
+qrank_idx_free(struct qrank_node *idx)
+{
+	struct qrank_node *node;
+	struct qrank_node *next;
+
+	if (idx == NULL)
+		return;
+	for (node = idx->qr_next[0]; node != NULL; node = next) {
+		next = node->qr_next[0];
+		*node->qr_owner = NULL;
+		free(node);
+	}
+	free(idx);
+}
+
+/**
+ * @brief
+ *		Find the first job of a job list with a qrank of at least 'rank'.
+ *		The qrank index is used when the list has one, otherwise the list
+ *		is walked.
+ *
+ * @param[in]	pque	-	queue whose qu_jobs to search, NULL for svr_alljobs
+ * @param[in]	rank	-	qrank to look for
+ *
+ * @return	job *
+ * @retval	NULL	: every job has a lower qrank
+ */
+job *
+find_job_by_qrank(pbs_queue *pque, long rank)
+{
+	struct qrank_node *idx = pque ? pque->qu_jobs_rank : svr_alljobs_rank;
+	struct qrank_node *x;
+	job *pjob;
+	int i;
+
+	if (idx != NULL) {
+		x = idx;
+		for (i = idx->qr_level - 1; i >= 0; i--) {
+			while ((x->qr_next[i] != NULL) && (x->qr_next[i]->qr_rank < rank))
+				x = x->qr_next[i];
+		}
+		return x->qr_next[0] ? x->qr_next[0]->qr_job : NULL;
+	}
+
+	pjob = (job *)GET_NEXT(pque ? pque->qu_jobs : svr_alljobs);
+	while (pjob && get_jattr_long(pjob, JOB_ATR_qrank) < rank)
+		pjob = (job *)(pque ? GET_NEXT(pjob->ji_jobque) : GET_NEXT(pjob->ji_alljobs));
+	return pjob;
+}
+
+/**
+ * @brief
+ *		Remove a job from the server and queue qrank indexes.
+ *
+ * @param[in]	pjob	-	job
+ */
+void
+job_qrank_unindex(job *pjob)
+{
+	qrank_idx_remove(pjob->ji_svr_rank);
+	qrank_idx_remove(pjob->ji_que_rank);
+}
+
+/**
+ * @brief
+ *		Keep the qrank indexes in step when two jobs of the same queue
+ *		exchange their qrank and their place in the job lists.
+ *
+ * @param[in]	pjob1	-	first job
+ * @param[in]	pjob2	-	second job
+ */
+void
+job_qrank_swap(job *pjob1, job *pjob2)
+{
+	struct qrank_node *tmp;
+
+	if ((pjob1->ji_svr_rank == NULL) != (pjob2->ji_svr_rank == NULL)) {
+		/* can't swap a partially indexed pair, rebuild the index later */
+		tmp = pjob1->ji_svr_rank ? pjob1->ji_svr_rank : pjob2->ji_svr_rank;
+		qrank_idx_free(tmp->qr_idx);
+		svr_alljobs_rank = NULL;
+	} else if (pjob1->ji_svr_rank != NULL) {
+		tmp = pjob1->ji_svr_rank;
+		pjob1->ji_svr_rank = pjob2->ji_svr_rank;
+		pjob2->ji_svr_rank = tmp;
+		pjob1->ji_svr_rank->qr_job = pjob1;
+		pjob1->ji_svr_rank->qr_owner = &pjob1->ji_svr_rank;
+		pjob2->ji_svr_rank->qr_job = pjob2;
+		pjob2->ji_svr_rank->qr_owner = &pjob2->ji_svr_rank;
+	}
+
+	if ((pjob1->ji_que_rank == NULL) != (pjob2->ji_que_rank == NULL)) {
+		qrank_idx_free(pjob1->ji_qhdr->qu_jobs_rank);
+		pjob1->ji_qhdr->qu_jobs_rank = NULL;
+	} else if (pjob1->ji_que_rank != NULL) {
+		tmp = pjob1->ji_que_rank;
+		pjob1->ji_que_rank = pjob2->ji_que_rank;
+		pjob2->ji_que_rank = tmp;
+		pjob1->ji_que_rank->qr_job = pjob1;
+		pjob1->ji_que_rank->qr_owner = &pjob1->ji_que_rank;
+		pjob2->ji_que_rank->qr_job = pjob2;
+		pjob2->ji_que_rank->qr_owner = &pjob2->ji_que_rank;
+	}
+}
+
 /**
  * @brief
  * 		svr_enquejob	-	Enqueue the job into specified queue.
@@ -262,44 +587,70 @@ svr_enquejob(job *pjob, char *selectspec)
 		return PBSE_INTERNAL;
 	}
 
-	pjcur = (job *)GET_PRIOR(svr_alljobs);
-	while (pjcur) {
-		if (get_jattr_long(pjob, JOB_ATR_qrank) >= get_jattr_long(pjcur, JOB_ATR_qrank))
-			break;
-		pjcur = (job *)GET_PRIOR(pjcur->ji_alljobs);
-	}
-	if (pjcur == 0) {
-		/* link first in server's list */
-		insert_link(&svr_alljobs, &pjob->ji_alljobs, pjob,
-			LINK_INSET_AFTER);
+	/* place into server's list in order of queue rank */
+
+	if (qrank_insert(&svr_alljobs_rank, &svr_alljobs, pjob, &pjcur) == 0) {
+		if (pjcur == NULL) {
+			/* link last in server's list */
+			append_link(&svr_alljobs, &pjob->ji_alljobs, pjob);
+		} else {
+			/* link before the first job of higher rank */
+			insert_link(&pjcur->ji_alljobs, &pjob->ji_alljobs, pjob,
+				LINK_INSET_BEFORE);
+		}
 	} else {
-		/* link after 'current' job in server's list */
-		insert_link(&pjcur->ji_alljobs, &pjob->ji_alljobs, pjob,
-			LINK_INSET_AFTER);
+		/* no index, search the list starting at the end */
+		pjcur = (job *)GET_PRIOR(svr_alljobs);
+		while (pjcur) {
+			if (get_jattr_long(pjob, JOB_ATR_qrank) >= get_jattr_long(pjcur, JOB_ATR_qrank))
+				break;
+			pjcur = (job *)GET_PRIOR(pjcur->ji_alljobs);
+		}
+		if (pjcur == NULL) {
+			/* link first in server's list */
+			insert_link(&svr_alljobs, &pjob->ji_alljobs, pjob,
+				LINK_INSET_AFTER);
+		} else {
+			/* link after 'current' job in server's list */
+			insert_link(&pjcur->ji_alljobs, &pjob->ji_alljobs, pjob,
+				LINK_INSET_AFTER);
+		}
 	}
 
 	server.sv_qs.sv_numjobs++;
 	if (state_num != -1)
 		server.sv_jobstates[state_num]++;
 
-	/* place into queue in order of queue rank starting at end */
+	/* place into queue in order of queue rank */
 
 	pjob->ji_qhdr = pque;
 
-	pjcur = (job *)GET_PRIOR(pque->qu_jobs);
-	while (pjcur) {
-		if (get_jattr_long(pjob, JOB_ATR_qrank) >= get_jattr_long(pjcur, JOB_ATR_qrank))
-			break;
-		pjcur = (job *)GET_PRIOR(pjcur->ji_jobque);
-	}
-	if (pjcur == 0) {
-		/* link first in list */
-		insert_link(&pque->qu_jobs, &pjob->ji_jobque, pjob,
-			LINK_INSET_AFTER);
+	if (qrank_insert(&pque->qu_jobs_rank, &pque->qu_jobs, pjob, &pjcur) == 0) {
+		if (pjcur == NULL) {
+			/* link last in list */
+			append_link(&pque->qu_jobs, &pjob->ji_jobque, pjob);
+		} else {
+			/* link before the first job of higher rank */
+			insert_link(&pjcur->ji_jobque, &pjob->ji_jobque, pjob,
+				LINK_INSET_BEFORE);
+		}
 	} else {
-		/* link after 'current' job in list */
-		insert_link(&pjcur->ji_jobque, &pjob->ji_jobque, pjob,
-			LINK_INSET_AFTER);
+		/* no index, search the list starting at the end */
+		pjcur = (job *)GET_PRIOR(pque->qu_jobs);
+		while (pjcur) {
+			if (get_jattr_long(pjob, JOB_ATR_qrank) >= get_jattr_long(pjcur, JOB_ATR_qrank))
+				break;
+			pjcur = (job *)GET_PRIOR(pjcur->ji_jobque);
+		}
+		if (pjcur == NULL) {
+			/* link first in list */
+			insert_link(&pque->qu_jobs, &pjob->ji_jobque, pjob,
+				LINK_INSET_AFTER);
+		} else {
+			/* link after 'current' job in list */
+			insert_link(&pjcur->ji_jobque, &pjob->ji_jobque, pjob,
+				LINK_INSET_AFTER);
+		}
 	}
 
 	/* update counts: queue and queue by state */
@@ -444,9 +795,10 @@ svr_dequejob(job *pjob)
 
 	/* remove job from server's all job list and reduce server counts */
 
-	if (is_linked(&svr_alljobs, &pjob->ji_alljobs)) {
+	if ((pjob->ji_svr_rank != NULL) || is_linked(&svr_alljobs, &pjob->ji_alljobs)) {
 		int state_num;
 
+		qrank_idx_remove(pjob->ji_svr_rank);
 		delete_link(&pjob->ji_alljobs);
 		delete_link(&pjob->ji_unlicjobs);
 		if (pbs_idx_delete(jobs_idx, pjob->ji_qs.ji_jobid) != PBS_IDX_RET_OK)
@@ -467,7 +819,8 @@ svr_dequejob(job *pjob)
 				pjob->ji_etlimit_decr_queued ? ETLIM_ACC_ALL_MAX : ETLIM_ACC_ALL);
 
 
-		if (is_linked(&pque->qu_jobs, &pjob->ji_jobque)) {
+		if ((pjob->ji_que_rank != NULL) || is_linked(&pque->qu_jobs, &pjob->ji_jobque)) {
+			qrank_idx_remove(pjob->ji_que_rank);
 			delete_link(&pjob->ji_jobque);
 			if (--pque->qu_numjobs < 0)
 				bad_ct = 1;
@@ -1260,19 +1613,19 @@ check_block_wt(struct work_task *ptask)
 
 	if (blockj->fd == -1) {
 		int sock_flags;
-		struct hostent		*hp;
+		pbs_net_t		addr;
 		struct sockaddr_in	remote;
 
-		if ((hp = gethostbyname(blockj->client)) == NULL) {
+		if ((addr = get_hostaddr(blockj->client)) == 0) {
 			sprintf(log_buffer, "client host %s not found for block job %s",
 			blockj->client, blockj->jobid);
 			goto err;
 		}
 
 		memset(&remote, 0, sizeof(remote));
-		memcpy(&remote.sin_addr, hp->h_addr, hp->h_length);
+		remote.sin_addr.s_addr = htonl(addr);
 		remote.sin_port = htons((unsigned short)blockj->port);
-		remote.sin_family = hp->h_addrtype;
+		remote.sin_family = AF_INET;
 
 		if ((blockj->fd = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
 			sprintf(log_buffer, "Failed to create socket for job %s", blockj->jobid);
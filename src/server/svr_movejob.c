@@ -771,6 +771,9 @@ send_job(job *jobp, pbs_net_t hostaddr, int port, int move_type,
 	struct in_addr addr;
 	long tempval;
 
+	/* the job must be in the database before the mom sees it */
+	job_save_db_flush(1);
+
 	/* if job has a script read it from database */
 	if (jobp->ji_qs.ji_svrflags & JOB_SVFLG_SCRIPT) {
 		if (svr_load_jobscript(jobp) == NULL) {
@@ -59,6 +59,7 @@
  * 	fprint_svrattrl_list()
  * 	fprint_str_array()
  * 	argv_list_to_str()
+ * 	hook_worker_main()
  * 	main()
  */
 #include <pbs_config.h>
@@ -99,6 +100,13 @@
 #include "svrfunc.h"
 #include "pbs_sched.h"
 #include "portability.h"
+#ifndef WIN32
+#include <stdint.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
 
 #define PBS_V1_COMMON_MODULE_DEFINE_STUB_FUNCS 1
 #include "pbs_v1_module_common.i"
@@ -1377,6 +1385,476 @@ argv_list_to_str(pbs_list_head *argv_list)
 
 }
 
+#ifndef WIN32
+/*
+ * Persistent hook worker ("pbs_python --hook-worker").  MoM starts one
+ * worker which initializes the Python interpreter and loads the pbs types
+ * once, then forks a fresh hook process for every request it receives.
+ * Compiled hook scripts are cached in the worker so that the forked
+ * hook processes inherit the code objects.
+ */
+#define HOOK_WORKER_MAXCHILDREN	64
+
+struct hook_worker_child {
+	pid_t	pid;	/* hook process, 0 if slot is unused */
+	int	conn;	/* requestor connection, -1 once it has gone away */
+};
+
+static struct hook_worker_child	hook_worker_children[HOOK_WORKER_MAXCHILDREN];
+static struct python_script	**hook_worker_scripts = NULL;
+static int			hook_worker_nscripts = 0;
+static struct python_script	*hook_worker_script = NULL; /* for the forked hook process */
+static int			hook_worker_sigpipe[2] = {-1, -1};
+static volatile sig_atomic_t	hook_worker_stopping = 0;
+
+/**
+ * @brief
+ *	SIGCHLD handler for the hook worker: wake up poll().
+ *
+ * @param[in]	sig	-	signal number
+ */
+static void
+hook_worker_sigchld(int sig)
+{
+	int save_errno = errno;
+
+	if (write(hook_worker_sigpipe[1], "", 1) == -1)
+		;	/* pipe full, poll() will wake up anyway */
+	errno = save_errno;
+}
+
+/**
+ * @brief
+ *	SIGTERM handler for the hook worker: stop accepting requests and
+ *	exit once the running hooks are done.
+ *
+ * @param[in]	sig	-	signal number
+ */
+static void
+hook_worker_sigterm(int sig)
+{
+	hook_worker_stopping = 1;
+}
+
+/**
+ * @brief
+ *	Read exactly 'len' bytes from 'fd'.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: error or end of file
+ */
+static int
+hook_worker_read(int fd, void *buf, size_t len)
+{
+	char	*p = buf;
+	ssize_t	n;
+
+	while (len > 0) {
+		n = read(fd, p, len);
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return -1;
+		p += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	Send the wait status of a hook process (or HOOK_WORKER_DECLINED)
+ *	back to the requestor and close the connection.
+ *
+ * @param[in]	conn	-	requestor connection
+ * @param[in]	status	-	value to send
+ */
+static void
+hook_worker_reply(int conn, int status)
+{
+	int32_t	st = (int32_t)status;
+
+	if (conn == -1)
+		return;
+	if (write(conn, &st, sizeof(st)) != sizeof(st))
+		log_err(errno, __func__, "failed to send hook status");
+	close(conn);
+}
+
+/**
+ * @brief
+ *	Read a hook request from 'conn' into a NULL terminated, malloc-ed
+ *	string array.
+ *
+ * @param[in]	conn	-	requestor connection
+ *
+ * @return	char **
+ * @retval	array of request strings (free with free_string_array())
+ * @retval	NULL	: malformed request
+ */
+static char **
+hook_worker_read_request(int conn)
+{
+	uint32_t	count;
+	uint32_t	len;
+	uint32_t	total = 0;
+	uint32_t	i;
+	char		**strs;
+
+	if (hook_worker_read(conn, &count, sizeof(count)) != 0)
+		return NULL;
+	if ((count < 3) || (count > HOOK_WORKER_MAXSTRS))
+		return NULL;
+	if ((strs = calloc(count + 1, sizeof(char *))) == NULL)
+		return NULL;
+	for (i = 0; i < count; i++) {
+		if (hook_worker_read(conn, &len, sizeof(len)) != 0)
+			break;
+		total += len;
+		if (total > HOOK_WORKER_MAXREQ)
+			break;
+		if ((strs[i] = malloc(len + 1)) == NULL)
+			break;
+		if (hook_worker_read(conn, strs[i], len) != 0)
+			break;
+		strs[i][len] = '\0';
+	}
+	if (i < count) {
+		free_string_array(strs);
+		return NULL;
+	}
+	return strs;
+}
+
+/**
+ * @brief
+ *	Return the cached, compiled python_script for 'path', compiling it
+ *	if it is new or has changed on disk.
+ *
+ * @param[in]	path	-	hook script path
+ *
+ * @return	struct python_script *
+ * @retval	cached script
+ * @retval	NULL	: could not be cached, hook process will load it itself
+ */
+static struct python_script *
+hook_worker_get_script(char *path)
+{
+	struct python_script	*py_script = NULL;
+	struct python_script	**tmp;
+	int			i;
+
+	for (i = 0; i < hook_worker_nscripts; i++) {
+		if (strcmp(hook_worker_scripts[i]->path, path) == 0) {
+			py_script = hook_worker_scripts[i];
+			break;
+		}
+	}
+	if (py_script == NULL) {
+		if (pbs_python_ext_alloc_python_script(path, &py_script) != 0)
+			return NULL;
+		tmp = realloc(hook_worker_scripts, (hook_worker_nscripts + 1) * sizeof(struct python_script *));
+		if (tmp == NULL) {
+			pbs_python_ext_free_python_script(py_script);
+			free(py_script);
+			return NULL;
+		}
+		hook_worker_scripts = tmp;
+		hook_worker_scripts[hook_worker_nscripts++] = py_script;
+	}
+	if (pbs_python_check_and_compile_script(&svr_interp_data, py_script) != 0)
+		return NULL;
+	return py_script;
+}
+
+/**
+ * @brief
+ *	Check that the resourcedef file named in a request is the one the
+ *	worker loaded its Python resource types from.
+ *
+ * @param[in]	rescdef	-	resourcedef named in the request, or NULL
+ * @param[in]	loaded	-	resourcedef the worker was started with, or NULL
+ * @param[in]	lsbuf	-	stat of 'loaded' taken at startup
+ *
+ * @return	int
+ * @retval	1	: same resource definitions
+ * @retval	0	: worker is stale
+ */
+static int
+hook_worker_rescdef_current(char *rescdef, char *loaded, struct stat *lsbuf)
+{
+	struct stat sbuf;
+
+	if ((rescdef == NULL) || (loaded == NULL))
+		return (rescdef == loaded);
+	if (strcmp(rescdef, loaded) != 0)
+		return 0;
+	if (stat(rescdef, &sbuf) != 0)
+		return 0;
+	return ((sbuf.st_ino == lsbuf->st_ino) &&
+		(sbuf.st_size == lsbuf->st_size) &&
+		(sbuf.st_mtime == lsbuf->st_mtime));
+}
+
+/**
+ * @brief
+ *	Main loop of the persistent hook worker.
+ *
+ * @par
+ *	Never returns in the worker itself.  For every accepted request a
+ *	hook process is forked; in that process this function returns with
+ *	'pargc'/'pargv' set to the "--hook" argument vector of the request,
+ *	so that main() runs the hook exactly as if pbs_python had been
+ *	executed with those arguments, but with the interpreter already
+ *	started and the hook script already compiled.
+ *
+ * @param[in]	argc	-	argument count
+ * @param[in]	argv	-	HOOK_WORKER_MODE <listen_fd> <path_log> <log_event_mask> [<resourcedef>]
+ * @param[out]	pargc	-	argument count of the request
+ * @param[out]	pargv	-	argument vector of the request
+ *
+ * @return	int
+ * @retval	0	: in the forked hook process
+ * @retval	1	: the worker failed to start
+ */
+static int
+hook_worker_main(int argc, char *argv[], int *pargc, char ***pargv)
+{
+	extern void pbs_python_svr_initialize_interpreter_data(struct python_interpreter_data *interp_data);
+	extern void pbs_python_svr_destroy_interpreter_data(struct python_interpreter_data *interp_data);
+	struct pollfd		pfds[HOOK_WORKER_MAXCHILDREN + 2];
+	struct sigaction	act;
+	struct stat		rescdef_sbuf;
+	struct timeval		tv;
+	char			*rescdef = NULL;
+	char			*req_rescdef;
+	char			**req;
+	char			*bad;
+	int			nreq;
+	int			lsock;
+	int			conn;
+	int			running = 0;
+	int			npfds;
+	int			st;
+	int			i, j;
+	pid_t			ppid;
+	pid_t			pid;
+
+	if (argc < 5) {
+		fprintf(stderr, "%s %s <listen_fd> <path_log> <log_event_mask> [<resourcedef>]\n", argv[0], HOOK_WORKER_MODE);
+		return 1;
+	}
+	lsock = (int)strtol(argv[2], &bad, 10);
+	if ((*bad != '\0') || (lsock < 0))
+		return 1;
+	*log_event_mask = strtol(argv[4], &bad, 0);
+	if (log_open_main("", argv[3], 1) != 0)
+		return 1;
+
+	if ((argc > 5) && (argv[5][0] != '\0')) {
+		rescdef = argv[5];
+		path_rescdef = strdup(rescdef);
+		if ((path_rescdef == NULL) || (stat(rescdef, &rescdef_sbuf) != 0) ||
+			(setup_resc(1) == -1)) {
+			log_errf(-1, __func__, "failed to load resourcedef %s", rescdef);
+			return 1;
+		}
+	}
+
+	svr_interp_data.data_initialized = 0;
+	svr_interp_data.init_interpreter_data = pbs_python_svr_initialize_interpreter_data;
+	svr_interp_data.destroy_interpreter_data = pbs_python_svr_destroy_interpreter_data;
+	if ((svr_interp_data.daemon_name = strdup(PBS_PYTHON_PROGRAM)) == NULL)
+		return 1;
+	if (pbs_python_ext_start_interpreter(&svr_interp_data) != 0) {
+		log_err(-1, __func__, "Failed to start Python interpreter");
+		return 1;
+	}
+
+	if (pipe(hook_worker_sigpipe) == -1)
+		return 1;
+	(void)fcntl(hook_worker_sigpipe[0], F_SETFL, O_NONBLOCK);
+	(void)fcntl(hook_worker_sigpipe[1], F_SETFL, O_NONBLOCK);
+	memset(&act, 0, sizeof(act));
+	sigemptyset(&act.sa_mask);
+	act.sa_handler = hook_worker_sigchld;
+	act.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+	sigaction(SIGCHLD, &act, NULL);
+	act.sa_handler = hook_worker_sigterm;
+	act.sa_flags = 0;
+	sigaction(SIGTERM, &act, NULL);
+	act.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &act, NULL);
+
+	for (i = 0; i < HOOK_WORKER_MAXCHILDREN; i++) {
+		hook_worker_children[i].pid = 0;
+		hook_worker_children[i].conn = -1;
+	}
+	ppid = getppid();
+	log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK, LOG_INFO, __func__,
+		   "hook worker started, pid=%d", getpid());
+
+	for (;;) {
+		/* collect finished hook processes */
+		while ((pid = waitpid(-1, &st, WNOHANG)) > 0) {
+			for (i = 0; i < HOOK_WORKER_MAXCHILDREN; i++) {
+				if (hook_worker_children[i].pid == pid) {
+					hook_worker_reply(hook_worker_children[i].conn, st);
+					hook_worker_children[i].pid = 0;
+					hook_worker_children[i].conn = -1;
+					running--;
+					break;
+				}
+			}
+		}
+
+		/* MoM went away, or we were told to stop */
+		if (getppid() != ppid)
+			hook_worker_stopping = 1;
+		if (hook_worker_stopping && (lsock != -1)) {
+			close(lsock);
+			lsock = -1;
+		}
+		if ((lsock == -1) && (running == 0))
+			break;
+
+		npfds = 0;
+		pfds[npfds].fd = hook_worker_sigpipe[0];
+		pfds[npfds++].events = POLLIN;
+		if ((lsock != -1) && (running < HOOK_WORKER_MAXCHILDREN)) {
+			pfds[npfds].fd = lsock;
+			pfds[npfds++].events = POLLIN;
+		}
+		for (i = 0; i < HOOK_WORKER_MAXCHILDREN; i++) {
+			if (hook_worker_children[i].conn != -1) {
+				pfds[npfds].fd = hook_worker_children[i].conn;
+				pfds[npfds++].events = POLLIN;
+			}
+		}
+		if (poll(pfds, npfds, 1000) <= 0)
+			continue;
+
+		for (j = 0; j < npfds; j++) {
+			if (pfds[j].revents == 0)
+				continue;
+			if (pfds[j].fd == hook_worker_sigpipe[0]) {
+				char drain[64];
+
+				while (read(hook_worker_sigpipe[0], drain, sizeof(drain)) > 0)
+					;
+				continue;
+			}
+			if (pfds[j].fd != lsock) {
+				/*
+				 * A requestor never sends anything after its
+				 * request, so this is the requestor going away
+				 * (e.g. MoM killed it on a hook alarm): take the
+				 * hook process down with it.
+				 */
+				for (i = 0; i < HOOK_WORKER_MAXCHILDREN; i++) {
+					if (hook_worker_children[i].conn == pfds[j].fd) {
+						kill(-hook_worker_children[i].pid, SIGKILL);
+						close(hook_worker_children[i].conn);
+						hook_worker_children[i].conn = -1;
+						break;
+					}
+				}
+				continue;
+			}
+
+			if ((conn = accept(lsock, NULL, NULL)) == -1)
+				continue;
+			tv.tv_sec = 5;
+			tv.tv_usec = 0;
+			(void)setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+			if ((req = hook_worker_read_request(conn)) == NULL) {
+				log_err(-1, __func__, "malformed hook request");
+				close(conn);
+				continue;
+			}
+			for (nreq = 0; req[nreq] != NULL; nreq++)
+				;
+
+			/* req: <cwd> <hook_config> --hook ... [-r <resourcedef>] ... <script> */
+			req_rescdef = NULL;
+			for (i = 3; i < nreq - 1; i++) {
+				if (strcmp(req[i], "-r") == 0)
+					req_rescdef = req[i + 1];
+			}
+			if (!hook_worker_rescdef_current(req_rescdef, rescdef, &rescdef_sbuf)) {
+				/* resource definitions changed, MoM starts a new worker */
+				log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK, LOG_INFO, __func__,
+					  "resourcedef changed, hook worker exiting");
+				hook_worker_reply(conn, HOOK_WORKER_DECLINED);
+				free_string_array(req);
+				hook_worker_stopping = 1;
+				continue;
+			}
+
+			hook_worker_script = NULL;
+			if (req[nreq - 1][0] != '-')
+				hook_worker_script = hook_worker_get_script(req[nreq - 1]);
+
+			pid = fork();
+			if (pid == -1) {
+				log_err(errno, __func__, "fork failed");
+				hook_worker_reply(conn, HOOK_WORKER_DECLINED);
+				free_string_array(req);
+				continue;
+			}
+			if (pid == 0) {
+				/* hook process */
+				for (i = 0; i < HOOK_WORKER_MAXCHILDREN; i++) {
+					if (hook_worker_children[i].conn != -1)
+						close(hook_worker_children[i].conn);
+				}
+				if (lsock != -1)
+					close(lsock);
+				close(conn);
+				close(hook_worker_sigpipe[0]);
+				close(hook_worker_sigpipe[1]);
+				act.sa_handler = SIG_DFL;
+				act.sa_flags = 0;
+				sigaction(SIGCHLD, &act, NULL);
+				sigaction(SIGTERM, &act, NULL);
+				sigaction(SIGPIPE, &act, NULL);
+				setsid();
+#if PY_VERSION_HEX >= 0x03070000
+				PyOS_AfterFork_Child();
+#else
+				PyOS_AfterFork();
+#endif
+				log_close(0);
+
+				if (chdir(req[0]) != 0)
+					exit(255);
+				if (req[1][0] != '\0')
+					setenv(PBS_HOOK_CONFIG_FILE, req[1], 1);
+				else
+					unsetenv(PBS_HOOK_CONFIG_FILE);
+
+				*pargc = nreq - 2;
+				*pargv = &req[2];
+				return 0;
+			}
+
+			for (i = 0; i < HOOK_WORKER_MAXCHILDREN; i++) {
+				if (hook_worker_children[i].pid == 0)
+					break;
+			}
+			hook_worker_children[i].pid = pid;
+			hook_worker_children[i].conn = conn;
+			running++;
+			free_string_array(req);
+		}
+	}
+
+	log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK, LOG_INFO, __func__, "hook worker exiting");
+	exit(0);
+}
+#endif /* !WIN32 */
+
 /**
  *
  * @brief
@@ -1480,6 +1958,14 @@ main(int argc, char *argv[], char *envp[])
 		svr_resc_def[i].rs_next = &svr_resc_def[i+1];
 	/* last entry is left with null pointer */
 
+#ifndef WIN32
+	if ((argv[1] != NULL) && (strcmp(argv[1], HOOK_WORKER_MODE) == 0)) {
+		/* only returns in a forked hook process, with its "--hook" arguments */
+		if (hook_worker_main(argc, argv, &argc, &argv) != 0)
+			return 1;
+	}
+#endif
+
 	if ((argv[1] == NULL) || (strcmp(argv[1], HOOK_MODE) != 0)) {
 		char *python_path = NULL;
 		if (get_py_progname(&python_path)) {
@@ -1971,20 +2457,28 @@ main(int argc, char *argv[], char *envp[])
 			snprintf(logname, sizeof(logname), "%s", full_logname);
 		}
 
-		/* set python interp data */
-		svr_interp_data.data_initialized = 0;
-		svr_interp_data.init_interpreter_data = pbs_python_svr_initialize_interpreter_data;
-		svr_interp_data.destroy_interpreter_data = pbs_python_svr_destroy_interpreter_data;
+		/* set python interp data, unless already started by the hook worker */
+		if (!svr_interp_data.interp_started) {
+			svr_interp_data.data_initialized = 0;
+			svr_interp_data.init_interpreter_data = pbs_python_svr_initialize_interpreter_data;
+			svr_interp_data.destroy_interpreter_data = pbs_python_svr_destroy_interpreter_data;
 
-		svr_interp_data.daemon_name = strdup(PBS_PYTHON_PROGRAM);
+			svr_interp_data.daemon_name = strdup(PBS_PYTHON_PROGRAM);
 
-		if (svr_interp_data.daemon_name == NULL) { /* should not happen */
-			fprintf(stderr, "strdup failed");
-			exit(1);
+			if (svr_interp_data.daemon_name == NULL) { /* should not happen */
+				fprintf(stderr, "strdup failed");
+				exit(1);
+			}
 		}
 
-		(void)pbs_python_ext_alloc_python_script(hook_script,
-			(struct python_script **) &py_script);
+#ifndef WIN32
+		if ((hook_worker_script != NULL) &&
+			(strcmp(hook_worker_script->path, hook_script) == 0))
+			py_script = hook_worker_script; /* compiled by the hook worker */
+		else
+#endif
+			(void)pbs_python_ext_alloc_python_script(hook_script,
+				(struct python_script **) &py_script);
 
 		hook_perf_stat_start(perf_label, HOOK_PERF_START_PYTHON, 0);
 		if (pbs_python_ext_start_interpreter(&svr_interp_data) != 0) {
@@ -39,6 +39,8 @@
 
 from tests.functional import *
 import ast
+import itertools
+import json
 
 
 @requirements(num_moms=3)
@@ -1357,3 +1359,101 @@ else:
 
         # Bring the mom back up
         self.momB.start()
+
+    def json_used(self, jid, resc):
+        """
+        Return the JSON text MoM reported for string resource 'resc' of
+        finished job 'jid', without its enclosing single quotes
+        """
+        qstat = self.server.status(JOB, 'resources_used.' + resc, id=jid,
+                                   extend='x')
+        val = qstat[0]['resources_used.' + resc]
+        self.assertTrue(val.startswith("'") and val.endswith("'"), val)
+        return val[1:-1]
+
+    def run_json_epilogue(self, values, select):
+        """
+        Run a job whose epilogue hook sets string resources_used values
+        taken from 'values', a dictionary of host name ('MS' for the
+        mother superior) to a dictionary of resource name to JSON text
+        """
+        hook_body = """
+import pbs
+e = pbs.event()
+vals = %r
+host = 'MS' if e.job.in_ms_mom() else pbs.get_local_nodename()
+for r, v in vals.get(host, {}).items():
+    e.job.resources_used[r] = v
+""" % (values,)
+        a = {'event': "execjob_epilogue", 'enabled': 'True'}
+        self.server.create_import_hook("epi_json", a, hook_body,
+                                       overwrite=True)
+        a = {'Resource_List.select': select,
+             'Resource_List.place': "scatter"}
+        j = Job(TEST_USER, attrs=a)
+        j.set_sleep_time("5")
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, extend='x', offset=5,
+                           id=jid)
+        return jid
+
+    def test_json_output_matches_python(self):
+        """
+        A JSON string value reported by a single node job is written
+        exactly as Python's json.dumps() writes it: escaped control and
+        non-ASCII characters, number formatting, nested objects and
+        repeated keys
+        """
+        texts = {
+            'foo_str': '{"ctl": "a\\u0001b\\u001fc\\n\\t\\r\\b\\f'
+                       '\\"\\\\/\\u007f", "utf8": "\u00e9\u20ac\U0001F600", '
+                       '"esc": "\\u00e9\\ud83d\\ude00\\u2028", '
+                       '"k\\u00e9y": 1}',
+            'foo_str2': '{"i": 123456789012345678901234567890, "neg": -42, '
+                        '"z": -0, "f": 0.1, "e": 1e-7, "E": 1E+21, '
+                        '"t": 2.50, "nz": -0.0, "one": 1.0, '
+                        '"big": 1.7976931348623157e308, "tiny": 5e-324, '
+                        '"sci": 1e16, "below": 1e15, "small": 0.0001, '
+                        '"smaller": 0.00001, "third": 0.3333333333333333, '
+                        '"lit": [true, false, null]}',
+            'foo_str3': '{"outer": {"inner": {"k": [1, {"x": "y"}, []]}, '
+                        '"empty": {}, "dup": 1, "dup": 2}, "dup": 1, '
+                        '"dup": 2, "arr": [[], [{}], [1, [2, [3]]]]}',
+            'foo_str4': ' { "a" :\n[ 1 ,2 ] , "b":{ } } ',
+        }
+        jid = self.run_json_epilogue({'MS': texts},
+                                     '1:ncpus=1:host=%s' % self.hostA)
+        for resc, text in texts.items():
+            self.assertEqual(self.json_used(jid, resc),
+                             json.dumps(json.loads(text)), resc)
+
+    def test_json_merge_matches_python(self):
+        """
+        The JSON values of a multinode job are merged as a Python dict
+        update of the sister values followed by the mother superior value,
+        and written exactly as json.dumps() writes the result.  Nested
+        objects are replaced as a whole, not merged.
+        """
+        sis = {
+            self.hostB: '{"common": {"from": "B", "n": [1, 2.50]}, '
+                        '"b_only": {"nested": {"deep": "\\u00e9\u00e8"}}, '
+                        '"last": "B"}',
+            self.hostC: '{"common": {"from": "C"}, '
+                        '"c_only": {"x": 1e-7, "big": 10000000000000000}, '
+                        '"last": "C"}',
+        }
+        ms = '{"last": "ms", "ms_only": {"ctl": "\\u0001\\n"}, ' \
+             '"common": {"from": "ms", "e": {}}}'
+        values = {'MS': {'foo_str': ms}}
+        for host, text in sis.items():
+            values[host] = {'foo_str': text}
+        jid = self.run_json_epilogue(values, '3:ncpus=1')
+
+        # the sisters' values are merged in the order their updates came
+        expected = []
+        for order in itertools.permutations(sis.values()):
+            merged = {}
+            for text in list(order) + [ms]:
+                merged.update(json.loads(text))
+            expected.append(json.dumps(merged))
+        self.assertIn(self.json_used(jid, 'foo_str'), expected)
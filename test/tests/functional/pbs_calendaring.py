@@ -229,3 +229,133 @@ class TestCalendaring(TestFunctional):
         est_time = job3[0]['estimated.start_time']
         est_time = time.mktime(time.strptime(est_time, '%c'))
         self.assertAlmostEqual(end_time, est_time, delta=1)
+
+    def epoch_of(self, jid, attr):
+        """
+        Return the time in job attribute attr as seconds since the epoch
+        """
+        job = self.server.status(JOB, attr, id=jid)
+        self.assertIn(attr, job[0])
+        return time.mktime(time.strptime(job[0][attr], '%c'))
+
+    @skipOnCpuSet
+    def test_topjob_skip_unfit_events(self):
+        """
+        Test that a top job which can't fit on the node after the first
+        end events in the calendar is still calendared to start at the
+        first end event after which it fits.
+        """
+
+        self.scheduler.set_sched_config({'strict_ordering': 'true all'})
+        a = {'resources_available.ncpus': 3}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        a = {'opt_backfill_fuzzy': 'off'}
+        self.server.manager(MGR_CMD_SET, SCHED, a)
+
+        jids = []
+        for wt in [100, 200, 300]:
+            res_req = {'Resource_List.select': '1:ncpus=1',
+                       'Resource_List.walltime': wt}
+            j = Job(TEST_USER, attrs=res_req)
+            j.set_sleep_time(1000)
+            jid = self.server.submit(j)
+            self.server.expect(JOB, {'job_state': 'R'}, jid)
+            jids.append(jid)
+
+        # The top job only fits once all three jobs have ended.  The end
+        # events of the first two jobs are skipped, so the job must not
+        # be calendared at either of them.
+        res_req = {'Resource_List.select': '1:ncpus=3',
+                   'Resource_List.walltime': 30}
+        j = Job(TEST_USER, attrs=res_req)
+        jid4 = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'Q'}, jid4)
+        self.server.expect(JOB, 'estimated.start_time', op=SET, id=jid4)
+
+        end_time = self.epoch_of(jids[2], 'stime') + 300
+        est_time = self.epoch_of(jid4, 'estimated.start_time')
+        self.assertAlmostEqual(end_time, est_time, delta=1)
+
+    def test_topjob_skip_unfit_events_placement(self):
+        """
+        Test that when enough resources are free in total after an end
+        event but the job can't be placed on the vnodes, it is calendared
+        at the later end event where it can be placed.
+        """
+
+        attrs = {'resources_available.ncpus': 2}
+        self.mom.create_vnodes(attrib=attrs, num=2,
+                               sharednode=False)
+        vn = self.mom.shortname
+        self.scheduler.set_sched_config({'strict_ordering': 'true all'})
+        a = {'opt_backfill_fuzzy': 'off'}
+        self.server.manager(MGR_CMD_SET, SCHED, a)
+
+        jids = []
+        for (v, wt) in [(0, 100), (1, 200), (0, 300)]:
+            res_req = {'Resource_List.select':
+                       '1:ncpus=1:vnode=%s[%d]' % (vn, v),
+                       'Resource_List.walltime': wt}
+            j = Job(TEST_USER, attrs=res_req)
+            j.set_sleep_time(1000)
+            jid = self.server.submit(j)
+            self.server.expect(JOB, {'job_state': 'R'}, jid)
+            jids.append(jid)
+
+        # After the first job ends there are two cpus free, but one on
+        # each vnode.  The job needs both cpus on the same vnode, which
+        # only happens when the second job ends.
+        res_req = {'Resource_List.select': '1:ncpus=2',
+                   'Resource_List.walltime': 30}
+        j = Job(TEST_USER, attrs=res_req)
+        jid4 = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'Q'}, jid4)
+        self.server.expect(JOB, 'estimated.start_time', op=SET, id=jid4)
+
+        end_time = self.epoch_of(jids[1], 'stime') + 200
+        est_time = self.epoch_of(jid4, 'estimated.start_time')
+        self.assertAlmostEqual(end_time, est_time, delta=1)
+
+    @skipOnCpuSet
+    def test_topjob_end_run_same_time(self):
+        """
+        Test that when a top job is calendared to start at the same time
+        a running job ends, its run event comes after the end event.  A
+        job which backfills around the top job sees the cpus freed by the
+        end event before the top job takes them, so it can run.
+        """
+
+        self.scheduler.set_sched_config({'strict_ordering': 'true all'})
+        a = {'resources_available.ncpus': 3}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        a = {'opt_backfill_fuzzy': 'off'}
+        self.server.manager(MGR_CMD_SET, SCHED, a)
+
+        res_req = {'Resource_List.select': '1:ncpus=2',
+                   'Resource_List.walltime': 100}
+        j1 = Job(TEST_USER, attrs=res_req)
+        j1.set_sleep_time(1000)
+        jid1 = self.server.submit(j1)
+        self.server.expect(JOB, {'job_state': 'R'}, jid1)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        res_req['Resource_List.walltime'] = 30
+        j2 = Job(TEST_USER, attrs=res_req)
+        jid2 = self.server.submit(j2)
+        res_req = {'Resource_List.select': '1:ncpus=1',
+                   'Resource_List.walltime': 200}
+        j3 = Job(TEST_USER, attrs=res_req)
+        j3.set_sleep_time(1000)
+        jid3 = self.server.submit(j3)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+
+        # The top job starts when the first job ends.  If its run event
+        # came first at that time, the node would look like it needs 5 of
+        # its 3 cpus and the backfill job would not run.
+        self.server.expect(JOB, {'job_state': 'R'}, jid3)
+        self.server.expect(JOB, {'job_state': 'Q'}, jid2)
+        self.server.expect(JOB, 'estimated.start_time', op=SET, id=jid2)
+
+        end_time = self.epoch_of(jid1, 'stime') + 100
+        est_time = self.epoch_of(jid2, 'estimated.start_time')
+        self.assertAlmostEqual(end_time, est_time, delta=1)
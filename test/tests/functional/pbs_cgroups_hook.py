@@ -1864,6 +1864,67 @@ if %s e.job.in_ms_mom():
         if self.swapctl == 'true':
             self.assertGreater(vmem_usage, 400000)
 
+    def test_cgroup_mom_usage_sampling(self):
+        """
+        Test that with $cgroup_usage set MoM reports cput and mem for
+        the job from its cgroup without help from the periodic hook.
+        The job's work is done by processes which left the job's session
+        but stay in its cgroup, so only the cgroup accounts for it.
+        """
+        if not self.paths['memory'] or not self.paths['cpuacct']:
+            self.skipTest('Test requires memory and cpuacct subsystems')
+        name = 'CGROUP_USAGE'
+        # Keep the periodic hook from setting the usage values
+        conf = {'freq': 3600}
+        self.server.manager(MGR_CMD_SET, HOOK, conf, self.hook_name)
+        self.load_config(self.cfg3 % ('', 'false', '', self.mem, '',
+                                      self.swapctl, ''))
+        self.mom.add_config({'$cgroup_usage': 'True'})
+        # Restart mom for changes made by cgroups hook to take effect
+        self.mom.restart()
+        a = {'Resource_List.select': '1:ncpus=1:mem=500mb:host=%s' %
+             self.hosts_list[0], ATTR_N: name}
+        # Only the sleep is left in the job's session, so summing the
+        # session's processes from /proc would give next to no usage
+        script = \
+            '#PBS -joe\n' \
+            '#PBS -S /bin/bash\n' \
+            'python_path=`which python3 2>/dev/null`\n' \
+            'if [ -z "$python_path" ]; then\n' \
+            '    python_path=`which python 2>/dev/null`\n' \
+            'fi\n' \
+            'setsid timeout 120 md5sum </dev/urandom >/dev/null &\n' \
+            'setsid $python_path -c "import time\n' \
+            'x = b\'a\' * (450 << 20)\n' \
+            'time.sleep(300)" &\n' \
+            'sleep 300\n'
+        j = Job(TEST_USER, attrs=a)
+        j.create_script(script)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, jid)
+        self.server.status(JOB, ATTR_o, jid)
+        self.tempfile.append(j.attributes[ATTR_o])
+        fn = self.get_cgroup_job_dir('memory', jid, self.hosts_list[0])
+        self.assertFalse(fn is None, 'No job directory for memory subsystem')
+        cput = 0
+        mem = 0
+        for _ in range(10):
+            time.sleep(8)
+            qstat = self.server.status(JOB, ['resources_used.cput',
+                                             'resources_used.mem'], id=jid)
+            if 'resources_used.cput' in qstat[0]:
+                cput = BatchUtils().convert_duration(
+                    qstat[0]['resources_used.cput'])
+            if 'resources_used.mem' in qstat[0]:
+                m = re.match(r'(\d+)kb', convert_size(
+                    qstat[0]['resources_used.mem'], 'kb'))
+                if m:
+                    mem = int(m.groups()[0])
+            if cput > 5 and mem > 400000:
+                break
+        self.assertGreater(cput, 5)
+        self.assertGreater(mem, 400000)
+
     def test_cgroup_cpuset_and_memory(self):
         """
         Test to verify that the job cgroup is created correctly
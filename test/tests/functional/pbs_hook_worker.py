@@ -0,0 +1,152 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+import time
+from tests.functional import *
+
+
+class TestHookWorker(TestFunctional):
+
+    """
+    Test suite for MoM running hooks in a persistent pbs_python worker
+    ($hook_worker in the MoM config file)
+    """
+
+    hook_body = """import pbs
+import os
+pbs.logmsg(pbs.LOG_DEBUG, "%s ppid=%d" % (pbs.event().hook_name,
+                                          os.getppid()))
+"""
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.mom.add_config({'$hook_worker': 'True', '$logevent': '0xffffffff'})
+
+    def tearDown(self):
+        self.mom.unset_mom_config('$hook_worker', hup=False)
+        self.mom.unset_mom_config('$hook_worker_exclude')
+        TestFunctional.tearDown(self)
+
+    def hook_ppid(self, hook_name):
+        """
+        Return the parent pid the hook 'hook_name' logged
+        """
+        msg = self.mom.log_match("%s ppid=" % hook_name, max_attempts=30)
+        return int(msg[1].split("ppid=")[1].split()[0])
+
+    def run_job(self):
+        """
+        Run a short job and wait for it to finish
+        """
+        j = Job(TEST_USER)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid, offset=1)
+        return jid
+
+    def test_hook_runs_in_worker(self):
+        """
+        A root hook runs in a process forked from the hook worker, and the
+        same worker serves the following events
+        """
+        a = {'event': 'execjob_begin', 'enabled': 'true'}
+        self.server.create_import_hook('wbegin', a, self.hook_body)
+        self.run_job()
+        self.mom.log_match("started hook worker pid=")
+        ppid = self.hook_ppid('wbegin')
+        self.assertNotEqual(ppid, int(self.mom.get_pid()))
+
+        start = time.time()
+        self.run_job()
+        self.mom.log_match("started hook worker pid=", starttime=start,
+                           existence=False, max_attempts=5)
+        self.assertEqual(self.hook_ppid('wbegin'), ppid)
+
+    def test_excluded_hook_forks(self):
+        """
+        A hook listed in $hook_worker_exclude executes its own pbs_python,
+        whose parent is MoM
+        """
+        self.mom.add_config({'$hook_worker_exclude': 'wunsafe'})
+        a = {'event': 'execjob_begin', 'enabled': 'true'}
+        self.server.create_import_hook('wunsafe', a, self.hook_body)
+        self.run_job()
+        self.assertEqual(self.hook_ppid('wunsafe'),
+                         int(self.mom.get_pid()))
+
+    def test_hook_alarm_in_worker(self):
+        """
+        A hook running in the worker is still stopped by its alarm
+        """
+        body = """import pbs
+import time
+time.sleep(30)
+"""
+        a = {'event': 'execjob_begin', 'enabled': 'true', 'alarm': 3}
+        self.server.create_import_hook('walarm', a, body)
+        j = Job(TEST_USER)
+        self.server.submit(j)
+        self.mom.log_match("alarm call while running execjob_begin hook "
+                           "'walarm'", max_attempts=30)
+
+    def test_worker_stopped_on_disable(self):
+        """
+        Turning $hook_worker off stops the running worker, and hooks then
+        execute their own pbs_python
+        """
+        a = {'event': 'execjob_begin', 'enabled': 'true'}
+        self.server.create_import_hook('wbegin', a, self.hook_body)
+        self.run_job()
+        msg = self.mom.log_match("started hook worker pid=")
+        wpid = msg[1].split("pid=")[1].split()[0]
+        self.assertEqual(self.hook_ppid('wbegin'), int(wpid))
+
+        self.mom.unset_mom_config('$hook_worker')
+        self.assertTrue(self.mom.isUp())
+        for _ in range(10):
+            ret = self.du.run_cmd(self.mom.hostname, ['ps', '-p', wpid])
+            if ret['rc'] != 0:
+                break
+            time.sleep(1)
+        self.assertNotEqual(ret['rc'], 0, "hook worker still running")
+
+        start = time.time()
+        self.run_job()
+        self.mom.log_match("wbegin ppid=%s" % self.mom.get_pid(),
+                           starttime=start, max_attempts=30)
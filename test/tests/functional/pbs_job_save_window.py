@@ -0,0 +1,161 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestJobSaveWindow(TestFunctional):
+
+    """
+    With job_save_window set the server defers and batches job saves.
+    A change must still be in the database before its ack reaches the
+    client, so it has to survive the server being killed right after.
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        # the batch size of each flush is logged at debug level
+        self.server.manager(MGR_CMD_SET, SERVER, {'job_save_window': 600,
+                                                  'log_events': 4095})
+
+    def kill_and_restart_svr(self):
+        try:
+            self.server.stop('-KILL')
+        except PbsServiceError as e:
+            raise self.failureException("Server failed to stop:" + e.msg)
+        try:
+            self.server.start()
+        except PbsServiceError as e:
+            raise self.failureException("Server failed to start:" + e.msg)
+        self.assertTrue(self.server.isUp(), "Failed to restart server")
+
+    def test_acked_hold_survives_crash(self):
+        """
+        Hold and alter a job, kill the server with SIGKILL and check that
+        both changes were saved
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid = self.server.submit(Job())
+        self.server.holdjob(jid, USER_HOLD)
+        self.server.alterjob(jid, {ATTR_N: 'saved_name'})
+        self.server.expect(JOB, {'job_state': 'H', ATTR_h: 'u',
+                                 ATTR_N: 'saved_name'}, id=jid)
+        self.kill_and_restart_svr()
+        self.server.expect(JOB, {'job_state': 'H', ATTR_h: 'u',
+                                 ATTR_N: 'saved_name'}, id=jid)
+
+    def test_running_job_survives_crash(self):
+        """
+        Run a job, kill the server with SIGKILL and check the job is still
+        known to be running after the restart
+        """
+        j = Job(attrs={ATTR_l + '.select': '1:ncpus=1'})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.kill_and_restart_svr()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+    def run_job(self):
+        """
+        Run a job, then turn scheduling off so that no further requests
+        change it
+        """
+        j = Job(attrs={ATTR_l + '.select': '1:ncpus=1'})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R', 'substate': 42}, id=jid)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        return jid
+
+    def test_window_flushes_without_ack(self):
+        """
+        Updates that no client waits for, such as the mom's substate and
+        resource usage reports, are written once the window expires
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'job_save_window': 5})
+        jid = self.run_job()
+        # no request which changes a job is sent from here on, so only
+        # the window can flush the deferred saves
+        t = time.time()
+        self.server.log_match("Saved [0-9]+ deferred jobs", regexp=True,
+                              starttime=t, max_attempts=60, interval=2)
+        self.kill_and_restart_svr()
+        self.server.expect(JOB, {'job_state': 'R', 'substate': 42}, id=jid)
+
+    def test_status_does_not_flush(self):
+        """
+        A status request changes no job, so replying to it must not
+        flush saves deferred by the mom's updates.  A request which
+        changes the job must.
+        """
+        jid = self.run_job()
+        time.sleep(1)
+        t = time.time()
+        # wait for a usage update from the mom, which is deferred
+        self.server.expect(JOB, 'resources_used.walltime', op=SET, id=jid,
+                           max_attempts=120)
+        for _ in range(5):
+            self.server.status(JOB, id=jid)
+        self.server.log_match("Saved [0-9]+ deferred jobs", regexp=True,
+                              starttime=t, existence=False, max_attempts=5)
+        self.server.alterjob(jid, {ATTR_N: 'altered'})
+        self.server.log_match("Saved [0-9]+ deferred jobs", regexp=True,
+                              starttime=t)
+
+    def test_mtime_set_on_deferred_save(self):
+        """
+        A job's mtime is the time of the change, even if the change is
+        not written until the window expires
+        """
+        j = Job(attrs={ATTR_l + '.select': '1:ncpus=1'})
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R', 'substate': 42}, id=jid)
+        s = self.server.status(JOB, ['mtime', 'resources_used.walltime'],
+                               id=jid)[0]
+        walltime = s.get('resources_used.walltime', '')
+        mtime = time.mktime(time.strptime(s['mtime'], '%c'))
+
+        # wait for the mom's next resource usage update
+        self.server.expect(JOB, {'resources_used.walltime': walltime},
+                           op=NE, id=jid, max_attempts=120)
+        s = self.server.status(JOB, 'mtime', id=jid)[0]
+        self.assertGreater(time.mktime(time.strptime(s['mtime'], '%c')),
+                           mtime)
@@ -46,6 +46,44 @@ class TestJobSortFormula(TestFunctional):
     Tests for the job_sort_formula
     """
 
+    def formula_values(self, formula, jobs):
+        """
+        Set the job_sort_formula unless formula is None, submit one job
+        per dictionary of resources in jobs and return the job ids and the
+        formula values the scheduler logged for them
+        """
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 2047})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        if formula is not None:
+            self.server.manager(MGR_CMD_SET, SERVER,
+                                {'job_sort_formula': formula},
+                                runas=ROOT_USER)
+
+        jids = []
+        for res in jobs:
+            a = {'Resource_List.' + r: v for r, v in res.items()}
+            jids.append(self.server.submit(Job(TEST_USER, attrs=a)))
+
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        values = []
+        for jid in jids:
+            m = self.scheduler.log_match(jid + ';Formula Evaluation = ',
+                                         starttime=t)
+            values.append(float(m[1].split('Formula Evaluation = ')[1]))
+        return jids, values
+
+    def check_formula(self, formula, jobs):
+        """
+        Check that the scheduler evaluates formula for jobs the same way
+        python's eval() does
+        """
+        jids, values = self.formula_values(formula, jobs)
+        for res, val in zip(jobs, values):
+            exp = eval(formula, {}, {r: float(v) for r, v in res.items()})
+            self.assertAlmostEqual(val, exp, places=3,
+                                   msg='%s with %s' % (formula, res))
+
     def test_job_sort_formula_negative_value(self):
         """
         Test to see that negative values in the
@@ -72,3 +110,60 @@ class TestJobSortFormula(TestFunctional):
             self.assertEqual(job.split('.')[0], c.political_order[i])
 
         self.server.expect(JOB, {'job_state=R': 2})
+
+    def test_job_sort_formula_precedence(self):
+        """
+        Test that operator precedence and associativity in the
+        job_sort_formula match python's
+        """
+        self.server.manager(MGR_CMD_CREATE, RSC, {'type': 'float'}, id='foo')
+        jobs = [{'ncpus': 1, 'foo': 1.5}, {'ncpus': 3, 'foo': -2}]
+
+        self.check_formula('2 + foo * 3 ** 2 - ncpus // 2 % 3', jobs)
+        self.check_formula('2 ** 3 ** 2 / (foo + 10) - ncpus * 2', jobs)
+        self.check_formula('(ncpus - 7) % 3 + (ncpus - 7) // 2', jobs)
+        self.check_formula('foo * (ncpus + 1) / 4 - 10 / 4 * foo', jobs)
+
+    def test_job_sort_formula_unary_minus(self):
+        """
+        Test that unary minus in the job_sort_formula binds like python's,
+        looser than ** and tighter than the binary operators
+        """
+        self.server.manager(MGR_CMD_CREATE, RSC, {'type': 'float'}, id='foo')
+        jobs = [{'ncpus': 2, 'foo': 3}, {'ncpus': 1, 'foo': -0.5}]
+
+        self.check_formula('-ncpus ** 2', jobs)
+        self.check_formula('2 ** -ncpus', jobs)
+        self.check_formula('- -foo * -ncpus', jobs)
+        self.check_formula('abs(-foo) + max(-ncpus, -foo, 1) - min(foo, 0)',
+                           jobs)
+
+    def test_job_sort_formula_division_by_zero(self):
+        """
+        Test that dividing by zero in the job_sort_formula gives the job
+        a zero value like the python evaluation did
+        """
+        self.server.manager(MGR_CMD_CREATE, RSC, {'type': 'float'}, id='foo')
+        jobs = [{'ncpus': 2, 'foo': 0}, {'ncpus': 2, 'foo': 4}]
+
+        for formula in ['ncpus / foo', 'ncpus // foo', 'ncpus % foo']:
+            jids, values = self.formula_values(formula, jobs)
+            self.assertEqual(values, [0, eval(formula, {},
+                                              {'ncpus': 2, 'foo': 4})])
+            self.scheduler.log_match(jids[0] + ';Formula evaluation for job '
+                                     'had an error.  Zero value will be used')
+
+    def test_job_sort_formula_unknown_resource(self):
+        """
+        Test that a job_sort_formula naming a resource which no longer
+        exists gives every job a zero value like the python evaluation did
+        """
+        self.server.manager(MGR_CMD_CREATE, RSC, {'type': 'float'}, id='foo')
+        a = {'job_sort_formula': 'foo + ncpus'}
+        self.server.manager(MGR_CMD_SET, SERVER, a, runas=ROOT_USER)
+        self.server.manager(MGR_CMD_DELETE, RSC, id='foo')
+
+        jids, values = self.formula_values(None, [{'ncpus': 1}])
+        self.assertEqual(values, [0])
+        self.scheduler.log_match(jids[0] + ';Formula evaluation for job '
+                                 'had an error.  Zero value will be used')
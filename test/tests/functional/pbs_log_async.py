@@ -0,0 +1,85 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestLogAsync(TestFunctional):
+
+    """
+    Test suite for daemons writing their logs from a background thread
+    (PBS_LOG_ASYNC in pbs.conf)
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.du.set_pbs_config(self.server.hostname,
+                               confs={'PBS_LOG_ASYNC': '1'})
+        self.server.restart()
+        self.scheduler.restart()
+
+    def tearDown(self):
+        self.du.unset_pbs_config(self.server.hostname,
+                                 confs=['PBS_LOG_ASYNC',
+                                        'PBS_LOG_ASYNC_DROP',
+                                        'PBS_LOG_ASYNC_FLUSH'])
+        self.server.restart()
+        self.scheduler.restart()
+        TestFunctional.tearDown(self)
+
+    def test_job_logged(self):
+        """
+        A job's life is logged as it is with synchronous logging
+        """
+        j = Job()
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid)
+        self.server.log_match(jid + ";Job Queued")
+        self.server.log_match(jid + ";Job Run")
+        self.scheduler.log_match(jid + ";Job run")
+
+    def test_flush_at_shutdown(self):
+        """
+        Records logged right before the server shuts down are written
+        """
+        jid = self.server.submit(Job())
+        self.server.restart()
+        self.server.log_match(jid + ";Job Queued")
+        self.server.log_match("Log closed")
@@ -864,6 +864,85 @@ class TestNodeBuckets(TestFunctional):
         for node in n1:
             self.assertTrue(node not in n2, 'Jobs share nodes: ' + node)
 
+    def bucket_nodes(self, jids, jobs):
+        """
+        Return the vnodes of each running job as lists of vnode numbers
+        """
+        nodes = []
+        for jid, j in zip(jids, jobs):
+            s = self.server.status(JOB, 'exec_vnode', id=jid)
+            nodes.append([int(n.split('[')[1].rstrip(']'))
+                          for n in j.get_vnodes(s[0]['exec_vnode'])])
+        return nodes
+
+    def test_word_boundaries(self):
+        """
+        Test that jobs taking 63, 64 and 65 nodes from a bucket get exactly
+        as many nodes, all from the right bucket, and that the nodes taken
+        across word boundaries of the bucket's bitmaps do not overlap
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        jobs = []
+        jids = []
+        for n in [63, 64, 65]:
+            a = {'Resource_List.select': '%d:ncpus=2:color=red' % n,
+                 'Resource_List.place': 'scatter:excl'}
+            jobs.append(Job(TEST_USER, attrs=a))
+            jids.append(self.server.submit(jobs[-1]))
+        # two chunks per node: 127 chunks need 64 nodes
+        a = {'Resource_List.select': '127:ncpus=1:color=orange',
+             'Resource_List.place': 'excl'}
+        jobs.append(Job(TEST_USER, attrs=a))
+        jids.append(self.server.submit(jobs[-1]))
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        nodes = self.bucket_nodes(jids, jobs)
+        msg = 'job did not run on correct number of nodes'
+        for n, num in zip(nodes, [63, 64, 65, 64]):
+            self.assertEqual(len(set(n)), num, msg)
+        red = nodes[0] + nodes[1] + nodes[2]
+        self.assertEqual(len(set(red)), 192, 'Jobs share nodes')
+        for n in red:
+            self.assertLess(n, 1430, 'job ran on a node which is not red')
+        for n in nodes[3]:
+            self.assertEqual(n // 1430, 1,
+                             'job ran on a node which is not orange')
+
+    def test_empty_pool(self):
+        """
+        Test that once a job takes every node of a bucket, the bucket's
+        empty free pool runs no more jobs while other buckets still do
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        a = {'Resource_List.select': '1430:ncpus=2:color=red',
+             'Resource_List.place': 'scatter:excl'}
+        j1 = Job(TEST_USER, attrs=a)
+        jid1 = self.server.submit(j1)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+
+        nodes = self.bucket_nodes([jid1], [j1])
+        self.assertEqual(sorted(nodes[0]), list(range(1430)))
+
+        a = {'Resource_List.select': '1:ncpus=1:color=red',
+             'Resource_List.place': 'scatter:excl'}
+        j2 = Job(TEST_USER, attrs=a)
+        jid2 = self.server.submit(j2)
+        a = {'Resource_List.select': '65:ncpus=2:color=orange',
+             'Resource_List.place': 'scatter:excl'}
+        j3 = Job(TEST_USER, attrs=a)
+        jid3 = self.server.submit(j3)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid3)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid2)
+
+        nodes = self.bucket_nodes([jid3], [j3])
+        self.assertEqual(len(set(nodes[0])), 65)
+
     def test_queue_nodes(self):
         """
         Test that buckets work with nodes associated to a queue
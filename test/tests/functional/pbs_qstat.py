@@ -40,6 +40,63 @@
 
 from tests.functional import *
 
+# Statuses the jobs of the server two at a time with the paging options of
+# a StatusJob request, and prints the id of each job listed.  Before each
+# page after the first one step is taken on the last job of the previous
+# page, one argument per page:
+#   -          nothing
+#   d          delete it
+#   o<job id>  swap its place in the queue with <job id>
+stat_page_code = '''
+#include <stdio.h>
+#include <string.h>
+#include <pbs_ifl.h>
+
+int main(int argc, char **argv)
+{
+    char extend[512] = ",page=2";
+    char after[PBS_MAXSVRJOBID + 1] = "";
+    char rank[32];
+    struct batch_status *bs;
+    struct batch_status *p;
+    struct attrl *a;
+    int c;
+    int n = 1;
+
+    if ((c = pbs_connect(NULL)) < 0)
+        return 1;
+    for (;;) {
+        if ((bs = pbs_statjob(c, "", NULL, extend)) == NULL)
+            return pbs_errno != 0;
+        rank[0] = '\\0';
+        for (p = bs; p != NULL; p = p->next) {
+            printf("%s\\n", p->name);
+            if (p->next != NULL)
+                continue;
+            snprintf(after, sizeof(after), "%s", p->name);
+            for (a = p->attribs; a != NULL; a = a->next)
+                if (strcmp(a->name, "page_cursor") == 0)
+                    snprintf(rank, sizeof(rank), "%s", a->value);
+        }
+        pbs_statfree(bs);
+        if (rank[0] == '\\0')
+            break;
+        if (n < argc) {
+            if (argv[n][0] == 'd' && pbs_deljob(c, after, NULL) != 0)
+                return 1;
+            if (argv[n][0] == 'o' &&
+                pbs_orderjob(c, after, argv[n] + 1, NULL) != 0)
+                return 1;
+            n++;
+        }
+        snprintf(extend, sizeof(extend), ",page=2,after=%s,rank=%s",
+                 after, rank);
+    }
+    pbs_disconnect(c);
+    return 0;
+}
+'''
+
 
 class TestQstat(TestFunctional):
     """
@@ -155,3 +212,86 @@ class TestQstat(TestFunctional):
                                       % re.escape(self.mom.shortname),
                                       qstat_out), None, "The exec host does"
                             " not contain the task slot number")
+
+    def test_qstat_paged_listing(self):
+        """
+        Test that qstat shows every job of the server and of a queue, with
+        a single header, when the listing spans more than one page.
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        njobs = 2100
+        jids = []
+        for _ in range(njobs):
+            j = Job(TEST_USER)
+            jids.append(self.server.submit(j).split('.')[0])
+
+        qstat_cmd = os.path.join(self.server.pbs_conf['PBS_EXEC'],
+                                 'bin', 'qstat')
+        for target in [[], ['workq']]:
+            ret = self.du.run_cmd(self.server.hostname,
+                                  cmd=[qstat_cmd] + target)
+            self.assertEqual(ret['rc'], 0,
+                             'Qstat returned with non-zero exit status')
+            shown = [l.split('.')[0] for l in ret['out']
+                     if l and l[0].isdigit()]
+            self.assertEqual(shown, jids)
+            hdrs = [l for l in ret['out'] if l.startswith('Job id')]
+            self.assertEqual(len(hdrs), 1)
+
+    def stat_pages(self, steps):
+        """
+        Build the paging driver and run it with the given steps.  Returns
+        the sequence numbers of the jobs it listed, in order.
+        """
+        if self.du.which(exe='gcc') == 'gcc':
+            self.skipTest("Couldn't find gcc!")
+        exec_dir = self.server.pbs_conf['PBS_EXEC']
+        libdir = os.path.join(exec_dir, 'lib')
+        src = self.du.create_temp_file(body=stat_page_code, suffix='.c')
+        exe = self.du.create_temp_file()
+        self.du.rm(path=exe)
+        cmd = ['gcc', '-g', '-O2', '-Wall', '-o', exe, src,
+               '-I%s' % os.path.join(exec_dir, 'include'),
+               '-L%s' % libdir, '-lpbs', '-lz']
+        ret = self.du.run_cmd(cmd=cmd)
+        self.assertEqual(ret['rc'], 0, "\n".join(ret['err']))
+        cmd = ['LD_LIBRARY_PATH=%s %s %s' % (libdir, exe, ' '.join(steps))]
+        ret = self.du.run_cmd(self.server.hostname, cmd=cmd, as_script=True,
+                              runas=MGR_USER)
+        self.assertEqual(ret['rc'], 0, "\n".join(ret['err']))
+        return [l.split('.')[0] for l in ret['out'] if l]
+
+    def test_stat_page_after_job_deleted(self):
+        """
+        Test that a paged job status resumes right after the last job of
+        the previous page when that job is deleted between the pages
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for _ in range(6):
+            j = Job(TEST_USER)
+            jids.append(self.server.submit(j).split('.')[0])
+
+        shown = self.stat_pages(['d', 'd'])
+        self.assertEqual(shown, jids)
+        self.server.expect(JOB, 'queue', op=UNSET, id=jids[1])
+        self.server.expect(JOB, 'queue', op=UNSET, id=jids[3])
+
+    def test_stat_page_after_job_reordered(self):
+        """
+        Test that a paged job status does not skip any job when the last
+        job of the previous page is moved further down the queue with
+        qorder between the pages
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for _ in range(6):
+            j = Job(TEST_USER)
+            jids.append(self.server.submit(j).split('.')[0])
+
+        # After the swap the queue is 0 4 2 3 1 5.  The listing resumes at
+        # the place the second job was, so it is listed again at its new
+        # place but none of the jobs it jumped over are skipped.
+        shown = self.stat_pages(['o' + jids[4]])
+        self.assertEqual(shown, [jids[0], jids[1], jids[4], jids[2],
+                                 jids[3], jids[1], jids[5]])
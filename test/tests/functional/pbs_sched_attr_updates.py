@@ -80,7 +80,8 @@ class TestSchedAttrUpdates(TestFunctional):
         # Verify that scheduler didn't send attr updates for new jobs
         self.server.expect(JOB, "comment", op=UNSET, id=jid5)
         self.server.expect(JOB, "comment", op=UNSET, id=jid6)
-        self.server.log_match("Type 96 request received", existence=False,
+        self.server.log_match("Type (96|102) request received",
+                              regexp=True, existence=False,
                               starttime=t, max_attempts=5)
 
         self.logger.info("Sleep for 45s for the attr_update_period to pass")
@@ -94,7 +95,8 @@ class TestSchedAttrUpdates(TestFunctional):
         # Verify that scheduler sent attr updates for all new jobs
         self.server.expect(JOB, "comment", op=SET, id=jid7)
         self.server.expect(JOB, "comment", op=SET, id=jid8)
-        self.server.log_match("Type 96 request received", starttime=t)
+        self.server.log_match("Type (96|102) request received",
+                              regexp=True, starttime=t)
 
     def test_accrue_type(self):
         """
@@ -138,3 +140,31 @@ class TestSchedAttrUpdates(TestFunctional):
         self.server.expect(JOB, "comment", op=SET, id=jid3, max_attempts=1)
         self.server.expect(JOB, {"accrue_type": "1"}, id=jid3, max_attempts=1)
         self.server.expect(JOB, {"accrue_type": "1"}, id=jid2, max_attempts=1)
+
+    def test_bulk_attr_updates(self):
+        """
+        Test that the scheduler sends the attribute updates of many jobs
+        in one bulk request instead of one request per job
+        """
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {"resources_available.ncpus": 1},
+                            id=self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {"scheduling": "False"})
+
+        j = Job()
+        j.set_sleep_time(1000)
+        jid1 = self.server.submit(j)
+        jids = []
+        for _ in range(20):
+            jids.append(self.server.submit(Job()))
+
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {"job_state": "R"}, id=jid1)
+        for jid in jids:
+            self.server.expect(JOB, {"job_state": "Q", "comment":
+                                     (MATCH_RE, "Not Running")},
+                               id=jid, max_attempts=5)
+        self.server.log_match("Type 102 request received", starttime=t)
+        self.server.log_match("Type 96 request received", existence=False,
+                              starttime=t, max_attempts=5)
@@ -0,0 +1,79 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+import json
+
+from tests.functional import *
+
+
+class TestSchedCycleProfile(TestFunctional):
+
+    def test_cycle_profile(self):
+        """
+        Test that with cycle_profile set the scheduler logs the phase
+        totals of a cycle and writes them to cycle_profile.json
+        """
+        self.scheduler.set_sched_config({'cycle_profile': 'True'})
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+
+        j1 = Job(TEST_USER)
+        jid1 = self.server.submit(j1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        j2 = Job(TEST_USER)
+        jid2 = self.server.submit(j2)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid2)
+        self.scheduler.log_match("Cycle profile: cycle=")
+
+        if 'sched_priv' in self.scheduler.attributes:
+            sched_priv = self.scheduler.attributes['sched_priv']
+        else:
+            sched_priv = os.path.join(self.server.pbs_conf['PBS_HOME'],
+                                      'sched_priv')
+        fn = os.path.join(sched_priv, 'cycle_profile.json')
+        ret = self.du.cat(self.scheduler.hostname, fn, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        prof = json.loads('\n'.join(ret['out']))
+        self.assertGreaterEqual(prof['totals']['cycle']['calls'], 1)
+        self.assertEqual(prof['phases']['cycle']['calls'], 1)
+        self.assertGreaterEqual(prof['totals']['run_job']['calls'], 1)
+        self.assertGreaterEqual(prof['totals']['is_ok_to_run']['calls'], 2)
+        self.assertEqual(len(prof['phases']['query_server']['hist_usec_log2']),
+                         24)
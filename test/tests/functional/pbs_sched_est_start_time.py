@@ -0,0 +1,106 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSchedEstStartTime(TestFunctional):
+
+    def test_est_start_time_freq(self):
+        """
+        Test that with est_start_time_freq set, queued jobs beyond
+        backfill_depth get an estimated start time from the background
+        estimation helper
+        """
+        self.scheduler.set_sched_config({'est_start_time_freq': '00:01:00'})
+        self.server.manager(MGR_CMD_SET, SERVER, {'backfill_depth': '1'})
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        a = {'Resource_List.walltime': 100}
+        jids = []
+        for _ in range(4):
+            j = Job(TEST_USER, a)
+            jids.append(self.server.submit(j))
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[0])
+        self.scheduler.log_match("Estimated the start times of 2 jobs")
+        for jid in jids[1:]:
+            self.server.expect(JOB, 'estimated.start_time', op=SET, id=jid)
+        self.scheduler.log_match(jids[3] + ";Job is estimated to run at")
+
+        # The top job's estimate must come before the later jobs'
+        st = self.server.status(JOB, 'estimated.start_time')
+        est = {s['id']: s['estimated.start_time'] for s in st}
+        t = [int(time.mktime(time.strptime(est[jid], '%a %b %d %H:%M:%S %Y')))
+             for jid in jids[1:]]
+        self.assertLess(t[0], t[1])
+        self.assertLess(t[1], t[2])
+
+    def test_est_helper_reaped_when_unset(self):
+        """
+        Test that the estimation helper is reaped by the next cycle even
+        when est_start_time_freq has been unset in the meantime, and that
+        it does not stay behind as a zombie
+        """
+        self.scheduler.set_sched_config({'est_start_time_freq': '00:01:00'})
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        a = {'Resource_List.walltime': 100}
+        jids = []
+        for _ in range(3):
+            j = Job(TEST_USER, a)
+            jids.append(self.server.submit(j))
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[0])
+        self.scheduler.log_match("Estimated the start times of 1 jobs")
+
+        self.scheduler.unset_sched_config('est_start_time_freq')
+        self.scheduler.run_scheduling_cycle()
+
+        pid = self.scheduler.get_pid()
+        ret = self.du.run_cmd(self.scheduler.hostname,
+                              ['ps', '-o', 'pid=,stat=', '--ppid', str(pid)])
+        for line in ret['out']:
+            self.assertNotIn('Z', line.split()[1],
+                             'Scheduler left a zombie: ' + line)
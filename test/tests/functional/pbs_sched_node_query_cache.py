@@ -0,0 +1,120 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+import re
+
+from tests.functional import *
+
+
+class TestSchedNodeQueryCache(TestFunctional):
+    """
+    Test that vnodes reused from the previous scheduling cycle are
+    refreshed when they change on the server
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 2047})
+        a = {'resources_available.ncpus': 1}
+        self.mom.create_vnodes(a, 2)
+        self.vn = [self.mom.shortname + '[%d]' % i for i in range(2)]
+
+    def reuse_count(self, starttime):
+        """
+        Return the number of vnodes reused and the number queried in the
+        first cycle after starttime
+        """
+        m = self.scheduler.log_match('Reused [0-9]+ of [0-9]+ unchanged',
+                                     regexp=True, starttime=starttime)
+        r = re.search('Reused ([0-9]+) of ([0-9]+) unchanged', m[1])
+        return int(r.group(1)), int(r.group(2))
+
+    def test_changed_vnode_refreshed(self):
+        """
+        Test that a vnode whose resources change between cycles is parsed
+        again while an unchanged vnode is reused
+        """
+        a = {'Resource_List.select': '1:ncpus=2'}
+        j = Job(TEST_USER, a)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+
+        t = time.time()
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 2},
+                            id=self.vn[1])
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        reused, total = self.reuse_count(t)
+        self.assertEqual(reused, total - 1)
+
+        s = self.server.status(JOB, 'exec_vnode', id=jid)
+        self.assertEqual(j.get_vnodes(s[0]['exec_vnode']), [self.vn[1]])
+
+    def test_reused_vnode_state_reset(self):
+        """
+        Test that a job run on a vnode in one cycle does not stay on the
+        reused vnode once the job is gone
+        """
+        a = {'Resource_List.select': '1:ncpus=1'}
+        j1 = Job(TEST_USER, a)
+        jid1 = self.server.submit(j1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.server.delete(jid1, wait=True)
+
+        # both vnodes are free again and should be used for the next job
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        a = {'Resource_List.select': '2:ncpus=1'}
+        j2 = Job(TEST_USER, a)
+        jid2 = self.server.submit(j2)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+
+        # once the vnodes show the job, an unchanged cycle reuses all of
+        # them and must still see the job on them
+        self.scheduler.run_scheduling_cycle()
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        reused, total = self.reuse_count(t)
+        self.assertEqual(reused, total)
+        j3 = Job(TEST_USER, {'Resource_List.select': '1:ncpus=1'})
+        jid3 = self.server.submit(j3)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid3)
@@ -0,0 +1,118 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSchedPsetUpdate(TestFunctional):
+    """
+    Test that placement sets and node ordering are kept up to date as
+    jobs run and end within a scheduling cycle
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_CREATE, RSC,
+                            {'type': 'string', 'flag': 'h'}, id='shape')
+        a = {'resources_available.ncpus': 2}
+        self.mom.create_vnodes(a, 4)
+        self.vn = [self.mom.shortname + '[%d]' % i for i in range(4)]
+        for i, shape in enumerate(['a', 'a', 'b', 'b']):
+            self.server.manager(MGR_CMD_SET, NODE,
+                                {'resources_available.shape': shape},
+                                id=self.vn[i])
+
+    def test_node_sort_unused_in_cycle(self):
+        """
+        Test that with node_sort_key sorting on unused resources, a node
+        which a job ran on earlier in the cycle is moved to its new place
+        """
+        self.scheduler.set_sched_config(
+            {'node_sort_key': '\"ncpus LOW unused\"'})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        j1 = Job(TEST_USER, {'Resource_List.select': '1:ncpus=1'})
+        jid1 = self.server.submit(j1)
+        j2 = Job(TEST_USER, {'Resource_List.select': '1:ncpus=1'})
+        jid2 = self.server.submit(j2)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+
+        # job 1's node has the fewest unused cpus, so job 2 joins it
+        s1 = self.server.status(JOB, 'exec_vnode', id=jid1)
+        s2 = self.server.status(JOB, 'exec_vnode', id=jid2)
+        self.assertEqual(j1.get_vnodes(s1[0]['exec_vnode']),
+                         j2.get_vnodes(s2[0]['exec_vnode']))
+
+    def test_pset_freed_in_calendar(self):
+        """
+        Test that when a job ends in the calendar, its placement set is
+        seen as free again when the top job is estimated
+        """
+        self.scheduler.set_sched_config({'strict_ordering': 'True ALL'})
+        a = {'node_group_key': 'shape', 'node_group_enable': 'True',
+             'scheduling': 'False'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+        a = {'Resource_List.select': '2:ncpus=2',
+             'Resource_List.walltime': 100}
+        j1 = Job(TEST_USER, a)
+        j1.set_sleep_time(1000)
+        jid1 = self.server.submit(j1)
+        a['Resource_List.walltime'] = 1000
+        j2 = Job(TEST_USER, a)
+        j2.set_sleep_time(1000)
+        jid2 = self.server.submit(j2)
+        a['Resource_List.walltime'] = 100
+        j3 = Job(TEST_USER, a)
+        jid3 = self.server.submit(j3)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+        self.server.expect(JOB, 'estimated.exec_vnode', op=SET, id=jid3)
+
+        # job 3 is estimated to run on the placement set job 1 frees
+        s1 = self.server.status(JOB, 'exec_vnode', id=jid1)
+        s3 = self.server.status(JOB, 'estimated.exec_vnode', id=jid3)
+        self.assertEqual(sorted(j1.get_vnodes(s1[0]['exec_vnode'])),
+                         sorted(j3.get_vnodes(
+                             s3[0]['estimated.exec_vnode'])))
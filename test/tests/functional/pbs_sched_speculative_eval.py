@@ -0,0 +1,67 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSchedSpeculativeEval(TestFunctional):
+
+    def test_speculative_no_fit(self):
+        """
+        Test that with speculative_job_eval set, a job which does not fit
+        on any host is found up front and gets the usual comment
+        """
+        self.scheduler.set_sched_config({'speculative_job_eval': 'True'})
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+
+        j1 = Job(TEST_USER, {'Resource_List.select': '1:ncpus=2'})
+        jid1 = self.server.submit(j1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+
+        j2 = Job(TEST_USER, {'Resource_List.select': '1:ncpus=1'})
+        jid2 = self.server.submit(j2)
+        self.scheduler.log_match("2 of 2 equivalence classes can not fit")
+        c = 'Not Running: Insufficient amount of resource: ncpus'
+        self.server.expect(JOB, {'job_state': 'Q', 'comment': (MATCH_RE, c)},
+                           id=jid2)
+
+        # Once resources are freed the job is checked again and runs
+        self.server.delete(jid1, wait=True)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
@@ -414,3 +414,37 @@ pbs.logmsg(pbs.LOG_DEBUG, "periodic hook ended at %%d" %% time.time())
             self.assertTrue(False, msg)
         self.server.manager(MGR_CMD_SET, HOOK, attrs, hook_name)
         self.server.manager(MGR_CMD_LIST, HOOK, {'freq': '120'}, hook_name)
+
+    def test_sp_hook_vnode_resv_list(self):
+        """
+        Check that a periodic hook's vnode_list and resv_list hold every
+        vnode and reservation, and that looking one up returns its
+        attributes even though the objects are only populated on access
+        """
+        vn = self.mom.shortname
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 2}, id=vn)
+        nvnodes = len(self.server.status(NODE))
+        r = Reservation(TEST_USER, attrs={'Resource_List.select': '1:ncpus=1',
+                                          'reserve_start': time.time() + 600,
+                                          'reserve_end': time.time() + 1200})
+        rid = self.server.submit(r)
+        self.server.expect(RESV, {'reserve_state':
+                                  (MATCH_RE, 'RESV_CONFIRMED|2')}, id=rid)
+        scr = """
+import pbs
+e = pbs.event()
+vl = e.vnode_list
+rl = e.resv_list
+pbs.logmsg(pbs.LOG_DEBUG, "vnodes=%%d resvs=%%d" %% (len(vl), len(rl)))
+pbs.logmsg(pbs.LOG_DEBUG, "%%s ncpus=%%s" %%
+           ('%s', vl['%s'].resources_available['ncpus']))
+pbs.logmsg(pbs.LOG_DEBUG, "%%s in list=%%s select=%%s" %%
+           ('%s', '%s' in rl, rl['%s'].Resource_List['select']))
+e.accept()
+""" % (vn, vn, rid, rid, rid)
+        attrs = {'event': "periodic", 'freq': 5, 'enabled': 'True'}
+        self.server.create_import_hook("lazy_hook", attrs, scr)
+        self.server.log_match("vnodes=%d resvs=1" % nvnodes)
+        self.server.log_match("%s ncpus=2" % vn)
+        self.server.log_match("%s in list=True select=1:ncpus=1" % rid)
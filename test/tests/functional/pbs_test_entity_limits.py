@@ -1036,3 +1036,44 @@ class TestEntityLimits(TestFunctional):
         self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
         self.server.expect(JOB, {'job_state': 'S'}, id=jid1)
         self.server.expect(JOB, {'job_state': 'Q'}, id=jid4)
+
+    def test_many_projects_res_max(self):
+        """
+        Enforce per-project limits on two resources with more projects
+        than the scheduler keeps in a plain list, so the counts are looked
+        up through their index, while the jobs of one cycle are run
+        """
+        a = {'resources_available.ncpus': 100,
+             'resources_available.mem': '100gb'}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        a = {'max_run_res.ncpus': '[p:PBS_GENERIC=2]',
+             'max_run_res.mem': '[p:PBS_GENERIC=2gb]'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        # even projects hit the mem limit, odd ones the ncpus limit
+        jobs = {}
+        for i in range(12):
+            proj = 'P%d' % i
+            if i % 2 == 0:
+                select, njobs = '1:ncpus=1:mem=1500mb', 2
+            else:
+                select, njobs = '1:ncpus=1:mem=100mb', 3
+            jobs[proj] = []
+            for _ in range(njobs):
+                attr = {'Resource_List.select': select, ATTR_project: proj}
+                j = Job(TEST_USER, attrs=attr)
+                jobs[proj].append(self.server.submit(j))
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+
+        for proj, jids in jobs.items():
+            for jid in jids[:-1]:
+                self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+            self.server.expect(JOB, {'job_state': 'Q'}, id=jids[-1])
+
+        # the queued job runs once a job of its project ends
+        for proj, jids in jobs.items():
+            self.server.delete(jids[0], wait=True)
+        self.scheduler.run_scheduling_cycle()
+        for proj, jids in jobs.items():
+            self.server.expect(JOB, {'job_state': 'R'}, id=jids[-1])
@@ -123,3 +123,37 @@ class Test_qorder(TestFunctional):
         self.logger.info(msg)
 
         self.assertEqual(firstconsidered, jid2)
+
+    def test_qorder_then_requeue_order(self):
+        """
+        Jobs keep queue rank order in the server and queue job lists after
+        a qorder, a move out and back into the queue, and a server restart
+        """
+        a = {'scheduling': 'false'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+        a = {'queue_type': 'e', 'enabled': '1', 'started': '1'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='workq2')
+
+        jids = []
+        for _ in range(3):
+            j = Job(TEST_USER)
+            jids.append(self.server.submit(j))
+
+        rc = self.server.orderjob(jobid1=jids[0], jobid2=jids[2])
+        self.assertEqual(rc, 0)
+        expected = [jids[2], jids[1], jids[0]]
+        order = [s['id'] for s in self.server.status(JOB)]
+        self.assertEqual(order, expected)
+
+        self.server.movejob(jids[1], 'workq2')
+        self.server.movejob(jids[1], 'workq')
+        expected = [jids[2], jids[0], jids[1]]
+        order = [s['id'] for s in self.server.status(JOB)]
+        self.assertEqual(order, expected)
+        order = [s['id'] for s in self.server.status(JOB, id='workq')]
+        self.assertEqual(order, expected)
+
+        self.server.restart()
+        order = [s['id'] for s in self.server.status(JOB)]
+        self.assertEqual(order, expected)
@@ -0,0 +1,194 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.interfaces import *
+
+# Drives the libpbs host name resolution cache.  Each argument is one step:
+#   a<host>  resolve <host> with pbs_resolve_addrs()
+#   i<host>  drop <host> from the cache, "i" alone drops everything
+#   s<secs>  sleep
+# and prints the result with the cache hit and miss counts after the step.
+test_code = '''
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <netdb.h>
+
+extern int pbs_loadconf(int);
+extern int pbs_resolve_addrs(char *, unsigned long *, int, int *);
+extern void pbs_resolve_cache_invalidate(char *);
+extern void pbs_resolve_cache_stats(unsigned long *, unsigned long *);
+
+int main(int argc, char **argv)
+{
+    unsigned long addrs[16];
+    unsigned long hits, misses;
+    int naddrs = 0;
+    int rc = 0;
+    int i;
+
+    if (pbs_loadconf(0) == 0)
+        return 1;
+    for (i = 1; i < argc; i++) {
+        switch (argv[i][0]) {
+        case 'a':
+            rc = pbs_resolve_addrs(argv[i] + 1, addrs, 16, &naddrs);
+            break;
+        case 'i':
+            pbs_resolve_cache_invalidate(argv[i][1] ? argv[i] + 1 : NULL);
+            break;
+        case 's':
+            sleep(atoi(argv[i] + 1));
+            break;
+        }
+        pbs_resolve_cache_stats(&hits, &misses);
+        printf("%s rc=%d again=%d n=%d hits=%lu misses=%lu\\n", argv[i],
+               rc, rc == EAI_AGAIN, naddrs, hits, misses);
+    }
+    return 0;
+}
+'''
+
+
+class TestResolveCache(TestInterfaces):
+    """
+    Test suite for the host name resolution cache in libpbs
+    """
+    bad_host = 'pbs-no-such-host.invalid'
+
+    def setUp(self):
+        TestInterfaces.setUp(self)
+        if self.du.get_platform().lower() != 'linux':
+            self.skipTest("This test is only supported on Linux!")
+        _gcc = self.du.which(exe='gcc')
+        if _gcc == 'gcc':
+            self.skipTest("Couldn't find gcc!")
+        self._ld = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'lib')
+        _fn = self.du.create_temp_file(body=test_code, suffix='.c')
+        self._en = self.du.create_temp_file()
+        self.du.rm(path=self._en)
+        cmd = ['gcc', '-g', '-O2', '-Wall', '-o', self._en, _fn,
+               '-L%s' % self._ld, '-lpbs', '-lz']
+        _res = self.du.run_cmd(cmd=cmd)
+        self.assertEqual(_res['rc'], 0, "\n".join(_res['err']))
+
+    def run_steps(self, steps, ttl=60, neg_ttl=60):
+        """
+        Run the cache driver with the given TTLs and return one dict of
+        results per step
+        """
+        cmd = ['PBS_DNS_CACHE_TTL=%d PBS_DNS_CACHE_NEG_TTL=%d '
+               'LD_LIBRARY_PATH=%s %s %s' % (ttl, neg_ttl, self._ld,
+                                             self._en, ' '.join(steps))]
+        _res = self.du.run_cmd(cmd=cmd, as_script=True)
+        self.assertEqual(_res['rc'], 0, "\n".join(_res['err']))
+        self.assertEqual(len(_res['out']), len(steps))
+        results = []
+        for line in _res['out']:
+            fields = line.split()
+            r = dict(f.split('=') for f in fields[1:])
+            results.append(dict((k, int(v)) for k, v in r.items()))
+        return results
+
+    def check_negative(self, r):
+        """
+        Skip when the resolver can't give a definite answer for bad_host,
+        as temporary failures are never cached
+        """
+        if r['again']:
+            self.skipTest("No resolver answer for %s" % self.bad_host)
+        self.assertNotEqual(r['rc'], 0)
+
+    def test_ttl_expiry(self):
+        """
+        A resolved name is answered from the cache until its TTL runs out,
+        then looked up again
+        """
+        r = self.run_steps(['alocalhost', 'alocalhost', 's3', 'alocalhost'],
+                           ttl=2)
+        self.assertEqual(r[0]['rc'], 0)
+        self.assertGreater(r[0]['n'], 0)
+        self.assertEqual((r[0]['hits'], r[0]['misses']), (0, 1))
+        self.assertEqual((r[1]['hits'], r[1]['misses']), (1, 1))
+        self.assertEqual(r[1]['n'], r[0]['n'])
+        self.assertEqual((r[3]['hits'], r[3]['misses']), (1, 2))
+        self.assertEqual(r[3]['rc'], 0)
+
+    def test_ttl_zero(self):
+        """
+        A TTL of 0 turns the positive cache off
+        """
+        r = self.run_steps(['alocalhost', 'alocalhost'], ttl=0)
+        self.assertEqual((r[1]['hits'], r[1]['misses']), (0, 2))
+
+    def test_negative_cache(self):
+        """
+        A failed lookup is remembered for the negative TTL, returning the
+        same error, and only for that long
+        """
+        h = 'a' + self.bad_host
+        r = self.run_steps([h, h, 's3', h], neg_ttl=2)
+        self.check_negative(r[0])
+        self.assertEqual((r[1]['hits'], r[1]['misses']), (1, 1))
+        self.assertEqual(r[1]['rc'], r[0]['rc'])
+        self.assertEqual(r[1]['n'], 0)
+        self.assertEqual((r[3]['hits'], r[3]['misses']), (1, 2))
+
+        r = self.run_steps([h, h], neg_ttl=0)
+        self.check_negative(r[0])
+        self.assertEqual((r[1]['hits'], r[1]['misses']), (0, 2))
+
+    def test_invalidate_failed_lookup(self):
+        """
+        A remembered failure is dropped by invalidating its name, or the
+        whole cache, so the next lookup goes to the resolver again; other
+        names stay cached
+        """
+        h = 'a' + self.bad_host
+        r = self.run_steps(['alocalhost', h, 'i' + self.bad_host, h,
+                            'alocalhost', 'i', h, 'alocalhost'])
+        self.check_negative(r[1])
+        self.assertEqual((r[1]['hits'], r[1]['misses']), (0, 2))
+        self.assertEqual((r[3]['hits'], r[3]['misses']), (0, 3))
+        self.assertNotEqual(r[3]['rc'], 0)
+        self.assertEqual((r[4]['hits'], r[4]['misses']), (1, 3))
+        self.assertEqual((r[6]['hits'], r[6]['misses']), (1, 4))
+        self.assertEqual((r[7]['hits'], r[7]['misses']), (1, 5))
+        self.assertEqual(r[7]['rc'], 0)
@@ -0,0 +1,112 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+import random
+import timeit
+
+from tests.performance import *
+
+
+class TestTimedTaskPerf(TestPerformance):
+    """
+    Measure how the server copes with a large number of timed work tasks.
+    Every job submitted with -a puts a timed task on the server's task list,
+    so a lot of waiting jobs stress inserting and dispatching timed tasks.
+    work_task_bench.c in this directory benchmarks the task list by itself.
+    """
+    num_jobs = 20000
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def submit_waiting_jobs(self, first, spread):
+        """
+        Submit num_jobs jobs with an execution time randomly chosen between
+        first and first + spread seconds from now.
+        Returns the time taken to submit them.
+        """
+        now = int(time.time())
+        start = timeit.default_timer()
+        for _ in range(self.num_jobs):
+            when = now + first + random.randint(0, spread)
+            a = {ATTR_a: BatchUtils().convert_seconds_to_datetime(when)}
+            j = Job(TEST_USER, attrs=a)
+            self.server.submit(j)
+        return timeit.default_timer() - start
+
+    @timeout(7200)
+    def test_timed_task_insert(self):
+        """
+        Submit jobs whose execution times are spread over a day, then time
+        a server restart, which recreates a timed task for every job.
+        """
+        submit_time = self.submit_waiting_jobs(3600, 86400)
+        self.server.expect(SERVER, {'state_count': 'Transit:0 Queued:0 '
+                                    'Held:0 Waiting:%d' % self.num_jobs},
+                           op=MATCH_RE)
+
+        start = timeit.default_timer()
+        self.server.restart()
+        self.server.expect(SERVER, {'total_jobs': self.num_jobs})
+        restart_time = timeit.default_timer() - start
+
+        self.logger.info("Submitted %d waiting jobs in %.2fs, "
+                         "restart took %.2fs" % (self.num_jobs, submit_time,
+                                                 restart_time))
+        self.perf_test_result(submit_time, "waiting_job_submit_time", "sec")
+        self.perf_test_result(restart_time, "waiting_job_restart_time", "sec")
+
+    @timeout(7200)
+    def test_timed_task_dispatch(self):
+        """
+        Submit jobs which all become eligible within a minute of each other
+        and time how long the server takes to move them out of the W state.
+        """
+        self.submit_waiting_jobs(120, 60)
+
+        start = timeit.default_timer()
+        self.server.expect(SERVER, {'state_count': 'Transit:0 Queued:%d '
+                                    'Held:0 Waiting:0' % self.num_jobs},
+                           op=MATCH_RE, interval=5, max_attempts=600)
+        dispatch_time = timeit.default_timer() - start
+
+        self.logger.info("Waiting jobs released after %.2fs" % dispatch_time)
+        self.perf_test_result(dispatch_time, "waiting_job_release_time", "sec")
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	work_task_bench.c
+ * @brief
+ *	Micro-benchmark of the server's timed work task list in work_task.c.
+ *
+ *	Timed tasks are added with due times spread at random over the last
+ *	day, 10% of them are deleted, and default_next_task() dispatches the
+ *	rest.  The time per task of each phase is printed, and the program
+ *	fails if the tasks are not dispatched in order of due time, or in the
+ *	order they were added when they are due at the same time.
+ *
+ *	It is not built with PBS.  From the top of a configured build tree:
+ *
+ *	cc -O2 -I src/include -I $srcdir/src/include -o work_task_bench \
+ *		$srcdir/test/tests/performance/work_task_bench.c \
+ *		$srcdir/src/lib/Libutil/work_task.c \
+ *		$srcdir/src/lib/Libifl/list_link.c
+ *
+ *	Usage: work_task_bench [number of tasks [seed]]
+ *	The default is 1000000 tasks.
+ */
+
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "list_link.h"
+#include "work_task.h"
+
+/* the globals work_task.c expects from the server */
+pbs_list_head task_list_immed;
+pbs_list_head task_list_timed;
+pbs_list_head task_list_event;
+int svr_delay_entry = 0;
+time_t time_now;
+
+static long last_event;		/* due time of the last dispatched task */
+static long last_seq;		/* add order of the last dispatched task */
+static long num_dispatched;
+static int out_of_order;
+
+/**
+ * @brief
+ *	work task function which checks the dispatch order
+ *
+ * @param[in]	ptask	- the task being dispatched, wt_aux is its add order
+ */
+static void
+bench_task(struct work_task *ptask)
+{
+	if (ptask->wt_event < last_event ||
+		(ptask->wt_event == last_event && ptask->wt_aux < last_seq))
+		out_of_order = 1;
+	last_event = ptask->wt_event;
+	last_seq = ptask->wt_aux;
+	num_dispatched++;
+}
+
+/**
+ * @brief
+ *	return the time in seconds between two timespecs
+ */
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct work_task **tasks;
+	struct timespec t0;
+	struct timespec t1;
+	long num_tasks = 1000000;
+	long num_deleted = 0;
+	long i;
+	time_t now;
+
+	if (argc > 1)
+		num_tasks = strtol(argv[1], NULL, 10);
+	srandom(argc > 2 ? (unsigned int) strtoul(argv[2], NULL, 10) : 1);
+	if (num_tasks <= 0) {
+		fprintf(stderr, "usage: %s [number of tasks [seed]]\n", argv[0]);
+		return 2;
+	}
+
+	CLEAR_HEAD(task_list_immed);
+	CLEAR_HEAD(task_list_timed);
+	CLEAR_HEAD(task_list_event);
+
+	if ((tasks = malloc(num_tasks * sizeof(struct work_task *))) == NULL) {
+		perror("malloc");
+		return 1;
+	}
+
+	/* all tasks are due by now, so default_next_task() dispatches them all */
+	now = time(NULL);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < num_tasks; i++) {
+		tasks[i] = set_task(WORK_Timed, now - 1 - random() % 86400, bench_task, NULL);
+		if (tasks[i] == NULL) {
+			fprintf(stderr, "set_task failed\n");
+			return 1;
+		}
+		tasks[i]->wt_aux = (int) i;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	printf("insert:   %ld tasks, %.3f us per task\n", num_tasks,
+		elapsed(&t0, &t1) * 1e6 / num_tasks);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < num_tasks; i++) {
+		if (random() % 10 == 0) {
+			delete_task(tasks[i]);
+			num_deleted++;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	if (num_deleted > 0)
+		printf("delete:   %ld tasks, %.3f us per task\n", num_deleted,
+			elapsed(&t0, &t1) * 1e6 / num_deleted);
+
+	last_event = 0;
+	last_seq = -1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	(void) default_next_task();
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	if (num_dispatched > 0)
+		printf("dispatch: %ld tasks, %.3f us per task\n", num_dispatched,
+			elapsed(&t0, &t1) * 1e6 / num_dispatched);
+
+	free(tasks);
+
+	if (num_dispatched != num_tasks - num_deleted) {
+		fprintf(stderr, "dispatched %ld of %ld tasks\n", num_dispatched,
+			num_tasks - num_deleted);
+		return 1;
+	}
+	if (out_of_order) {
+		fprintf(stderr, "tasks were dispatched out of order\n");
+		return 1;
+	}
+
+	return 0;
+}